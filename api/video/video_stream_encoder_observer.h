@@ -63,6 +63,9 @@ class VideoStreamEncoderObserver : public CpuOveruseMetricsObserver {
   ~VideoStreamEncoderObserver() override = default;
 
   virtual void OnIncomingFrame(int width, int height) = 0;
+  // Called when an incoming frame has made it through the encoder queue, with
+  // the capture time of the frame in the clock of the encoder.
+  virtual void OnIncomingFrameQueued(int64_t capture_time_ms) {}
 
   // TODO(nisse): Merge into one callback per encoded frame.
   using CpuOveruseMetricsObserver::OnEncodedFrameTimeMeasured;
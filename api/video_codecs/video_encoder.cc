@@ -12,6 +12,7 @@
 
 #include <string.h>
 
+#include "absl/algorithm/container.h"
 #include "rtc_base/checks.h"
 
 namespace webrtc {
@@ -80,6 +81,8 @@ constexpr VideoEncoder::ScalingSettings::KOff
     VideoEncoder::ScalingSettings::kOff;
 // static
 constexpr uint8_t VideoEncoder::EncoderInfo::kMaxFramerateFraction;
+// static
+constexpr size_t VideoEncoder::EncoderInfo::kMaxPreferredPixelFormats;
 
 VideoEncoder::EncoderInfo::EncoderInfo()
     : scaling_settings(VideoEncoder::ScalingSettings::kOff),
@@ -90,12 +93,20 @@ VideoEncoder::EncoderInfo::EncoderInfo()
       has_internal_source(false),
       fps_allocation{absl::InlinedVector<uint8_t, kMaxTemporalStreams>(
           1,
-          kMaxFramerateFraction)} {}
+          kMaxFramerateFraction)},
+      preferred_pixel_formats{VideoFrameBuffer::Type::kI420} {}
 
 VideoEncoder::EncoderInfo::EncoderInfo(const EncoderInfo&) = default;
 
 VideoEncoder::EncoderInfo::~EncoderInfo() = default;
 
+bool VideoEncoder::EncoderInfo::SupportsBufferType(
+    VideoFrameBuffer::Type type) const {
+  if (type == VideoFrameBuffer::Type::kNative)
+    return supports_native_handle;
+  return absl::c_linear_search(preferred_pixel_formats, type);
+}
+
 VideoEncoder::RateControlParameters::RateControlParameters()
     : bitrate(VideoBitrateAllocation()),
       framerate_fps(0.0),
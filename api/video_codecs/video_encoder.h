@@ -24,6 +24,7 @@
 #include "api/video/video_bitrate_allocation.h"
 #include "api/video/video_codec_constants.h"
 #include "api/video/video_frame.h"
+#include "api/video/video_frame_buffer.h"
 #include "api/video_codecs/video_codec.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/system/rtc_export.h"
@@ -147,6 +148,7 @@ class RTC_EXPORT VideoEncoder {
   struct EncoderInfo {
     static constexpr uint8_t kMaxFramerateFraction =
         std::numeric_limits<uint8_t>::max();
+    static constexpr size_t kMaxPreferredPixelFormats = 5;
 
     EncoderInfo();
     EncoderInfo(const EncoderInfo&);
@@ -216,6 +218,17 @@ class RTC_EXPORT VideoEncoder {
 
     // Recommended bitrate thresholds for different resolutions.
     std::vector<ResolutionBitrateThresholds> resolution_bitrate_thresholds;
+
+    // The memory backed frame buffer types the encoder can encode without
+    // converting them first, in order of preference. Frames of other types
+    // are converted to I420 before they are passed to Encode(), except for
+    // native frames if |supports_native_handle| is set. Defaults to I420.
+    absl::InlinedVector<VideoFrameBuffer::Type, kMaxPreferredPixelFormats>
+        preferred_pixel_formats;
+
+    // Returns true if a frame buffer of |type| can be passed to Encode()
+    // as is.
+    bool SupportsBufferType(VideoFrameBuffer::Type type) const;
   };
 
   struct RateControlParameters {
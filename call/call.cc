@@ -41,6 +41,7 @@
 #include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
 #include "modules/rtp_rtcp/include/rtp_header_parser.h"
 #include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
 #include "modules/rtp_rtcp/source/rtp_packet_received.h"
 #include "modules/utility/include/process_thread.h"
 #include "modules/video_coding/fec_controller_default.h"
@@ -1494,18 +1495,27 @@ void Call::NotifyBweOfReceivedPacket(const RtpPacketReceived& packet,
   bool use_send_side_bwe =
       (it != receive_rtp_config_.end()) && it->second.use_send_side_bwe;
 
-  RTPHeader header;
-  packet.GetHeader(&header);
+  // Reads only the extensions needed here; the full header is built below
+  // for the receive side estimator alone.
+  RTPHeaderExtension extension;
+  extension.hasAbsoluteSendTime =
+      packet.GetExtension<AbsoluteSendTime>(&extension.absoluteSendTime);
+  uint16_t transport_sequence_number;
+  absl::optional<FeedbackRequest> feedback_request;
+  const bool has_transport_sequence_number =
+      packet.GetExtension<TransportSequenceNumberV2>(
+          &transport_sequence_number, &feedback_request) ||
+      packet.GetExtension<TransportSequenceNumber>(&transport_sequence_number);
 
   ReceivedPacket packet_msg;
   packet_msg.size = DataSize::bytes(packet.payload_size());
   packet_msg.receive_time = Timestamp::ms(packet.arrival_time_ms());
-  if (header.extension.hasAbsoluteSendTime) {
-    packet_msg.send_time = header.extension.GetAbsoluteSendTimestamp();
+  if (extension.hasAbsoluteSendTime) {
+    packet_msg.send_time = extension.GetAbsoluteSendTimestamp();
   }
   transport_send_ptr_->OnReceivedPacket(packet_msg);
 
-  if (!use_send_side_bwe && header.extension.hasTransportSequenceNumber) {
+  if (!use_send_side_bwe && has_transport_sequence_number) {
     // Inconsistent configuration of send side BWE. Do nothing.
     // TODO(nisse): Without this check, we may produce RTCP feedback
     // packets even when not negotiated. But it would be cleaner to
@@ -1517,7 +1527,9 @@ void Call::NotifyBweOfReceivedPacket(const RtpPacketReceived& packet,
   }
   // For audio, we only support send side BWE.
   if (media_type == MediaType::VIDEO ||
-      (use_send_side_bwe && header.extension.hasTransportSequenceNumber)) {
+      (use_send_side_bwe && has_transport_sequence_number)) {
+    RTPHeader header;
+    packet.GetHeader(&header);
     receive_side_cc_.OnReceivedPacket(
         packet.arrival_time_ms(), packet.payload_size() + packet.padding_size(),
         header);
@@ -10,6 +10,8 @@
 
 #include "call/rtp_demuxer.h"
 
+#include <algorithm>
+
 #include "call/rtp_packet_sink_interface.h"
 #include "call/rtp_rtcp_demuxer_helper.h"
 #include "call/ssrc_binding_observer.h"
@@ -20,6 +22,12 @@
 #include "rtc_base/strings/string_builder.h"
 
 namespace webrtc {
+namespace {
+
+// Initial capacity of the SSRC table. It is doubled when it is half full.
+constexpr int kMinSsrcEntriesBits = 4;
+
+}  // namespace
 
 RtpDemuxerCriteria::RtpDemuxerCriteria() = default;
 RtpDemuxerCriteria::~RtpDemuxerCriteria() = default;
@@ -43,6 +51,25 @@ std::string RtpDemuxer::DescribePacket(const RtpPacketReceived& packet) {
   return sb.Release();
 }
 
+RtpDemuxer::IdTable::IdTable() = default;
+RtpDemuxer::IdTable::~IdTable() = default;
+
+int RtpDemuxer::IdTable::Find(const std::string& name) const {
+  const auto it = ids_.find(name);
+  if (it == ids_.end()) {
+    return kNoId;
+  }
+  return it->second;
+}
+
+int RtpDemuxer::IdTable::FindOrAdd(const std::string& name) {
+  const auto result = ids_.emplace(name, static_cast<int>(names_.size()));
+  if (result.second) {
+    names_.push_back(name);
+  }
+  return result.first->second;
+}
+
 RtpDemuxer::RtpDemuxer() = default;
 
 RtpDemuxer::~RtpDemuxer() {
@@ -69,7 +96,13 @@ bool RtpDemuxer::AddSink(const RtpDemuxerCriteria& criteria,
     return false;
   }
 
+  // Ids of signaled MIDs and RSIDs are never limited, unlike those of RSIDs
+  // that are first seen in packets.
+  if (!criteria.rsid.empty()) {
+    rsids_.FindOrAdd(criteria.rsid);
+  }
   if (!criteria.mid.empty()) {
+    mids_.FindOrAdd(criteria.mid);
     if (criteria.rsid.empty()) {
       sink_by_mid_.emplace(criteria.mid, sink);
     } else {
@@ -91,6 +124,7 @@ bool RtpDemuxer::AddSink(const RtpDemuxerCriteria& criteria,
   }
 
   RefreshKnownMids();
+  ++rules_version_;
 
   return true;
 }
@@ -104,7 +138,7 @@ bool RtpDemuxer::CriteriaWouldConflict(
       // MID, RSID pair for our MID and some RSID.
       // Adding this criteria would cause one of these rules to be shadowed, so
       // reject this new criteria.
-      if (known_mids_.find(criteria.mid) != known_mids_.end()) {
+      if (IsKnownMid(criteria.mid)) {
         return true;
       }
     } else {
@@ -134,19 +168,24 @@ bool RtpDemuxer::CriteriaWouldConflict(
 }
 
 void RtpDemuxer::RefreshKnownMids() {
-  known_mids_.clear();
+  known_mids_.assign(mids_.size(), false);
 
   for (auto const& item : sink_by_mid_) {
     const std::string& mid = item.first;
-    known_mids_.insert(mid);
+    known_mids_[mids_.Find(mid)] = true;
   }
 
   for (auto const& item : sink_by_mid_and_rsid_) {
     const std::string& mid = item.first.first;
-    known_mids_.insert(mid);
+    known_mids_[mids_.Find(mid)] = true;
   }
 }
 
+bool RtpDemuxer::IsKnownMid(const std::string& mid) const {
+  const int mid_id = mids_.Find(mid);
+  return mid_id != kNoId && known_mids_[mid_id];
+}
+
 bool RtpDemuxer::AddSink(uint32_t ssrc, RtpPacketSinkInterface* sink) {
   RtpDemuxerCriteria criteria;
   criteria.ssrcs.insert(ssrc);
@@ -168,6 +207,7 @@ bool RtpDemuxer::RemoveSink(const RtpPacketSinkInterface* sink) {
                        RemoveFromMapByValue(&sink_by_mid_and_rsid_, sink) +
                        RemoveFromMapByValue(&sink_by_rsid_, sink);
   RefreshKnownMids();
+  ++rules_version_;
   return num_removed > 0;
 }
 
@@ -194,42 +234,88 @@ RtpPacketSinkInterface* RtpDemuxer::ResolveSink(
     has_rsid = packet.GetExtension<RtpStreamId>(&packet_rsid);
   }
   uint32_t ssrc = packet.Ssrc();
+  uint8_t payload_type = packet.PayloadType();
 
   // The BUNDLE spec says to drop any packets with unknown MIDs, even if the
   // SSRC is known/latched.
-  if (has_mid && known_mids_.find(packet_mid) == known_mids_.end()) {
-    return nullptr;
+  int packet_mid_id = kNoId;
+  if (has_mid) {
+    packet_mid_id = mids_.Find(packet_mid);
+    if (packet_mid_id == kNoId || !known_mids_[packet_mid_id]) {
+      return nullptr;
+    }
+  }
+  int packet_rsid_id = kNoId;
+  if (has_rsid) {
+    packet_rsid_id = rsids_.Find(packet_rsid);
+    if (packet_rsid_id == kNoId) {
+      // Bound the memory spent on RSIDs chosen by the peer. The RSIDs of the
+      // sinks got their ids in AddSink, so this never hides a signaled RSID.
+      if (num_unsignaled_rsids_ < kMaxSsrcBindings) {
+        packet_rsid_id = rsids_.FindOrAdd(packet_rsid);
+        ++num_unsignaled_rsids_;
+      } else {
+        packet_rsid_id = kUnknownId;
+      }
+    }
+  }
+
+  // Packets of an SSRC that has been resolved before, with the same (or no)
+  // MID and RSID and since when no sinks have changed, go to the same sink.
+  SsrcEntry* entry = FindSsrcEntry(ssrc);
+  if (entry != nullptr && entry->rules_version == rules_version_ &&
+      entry->payload_type == payload_type &&
+      (!has_mid || packet_mid_id == entry->mid) &&
+      (!has_rsid || packet_rsid_id == entry->rsid)) {
+    return entry->sink;
   }
 
+  RtpPacketSinkInterface* sink =
+      ResolveSinkByIds(packet_mid_id, packet_rsid_id, ssrc, payload_type);
+
+  entry = FindOrAddSsrcEntry(ssrc);
+  if (entry != nullptr) {
+    entry->rules_version = rules_version_;
+    entry->payload_type = payload_type;
+    entry->sink = sink;
+  }
+  return sink;
+}
+
+RtpPacketSinkInterface* RtpDemuxer::ResolveSinkByIds(int packet_mid_id,
+                                                     int packet_rsid_id,
+                                                     uint32_t ssrc,
+                                                     uint8_t payload_type) {
   // Cache information we learn about SSRCs and IDs. We need to do this even if
   // there isn't a rule/sink yet because we might add an MID/RSID rule after
   // learning an MID/RSID<->SSRC association.
-
-  std::string* mid = nullptr;
-  if (has_mid) {
-    mid_by_ssrc_[ssrc] = packet_mid;
-    mid = &packet_mid;
-  } else {
-    // If the packet does not include a MID header extension, check if there is
-    // a latched MID for the SSRC.
-    const auto it = mid_by_ssrc_.find(ssrc);
-    if (it != mid_by_ssrc_.end()) {
-      mid = &it->second;
+  int mid_id = packet_mid_id;
+  int rsid_id = packet_rsid_id;
+  if (packet_mid_id != kNoId || packet_rsid_id != kNoId) {
+    // Once the SSRC table is full, new SSRCs are routed by the ids in their
+    // packets alone.
+    SsrcEntry* entry = FindOrAddSsrcEntry(ssrc);
+    if (entry != nullptr) {
+      if (packet_mid_id != kNoId) {
+        entry->mid = packet_mid_id;
+      }
+      if (packet_rsid_id != kNoId) {
+        entry->rsid = packet_rsid_id;
+      }
+      mid_id = entry->mid;
+      rsid_id = entry->rsid;
     }
-  }
-
-  std::string* rsid = nullptr;
-  if (has_rsid) {
-    rsid_by_ssrc_[ssrc] = packet_rsid;
-    rsid = &packet_rsid;
   } else {
-    // If the packet does not include an RRID/RSID header extension, check if
-    // there is a latched RSID for the SSRC.
-    const auto it = rsid_by_ssrc_.find(ssrc);
-    if (it != rsid_by_ssrc_.end()) {
-      rsid = &it->second;
+    // If the packet does not include a MID or RRID/RSID header extension,
+    // check if there is a latched MID or RSID for the SSRC.
+    const SsrcEntry* entry = FindSsrcEntry(ssrc);
+    if (entry != nullptr) {
+      mid_id = entry->mid;
+      rsid_id = entry->rsid;
     }
   }
+  const std::string* mid = mid_id != kNoId ? &mids_.Name(mid_id) : nullptr;
+  const std::string* rsid = rsid_id >= 0 ? &rsids_.Name(rsid_id) : nullptr;
 
   // If MID and/or RSID is specified, prioritize that for demuxing the packet.
   // The motivation behind the BUNDLE algorithm is that we trust these are used
@@ -276,7 +362,7 @@ RtpPacketSinkInterface* RtpDemuxer::ResolveSink(
   }
 
   // Legacy senders will only signal payload type, support that as last resort.
-  return ResolveSinkByPayloadType(packet.PayloadType(), ssrc);
+  return ResolveSinkByPayloadType(payload_type, ssrc);
 }
 
 RtpPacketSinkInterface* RtpDemuxer::ResolveSinkByMid(const std::string& mid,
@@ -379,6 +465,68 @@ bool RtpDemuxer::AddSsrcSinkBinding(uint32_t ssrc,
   return false;
 }
 
+size_t RtpDemuxer::SsrcEntryIndex(uint32_t ssrc) const {
+  // Fibonacci hashing; uses the high bits of the product.
+  return static_cast<uint32_t>(ssrc * 0x9E3779B9u) >>
+         (32 - ssrc_entries_bits_);
+}
+
+RtpDemuxer::SsrcEntry* RtpDemuxer::FindSsrcEntry(uint32_t ssrc) {
+  if (ssrc_entries_.empty()) {
+    return nullptr;
+  }
+  const size_t mask = ssrc_entries_.size() - 1;
+  for (size_t i = SsrcEntryIndex(ssrc);; i = (i + 1) & mask) {
+    SsrcEntry& entry = ssrc_entries_[i];
+    if (!entry.used) {
+      return nullptr;
+    }
+    if (entry.ssrc == ssrc) {
+      return &entry;
+    }
+  }
+}
+
+RtpDemuxer::SsrcEntry* RtpDemuxer::FindOrAddSsrcEntry(uint32_t ssrc) {
+  if (num_ssrc_entries_ >= kMaxSsrcBindings) {
+    return FindSsrcEntry(ssrc);
+  }
+  if (2 * (num_ssrc_entries_ + 1) > ssrc_entries_.size()) {
+    GrowSsrcEntries();
+  }
+  const size_t mask = ssrc_entries_.size() - 1;
+  for (size_t i = SsrcEntryIndex(ssrc);; i = (i + 1) & mask) {
+    SsrcEntry& entry = ssrc_entries_[i];
+    if (!entry.used) {
+      entry.used = true;
+      entry.ssrc = ssrc;
+      ++num_ssrc_entries_;
+      return &entry;
+    }
+    if (entry.ssrc == ssrc) {
+      return &entry;
+    }
+  }
+}
+
+void RtpDemuxer::GrowSsrcEntries() {
+  std::vector<SsrcEntry> old_entries;
+  old_entries.swap(ssrc_entries_);
+  ssrc_entries_bits_ = std::max(ssrc_entries_bits_ + 1, kMinSsrcEntriesBits);
+  ssrc_entries_.resize(size_t{1} << ssrc_entries_bits_);
+  const size_t mask = ssrc_entries_.size() - 1;
+  for (const SsrcEntry& old_entry : old_entries) {
+    if (!old_entry.used) {
+      continue;
+    }
+    size_t i = SsrcEntryIndex(old_entry.ssrc);
+    while (ssrc_entries_[i].used) {
+      i = (i + 1) & mask;
+    }
+    ssrc_entries_[i] = old_entry;
+  }
+}
+
 void RtpDemuxer::RegisterSsrcBindingObserver(SsrcBindingObserver* observer) {
   RTC_DCHECK(observer);
   RTC_DCHECK(!ContainerHasKey(ssrc_binding_observers_, observer));
@@ -11,9 +11,12 @@
 #ifndef CALL_RTP_DEMUXER_H_
 #define CALL_RTP_DEMUXER_H_
 
+#include <stdint.h>
+
 #include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -155,6 +158,13 @@ class RtpDemuxer {
   // Will record any SSRC<->ID associations along the way.
   // If the packet should be dropped, this method returns null.
   RtpPacketSinkInterface* ResolveSink(const RtpPacketReceived& packet);
+  // Runs the demux algorithm given the ids of the MID and RSID of the packet,
+  // or kNoId if it has none. Called by ResolveSink when there is no memoized
+  // sink for the packet.
+  RtpPacketSinkInterface* ResolveSinkByIds(int packet_mid_id,
+                                           int packet_rsid_id,
+                                           uint32_t ssrc,
+                                           uint8_t payload_type);
 
   // Used by the ResolveSink algorithm.
   RtpPacketSinkInterface* ResolveSinkByMid(const std::string& mid,
@@ -170,6 +180,7 @@ class RtpDemuxer {
   // Regenerate the known_mids_ set from information in the sink_by_mid_ and
   // sink_by_mid_and_rsid_ maps.
   void RefreshKnownMids();
+  bool IsKnownMid(const std::string& mid) const;
 
   // Map each sink by its component attributes to facilitate quick lookups.
   // Payload Type mapping is a multimap because if two sinks register for the
@@ -185,17 +196,75 @@ class RtpDemuxer {
       sink_by_mid_and_rsid_;
   std::map<std::string, RtpPacketSinkInterface*> sink_by_rsid_;
 
-  // Tracks all the MIDs that have been identified in added criteria. Used to
-  // determine if a packet should be dropped right away because the MID is
-  // unknown.
-  std::set<std::string> known_mids_;
+  static constexpr int kNoId = -1;
+  // Latched for RSIDs seen in packets once the peer has used up its share of
+  // |rsids_|. Matches no sink.
+  static constexpr int kUnknownId = -2;
+
+  // Maps MIDs and RSIDs to small integer ids, so that what is learned on the
+  // packet path can be stored and compared without copying strings. Ids are
+  // indices into |names_| and are never reused.
+  class IdTable {
+   public:
+    IdTable();
+    ~IdTable();
+
+    // Returns the id of |name|, or kNoId if |name| has no id.
+    int Find(const std::string& name) const;
+    int FindOrAdd(const std::string& name);
+    const std::string& Name(int id) const { return names_[id]; }
+    size_t size() const { return names_.size(); }
+
+   private:
+    std::unordered_map<std::string, int> ids_;
+    std::vector<std::string> names_;
+  };
+
+  // MIDs get ids when used in a criteria, RSIDs also when seen in packets.
+  IdTable mids_;
+  IdTable rsids_;
+  // Number of RSIDs in |rsids_| that were first seen in packets rather than
+  // added in a criteria. Bounded by kMaxSsrcBindings, as the peer chooses them.
+  int num_unsignaled_rsids_ = 0;
+
+  // Tracks all the MIDs that have been identified in added criteria, indexed
+  // by MID id. Used to determine if a packet should be dropped right away
+  // because the MID is unknown.
+  std::vector<bool> known_mids_;
+
+  // What has been learned about an SSRC from received packets.
+  struct SsrcEntry {
+    uint32_t ssrc = 0;
+    bool used = false;
+    // Latched MID and RSID ids, or kNoId.
+    int mid = kNoId;
+    int rsid = kNoId;
+    // The sink that ResolveSink() returned for the latched MID and RSID and
+    // |payload_type|. Valid while |rules_version| equals |rules_version_|.
+    uint32_t rules_version = 0;
+    uint8_t payload_type = 0;
+    RtpPacketSinkInterface* sink = nullptr;
+  };
 
   // Records learned mappings of MID --> SSRC and RSID --> SSRC as packets are
-  // received.
+  // received, together with the resolved sink, in an open-addressed hash table
+  // with linear probing. Entries are never removed; latched ids are kept also
+  // when sinks are removed. At most kMaxSsrcBindings SSRCs get an entry;
+  // FindOrAddSsrcEntry() returns null for new SSRCs once the table is full.
   // This is stored separately from the sink mappings because if a sink is
   // removed we want to still remember these associations.
-  std::map<uint32_t, std::string> mid_by_ssrc_;
-  std::map<uint32_t, std::string> rsid_by_ssrc_;
+  SsrcEntry* FindSsrcEntry(uint32_t ssrc);
+  SsrcEntry* FindOrAddSsrcEntry(uint32_t ssrc);
+  void GrowSsrcEntries();
+  size_t SsrcEntryIndex(uint32_t ssrc) const;
+
+  std::vector<SsrcEntry> ssrc_entries_;
+  size_t num_ssrc_entries_ = 0;
+  int ssrc_entries_bits_ = 0;
+
+  // Incremented whenever the sinks or their criteria change, invalidating the
+  // sinks memoized in |ssrc_entries_|.
+  uint32_t rules_version_ = 1;
 
   // Adds a binding from the SSRC to the given sink. Returns true if there was
   // not already a sink bound to the SSRC or if the sink replaced a different
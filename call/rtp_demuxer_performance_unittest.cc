@@ -0,0 +1,129 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "call/rtp_demuxer.h"
+#include "call/rtp_packet_sink_interface.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumPackets = 2000000;
+constexpr int kQuickNumPackets = 100000;
+constexpr uint8_t kAudioPayloadType = 111;
+constexpr uint8_t kVideoPayloadType = 96;
+const char* const kRsids[] = {"lo", "mid", "hi"};
+
+class NullSink : public RtpPacketSinkInterface {
+ public:
+  void OnRtpPacket(const RtpPacketReceived& packet) override {}
+};
+
+// A bundle where every other m-line is audio, demuxed by MID, and every other
+// is video with three simulcast layers, demuxed by MID and RSID.
+class Bundle {
+ public:
+  Bundle(int num_mids, bool include_ids) {
+    extensions_.Register<RtpMid>(1);
+    extensions_.Register<RtpStreamId>(2);
+    uint32_t ssrc = 1000;
+    sinks_.resize(num_mids * 3);
+    for (int i = 0; i < num_mids; ++i) {
+      const std::string mid = std::to_string(i);
+      RtpDemuxerCriteria criteria;
+      criteria.mid = mid;
+      if (i % 2 == 0) {
+        EXPECT_TRUE(demuxer_.AddSink(criteria, &sinks_[3 * i]));
+        AddStream(include_ids, ssrc++, kAudioPayloadType, mid, "");
+        continue;
+      }
+      for (int j = 0; j < 3; ++j) {
+        criteria.rsid = kRsids[j];
+        EXPECT_TRUE(demuxer_.AddSink(criteria, &sinks_[3 * i + j]));
+        AddStream(include_ids, ssrc++, kVideoPayloadType, mid, kRsids[j]);
+      }
+    }
+  }
+
+  ~Bundle() {
+    for (NullSink& sink : sinks_) {
+      demuxer_.RemoveSink(&sink);
+    }
+  }
+
+  RtpDemuxer& demuxer() { return demuxer_; }
+  const std::vector<RtpPacketReceived>& packets() const { return packets_; }
+
+ private:
+  // Sends a first packet carrying the MID and RSID so that the demuxer
+  // latches |ssrc|, then stores the packet used for the measurements.
+  void AddStream(bool include_ids,
+                 uint32_t ssrc,
+                 uint8_t payload_type,
+                 const std::string& mid,
+                 const std::string& rsid) {
+    RtpPacketReceived packet(&extensions_);
+    packet.SetSsrc(ssrc);
+    packet.SetPayloadType(payload_type);
+    RtpPacketReceived latching_packet = packet;
+    latching_packet.SetExtension<RtpMid>(mid);
+    if (!rsid.empty()) {
+      latching_packet.SetExtension<RtpStreamId>(rsid);
+    }
+    EXPECT_TRUE(demuxer_.OnRtpPacket(latching_packet));
+    packets_.push_back(include_ids ? latching_packet : packet);
+  }
+
+  RtpPacketReceived::ExtensionManager extensions_;
+  RtpDemuxer demuxer_;
+  std::vector<NullSink> sinks_;
+  std::vector<RtpPacketReceived> packets_;
+};
+
+}  // namespace
+
+// Measures the per packet cost of demuxing a BUNDLE group, both when every
+// packet carries the MID and RSID header extensions and when the SSRCs have
+// already been latched and packets carry no extensions.
+TEST(RtpDemuxerPerformanceTest, LargeBundles) {
+  const int num_packets = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                              ? kQuickNumPackets
+                              : kNumPackets;
+  for (int num_mids : {4, 64, 256}) {
+    for (bool include_ids : {true, false}) {
+      Bundle bundle(num_mids, include_ids);
+      const std::vector<RtpPacketReceived>& packets = bundle.packets();
+      int num_routed = 0;
+      const int64_t start_cpu_ns = rtc::GetThreadCpuTimeNanos();
+      for (int i = 0; i < num_packets; ++i) {
+        num_routed += bundle.demuxer().OnRtpPacket(packets[i % packets.size()]);
+      }
+      const int64_t cpu_ns = rtc::GetThreadCpuTimeNanos() - start_cpu_ns;
+      EXPECT_EQ(num_packets, num_routed);
+      const std::string trace = std::to_string(num_mids) + "_mids_" +
+                                (include_ids ? "mid_rsid" : "ssrc_only");
+      test::PrintResult("rtp_demuxer_cpu_per_packet", "", trace,
+                        static_cast<double>(cpu_ns) / num_packets, "ns",
+                        true);
+    }
+  }
+}
+
+}  // namespace webrtc
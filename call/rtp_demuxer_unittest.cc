@@ -13,6 +13,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "call/ssrc_binding_observer.h"
@@ -1459,6 +1460,35 @@ TEST_F(RtpDemuxerTest,
   demuxer_.OnRtpPacket(*packet);
 }
 
+TEST_F(RtpDemuxerTest, LargeBundleWithSimulcastRoutedBySsrcAfterLatching) {
+  constexpr int kNumMids = 64;
+  const std::string kRsids[] = {"lo", "mid", "hi"};
+
+  std::vector<std::unique_ptr<MockRtpPacketSink>> sinks;
+  for (int i = 0; i < kNumMids; ++i) {
+    for (const std::string& rsid : kRsids) {
+      sinks.push_back(absl::make_unique<MockRtpPacketSink>());
+      ASSERT_TRUE(
+          AddSinkBothMidRsid(std::to_string(i), rsid, sinks.back().get()));
+      EXPECT_CALL(*sinks.back(), OnRtpPacket(_)).Times(2);
+    }
+  }
+
+  // The first packet of every SSRC carries MID and RSID, the second only the
+  // SSRC.
+  for (size_t i = 0; i < sinks.size(); ++i) {
+    const uint32_t ssrc = 1000 + i;
+    auto packet = CreatePacketWithSsrcMidRsid(
+        ssrc, std::to_string(i / arraysize(kRsids)),
+        kRsids[i % arraysize(kRsids)]);
+    EXPECT_TRUE(demuxer_.OnRtpPacket(*packet));
+  }
+  for (size_t i = 0; i < sinks.size(); ++i) {
+    const uint32_t ssrc = 1000 + i;
+    EXPECT_TRUE(demuxer_.OnRtpPacket(*CreatePacketWithSsrc(ssrc)));
+  }
+}
+
 TEST_F(RtpDemuxerTest, MaliciousPeerCannotCauseMemoryOveruse) {
   const std::string mid = "v";
 
@@ -1477,6 +1507,33 @@ TEST_F(RtpDemuxerTest, MaliciousPeerCannotCauseMemoryOveruse) {
   }
 }
 
+TEST_F(RtpDemuxerTest, MaliciousPeerCannotHideSignaledRsids) {
+  MockRtpPacketSink sink_before;
+  ASSERT_TRUE(AddSinkOnlyRsid("before", &sink_before));
+
+  // Every packet carries a new RSID on a new SSRC, which uses up both the ids
+  // for RSIDs seen in packets and the SSRC table.
+  for (int i = 0; i < RtpDemuxer::kMaxSsrcBindings + 10; i++) {
+    auto packet = CreatePacketWithSsrcRsid(i, "bogus" + std::to_string(i));
+    EXPECT_FALSE(demuxer_.OnRtpPacket(*packet));
+  }
+
+  MockRtpPacketSink sink_after;
+  ASSERT_TRUE(AddSinkOnlyRsid("after", &sink_after));
+
+  constexpr uint32_t kSsrcBefore = 100000;
+  constexpr uint32_t kSsrcAfter = 100001;
+  EXPECT_CALL(sink_before, OnRtpPacket(_)).Times(2);
+  EXPECT_CALL(sink_after, OnRtpPacket(_)).Times(2);
+  EXPECT_TRUE(
+      demuxer_.OnRtpPacket(*CreatePacketWithSsrcRsid(kSsrcBefore, "before")));
+  EXPECT_TRUE(
+      demuxer_.OnRtpPacket(*CreatePacketWithSsrcRsid(kSsrcAfter, "after")));
+  // Later packets with only the SSRC are routed by the binding.
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*CreatePacketWithSsrc(kSsrcBefore)));
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*CreatePacketWithSsrc(kSsrcAfter)));
+}
+
 #if RTC_DCHECK_IS_ON && GTEST_HAS_DEATH_TEST && !defined(WEBRTC_ANDROID)
 
 TEST_F(RtpDemuxerTest, CriteriaMustBeNonEmpty) {
@@ -17,6 +17,16 @@
 
 namespace webrtc {
 
+std::string VideoSendStream::PipelineDelayStats::ToString() const {
+  char buf[128];
+  rtc::SimpleStringBuilder ss(buf);
+  ss << "{frames: " << num_frames << ", ";
+  ss << "p50: " << p50_ms << ", ";
+  ss << "p95: " << p95_ms << ", ";
+  ss << "p99: " << p99_ms << '}';
+  return ss.str();
+}
+
 VideoSendStream::StreamStats::StreamStats() = default;
 VideoSendStream::StreamStats::~StreamStats() = default;
 
@@ -61,7 +71,14 @@ std::string VideoSendStream::Stats::ToString(int64_t time_ms) const {
   ss << "cpu_adapted_fps: " << (cpu_limited_framerate ? "true" : "false")
      << ", ";
   ss << "#cpu_adaptations: " << number_of_cpu_adapt_changes << ", ";
-  ss << "#quality_adaptations: " << number_of_quality_adapt_changes;
+  ss << "#quality_adaptations: " << number_of_quality_adapt_changes << ", ";
+  ss << "capture_to_encoder_task_ms: "
+     << capture_to_encoder_task_delay.ToString() << ", ";
+  ss << "capture_to_encode_start_ms: "
+     << capture_to_encode_start_delay.ToString() << ", ";
+  ss << "capture_to_encode_finish_ms: "
+     << capture_to_encode_finish_delay.ToString() << ", ";
+  ss << "capture_to_packetized_ms: " << capture_to_packetized_delay.ToString();
   ss << '}';
   for (const auto& substream : substreams) {
     if (!substream.second.is_rtx && !substream.second.is_flexfec) {
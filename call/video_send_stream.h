@@ -39,6 +39,17 @@ class FrameEncryptorInterface;
 
 class VideoSendStream {
  public:
+  // Percentiles of the time from capture until frames reach one stage of the
+  // send pipeline.
+  struct PipelineDelayStats {
+    std::string ToString() const;
+
+    uint32_t num_frames = 0;
+    int p50_ms = 0;
+    int p95_ms = 0;
+    int p99_ms = 0;
+  };
+
   struct StreamStats {
     StreamStats();
     ~StreamStats();
@@ -107,6 +118,15 @@ class VideoSendStream {
     webrtc::VideoContentType content_type =
         webrtc::VideoContentType::UNSPECIFIED;
     uint32_t huge_frames_sent = 0;
+    // Breakdown of the send delay: the time from capture until the encoder
+    // queue runs the task posted for a frame, until encoding starts and
+    // finishes, and until the frame has been packetized into the pacer queue.
+    // The time until packets leave the pacer is |avg_delay_ms| of the
+    // substreams.
+    PipelineDelayStats capture_to_encoder_task_delay;
+    PipelineDelayStats capture_to_encode_start_delay;
+    PipelineDelayStats capture_to_encode_finish_delay;
+    PipelineDelayStats capture_to_packetized_delay;
   };
 
   struct Config {
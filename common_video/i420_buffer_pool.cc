@@ -11,22 +11,49 @@
 #include "common_video/include/i420_buffer_pool.h"
 
 #include <limits>
+#include <utility>
 
 #include "rtc_base/checks.h"
 
 namespace webrtc {
+namespace {
+
+// Free buffers that have not been handed out during this many calls to
+// CreateBuffer are released, e.g. buffers of a resolution no longer in use.
+constexpr uint64_t kMaxIdleCreateBufferCalls = 300;
+
+size_t I420DataSize(int height, int stride_y, int stride_u, int stride_v) {
+  return static_cast<size_t>(stride_y) * height +
+         static_cast<size_t>(stride_u + stride_v) * ((height + 1) / 2);
+}
+
+}  // namespace
 
 I420BufferPool::I420BufferPool() : I420BufferPool(false) {}
 I420BufferPool::I420BufferPool(bool zero_initialize)
     : I420BufferPool(zero_initialize, std::numeric_limits<size_t>::max()) {}
 I420BufferPool::I420BufferPool(bool zero_initialize,
                                size_t max_number_of_buffers)
+    : I420BufferPool(zero_initialize,
+                     max_number_of_buffers,
+                     std::numeric_limits<size_t>::max()) {}
+I420BufferPool::I420BufferPool(bool zero_initialize,
+                               size_t max_number_of_buffers,
+                               size_t max_number_of_bytes)
     : zero_initialize_(zero_initialize),
-      max_number_of_buffers_(max_number_of_buffers) {}
+      max_number_of_buffers_(max_number_of_buffers),
+      max_number_of_bytes_(max_number_of_bytes) {}
 I420BufferPool::~I420BufferPool() = default;
 
 void I420BufferPool::Release() {
   buffers_.clear();
+  stats_.num_buffers = 0;
+  stats_.num_bytes = 0;
+}
+
+I420BufferPool::Stats I420BufferPool::GetStats() const {
+  RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
+  return stats_;
 }
 
 rtc::scoped_refptr<I420Buffer> I420BufferPool::CreateBuffer(int width,
@@ -41,36 +68,108 @@ rtc::scoped_refptr<I420Buffer> I420BufferPool::CreateBuffer(int width,
                                                             int stride_u,
                                                             int stride_v) {
   RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
-  // Release buffers with wrong resolution.
-  for (auto it = buffers_.begin(); it != buffers_.end();) {
-    const auto& buffer = *it;
-    if (buffer->width() != width || buffer->height() != height ||
-        buffer->StrideY() != stride_y || buffer->StrideU() != stride_u ||
-        buffer->StrideV() != stride_v) {
-      it = buffers_.erase(it);
-    } else {
-      ++it;
+  ++use_counter_;
+  EvictIdleBuffers();
+
+  const BufferKey key(width, height, stride_y, stride_u, stride_v);
+  auto bucket_it = buffers_.find(key);
+  if (bucket_it != buffers_.end()) {
+    // Look for a free buffer.
+    for (PooledBuffer& pooled : bucket_it->second) {
+      // If the buffer is in use, the ref count will be >= 2, one from the
+      // bucket we are looping over and one from the application. If the ref
+      // count is 1, then the bucket holds the only reference and it's safe to
+      // reuse.
+      if (pooled.buffer->HasOneRef()) {
+        pooled.last_use = use_counter_;
+        ++stats_.hits;
+        return pooled.buffer;
+      }
     }
   }
-  // Look for a free buffer.
-  for (const rtc::scoped_refptr<PooledI420Buffer>& buffer : buffers_) {
-    // If the buffer is in use, the ref count will be >= 2, one from the list we
-    // are looping over and one from the application. If the ref count is 1,
-    // then the list we are looping over holds the only reference and it's safe
-    // to reuse.
-    if (buffer->HasOneRef())
-      return buffer;
+
+  // Make room for a new buffer, evicting other buffers if needed.
+  const size_t size_bytes = I420DataSize(height, stride_y, stride_u, stride_v);
+  while (stats_.num_buffers >= max_number_of_buffers_ ||
+         stats_.num_bytes + size_bytes > max_number_of_bytes_) {
+    if (!EvictOneBuffer(key)) {
+      ++stats_.failures;
+      return nullptr;
+    }
   }
 
-  if (buffers_.size() >= max_number_of_buffers_)
-    return nullptr;
   // Allocate new buffer.
   rtc::scoped_refptr<PooledI420Buffer> buffer =
       new PooledI420Buffer(width, height, stride_y, stride_u, stride_v);
   if (zero_initialize_)
     buffer->InitializeData();
-  buffers_.push_back(buffer);
+  buffers_[key].push_back(PooledBuffer{buffer, size_bytes, use_counter_});
+  ++stats_.misses;
+  ++stats_.num_buffers;
+  stats_.num_bytes += size_bytes;
   return buffer;
 }
 
+void I420BufferPool::EvictIdleBuffers() {
+  for (auto bucket_it = buffers_.begin(); bucket_it != buffers_.end();) {
+    std::vector<PooledBuffer>& bucket = bucket_it->second;
+    for (size_t i = 0; i < bucket.size();) {
+      if (bucket[i].buffer->HasOneRef() &&
+          use_counter_ - bucket[i].last_use > kMaxIdleCreateBufferCalls) {
+        RemoveBuffer(&bucket, i);
+      } else {
+        ++i;
+      }
+    }
+    if (bucket.empty()) {
+      bucket_it = buffers_.erase(bucket_it);
+    } else {
+      ++bucket_it;
+    }
+  }
+}
+
+bool I420BufferPool::EvictOneBuffer(const BufferKey& key) {
+  // Prefer the least recently used free buffer, of any size. If there is none,
+  // stop tracking the least recently used buffer of another size; it is freed
+  // when the application releases it, as if the pool had been reset.
+  std::vector<PooledBuffer>* lru_bucket = nullptr;
+  size_t lru_index = 0;
+  bool lru_is_free = false;
+  for (auto& bucket_it : buffers_) {
+    const bool other_size = bucket_it.first != key;
+    std::vector<PooledBuffer>& bucket = bucket_it.second;
+    for (size_t i = 0; i < bucket.size(); ++i) {
+      const bool is_free = bucket[i].buffer->HasOneRef();
+      if (!is_free && !other_size) {
+        continue;
+      }
+      if (!lru_bucket || (is_free && !lru_is_free) ||
+          (is_free == lru_is_free &&
+           bucket[i].last_use < (*lru_bucket)[lru_index].last_use)) {
+        lru_bucket = &bucket;
+        lru_index = i;
+        lru_is_free = is_free;
+      }
+    }
+  }
+  if (!lru_bucket) {
+    return false;
+  }
+  RemoveBuffer(lru_bucket, lru_index);
+  // Empty buckets are cleaned up by EvictIdleBuffers().
+  return true;
+}
+
+void I420BufferPool::RemoveBuffer(std::vector<PooledBuffer>* bucket,
+                                  size_t index) {
+  RTC_DCHECK_LT(index, bucket->size());
+  RTC_DCHECK_GE(stats_.num_bytes, (*bucket)[index].size_bytes);
+  stats_.num_bytes -= (*bucket)[index].size_bytes;
+  --stats_.num_buffers;
+  ++stats_.evictions;
+  (*bucket)[index] = std::move(bucket->back());
+  bucket->pop_back();
+}
+
 }  // namespace webrtc
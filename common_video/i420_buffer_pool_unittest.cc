@@ -113,4 +113,49 @@ TEST(TestI420BufferPool, MaxNumberOfBuffers) {
   EXPECT_EQ(nullptr, pool.CreateBuffer(16, 16).get());
 }
 
+TEST(TestI420BufferPool, ReusesBuffersOfSeveralResolutions) {
+  I420BufferPool pool;
+  auto small_buffer = pool.CreateBuffer(16, 16);
+  auto large_buffer = pool.CreateBuffer(32, 32);
+  const uint8_t* small_y_ptr = small_buffer->DataY();
+  const uint8_t* large_y_ptr = large_buffer->DataY();
+  small_buffer = nullptr;
+  large_buffer = nullptr;
+
+  // Alternating between the resolutions does not purge the other one.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(small_y_ptr, pool.CreateBuffer(16, 16)->DataY());
+    EXPECT_EQ(large_y_ptr, pool.CreateBuffer(32, 32)->DataY());
+  }
+
+  I420BufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(2, stats.misses);
+  EXPECT_EQ(6, stats.hits);
+  EXPECT_EQ(0, stats.evictions);
+  EXPECT_EQ(2u, stats.num_buffers);
+  EXPECT_EQ(16u * 16 * 3 / 2 + 32u * 32 * 3 / 2, stats.num_bytes);
+}
+
+TEST(TestI420BufferPool, MaxNumberOfBytes) {
+  const size_t kBufferBytes = 16 * 16 * 3 / 2;
+  I420BufferPool pool(/*zero_initialize=*/false,
+                      /*max_number_of_buffers=*/10,
+                      /*max_number_of_bytes=*/2 * kBufferBytes);
+  auto buffer1 = pool.CreateBuffer(16, 16);
+  auto buffer2 = pool.CreateBuffer(16, 16);
+  ASSERT_TRUE(buffer1);
+  ASSERT_TRUE(buffer2);
+  // The pool is full of buffers in use; apply back-pressure.
+  EXPECT_EQ(nullptr, pool.CreateBuffer(16, 16).get());
+  EXPECT_EQ(1, pool.GetStats().failures);
+
+  // Once a buffer is returned, the least recently used free buffer is evicted
+  // to make room for another resolution.
+  buffer1 = nullptr;
+  auto buffer3 = pool.CreateBuffer(8, 8);
+  ASSERT_TRUE(buffer3);
+  EXPECT_EQ(1, pool.GetStats().evictions);
+  EXPECT_LE(pool.GetStats().num_bytes, 2 * kBufferBytes);
+}
+
 }  // namespace webrtc
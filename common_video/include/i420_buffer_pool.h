@@ -12,7 +12,11 @@
 #define COMMON_VIDEO_INCLUDE_I420_BUFFER_POOL_H_
 
 #include <stddef.h>
-#include <list>
+#include <stdint.h>
+
+#include <map>
+#include <tuple>
+#include <vector>
 
 #include "api/scoped_refptr.h"
 #include "api/video/i420_buffer.h"
@@ -24,20 +28,42 @@ namespace webrtc {
 // Simple buffer pool to avoid unnecessary allocations of I420Buffer objects.
 // The pool manages the memory of the I420Buffer returned from CreateBuffer.
 // When the I420Buffer is destructed, the memory is returned to the pool for use
-// by subsequent calls to CreateBuffer. If the resolution passed to CreateBuffer
-// changes, old buffers will be purged from the pool.
-// Note that CreateBuffer will crash if more than kMaxNumberOfFramesBeforeCrash
-// are created. This is to prevent memory leaks where frames are not returned.
+// by subsequent calls to CreateBuffer. Buffers are kept in buckets keyed by
+// resolution and strides, so that several resolutions, e.g. simulcast layers,
+// can be served from the same pool. Free buffers that have not been reused for
+// a while, and the least recently used free buffers when the pool is at one of
+// its limits, are purged from the pool. Buffer data is 64-byte aligned.
 class I420BufferPool {
  public:
+  struct Stats {
+    // Calls to CreateBuffer served by a pooled buffer.
+    int64_t hits = 0;
+    // Calls to CreateBuffer that allocated a new buffer.
+    int64_t misses = 0;
+    // Calls to CreateBuffer that returned null because of the pool limits.
+    int64_t failures = 0;
+    // Buffers removed from the pool to make room for other buffers, or
+    // because they were not used for a while.
+    int64_t evictions = 0;
+    // Buffers currently tracked by the pool, free or in use, and their size.
+    size_t num_buffers = 0;
+    size_t num_bytes = 0;
+  };
+
   I420BufferPool();
   explicit I420BufferPool(bool zero_initialize);
   I420BufferPool(bool zero_initialze, size_t max_number_of_buffers);
+  I420BufferPool(bool zero_initialze,
+                 size_t max_number_of_buffers,
+                 size_t max_number_of_bytes);
   ~I420BufferPool();
 
-  // Returns a buffer from the pool. If no suitable buffer exist in the pool
-  // and there are less than |max_number_of_buffers| pending, a buffer is
-  // created. Returns null otherwise.
+  // Returns a buffer from the pool. If no suitable buffer exist in the pool, a
+  // buffer is created if that fits within |max_number_of_buffers| and
+  // |max_number_of_bytes|, after evicting free buffers of other sizes and
+  // forgetting in-use buffers of other sizes if needed. Returns null otherwise,
+  // i.e. when the buffers of the requested size that are in use already take
+  // up the pool.
   rtc::scoped_refptr<I420Buffer> CreateBuffer(int width, int height);
 
   // Returns a buffer from the pool with the explicitly specified stride.
@@ -51,13 +77,35 @@ class I420BufferPool {
   // later from another thread.
   void Release();
 
+  Stats GetStats() const;
+
  private:
   // Explicitly use a RefCountedObject to get access to HasOneRef,
   // needed by the pool to check exclusive access.
   using PooledI420Buffer = rtc::RefCountedObject<I420Buffer>;
 
+  // Width, height and the three strides.
+  using BufferKey = std::tuple<int, int, int, int, int>;
+
+  struct PooledBuffer {
+    rtc::scoped_refptr<PooledI420Buffer> buffer;
+    size_t size_bytes;
+    // Value of |use_counter_| when the buffer was last handed out.
+    uint64_t last_use;
+  };
+
+  // Removes free buffers that have not been handed out for a while.
+  void EvictIdleBuffers();
+  // Removes one buffer to make room for a buffer of size |key|: the least
+  // recently used free buffer, or else the least recently used buffer of
+  // another size. Returns false if there is no such buffer.
+  bool EvictOneBuffer(const BufferKey& key);
+  void RemoveBuffer(std::vector<PooledBuffer>* bucket, size_t index);
+
   rtc::RaceChecker race_checker_;
-  std::list<rtc::scoped_refptr<PooledI420Buffer>> buffers_;
+  std::map<BufferKey, std::vector<PooledBuffer>> buffers_;
+  uint64_t use_counter_ = 0;
+  Stats stats_;
   // If true, newly allocated buffers are zero-initialized. Note that recycled
   // buffers are not zero'd before reuse. This is required of buffers used by
   // FFmpeg according to http://crbug.com/390941, which only requires it for the
@@ -66,6 +114,8 @@ class I420BufferPool {
   const bool zero_initialize_;
   // Max number of buffers this pool can have pending.
   const size_t max_number_of_buffers_;
+  // Max total size of the buffers this pool can have pending.
+  const size_t max_number_of_bytes_;
 };
 
 }  // namespace webrtc
@@ -0,0 +1,137 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+
+#include "api/video/i420_buffer.h"
+#include "common_video/libyuv/include/webrtc_libyuv.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumFrames = 300;
+constexpr int kQuickNumFrames = 3;
+
+struct Resolution {
+  std::string name;
+  int width;
+  int height;
+};
+
+struct Adaptation {
+  std::string name;
+  // The source is cropped to 4:3 if set, and scaled by |scale_num| /
+  // |scale_den|.
+  bool crop;
+  int scale_num;
+  int scale_den;
+  VideoRotation rotation;
+};
+
+rtc::scoped_refptr<I420Buffer> CreateSource(int width, int height) {
+  rtc::scoped_refptr<I420Buffer> buffer = I420Buffer::Create(width, height);
+  for (int y = 0; y < height; ++y)
+    memset(buffer->MutableDataY() + y * buffer->StrideY(), y, width);
+  memset(buffer->MutableDataU(), 64,
+         buffer->StrideU() * buffer->ChromaHeight());
+  memset(buffer->MutableDataV(), 192,
+         buffer->StrideV() * buffer->ChromaHeight());
+  return buffer;
+}
+
+// What the capture sources did before I420CropScaleRotator: a crop and scale
+// pass and a rotation pass, each into a newly allocated buffer.
+rtc::scoped_refptr<I420BufferInterface> CropScaleAndRotateInSteps(
+    const I420BufferInterface& src,
+    int offset_x,
+    int offset_y,
+    int crop_width,
+    int crop_height,
+    int scaled_width,
+    int scaled_height,
+    VideoRotation rotation) {
+  rtc::scoped_refptr<I420Buffer> scaled =
+      I420Buffer::Create(scaled_width, scaled_height);
+  scaled->CropAndScaleFrom(src, offset_x, offset_y, crop_width, crop_height);
+  if (rotation == kVideoRotation_0)
+    return scaled;
+  return I420Buffer::Rotate(*scaled, rotation);
+}
+
+}  // namespace
+
+// Measures adapting captured I420 frames for the encoder, for the cases
+// AdaptedVideoTrackSource and VideoStreamEncoder see, at common capture
+// resolutions.
+TEST(CropScaleRotatePerformanceTest, AdaptCapturedFrames) {
+  const int num_frames = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                             ? kQuickNumFrames
+                             : kNumFrames;
+  const Resolution kResolutions[] = {
+      {"720p", 1280, 720}, {"1080p", 1920, 1080}, {"4k", 3840, 2160}};
+  const Adaptation kAdaptations[] = {
+      {"rotate", false, 1, 1, kVideoRotation_90},
+      {"crop", true, 1, 1, kVideoRotation_0},
+      {"scale", false, 3, 4, kVideoRotation_0},
+      {"crop_scale_rotate", true, 1, 2, kVideoRotation_90}};
+  for (const Resolution& resolution : kResolutions) {
+    rtc::scoped_refptr<I420Buffer> src =
+        CreateSource(resolution.width, resolution.height);
+    for (const Adaptation& adaptation : kAdaptations) {
+      const int crop_width = adaptation.crop
+                                 ? resolution.height * 4 / 3
+                                 : resolution.width;
+      const int crop_height = resolution.height;
+      const int offset_x = (resolution.width - crop_width) / 2;
+      const int scaled_width =
+          crop_width * adaptation.scale_num / adaptation.scale_den;
+      const int scaled_height =
+          crop_height * adaptation.scale_num / adaptation.scale_den;
+
+      const int64_t start_ns = rtc::TimeNanos();
+      for (int i = 0; i < num_frames; ++i) {
+        rtc::scoped_refptr<I420BufferInterface> result =
+            CropScaleAndRotateInSteps(*src, offset_x, 0, crop_width,
+                                      crop_height, scaled_width,
+                                      scaled_height, adaptation.rotation);
+        ASSERT_TRUE(result);
+      }
+      const int64_t in_steps_ns = rtc::TimeNanos() - start_ns;
+
+      I420CropScaleRotator rotator;
+      const int64_t fused_start_ns = rtc::TimeNanos();
+      for (int i = 0; i < num_frames; ++i) {
+        rtc::scoped_refptr<I420BufferInterface> result =
+            rotator.CropScaleAndRotate(src, offset_x, 0, crop_width,
+                                       crop_height, scaled_width,
+                                       scaled_height, adaptation.rotation);
+        ASSERT_TRUE(result);
+      }
+      const int64_t fused_ns = rtc::TimeNanos() - fused_start_ns;
+
+      const std::string story = resolution.name + "_" + adaptation.name;
+      test::PrintResult("adapt_frame_time_in_steps", "", story,
+                        static_cast<double>(in_steps_ns) / num_frames / 1000,
+                        "us", true);
+      test::PrintResult("adapt_frame_time_fused", "", story,
+                        static_cast<double>(fused_ns) / num_frames / 1000,
+                        "us", true);
+    }
+  }
+}
+
+}  // namespace webrtc
@@ -22,6 +22,8 @@
 #include "api/scoped_refptr.h"
 #include "api/video/video_frame.h"
 #include "api/video/video_frame_buffer.h"
+#include "api/video/video_rotation.h"
+#include "common_video/include/i420_buffer_pool.h"
 
 namespace webrtc {
 
@@ -155,6 +157,44 @@ class NV12ToI420Scaler {
   std::vector<uint8_t> tmp_uv_planes_;
 };
 
+// Helper class for cropping, scaling and rotating a frame buffer into an I420
+// buffer from a pool, in as few passes over the pixels as libyuv allows. The
+// cropped area is scaled and rotated straight to the output, and a pooled
+// intermediate buffer is only used when both scaling and rotation are needed.
+// Buffers that are not I420 are converted with ToI420 first. Not thread safe.
+class I420CropScaleRotator {
+ public:
+  I420CropScaleRotator();
+  ~I420CropScaleRotator();
+
+  // Crops the |crop_width| x |crop_height| area at |offset_x|, |offset_y| out
+  // of |src|, scales it to |scaled_width| x |scaled_height| and rotates it by
+  // |rotation|, so that the result is |scaled_height| x |scaled_width| for 90
+  // and 270 degrees. Odd offsets are rounded down as in
+  // I420Buffer::CropAndScaleFrom. Returns |src| converted to I420 if there is
+  // nothing to do, and null if the conversion fails or the pool is exhausted.
+  rtc::scoped_refptr<I420BufferInterface> CropScaleAndRotate(
+      const rtc::scoped_refptr<VideoFrameBuffer>& src,
+      int offset_x,
+      int offset_y,
+      int crop_width,
+      int crop_height,
+      int scaled_width,
+      int scaled_height,
+      VideoRotation rotation);
+
+  // Scales and rotates all of |src|.
+  rtc::scoped_refptr<I420BufferInterface> ScaleAndRotate(
+      const rtc::scoped_refptr<VideoFrameBuffer>& src,
+      int scaled_width,
+      int scaled_height,
+      VideoRotation rotation);
+
+ private:
+  I420BufferPool output_pool_;
+  I420BufferPool intermediate_pool_;
+};
+
 // Convert VideoType to libyuv FourCC type
 int ConvertVideoType(VideoType video_type);
 
@@ -336,4 +336,103 @@ TEST_F(TestLibYuv, NV12Scale4x4to2x2) {
               ::testing::ElementsAre(Average(0, 2, 4, 6), Average(1, 3, 5, 7)));
 }
 
+namespace {
+
+rtc::scoped_refptr<I420Buffer> CreateGradientBuffer(int width, int height) {
+  rtc::scoped_refptr<I420Buffer> buffer = I420Buffer::Create(width, height);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x)
+      buffer->MutableDataY()[y * buffer->StrideY() + x] = 3 * x + 5 * y;
+  }
+  for (int y = 0; y < buffer->ChromaHeight(); ++y) {
+    for (int x = 0; x < buffer->ChromaWidth(); ++x) {
+      buffer->MutableDataU()[y * buffer->StrideU() + x] = 7 * x + y;
+      buffer->MutableDataV()[y * buffer->StrideV() + x] = x + 11 * y;
+    }
+  }
+  return buffer;
+}
+
+// The separate passes that I420CropScaleRotator replaces.
+rtc::scoped_refptr<I420BufferInterface> CropScaleAndRotateInSteps(
+    const I420BufferInterface& src,
+    int offset_x,
+    int offset_y,
+    int crop_width,
+    int crop_height,
+    int scaled_width,
+    int scaled_height,
+    VideoRotation rotation) {
+  rtc::scoped_refptr<I420Buffer> scaled =
+      I420Buffer::Create(scaled_width, scaled_height);
+  scaled->CropAndScaleFrom(src, offset_x, offset_y, crop_width, crop_height);
+  return I420Buffer::Rotate(*scaled, rotation);
+}
+
+}  // namespace
+
+TEST(I420CropScaleRotatorTest, ReturnsSourceIfNothingToDo) {
+  I420CropScaleRotator rotator;
+  rtc::scoped_refptr<I420Buffer> src = CreateGradientBuffer(64, 48);
+  EXPECT_EQ(src.get(),
+            rotator.ScaleAndRotate(src, 64, 48, kVideoRotation_0).get());
+}
+
+TEST(I420CropScaleRotatorTest, MatchesSeparatePasses) {
+  rtc::scoped_refptr<I420Buffer> src = CreateGradientBuffer(64, 48);
+  struct {
+    int offset_x;
+    int offset_y;
+    int crop_width;
+    int crop_height;
+    int scaled_width;
+    int scaled_height;
+  } const kCases[] = {{0, 0, 64, 48, 64, 48},  {5, 3, 48, 36, 48, 36},
+                      {0, 0, 64, 48, 32, 24},  {8, 6, 48, 36, 24, 18},
+                      {3, 1, 60, 46, 30, 22}};
+  const VideoRotation kRotations[] = {kVideoRotation_0, kVideoRotation_90,
+                                      kVideoRotation_180, kVideoRotation_270};
+  I420CropScaleRotator rotator;
+  for (const auto& c : kCases) {
+    for (VideoRotation rotation : kRotations) {
+      rtc::scoped_refptr<I420BufferInterface> expected =
+          CropScaleAndRotateInSteps(*src, c.offset_x, c.offset_y,
+                                    c.crop_width, c.crop_height,
+                                    c.scaled_width, c.scaled_height, rotation);
+      rtc::scoped_refptr<I420BufferInterface> result =
+          rotator.CropScaleAndRotate(src, c.offset_x, c.offset_y,
+                                     c.crop_width, c.crop_height,
+                                     c.scaled_width, c.scaled_height,
+                                     rotation);
+      ASSERT_TRUE(result);
+      ASSERT_EQ(expected->width(), result->width());
+      ASSERT_EQ(expected->height(), result->height());
+      EXPECT_EQ(48.0, I420PSNR(*expected, *result));
+    }
+  }
+}
+
+TEST(I420CropScaleRotatorTest, UpscalesAndRotates) {
+  rtc::scoped_refptr<I420Buffer> src = CreateGradientBuffer(32, 24);
+  I420CropScaleRotator rotator;
+  rtc::scoped_refptr<I420BufferInterface> result =
+      rotator.ScaleAndRotate(src, 64, 48, kVideoRotation_90);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(48, result->width());
+  EXPECT_EQ(64, result->height());
+  EXPECT_GT(I420PSNR(*CropScaleAndRotateInSteps(*src, 0, 0, 32, 24, 64, 48,
+                                                kVideoRotation_90),
+                     *result),
+            30.0);
+}
+
+TEST(I420CropScaleRotatorTest, ReusesBuffers) {
+  rtc::scoped_refptr<I420Buffer> src = CreateGradientBuffer(64, 48);
+  I420CropScaleRotator rotator;
+  const uint8_t* data_y =
+      rotator.ScaleAndRotate(src, 32, 24, kVideoRotation_90)->DataY();
+  EXPECT_EQ(data_y,
+            rotator.ScaleAndRotate(src, 32, 24, kVideoRotation_90)->DataY());
+}
+
 }  // namespace webrtc
@@ -469,4 +469,145 @@ void NV12ToI420Scaler::NV12ToI420Scale(const uint8_t* src_y,
                     dst_height, libyuv::kFilterBox);
 }
 
+namespace {
+
+void ScalePlanes(const uint8_t* src_y,
+                 int src_stride_y,
+                 const uint8_t* src_u,
+                 int src_stride_u,
+                 const uint8_t* src_v,
+                 int src_stride_v,
+                 int src_width,
+                 int src_height,
+                 I420Buffer* dst) {
+  libyuv::I420Scale(src_y, src_stride_y, src_u, src_stride_u, src_v,
+                    src_stride_v, src_width, src_height, dst->MutableDataY(),
+                    dst->StrideY(), dst->MutableDataU(), dst->StrideU(),
+                    dst->MutableDataV(), dst->StrideV(), dst->width(),
+                    dst->height(), libyuv::kFilterBox);
+}
+
+// With |rotation| == kVideoRotation_0 this is a plain copy.
+void RotatePlanes(const uint8_t* src_y,
+                  int src_stride_y,
+                  const uint8_t* src_u,
+                  int src_stride_u,
+                  const uint8_t* src_v,
+                  int src_stride_v,
+                  int src_width,
+                  int src_height,
+                  VideoRotation rotation,
+                  I420Buffer* dst) {
+  RTC_CHECK_EQ(0, libyuv::I420Rotate(
+                      src_y, src_stride_y, src_u, src_stride_u, src_v,
+                      src_stride_v, dst->MutableDataY(), dst->StrideY(),
+                      dst->MutableDataU(), dst->StrideU(), dst->MutableDataV(),
+                      dst->StrideV(), src_width, src_height,
+                      static_cast<libyuv::RotationMode>(rotation)));
+}
+
+}  // namespace
+
+I420CropScaleRotator::I420CropScaleRotator() = default;
+I420CropScaleRotator::~I420CropScaleRotator() = default;
+
+rtc::scoped_refptr<I420BufferInterface>
+I420CropScaleRotator::CropScaleAndRotate(
+    const rtc::scoped_refptr<VideoFrameBuffer>& src,
+    int offset_x,
+    int offset_y,
+    int crop_width,
+    int crop_height,
+    int scaled_width,
+    int scaled_height,
+    VideoRotation rotation) {
+  RTC_DCHECK_GT(scaled_width, 0);
+  RTC_DCHECK_GT(scaled_height, 0);
+  rtc::scoped_refptr<I420BufferInterface> i420 = src->ToI420();
+  if (!i420)
+    return nullptr;
+  RTC_CHECK_LE(crop_width, i420->width());
+  RTC_CHECK_LE(crop_height, i420->height());
+  RTC_CHECK_LE(crop_width + offset_x, i420->width());
+  RTC_CHECK_LE(crop_height + offset_y, i420->height());
+  RTC_CHECK_GE(offset_x, 0);
+  RTC_CHECK_GE(offset_y, 0);
+
+  const bool scale =
+      crop_width != scaled_width || crop_height != scaled_height;
+  if (!scale && rotation == kVideoRotation_0 &&
+      crop_width == i420->width() && crop_height == i420->height()) {
+    return i420;
+  }
+
+  // Make sure offset is even so that u/v plane becomes aligned.
+  const int uv_offset_x = offset_x / 2;
+  const int uv_offset_y = offset_y / 2;
+  offset_x = uv_offset_x * 2;
+  offset_y = uv_offset_y * 2;
+  const uint8_t* y_plane =
+      i420->DataY() + i420->StrideY() * offset_y + offset_x;
+  const uint8_t* u_plane =
+      i420->DataU() + i420->StrideU() * uv_offset_y + uv_offset_x;
+  const uint8_t* v_plane =
+      i420->DataV() + i420->StrideV() * uv_offset_y + uv_offset_x;
+
+  const bool transpose =
+      rotation == kVideoRotation_90 || rotation == kVideoRotation_270;
+  rtc::scoped_refptr<I420Buffer> dst =
+      transpose ? output_pool_.CreateBuffer(scaled_height, scaled_width)
+                : output_pool_.CreateBuffer(scaled_width, scaled_height);
+  if (!dst)
+    return nullptr;
+
+  if (!scale) {
+    RotatePlanes(y_plane, i420->StrideY(), u_plane, i420->StrideU(), v_plane,
+                 i420->StrideV(), crop_width, crop_height, rotation, dst);
+    return dst;
+  }
+  if (rotation == kVideoRotation_0) {
+    ScalePlanes(y_plane, i420->StrideY(), u_plane, i420->StrideU(), v_plane,
+                i420->StrideV(), crop_width, crop_height, dst);
+    return dst;
+  }
+
+  // libyuv can't scale and rotate in one pass. Rotate whichever of the cropped
+  // and the scaled image is the smaller one.
+  rtc::scoped_refptr<I420Buffer> intermediate;
+  if (scaled_width * scaled_height <= crop_width * crop_height) {
+    intermediate = intermediate_pool_.CreateBuffer(scaled_width, scaled_height);
+    if (!intermediate)
+      return nullptr;
+    ScalePlanes(y_plane, i420->StrideY(), u_plane, i420->StrideU(), v_plane,
+                i420->StrideV(), crop_width, crop_height, intermediate);
+    RotatePlanes(intermediate->DataY(), intermediate->StrideY(),
+                 intermediate->DataU(), intermediate->StrideU(),
+                 intermediate->DataV(), intermediate->StrideV(), scaled_width,
+                 scaled_height, rotation, dst);
+  } else {
+    intermediate =
+        transpose ? intermediate_pool_.CreateBuffer(crop_height, crop_width)
+                  : intermediate_pool_.CreateBuffer(crop_width, crop_height);
+    if (!intermediate)
+      return nullptr;
+    RotatePlanes(y_plane, i420->StrideY(), u_plane, i420->StrideU(), v_plane,
+                 i420->StrideV(), crop_width, crop_height, rotation,
+                 intermediate);
+    ScalePlanes(intermediate->DataY(), intermediate->StrideY(),
+                intermediate->DataU(), intermediate->StrideU(),
+                intermediate->DataV(), intermediate->StrideV(),
+                intermediate->width(), intermediate->height(), dst);
+  }
+  return dst;
+}
+
+rtc::scoped_refptr<I420BufferInterface> I420CropScaleRotator::ScaleAndRotate(
+    const rtc::scoped_refptr<VideoFrameBuffer>& src,
+    int scaled_width,
+    int scaled_height,
+    VideoRotation rotation) {
+  return CropScaleAndRotate(src, 0, 0, src->width(), src->height(),
+                            scaled_width, scaled_height, rotation);
+}
+
 }  // namespace webrtc
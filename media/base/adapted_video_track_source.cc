@@ -11,7 +11,6 @@
 #include "media/base/adapted_video_track_source.h"
 
 #include "api/scoped_refptr.h"
-#include "api/video/i420_buffer.h"
 #include "api/video/video_frame_buffer.h"
 #include "api/video/video_rotation.h"
 #include "rtc_base/checks.h"
@@ -51,9 +50,15 @@ void AdaptedVideoTrackSource::OnFrame(const webrtc::VideoFrame& frame) {
   if (apply_rotation() && frame.rotation() != webrtc::kVideoRotation_0 &&
       buffer->type() == webrtc::VideoFrameBuffer::Type::kI420) {
     /* Apply pending rotation. */
+    rtc::scoped_refptr<webrtc::I420BufferInterface> rotated_buffer;
+    {
+      rtc::CritScope lock(&crop_scale_rotator_crit_);
+      rotated_buffer = crop_scale_rotator_.ScaleAndRotate(
+          buffer, buffer->width(), buffer->height(), frame.rotation());
+    }
+    RTC_DCHECK(rotated_buffer);
     webrtc::VideoFrame rotated_frame(frame);
-    rotated_frame.set_video_frame_buffer(
-        webrtc::I420Buffer::Rotate(*buffer->GetI420(), frame.rotation()));
+    rotated_frame.set_video_frame_buffer(rotated_buffer);
     rotated_frame.set_rotation(webrtc::kVideoRotation_0);
     broadcaster_.OnFrame(rotated_frame);
   } else {
@@ -78,6 +83,30 @@ bool AdaptedVideoTrackSource::apply_rotation() {
   return broadcaster_.wants().rotation_applied;
 }
 
+rtc::scoped_refptr<webrtc::VideoFrameBuffer>
+AdaptedVideoTrackSource::CropScaleAndRotate(
+    const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& buffer,
+    int crop_x,
+    int crop_y,
+    int crop_width,
+    int crop_height,
+    int out_width,
+    int out_height,
+    webrtc::VideoRotation* rotation) {
+  const webrtc::VideoRotation applied_rotation =
+      apply_rotation() ? *rotation : webrtc::kVideoRotation_0;
+  rtc::scoped_refptr<webrtc::I420BufferInterface> result;
+  {
+    rtc::CritScope lock(&crop_scale_rotator_crit_);
+    result = crop_scale_rotator_.CropScaleAndRotate(
+        buffer, crop_x, crop_y, crop_width, crop_height, out_width, out_height,
+        applied_rotation);
+  }
+  if (result && applied_rotation != webrtc::kVideoRotation_0)
+    *rotation = webrtc::kVideoRotation_0;
+  return result;
+}
+
 void AdaptedVideoTrackSource::OnSinkWantsChanged(
     const rtc::VideoSinkWants& wants) {
   video_adapter_.OnResolutionFramerateRequest(
@@ -19,6 +19,7 @@
 #include "api/video/video_frame.h"
 #include "api/video/video_sink_interface.h"
 #include "api/video/video_source_interface.h"
+#include "common_video/libyuv/include/webrtc_libyuv.h"
 #include "media/base/video_adapter.h"
 #include "media/base/video_broadcaster.h"
 #include "rtc_base/critical_section.h"
@@ -66,6 +67,21 @@ class RTC_EXPORT AdaptedVideoTrackSource
   // become stale before it is used.
   bool apply_rotation();
 
+  // Crops the area given by AdaptFrame out of |buffer| and scales it to
+  // |out_width| x |out_height|. If apply_rotation() is set, |*rotation| is
+  // applied too, and reset to kVideoRotation_0. This is done in as few passes
+  // as possible, into a buffer from a pool owned by this source. Returns null
+  // if |buffer| can't be converted to I420.
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> CropScaleAndRotate(
+      const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& buffer,
+      int crop_x,
+      int crop_y,
+      int crop_width,
+      int crop_height,
+      int out_width,
+      int out_height,
+      webrtc::VideoRotation* rotation);
+
   cricket::VideoAdapter* video_adapter() { return &video_adapter_; }
 
  private:
@@ -85,6 +101,11 @@ class RTC_EXPORT AdaptedVideoTrackSource
   absl::optional<Stats> stats_ RTC_GUARDED_BY(stats_crit_);
 
   VideoBroadcaster broadcaster_;
+
+  // Frames may be delivered on any thread.
+  rtc::CriticalSection crop_scale_rotator_crit_;
+  webrtc::I420CropScaleRotator crop_scale_rotator_
+      RTC_GUARDED_BY(crop_scale_rotator_crit_);
 };
 
 }  // namespace rtc
@@ -10,15 +10,297 @@
 
 #include "media/base/video_broadcaster.h"
 
+#include <algorithm>
+#include <deque>
+#include <utility>
 #include <vector>
 
+#include "absl/base/attributes.h"
+#include "absl/base/config.h"
 #include "absl/types/optional.h"
 #include "api/video/i420_buffer.h"
 #include "api/video/video_rotation.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/ref_count.h"
+#include "rtc_base/ref_counted_object.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "rtc_base/time_utils.h"
 
 namespace rtc {
+namespace {
+
+// Marks a call into a sink of |broadcaster| on the current thread. Calls into
+// sinks of different broadcasters may be nested, e.g. when a sink feeds
+// another broadcaster.
+class ScopedSinkCall {
+ public:
+  explicit ScopedSinkCall(const VideoBroadcaster* broadcaster);
+  ~ScopedSinkCall();
+
+  // Returns true if the current thread is inside a call into a sink of
+  // |broadcaster|.
+  static bool IsInSinkOf(const VideoBroadcaster* broadcaster);
+
+ private:
+  const VideoBroadcaster* const broadcaster_;
+  const ScopedSinkCall* const previous_;
+};
+
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+
+// Innermost call into a sink in progress on the current thread.
+ABSL_CONST_INIT thread_local const ScopedSinkCall* current_sink_call = nullptr;
+
+ScopedSinkCall::ScopedSinkCall(const VideoBroadcaster* broadcaster)
+    : broadcaster_(broadcaster), previous_(current_sink_call) {
+  current_sink_call = this;
+}
+
+ScopedSinkCall::~ScopedSinkCall() {
+  current_sink_call = previous_;
+}
+
+bool ScopedSinkCall::IsInSinkOf(const VideoBroadcaster* broadcaster) {
+  for (const ScopedSinkCall* call = current_sink_call; call;
+       call = call->previous_) {
+    if (call->broadcaster_ == broadcaster) {
+      return true;
+    }
+  }
+  return false;
+}
+
+#else
+
+// Without thread-local storage, calls into sinks are not tracked, and
+// RemoveSink always waits for a delivery in progress.
+ScopedSinkCall::ScopedSinkCall(const VideoBroadcaster* broadcaster)
+    : broadcaster_(broadcaster), previous_(nullptr) {}
+
+ScopedSinkCall::~ScopedSinkCall() = default;
+
+bool ScopedSinkCall::IsInSinkOf(const VideoBroadcaster* broadcaster) {
+  return false;
+}
+
+#endif
+
+}  // namespace
+
+// Per-sink delivery state. Shared between the snapshots that contain the sink
+// and the tasks posted to its delivery queue, if any.
+class VideoBroadcaster::SinkEntry : public rtc::RefCountInterface {
+ public:
+  SinkEntry(const VideoBroadcaster* broadcaster,
+            VideoSinkInterface<webrtc::VideoFrame>* sink)
+      : broadcaster_(broadcaster), sink_(sink) {}
+
+  VideoSinkInterface<webrtc::VideoFrame>* sink() const { return sink_; }
+
+  // Delivers |frame| to the sink, either directly or through the delivery
+  // queue. |broadcast_time_us| is when the broadcaster received the frame.
+  void Deliver(const webrtc::VideoFrame& frame, int64_t broadcast_time_us) {
+    webrtc::TaskQueueBase* delivery_queue = nullptr;
+    {
+      rtc::CritScope cs(&queue_lock_);
+      if (removed_) {
+        return;
+      }
+      // While a delivery task is pending, also on a delivery queue that has
+      // since been replaced or unset, frames are queued behind it so that the
+      // sink gets them in order.
+      if (delivery_queue_ || delivery_task_posted_) {
+        if (max_queued_frames_ > 0 &&
+            queued_frames_.size() >= max_queued_frames_) {
+          // Drop the oldest frame; the sink is told when the queue runs.
+          queued_frames_.pop_front();
+          ++pending_discards_;
+          ++stats_.frames_dropped;
+          needs_refresh_ = true;
+        }
+        queued_frames_.push_back(QueuedFrame{frame, broadcast_time_us});
+        if (delivery_task_posted_) {
+          return;
+        }
+        delivery_task_posted_ = true;
+        delivery_queue = delivery_queue_;
+      }
+    }
+    if (delivery_queue) {
+      rtc::scoped_refptr<SinkEntry> self(this);
+      delivery_queue->PostTask(
+          webrtc::ToQueuedTask([self] { self->DeliverQueuedFrames(); }));
+      return;
+    }
+
+    rtc::CritScope cs(&delivery_lock_);
+    DeliverFrame(frame, broadcast_time_us);
+  }
+
+  // Tells the sink that a frame was discarded. If |missed_frame| is true, the
+  // sink did not get a frame that the other sinks got, and the next frame
+  // delivered to it is marked as fully updated.
+  void Discard(bool missed_frame) {
+    {
+      rtc::CritScope cs(&queue_lock_);
+      if (removed_) {
+        return;
+      }
+      if (missed_frame) {
+        needs_refresh_ = true;
+      }
+      if (delivery_queue_ || delivery_task_posted_) {
+        ++pending_discards_;
+        if (!delivery_task_posted_) {
+          delivery_task_posted_ = true;
+          rtc::scoped_refptr<SinkEntry> self(this);
+          delivery_queue_->PostTask(
+              webrtc::ToQueuedTask([self] { self->DeliverQueuedFrames(); }));
+        }
+        return;
+      }
+    }
+    rtc::CritScope cs(&delivery_lock_);
+    if (!IsRemoved()) {
+      ScopedSinkCall sink_call(broadcaster_);
+      sink_->OnDiscardedFrame();
+    }
+  }
+
+  void SetDeliveryQueue(webrtc::TaskQueueBase* delivery_queue,
+                        size_t max_queued_frames) {
+    RTC_DCHECK(!delivery_queue || max_queued_frames > 0);
+    rtc::CritScope cs(&queue_lock_);
+    delivery_queue_ = delivery_queue;
+    max_queued_frames_ = max_queued_frames;
+    // Frames queued on a previous delivery queue are still delivered by the
+    // task already posted there, and so are the frames that arrive before it
+    // has run, see Deliver().
+  }
+
+  // Stops all further deliveries. Blocks until a delivery in progress on
+  // another thread has finished, unless called from within a sink of the same
+  // broadcaster, as two sinks removing each other on different threads would
+  // then deadlock.
+  void Remove() {
+    if (ScopedSinkCall::IsInSinkOf(broadcaster_)) {
+      MarkRemoved();
+      return;
+    }
+    rtc::CritScope delivery_cs(&delivery_lock_);
+    MarkRemoved();
+  }
+
+  VideoBroadcaster::SinkStats stats() const {
+    rtc::CritScope cs(&queue_lock_);
+    return stats_;
+  }
+
+ private:
+  struct QueuedFrame {
+    webrtc::VideoFrame frame;
+    int64_t broadcast_time_us;
+  };
+
+  bool IsRemoved() const {
+    rtc::CritScope cs(&queue_lock_);
+    return removed_;
+  }
+
+  void MarkRemoved() {
+    rtc::CritScope cs(&queue_lock_);
+    removed_ = true;
+    queued_frames_.clear();
+  }
+
+  // Runs on the delivery queue.
+  void DeliverQueuedFrames() {
+    rtc::CritScope delivery_cs(&delivery_lock_);
+    while (true) {
+      absl::optional<QueuedFrame> queued_frame;
+      int discards = 0;
+      {
+        rtc::CritScope cs(&queue_lock_);
+        if (removed_) {
+          return;
+        }
+        std::swap(discards, pending_discards_);
+        if (!queued_frames_.empty()) {
+          queued_frame.emplace(std::move(queued_frames_.front()));
+          queued_frames_.pop_front();
+        } else if (discards == 0) {
+          delivery_task_posted_ = false;
+          return;
+        }
+      }
+      for (int i = 0; i < discards; ++i) {
+        ScopedSinkCall sink_call(broadcaster_);
+        sink_->OnDiscardedFrame();
+      }
+      if (queued_frame) {
+        DeliverFrame(queued_frame->frame, queued_frame->broadcast_time_us);
+      }
+    }
+  }
+
+  void DeliverFrame(const webrtc::VideoFrame& frame, int64_t broadcast_time_us)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(delivery_lock_) {
+    bool needs_refresh;
+    {
+      rtc::CritScope cs(&queue_lock_);
+      if (removed_) {
+        return;
+      }
+      needs_refresh = needs_refresh_;
+      needs_refresh_ = false;
+    }
+    {
+      ScopedSinkCall sink_call(broadcaster_);
+      if (needs_refresh) {
+        // Since the last frame was not sent to this sink, full update is
+        // needed.
+        webrtc::VideoFrame copy = frame;
+        copy.set_update_rect(webrtc::VideoFrame::UpdateRect{
+            0, 0, frame.width(), frame.height()});
+        sink_->OnFrame(copy);
+      } else {
+        sink_->OnFrame(frame);
+      }
+    }
+    const int64_t latency_us = rtc::TimeMicros() - broadcast_time_us;
+
+    rtc::CritScope cs(&queue_lock_);
+    ++stats_.frames_delivered;
+    stats_.total_delivery_latency_us += latency_us;
+    stats_.max_delivery_latency_us =
+        std::max(stats_.max_delivery_latency_us, latency_us);
+  }
+
+  // Only used to identify calls into sinks of the owning broadcaster; the
+  // entry may outlive it in a pending delivery task.
+  const VideoBroadcaster* const broadcaster_;
+  VideoSinkInterface<webrtc::VideoFrame>* const sink_;
+
+  // Held while calling into the sink, so that Remove() can wait for an
+  // ongoing delivery. Recursive, which allows a sink to remove itself.
+  rtc::CriticalSection delivery_lock_;
+  // Protects the state below; never held while calling into the sink.
+  rtc::CriticalSection queue_lock_;
+  bool removed_ RTC_GUARDED_BY(queue_lock_) = false;
+  // True until the sink has received a frame, and whenever it has missed one.
+  bool needs_refresh_ RTC_GUARDED_BY(queue_lock_) = true;
+  webrtc::TaskQueueBase* delivery_queue_ RTC_GUARDED_BY(queue_lock_) = nullptr;
+  size_t max_queued_frames_ RTC_GUARDED_BY(queue_lock_) = 0;
+  std::deque<QueuedFrame> queued_frames_ RTC_GUARDED_BY(queue_lock_);
+  int pending_discards_ RTC_GUARDED_BY(queue_lock_) = 0;
+  bool delivery_task_posted_ RTC_GUARDED_BY(queue_lock_) = false;
+  VideoBroadcaster::SinkStats stats_ RTC_GUARDED_BY(queue_lock_);
+};
+
+struct VideoBroadcaster::SinkSnapshot : public rtc::RefCountInterface {
+  std::vector<SnapshotEntry> entries;
+};
 
 VideoBroadcaster::VideoBroadcaster() = default;
 VideoBroadcaster::~VideoBroadcaster() = default;
@@ -28,20 +310,27 @@ void VideoBroadcaster::AddOrUpdateSink(
     const VideoSinkWants& wants) {
   RTC_DCHECK(sink != nullptr);
   rtc::CritScope cs(&sinks_and_wants_lock_);
-  if (!FindSinkPair(sink)) {
-    // |Sink| is a new sink, which didn't receive previous frame.
-    previous_frame_sent_to_all_sinks_ = false;
-  }
   VideoSourceBase::AddOrUpdateSink(sink, wants);
   UpdateWants();
+  UpdateSnapshot();
 }
 
 void VideoBroadcaster::RemoveSink(
     VideoSinkInterface<webrtc::VideoFrame>* sink) {
   RTC_DCHECK(sink != nullptr);
-  rtc::CritScope cs(&sinks_and_wants_lock_);
-  VideoSourceBase::RemoveSink(sink);
-  UpdateWants();
+  rtc::scoped_refptr<SinkEntry> entry;
+  {
+    rtc::CritScope cs(&sinks_and_wants_lock_);
+    entry = FindEntry(sink);
+    VideoSourceBase::RemoveSink(sink);
+    UpdateWants();
+    UpdateSnapshot();
+  }
+  // OnFrame calls that picked up an older snapshot may still be delivering to
+  // the sink; wait for them without blocking the other sinks.
+  if (entry) {
+    entry->Remove();
+  }
 }
 
 bool VideoBroadcaster::frame_wanted() const {
@@ -55,47 +344,83 @@ VideoSinkWants VideoBroadcaster::wants() const {
 }
 
 void VideoBroadcaster::OnFrame(const webrtc::VideoFrame& frame) {
-  rtc::CritScope cs(&sinks_and_wants_lock_);
-  bool current_frame_was_discarded = false;
-  for (auto& sink_pair : sink_pairs()) {
-    if (sink_pair.wants.rotation_applied &&
+  const int64_t broadcast_time_us = rtc::TimeMicros();
+  rtc::scoped_refptr<SinkSnapshot> snapshot;
+  {
+    rtc::CritScope cs(&sinks_and_wants_lock_);
+    snapshot = snapshot_;
+  }
+  if (!snapshot) {
+    return;
+  }
+
+  for (const SnapshotEntry& snapshot_entry : snapshot->entries) {
+    SinkEntry* entry = snapshot_entry.entry.get();
+    const VideoSinkWants& wants = snapshot_entry.wants;
+    if (wants.rotation_applied &&
         frame.rotation() != webrtc::kVideoRotation_0) {
       // Calls to OnFrame are not synchronized with changes to the sink wants.
       // When rotation_applied is set to true, one or a few frames may get here
       // with rotation still pending. Protect sinks that don't expect any
       // pending rotation.
       RTC_LOG(LS_VERBOSE) << "Discarding frame with unexpected rotation.";
-      sink_pair.sink->OnDiscardedFrame();
-      current_frame_was_discarded = true;
+      entry->Discard(/*missed_frame=*/true);
       continue;
     }
-    if (sink_pair.wants.black_frames) {
+    if (wants.black_frames) {
+      rtc::scoped_refptr<webrtc::VideoFrameBuffer> black_frame_buffer;
+      {
+        rtc::CritScope cs(&sinks_and_wants_lock_);
+        black_frame_buffer = GetBlackFrameBuffer(frame.width(), frame.height());
+      }
       webrtc::VideoFrame black_frame =
           webrtc::VideoFrame::Builder()
-              .set_video_frame_buffer(
-                  GetBlackFrameBuffer(frame.width(), frame.height()))
+              .set_video_frame_buffer(black_frame_buffer)
               .set_rotation(frame.rotation())
               .set_timestamp_us(frame.timestamp_us())
               .set_id(frame.id())
               .build();
-      sink_pair.sink->OnFrame(black_frame);
-    } else if (!previous_frame_sent_to_all_sinks_) {
-      // Since last frame was not sent to some sinks, full update is needed.
-      webrtc::VideoFrame copy = frame;
-      copy.set_update_rect(
-          webrtc::VideoFrame::UpdateRect{0, 0, frame.width(), frame.height()});
-      sink_pair.sink->OnFrame(copy);
+      entry->Deliver(black_frame, broadcast_time_us);
     } else {
-      sink_pair.sink->OnFrame(frame);
+      entry->Deliver(frame, broadcast_time_us);
     }
   }
-  previous_frame_sent_to_all_sinks_ = !current_frame_was_discarded;
 }
 
 void VideoBroadcaster::OnDiscardedFrame() {
-  for (auto& sink_pair : sink_pairs()) {
-    sink_pair.sink->OnDiscardedFrame();
+  rtc::scoped_refptr<SinkSnapshot> snapshot;
+  {
+    rtc::CritScope cs(&sinks_and_wants_lock_);
+    snapshot = snapshot_;
   }
+  if (!snapshot) {
+    return;
+  }
+  for (const SnapshotEntry& snapshot_entry : snapshot->entries) {
+    snapshot_entry.entry->Discard(/*missed_frame=*/false);
+  }
+}
+
+void VideoBroadcaster::SetDeliveryQueue(
+    VideoSinkInterface<webrtc::VideoFrame>* sink,
+    webrtc::TaskQueueBase* delivery_queue,
+    size_t max_queued_frames) {
+  rtc::CritScope cs(&sinks_and_wants_lock_);
+  rtc::scoped_refptr<SinkEntry> entry = FindEntry(sink);
+  RTC_DCHECK(entry);
+  if (entry) {
+    entry->SetDeliveryQueue(delivery_queue, max_queued_frames);
+  }
+}
+
+absl::optional<VideoBroadcaster::SinkStats> VideoBroadcaster::GetSinkStats(
+    const VideoSinkInterface<webrtc::VideoFrame>* sink) const {
+  rtc::CritScope cs(&sinks_and_wants_lock_);
+  rtc::scoped_refptr<SinkEntry> entry = FindEntry(sink);
+  if (!entry) {
+    return absl::nullopt;
+  }
+  return entry->stats();
 }
 
 void VideoBroadcaster::UpdateWants() {
@@ -132,6 +457,34 @@ void VideoBroadcaster::UpdateWants() {
   current_wants_ = wants;
 }
 
+void VideoBroadcaster::UpdateSnapshot() {
+  rtc::scoped_refptr<SinkSnapshot> snapshot(
+      new rtc::RefCountedObject<SinkSnapshot>());
+  snapshot->entries.reserve(sink_pairs().size());
+  for (const SinkPair& sink_pair : sink_pairs()) {
+    rtc::scoped_refptr<SinkEntry> entry = FindEntry(sink_pair.sink);
+    if (!entry) {
+      // |sink| is a new sink, which didn't receive the previous frame.
+      entry = new rtc::RefCountedObject<SinkEntry>(this, sink_pair.sink);
+    }
+    snapshot->entries.push_back(SnapshotEntry{entry, sink_pair.wants});
+  }
+  snapshot_ = snapshot;
+}
+
+rtc::scoped_refptr<VideoBroadcaster::SinkEntry> VideoBroadcaster::FindEntry(
+    const VideoSinkInterface<webrtc::VideoFrame>* sink) const {
+  if (!snapshot_) {
+    return nullptr;
+  }
+  for (const SnapshotEntry& snapshot_entry : snapshot_->entries) {
+    if (snapshot_entry.entry->sink() == sink) {
+      return snapshot_entry.entry;
+    }
+  }
+  return nullptr;
+}
+
 const rtc::scoped_refptr<webrtc::VideoFrameBuffer>&
 VideoBroadcaster::GetBlackFrameBuffer(int width, int height) {
   if (!black_frame_buffer_ || black_frame_buffer_->width() != width ||
@@ -11,7 +11,14 @@
 #ifndef MEDIA_BASE_VIDEO_BROADCASTER_H_
 #define MEDIA_BASE_VIDEO_BROADCASTER_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "absl/types/optional.h"
 #include "api/scoped_refptr.h"
+#include "api/task_queue/task_queue_base.h"
 #include "api/video/video_frame_buffer.h"
 #include "api/video/video_source_interface.h"
 #include "media/base/video_source_base.h"
@@ -26,9 +33,30 @@ namespace rtc {
 // rtc::VideoSinkInterface. The class is threadsafe; methods may be called on
 // any thread. This is needed because VideoStreamEncoder calls AddOrUpdateSink
 // both on the worker thread and on the encoder task queue.
+//
+// Frames are delivered from an immutable snapshot of the sink list, which is
+// replaced whenever sinks are added, updated or removed, so OnFrame does not
+// hold |sinks_and_wants_lock_| while calling into the sinks. A slow sink only
+// delays the sinks after it in the same OnFrame call; with a delivery queue
+// (see SetDeliveryQueue) it delays nobody. Once RemoveSink has returned, the
+// sink will not receive any more frames, except that RemoveSink doesn't wait
+// for a delivery in progress on another thread when it's called from within a
+// sink of the same broadcaster, e.g. from its OnFrame. RemoveSink must not be
+// called while holding a lock that a sink takes in OnFrame, as it may wait for
+// a delivery to that sink.
 class VideoBroadcaster : public VideoSourceBase,
                          public VideoSinkInterface<webrtc::VideoFrame> {
  public:
+  struct SinkStats {
+    int64_t frames_delivered = 0;
+    // Frames dropped from a full delivery queue.
+    int64_t frames_dropped = 0;
+    // Time from OnFrame being called on the broadcaster until the sink's
+    // OnFrame has returned, including any time spent in the delivery queue.
+    int64_t total_delivery_latency_us = 0;
+    int64_t max_delivery_latency_us = 0;
+  };
+
   VideoBroadcaster();
   ~VideoBroadcaster() override;
   void AddOrUpdateSink(VideoSinkInterface<webrtc::VideoFrame>* sink,
@@ -50,7 +78,37 @@ class VideoBroadcaster : public VideoSourceBase,
 
   void OnDiscardedFrame() override;
 
+  // Makes frames for |sink| be delivered on |delivery_queue| instead of on the
+  // thread calling OnFrame. At most |max_queued_frames| frames wait in the
+  // queue; when it is full, the oldest frame is dropped and reported to the
+  // sink through OnDiscardedFrame. A null |delivery_queue| restores
+  // synchronous delivery once the frames already queued have been delivered.
+  // |sink| must have been added, and |delivery_queue| must outlive the sink's
+  // registration.
+  void SetDeliveryQueue(VideoSinkInterface<webrtc::VideoFrame>* sink,
+                        webrtc::TaskQueueBase* delivery_queue,
+                        size_t max_queued_frames);
+
+  // Returns the delivery statistics for |sink|, or nullopt if it is not
+  // added.
+  absl::optional<SinkStats> GetSinkStats(
+      const VideoSinkInterface<webrtc::VideoFrame>* sink) const;
+
  protected:
+  class SinkEntry;
+  struct SnapshotEntry {
+    rtc::scoped_refptr<SinkEntry> entry;
+    VideoSinkWants wants;
+  };
+  struct SinkSnapshot;
+
+  // Publishes a new snapshot of the current sinks, reusing the entries of
+  // sinks that were already added.
+  void UpdateSnapshot() RTC_EXCLUSIVE_LOCKS_REQUIRED(sinks_and_wants_lock_);
+  rtc::scoped_refptr<SinkEntry> FindEntry(
+      const VideoSinkInterface<webrtc::VideoFrame>* sink) const
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(sinks_and_wants_lock_);
+
   void UpdateWants() RTC_EXCLUSIVE_LOCKS_REQUIRED(sinks_and_wants_lock_);
   const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& GetBlackFrameBuffer(
       int width,
@@ -59,9 +117,10 @@ class VideoBroadcaster : public VideoSourceBase,
   rtc::CriticalSection sinks_and_wants_lock_;
 
   VideoSinkWants current_wants_ RTC_GUARDED_BY(sinks_and_wants_lock_);
-  rtc::scoped_refptr<webrtc::VideoFrameBuffer> black_frame_buffer_;
-  bool previous_frame_sent_to_all_sinks_ RTC_GUARDED_BY(sinks_and_wants_lock_) =
-      true;
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> black_frame_buffer_
+      RTC_GUARDED_BY(sinks_and_wants_lock_);
+  rtc::scoped_refptr<SinkSnapshot> snapshot_
+      RTC_GUARDED_BY(sinks_and_wants_lock_);
 };
 
 }  // namespace rtc
@@ -8,7 +8,9 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <atomic>
 #include <limits>
+#include <vector>
 
 #include "absl/types/optional.h"
 #include "api/video/i420_buffer.h"
@@ -16,6 +18,10 @@
 #include "api/video/video_rotation.h"
 #include "media/base/fake_video_renderer.h"
 #include "media/base/video_broadcaster.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/event.h"
+#include "rtc_base/task_queue_for_test.h"
+#include "rtc_base/thread.h"
 #include "test/gtest.h"
 
 using rtc::VideoBroadcaster;
@@ -204,3 +210,317 @@ TEST(VideoBroadcasterTest, SinkWantsBlackFrames) {
   EXPECT_TRUE(sink2.black_frame());
   EXPECT_EQ(30, sink2.timestamp_us());
 }
+
+TEST(VideoBroadcasterTest, SinkCanRemoveItselfFromOnFrame) {
+  class SelfRemovingSink : public FakeVideoRenderer {
+   public:
+    explicit SelfRemovingSink(VideoBroadcaster* broadcaster)
+        : broadcaster_(broadcaster) {}
+    void OnFrame(const webrtc::VideoFrame& frame) override {
+      FakeVideoRenderer::OnFrame(frame);
+      broadcaster_->RemoveSink(this);
+    }
+
+   private:
+    VideoBroadcaster* const broadcaster_;
+  };
+
+  VideoBroadcaster broadcaster;
+  SelfRemovingSink sink1(&broadcaster);
+  FakeVideoRenderer sink2;
+  broadcaster.AddOrUpdateSink(&sink1, rtc::VideoSinkWants());
+  broadcaster.AddOrUpdateSink(&sink2, rtc::VideoSinkWants());
+
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer(
+      webrtc::I420Buffer::Create(100, 50));
+  webrtc::I420Buffer::SetBlack(buffer);
+  webrtc::VideoFrame frame = webrtc::VideoFrame::Builder()
+                                 .set_video_frame_buffer(buffer)
+                                 .set_rotation(webrtc::kVideoRotation_0)
+                                 .set_timestamp_us(0)
+                                 .build();
+
+  broadcaster.OnFrame(frame);
+  broadcaster.OnFrame(frame);
+  EXPECT_EQ(1, sink1.num_rendered_frames());
+  EXPECT_EQ(2, sink2.num_rendered_frames());
+  EXPECT_FALSE(broadcaster.GetSinkStats(&sink1));
+  EXPECT_EQ(2, broadcaster.GetSinkStats(&sink2)->frames_delivered);
+}
+
+TEST(VideoBroadcasterTest, DeliveryQueueDropsOldestFrames) {
+  // Sink that blocks in OnFrame until released.
+  class BlockingSink : public FakeVideoRenderer {
+   public:
+    void OnFrame(const webrtc::VideoFrame& frame) override {
+      release_.Wait(rtc::Event::kForever);
+      FakeVideoRenderer::OnFrame(frame);
+    }
+    void Release() { release_.Set(); }
+
+   private:
+    rtc::Event release_{/*manual_reset=*/true, /*initially_signaled=*/false};
+  };
+
+  webrtc::TaskQueueForTest delivery_queue("DeliveryQueue");
+  VideoBroadcaster broadcaster;
+  BlockingSink slow_sink;
+  FakeVideoRenderer fast_sink;
+  broadcaster.AddOrUpdateSink(&slow_sink, rtc::VideoSinkWants());
+  broadcaster.AddOrUpdateSink(&fast_sink, rtc::VideoSinkWants());
+  const size_t kMaxQueuedFrames = 2;
+  broadcaster.SetDeliveryQueue(&slow_sink, delivery_queue.Get(),
+                               kMaxQueuedFrames);
+
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer(
+      webrtc::I420Buffer::Create(100, 50));
+  webrtc::I420Buffer::SetBlack(buffer);
+  const int kNumFrames = 10;
+  for (int i = 0; i < kNumFrames; ++i) {
+    broadcaster.OnFrame(webrtc::VideoFrame::Builder()
+                            .set_video_frame_buffer(buffer)
+                            .set_rotation(webrtc::kVideoRotation_0)
+                            .set_timestamp_us(i)
+                            .build());
+  }
+  // The blocked sink does not hold back the other sink.
+  EXPECT_EQ(kNumFrames, fast_sink.num_rendered_frames());
+
+  slow_sink.Release();
+  delivery_queue.SendTask([] {});
+
+  // The first frame was being delivered when the sink blocked, and of the
+  // rest only the newest |kMaxQueuedFrames| were kept.
+  absl::optional<VideoBroadcaster::SinkStats> stats =
+      broadcaster.GetSinkStats(&slow_sink);
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(kNumFrames, stats->frames_delivered + stats->frames_dropped);
+  EXPECT_EQ(stats->frames_delivered, slow_sink.num_rendered_frames());
+  EXPECT_LE(stats->frames_delivered, 1 + static_cast<int>(kMaxQueuedFrames));
+  EXPECT_EQ(kNumFrames - 1, slow_sink.timestamp_us());
+
+  broadcaster.RemoveSink(&slow_sink);
+}
+
+TEST(VideoBroadcasterTest, FullUpdateRectAfterMissedFrame) {
+  class UpdateRectSink : public FakeVideoRenderer {
+   public:
+    void OnFrame(const webrtc::VideoFrame& frame) override {
+      FakeVideoRenderer::OnFrame(frame);
+      update_rect_ = frame.update_rect();
+    }
+    bool full_update() const {
+      return update_rect_.offset_x == 0 && update_rect_.offset_y == 0 &&
+             update_rect_.width == width() && update_rect_.height == height();
+    }
+
+   private:
+    webrtc::VideoFrame::UpdateRect update_rect_ = {};
+  };
+
+  VideoBroadcaster broadcaster;
+  UpdateRectSink sink1;
+  UpdateRectSink sink2;
+  broadcaster.AddOrUpdateSink(&sink1, rtc::VideoSinkWants());
+  VideoSinkWants wants2;
+  wants2.rotation_applied = true;
+  broadcaster.AddOrUpdateSink(&sink2, wants2);
+
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer(
+      webrtc::I420Buffer::Create(100, 50));
+  webrtc::I420Buffer::SetBlack(buffer);
+  auto create_frame = [&buffer](webrtc::VideoRotation rotation) {
+    webrtc::VideoFrame frame = webrtc::VideoFrame::Builder()
+                                   .set_video_frame_buffer(buffer)
+                                   .set_rotation(rotation)
+                                   .set_timestamp_us(0)
+                                   .build();
+    frame.set_update_rect(webrtc::VideoFrame::UpdateRect{0, 0, 10, 10});
+    return frame;
+  };
+
+  // The first frame of a sink is a full update.
+  broadcaster.OnFrame(create_frame(webrtc::kVideoRotation_0));
+  EXPECT_TRUE(sink1.full_update());
+  EXPECT_TRUE(sink2.full_update());
+  broadcaster.OnFrame(create_frame(webrtc::kVideoRotation_0));
+  EXPECT_FALSE(sink1.full_update());
+  EXPECT_FALSE(sink2.full_update());
+
+  // Only |sink2| misses the rotated frame, so only its next frame is a full
+  // update.
+  broadcaster.OnFrame(create_frame(webrtc::kVideoRotation_90));
+  EXPECT_EQ(3, sink1.num_rendered_frames());
+  EXPECT_EQ(2, sink2.num_rendered_frames());
+  broadcaster.OnFrame(create_frame(webrtc::kVideoRotation_0));
+  EXPECT_FALSE(sink1.full_update());
+  EXPECT_TRUE(sink2.full_update());
+  broadcaster.OnFrame(create_frame(webrtc::kVideoRotation_0));
+  EXPECT_FALSE(sink2.full_update());
+}
+
+TEST(VideoBroadcasterTest, KeepsFrameOrderWhenDeliveryQueueIsUnset) {
+  class TimestampSink : public rtc::VideoSinkInterface<webrtc::VideoFrame> {
+   public:
+    void OnFrame(const webrtc::VideoFrame& frame) override {
+      rtc::CritScope cs(&crit_);
+      timestamps_.push_back(frame.timestamp_us());
+    }
+    std::vector<int64_t> timestamps() const {
+      rtc::CritScope cs(&crit_);
+      return timestamps_;
+    }
+
+   private:
+    rtc::CriticalSection crit_;
+    std::vector<int64_t> timestamps_;
+  };
+
+  webrtc::TaskQueueForTest delivery_queue("DeliveryQueue");
+  VideoBroadcaster broadcaster;
+  TimestampSink sink;
+  broadcaster.AddOrUpdateSink(&sink, rtc::VideoSinkWants());
+  broadcaster.SetDeliveryQueue(&sink, delivery_queue.Get(),
+                               /*max_queued_frames=*/10);
+
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer(
+      webrtc::I420Buffer::Create(100, 50));
+  webrtc::I420Buffer::SetBlack(buffer);
+  auto create_frame = [&buffer](int64_t timestamp_us) {
+    return webrtc::VideoFrame::Builder()
+        .set_video_frame_buffer(buffer)
+        .set_rotation(webrtc::kVideoRotation_0)
+        .set_timestamp_us(timestamp_us)
+        .build();
+  };
+
+  // Hold the delivery queue so that the delivery task doesn't run before the
+  // queue is unset.
+  rtc::Event release;
+  delivery_queue.PostTask([&release] { release.Wait(rtc::Event::kForever); });
+  broadcaster.OnFrame(create_frame(0));
+  broadcaster.OnFrame(create_frame(1));
+  broadcaster.SetDeliveryQueue(&sink, nullptr, 0);
+  broadcaster.OnFrame(create_frame(2));
+  EXPECT_TRUE(sink.timestamps().empty());
+
+  release.Set();
+  delivery_queue.SendTask([] {});
+  EXPECT_EQ(std::vector<int64_t>({0, 1, 2}), sink.timestamps());
+
+  // With the queued frames delivered, frames are delivered synchronously.
+  broadcaster.OnFrame(create_frame(3));
+  EXPECT_EQ(std::vector<int64_t>({0, 1, 2, 3}), sink.timestamps());
+}
+
+TEST(VideoBroadcasterTest, SinksCanRemoveEachOtherOnDifferentThreads) {
+  class RemovingSink : public FakeVideoRenderer {
+   public:
+    explicit RemovingSink(VideoBroadcaster* broadcaster)
+        : broadcaster_(broadcaster) {}
+    void set_other(RemovingSink* other) { other_ = other; }
+    void OnFrame(const webrtc::VideoFrame& frame) override {
+      FakeVideoRenderer::OnFrame(frame);
+      in_on_frame_.Set();
+      // Both sinks are in OnFrame when they remove each other.
+      other_->in_on_frame_.Wait(rtc::Event::kForever);
+      broadcaster_->RemoveSink(other_);
+    }
+
+   private:
+    VideoBroadcaster* const broadcaster_;
+    RemovingSink* other_ = nullptr;
+    rtc::Event in_on_frame_;
+  };
+
+  webrtc::TaskQueueForTest delivery_queue1("DeliveryQueue1");
+  webrtc::TaskQueueForTest delivery_queue2("DeliveryQueue2");
+  VideoBroadcaster broadcaster;
+  RemovingSink sink1(&broadcaster);
+  RemovingSink sink2(&broadcaster);
+  sink1.set_other(&sink2);
+  sink2.set_other(&sink1);
+  broadcaster.AddOrUpdateSink(&sink1, rtc::VideoSinkWants());
+  broadcaster.AddOrUpdateSink(&sink2, rtc::VideoSinkWants());
+  broadcaster.SetDeliveryQueue(&sink1, delivery_queue1.Get(), 1);
+  broadcaster.SetDeliveryQueue(&sink2, delivery_queue2.Get(), 1);
+
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer(
+      webrtc::I420Buffer::Create(100, 50));
+  webrtc::I420Buffer::SetBlack(buffer);
+  broadcaster.OnFrame(webrtc::VideoFrame::Builder()
+                          .set_video_frame_buffer(buffer)
+                          .set_rotation(webrtc::kVideoRotation_0)
+                          .set_timestamp_us(0)
+                          .build());
+  delivery_queue1.SendTask([] {});
+  delivery_queue2.SendTask([] {});
+
+  EXPECT_EQ(1, sink1.num_rendered_frames());
+  EXPECT_EQ(1, sink2.num_rendered_frames());
+  EXPECT_FALSE(broadcaster.frame_wanted());
+}
+
+TEST(VideoBroadcasterTest, SinkOfOtherBroadcasterWaitsForDeliveryOnRemove) {
+  // Delivers slowly on a delivery queue of |broadcaster2|.
+  class SlowSink : public FakeVideoRenderer {
+   public:
+    void OnFrame(const webrtc::VideoFrame& frame) override {
+      in_on_frame_.Set();
+      rtc::Thread::SleepMs(50);
+      FakeVideoRenderer::OnFrame(frame);
+      delivered_ = true;
+    }
+    rtc::Event* in_on_frame() { return &in_on_frame_; }
+    bool delivered() const { return delivered_; }
+
+   private:
+    rtc::Event in_on_frame_;
+    std::atomic<bool> delivered_{false};
+  };
+  // A sink of |broadcaster1| which removes |slow_sink| from |broadcaster2|
+  // while it's receiving a frame on another thread.
+  class RemovingSink : public FakeVideoRenderer {
+   public:
+    RemovingSink(VideoBroadcaster* broadcaster, SlowSink* slow_sink)
+        : broadcaster_(broadcaster), slow_sink_(slow_sink) {}
+    void OnFrame(const webrtc::VideoFrame& frame) override {
+      FakeVideoRenderer::OnFrame(frame);
+      slow_sink_->in_on_frame()->Wait(rtc::Event::kForever);
+      broadcaster_->RemoveSink(slow_sink_);
+      delivered_before_removed_ = slow_sink_->delivered();
+    }
+    bool delivered_before_removed() const { return delivered_before_removed_; }
+
+   private:
+    VideoBroadcaster* const broadcaster_;
+    SlowSink* const slow_sink_;
+    bool delivered_before_removed_ = false;
+  };
+
+  webrtc::TaskQueueForTest delivery_queue("DeliveryQueue");
+  VideoBroadcaster broadcaster1;
+  VideoBroadcaster broadcaster2;
+  SlowSink slow_sink;
+  RemovingSink removing_sink(&broadcaster2, &slow_sink);
+  broadcaster1.AddOrUpdateSink(&removing_sink, rtc::VideoSinkWants());
+  broadcaster2.AddOrUpdateSink(&slow_sink, rtc::VideoSinkWants());
+  broadcaster2.SetDeliveryQueue(&slow_sink, delivery_queue.Get(), 1);
+
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer(
+      webrtc::I420Buffer::Create(100, 50));
+  webrtc::I420Buffer::SetBlack(buffer);
+  webrtc::VideoFrame frame = webrtc::VideoFrame::Builder()
+                                 .set_video_frame_buffer(buffer)
+                                 .set_rotation(webrtc::kVideoRotation_0)
+                                 .set_timestamp_us(0)
+                                 .build();
+  broadcaster2.OnFrame(frame);
+  broadcaster1.OnFrame(frame);
+  delivery_queue.SendTask([] {});
+
+  // Being inside a sink of |broadcaster1| must not exempt RemoveSink on
+  // |broadcaster2| from waiting for the delivery in progress.
+  EXPECT_TRUE(removing_sink.delivered_before_removed());
+  EXPECT_EQ(1, slow_sink.num_rendered_frames());
+}
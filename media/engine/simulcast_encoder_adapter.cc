@@ -13,11 +13,15 @@
 #include <stdio.h>
 #include <string.h>
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <utility>
 
+#include "absl/memory/memory.h"
 #include "api/scoped_refptr.h"
+#include "api/task_queue/default_task_queue_factory.h"
+#include "api/video/encoded_image.h"
 #include "api/video/i420_buffer.h"
 #include "api/video/video_codec_constants.h"
 #include "api/video/video_frame_buffer.h"
@@ -28,6 +32,7 @@
 #include "modules/video_coding/utility/simulcast_rate_allocator.h"
 #include "rtc_base/atomic_ops.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/event.h"
 #include "rtc_base/experiments/rate_control_settings.h"
 #include "rtc_base/logging.h"
 #include "system_wrappers/include/field_trial.h"
@@ -51,6 +56,11 @@ absl::optional<unsigned int> GetScreenshareBoostedQpValue() {
   return qp;
 }
 
+bool IsParallelEncodingEnabled() {
+  return webrtc::field_trial::IsEnabled(
+      "WebRTC-SimulcastEncoderAdapter-ParallelEncoding");
+}
+
 uint32_t SumStreamMaxBitrate(int streams, const webrtc::VideoCodec& codec) {
   uint32_t bitrate_sum = 0;
   for (int i = 0; i < streams; ++i) {
@@ -121,6 +131,31 @@ class AdapterEncodedImageCallback : public webrtc::EncodedImageCallback {
 
 namespace webrtc {
 
+SimulcastEncoderAdapter::PendingImage::PendingImage(
+    size_t stream_idx,
+    const EncodedImage& encoded_image,
+    const CodecSpecificInfo& codec_specific_info,
+    const RTPFragmentationHeader* fragmentation)
+    : stream_idx(stream_idx),
+      encoded_image(encoded_image),
+      codec_specific_info(codec_specific_info) {
+  // A buffer that isn't owned by the image belongs to the encoder, which may
+  // reuse it for its next output, so the image is held back with a copy.
+  if (encoded_image.buffer()) {
+    this->encoded_image.SetEncodedData(EncodedImageBuffer::Create(
+        encoded_image.data(), encoded_image.size()));
+  }
+  if (fragmentation) {
+    this->fragmentation = absl::make_unique<RTPFragmentationHeader>();
+    this->fragmentation->CopyFrom(*fragmentation);
+  }
+}
+
+SimulcastEncoderAdapter::PendingImage::PendingImage(PendingImage&&) = default;
+SimulcastEncoderAdapter::PendingImage&
+SimulcastEncoderAdapter::PendingImage::operator=(PendingImage&&) = default;
+SimulcastEncoderAdapter::PendingImage::~PendingImage() = default;
+
 SimulcastEncoderAdapter::SimulcastEncoderAdapter(VideoEncoderFactory* factory,
                                                  const SdpVideoFormat& format)
     : inited_(0),
@@ -129,7 +164,8 @@ SimulcastEncoderAdapter::SimulcastEncoderAdapter(VideoEncoderFactory* factory,
       encoded_complete_callback_(nullptr),
       experimental_boosted_screenshare_qp_(GetScreenshareBoostedQpValue()),
       boost_base_layer_quality_(RateControlSettings::ParseFromFieldTrials()
-                                    .Vp8BoostBaseLayerQuality()) {
+                                    .Vp8BoostBaseLayerQuality()),
+      parallel_encoding_(IsParallelEncodingEnabled()) {
   RTC_DCHECK(factory_);
   encoder_info_.implementation_name = "SimulcastEncoderAdapter";
 
@@ -138,6 +174,10 @@ SimulcastEncoderAdapter::SimulcastEncoderAdapter(VideoEncoderFactory* factory,
   encoder_queue_.Detach();
 
   memset(&codec_, 0, sizeof(webrtc::VideoCodec));
+
+  if (parallel_encoding_) {
+    task_queue_factory_ = CreateDefaultTaskQueueFactory();
+  }
 }
 
 SimulcastEncoderAdapter::~SimulcastEncoderAdapter() {
@@ -304,6 +344,8 @@ int SimulcastEncoderAdapter::InitEncode(
             encoder_impl_info.is_hardware_accelerated;
         encoder_info_.has_internal_source =
             encoder_impl_info.has_internal_source;
+        encoder_info_.preferred_pixel_formats =
+            encoder_impl_info.preferred_pixel_formats;
       } else {
         encoder_info_.implementation_name += ", ";
         encoder_info_.implementation_name +=
@@ -327,6 +369,19 @@ int SimulcastEncoderAdapter::InitEncode(
         // Has internal source only if all encoders have it.
         encoder_info_.has_internal_source &=
             encoder_impl_info.has_internal_source;
+
+        // Streams that aren't scaled get the input frame as is, so only
+        // buffer types that all encoders support can be passed through.
+        const auto& impl_formats = encoder_impl_info.preferred_pixel_formats;
+        auto& formats = encoder_info_.preferred_pixel_formats;
+        formats.erase(std::remove_if(formats.begin(), formats.end(),
+                                     [&](VideoFrameBuffer::Type type) {
+                                       return std::find(impl_formats.begin(),
+                                                        impl_formats.end(),
+                                                        type) ==
+                                              impl_formats.end();
+                                     }),
+                      formats.end());
       }
       encoder_info_.fps_allocation[i] = encoder_impl_info.fps_allocation[0];
     }
@@ -339,6 +394,17 @@ int SimulcastEncoderAdapter::InitEncode(
   // To save memory, don't store encoders that we don't use.
   DestroyStoredEncoders();
 
+  if (parallel_encoding_) {
+    // All streams but the last one of a frame get a queue of their own.
+    while (encode_queues_.size() + 1 <
+           static_cast<size_t>(number_of_streams)) {
+      encode_queues_.push_back(absl::make_unique<rtc::TaskQueue>(
+          task_queue_factory_->CreateTaskQueue(
+              "SimulcastEncode" + std::to_string(encode_queues_.size()),
+              TaskQueueFactory::Priority::NORMAL)));
+    }
+  }
+
   rtc::AtomicOps::ReleaseStore(&inited_, 1);
 
   return WEBRTC_VIDEO_CODEC_OK;
@@ -377,72 +443,153 @@ int SimulcastEncoderAdapter::Encode(
 
   int src_width = input_image.width();
   int src_height = input_image.height();
+  const bool is_native = input_image.video_frame_buffer()->type() ==
+                         VideoFrameBuffer::Type::kNative;
+  std::vector<size_t> stream_indices;
+  bool needs_scaling = false;
   for (size_t stream_idx = 0; stream_idx < streaminfos_.size(); ++stream_idx) {
     // Don't encode frames in resolutions that we don't intend to send.
     if (!streaminfos_[stream_idx].send_stream) {
       continue;
     }
-
-    std::vector<VideoFrameType> stream_frame_types;
+    stream_indices.push_back(stream_idx);
     if (send_key_frame) {
-      stream_frame_types.push_back(VideoFrameType::kVideoFrameKey);
       streaminfos_[stream_idx].key_frame_request = false;
-    } else {
-      stream_frame_types.push_back(VideoFrameType::kVideoFrameDelta);
     }
+    if (!is_native && (streaminfos_[stream_idx].width != src_width ||
+                       streaminfos_[stream_idx].height != src_height)) {
+      needs_scaling = true;
+    }
+  }
 
-    int dst_width = streaminfos_[stream_idx].width;
-    int dst_height = streaminfos_[stream_idx].height;
-    // If scaling isn't required, because the input resolution
-    // matches the destination or the input image is empty (e.g.
-    // a keyframe request for encoders with internal camera
-    // sources) or the source image has a native handle, pass the image on
-    // directly. Otherwise, we'll scale it to match what the encoder expects
-    // (below).
-    // For texture frames, the underlying encoder is expected to be able to
-    // correctly sample/scale the source texture.
-    // TODO(perkj): ensure that works going forward, and figure out how this
-    // affects webrtc:5683.
-    if ((dst_width == src_width && dst_height == src_height) ||
-        input_image.video_frame_buffer()->type() ==
-            VideoFrameBuffer::Type::kNative) {
-      int ret = streaminfos_[stream_idx].encoder->Encode(input_image,
-                                                         &stream_frame_types);
-      if (ret != WEBRTC_VIDEO_CODEC_OK) {
-        return ret;
-      }
-    } else {
-      rtc::scoped_refptr<I420Buffer> dst_buffer =
-          I420Buffer::Create(dst_width, dst_height);
-      rtc::scoped_refptr<I420BufferInterface> src_buffer =
-          input_image.video_frame_buffer()->ToI420();
-      libyuv::I420Scale(src_buffer->DataY(), src_buffer->StrideY(),
-                        src_buffer->DataU(), src_buffer->StrideU(),
-                        src_buffer->DataV(), src_buffer->StrideV(), src_width,
-                        src_height, dst_buffer->MutableDataY(),
-                        dst_buffer->StrideY(), dst_buffer->MutableDataU(),
-                        dst_buffer->StrideU(), dst_buffer->MutableDataV(),
-                        dst_buffer->StrideV(), dst_width, dst_height,
-                        libyuv::kFilterBilinear);
-
-      // UpdateRect is not propagated to lower simulcast layers currently.
-      // TODO(ilnik): Consider scaling UpdateRect together with the buffer.
-      VideoFrame frame(input_image);
-      frame.set_video_frame_buffer(dst_buffer);
-      frame.set_rotation(webrtc::kVideoRotation_0);
-      frame.set_update_rect(
-          VideoFrame::UpdateRect{0, 0, frame.width(), frame.height()});
-      int ret =
-          streaminfos_[stream_idx].encoder->Encode(frame, &stream_frame_types);
-      if (ret != WEBRTC_VIDEO_CODEC_OK) {
-        return ret;
-      }
+  // Convert the input only once, also when several streams are scaled from it.
+  rtc::scoped_refptr<I420BufferInterface> src_buffer;
+  if (needs_scaling) {
+    src_buffer = input_image.video_frame_buffer()->ToI420();
+  }
+
+  const VideoFrameType frame_type = send_key_frame
+                                        ? VideoFrameType::kVideoFrameKey
+                                        : VideoFrameType::kVideoFrameDelta;
+  if (parallel_encoding_ && stream_indices.size() > 1) {
+    return EncodeStreamsInParallel(stream_indices, input_image, src_buffer,
+                                   frame_type);
+  }
+  for (size_t stream_idx : stream_indices) {
+    int ret = EncodeStream(stream_idx, input_image, src_buffer, frame_type);
+    if (ret != WEBRTC_VIDEO_CODEC_OK) {
+      return ret;
     }
   }
 
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
+int SimulcastEncoderAdapter::EncodeStream(
+    size_t stream_idx,
+    const VideoFrame& input_image,
+    const rtc::scoped_refptr<I420BufferInterface>& src_buffer,
+    VideoFrameType frame_type) {
+  StreamInfo& stream = streaminfos_[stream_idx];
+  std::vector<VideoFrameType> stream_frame_types(1, frame_type);
+
+  int src_width = input_image.width();
+  int src_height = input_image.height();
+  int dst_width = stream.width;
+  int dst_height = stream.height;
+  // If scaling isn't required, because the input resolution
+  // matches the destination or the input image is empty (e.g.
+  // a keyframe request for encoders with internal camera
+  // sources) or the source image has a native handle, pass the image on
+  // directly. Otherwise, we'll scale it to match what the encoder expects
+  // (below).
+  // For texture frames, the underlying encoder is expected to be able to
+  // correctly sample/scale the source texture.
+  // TODO(perkj): ensure that works going forward, and figure out how this
+  // affects webrtc:5683.
+  if ((dst_width == src_width && dst_height == src_height) ||
+      input_image.video_frame_buffer()->type() ==
+          VideoFrameBuffer::Type::kNative) {
+    return stream.encoder->Encode(input_image, &stream_frame_types);
+  }
+
+  RTC_DCHECK(src_buffer);
+  rtc::scoped_refptr<I420Buffer> dst_buffer =
+      I420Buffer::Create(dst_width, dst_height);
+  libyuv::I420Scale(src_buffer->DataY(), src_buffer->StrideY(),
+                    src_buffer->DataU(), src_buffer->StrideU(),
+                    src_buffer->DataV(), src_buffer->StrideV(), src_width,
+                    src_height, dst_buffer->MutableDataY(),
+                    dst_buffer->StrideY(), dst_buffer->MutableDataU(),
+                    dst_buffer->StrideU(), dst_buffer->MutableDataV(),
+                    dst_buffer->StrideV(), dst_width, dst_height,
+                    libyuv::kFilterBilinear);
+
+  // UpdateRect is not propagated to lower simulcast layers currently.
+  // TODO(ilnik): Consider scaling UpdateRect together with the buffer.
+  VideoFrame frame(input_image);
+  frame.set_video_frame_buffer(dst_buffer);
+  frame.set_rotation(webrtc::kVideoRotation_0);
+  frame.set_update_rect(
+      VideoFrame::UpdateRect{0, 0, frame.width(), frame.height()});
+  return stream.encoder->Encode(frame, &stream_frame_types);
+}
+
+int SimulcastEncoderAdapter::EncodeStreamsInParallel(
+    const std::vector<size_t>& stream_indices,
+    const VideoFrame& input_image,
+    const rtc::scoped_refptr<I420BufferInterface>& src_buffer,
+    VideoFrameType frame_type) {
+  RTC_DCHECK_GT(stream_indices.size(), 1);
+  {
+    rtc::CritScope lock(&pending_images_lock_);
+    hold_encoded_images_ = true;
+  }
+
+  // All streams but the last are encoded on their own queues, while the last
+  // one is encoded here. The streams only share the (read-only) input.
+  std::vector<int> results(stream_indices.size(), WEBRTC_VIDEO_CODEC_OK);
+  std::atomic<int> num_pending(static_cast<int>(stream_indices.size()) - 1);
+  rtc::Event done;
+  for (size_t i = 0; i + 1 < stream_indices.size(); ++i) {
+    const size_t stream_idx = stream_indices[i];
+    int* result = &results[i];
+    encode_queues_[stream_idx]->PostTask([&, stream_idx, result] {
+      *result = EncodeStream(stream_idx, input_image, src_buffer, frame_type);
+      if (num_pending.fetch_sub(1) == 1) {
+        done.Set();
+      }
+    });
+  }
+  results.back() =
+      EncodeStream(stream_indices.back(), input_image, src_buffer, frame_type);
+  done.Wait(rtc::Event::kForever);
+
+  // Deliver the encoded images in stream order. Images of the same stream
+  // stay in the order they were produced in.
+  std::vector<PendingImage> pending_images;
+  {
+    rtc::CritScope lock(&pending_images_lock_);
+    hold_encoded_images_ = false;
+    pending_images.swap(pending_images_);
+  }
+  std::stable_sort(pending_images.begin(), pending_images.end(),
+                   [](const PendingImage& a, const PendingImage& b) {
+                     return a.stream_idx < b.stream_idx;
+                   });
+  for (const PendingImage& image : pending_images) {
+    OnEncodedImage(image.stream_idx, image.encoded_image,
+                   &image.codec_specific_info, image.fragmentation.get());
+  }
+
+  for (int ret : results) {
+    if (ret != WEBRTC_VIDEO_CODEC_OK) {
+      return ret;
+    }
+  }
+  return WEBRTC_VIDEO_CODEC_OK;
+}
+
 int SimulcastEncoderAdapter::RegisterEncodeCompleteCallback(
     EncodedImageCallback* callback) {
   RTC_DCHECK_RUN_ON(&encoder_queue_);
@@ -560,6 +707,16 @@ EncodedImageCallback::Result SimulcastEncoderAdapter::OnEncodedImage(
     const EncodedImage& encodedImage,
     const CodecSpecificInfo* codecSpecificInfo,
     const RTPFragmentationHeader* fragmentation) {
+  if (parallel_encoding_) {
+    rtc::CritScope lock(&pending_images_lock_);
+    if (hold_encoded_images_) {
+      pending_images_.emplace_back(stream_idx, encodedImage,
+                                   *codecSpecificInfo, fragmentation);
+      return EncodedImageCallback::Result(EncodedImageCallback::Result::OK,
+                                          encodedImage.Timestamp());
+    }
+  }
+
   EncodedImage stream_image(encodedImage);
   CodecSpecificInfo stream_codec_specific = *codecSpecificInfo;
 
@@ -20,12 +20,19 @@
 
 #include "absl/types/optional.h"
 #include "api/fec_controller_override.h"
+#include "api/scoped_refptr.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "api/video/video_frame_buffer.h"
 #include "api/video_codecs/sdp_video_format.h"
 #include "api/video_codecs/video_encoder.h"
+#include "modules/include/module_common_types.h"
 #include "modules/video_coding/include/video_codec_interface.h"
 #include "rtc_base/atomic_ops.h"
+#include "rtc_base/critical_section.h"
 #include "rtc_base/synchronization/sequence_checker.h"
 #include "rtc_base/system/rtc_export.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/thread_annotations.h"
 
 namespace webrtc {
 
@@ -36,6 +43,14 @@ class VideoEncoderFactory;
 // webrtc::VideoEncoder instances with the given VideoEncoderFactory.
 // The object is created and destroyed on the worker thread, but all public
 // interfaces should be called from the encoder task queue.
+//
+// With the field trial WebRTC-SimulcastEncoderAdapter-ParallelEncoding
+// enabled, the simulcast layers of a frame are encoded concurrently, each
+// layer on its own task queue, and Encode() returns when all of them are done.
+// The encoded images produced during Encode() are held back and delivered to
+// the registered callback in stream index order, so the callback sequence is
+// the same as with serial encoding. The underlying encoders must not rely on
+// being called from a single thread, which holds for the software encoders.
 class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
  public:
   explicit SimulcastEncoderAdapter(VideoEncoderFactory* factory,
@@ -88,6 +103,21 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
     bool send_stream;
   };
 
+  // An encoded image held back during a parallel Encode() call.
+  struct PendingImage {
+    PendingImage(size_t stream_idx,
+                 const EncodedImage& encoded_image,
+                 const CodecSpecificInfo& codec_specific_info,
+                 const RTPFragmentationHeader* fragmentation);
+    PendingImage(PendingImage&&);
+    PendingImage& operator=(PendingImage&&);
+    ~PendingImage();
+    size_t stream_idx;
+    EncodedImage encoded_image;
+    CodecSpecificInfo codec_specific_info;
+    std::unique_ptr<RTPFragmentationHeader> fragmentation;
+  };
+
   enum class StreamResolution {
     OTHER,
     HIGHEST,
@@ -103,6 +133,18 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
 
   bool Initialized() const;
 
+  // Encodes |input_image| on stream |stream_idx|, scaling it from
+  // |src_buffer| if the stream has a different resolution.
+  int EncodeStream(size_t stream_idx,
+                   const VideoFrame& input_image,
+                   const rtc::scoped_refptr<I420BufferInterface>& src_buffer,
+                   VideoFrameType frame_type);
+  int EncodeStreamsInParallel(
+      const std::vector<size_t>& stream_indices,
+      const VideoFrame& input_image,
+      const rtc::scoped_refptr<I420BufferInterface>& src_buffer,
+      VideoFrameType frame_type);
+
   void DestroyStoredEncoders();
 
   volatile int inited_;  // Accessed atomically.
@@ -122,6 +164,16 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
 
   const absl::optional<unsigned int> experimental_boosted_screenshare_qp_;
   const bool boost_base_layer_quality_;
+
+  // Parallel encoding. |encode_queues_[i]| runs the encodes of stream i; the
+  // last stream of a frame is encoded on the calling queue.
+  const bool parallel_encoding_;
+  std::unique_ptr<TaskQueueFactory> task_queue_factory_;
+  std::vector<std::unique_ptr<rtc::TaskQueue>> encode_queues_;
+  rtc::CriticalSection pending_images_lock_;
+  bool hold_encoded_images_ RTC_GUARDED_BY(pending_images_lock_) = false;
+  std::vector<PendingImage> pending_images_
+      RTC_GUARDED_BY(pending_images_lock_);
 };
 
 }  // namespace webrtc
@@ -0,0 +1,186 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/video/video_frame.h"
+#include "api/video_codecs/sdp_video_format.h"
+#include "api/video_codecs/video_codec.h"
+#include "api/video_codecs/video_encoder.h"
+#include "media/base/media_constants.h"
+#include "media/engine/internal_encoder_factory.h"
+#include "media/engine/simulcast_encoder_adapter.h"
+#include "modules/video_coding/include/video_error_codes.h"
+#include "modules/video_coding/utility/simulcast_rate_allocator.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/field_trial.h"
+#include "test/frame_generator.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+
+constexpr int kWidth = 1920;
+constexpr int kHeight = 1080;
+constexpr int kFramerate = 30;
+constexpr int kRtpTicksPerFrame = 90000 / kFramerate;
+constexpr int kNumFrames = 300;
+constexpr int kQuickNumFrames = 30;
+constexpr int kNumStreams = 3;
+constexpr int kMinBitratesKbps[kNumStreams] = {50, 150, 600};
+constexpr int kTargetBitratesKbps[kNumStreams] = {150, 500, 2500};
+constexpr int kMaxBitratesKbps[kNumStreams] = {200, 700, 3500};
+
+struct EncodeStats {
+  int num_frames = 0;
+  int num_encoded_images = 0;
+  // Wall-clock time of the Encode() calls.
+  double mean_latency_ms = 0.0;
+  double max_latency_ms = 0.0;
+  // Process CPU time spent during the Encode() calls, i.e. including the time
+  // spent on other threads.
+  double cpu_ms_per_frame = 0.0;
+};
+
+class EncodedImageCounter : public EncodedImageCallback {
+ public:
+  Result OnEncodedImage(const EncodedImage& encoded_image,
+                        const CodecSpecificInfo* codec_specific_info,
+                        const RTPFragmentationHeader* fragmentation) override {
+    ++num_encoded_images_;
+    return Result(Result::OK, encoded_image.Timestamp());
+  }
+
+  int num_encoded_images() const { return num_encoded_images_; }
+
+ private:
+  int num_encoded_images_ = 0;
+};
+
+VideoCodec CreateCodecSettings() {
+  VideoCodec codec;
+  codec.codecType = kVideoCodecVP8;
+  codec.plType = 120;
+  codec.width = kWidth;
+  codec.height = kHeight;
+  codec.maxFramerate = kFramerate;
+  codec.minBitrate = kMinBitratesKbps[0];
+  codec.maxBitrate = 0;
+  codec.startBitrate = 0;
+  codec.numberOfSimulcastStreams = kNumStreams;
+  codec.active = true;
+  *codec.VP8() = VideoEncoder::GetDefaultVp8Settings();
+  codec.VP8()->automaticResizeOn = false;
+  codec.VP8()->frameDroppingOn = false;
+  for (int i = 0; i < kNumStreams; ++i) {
+    const int downscale = 1 << (kNumStreams - 1 - i);
+    SimulcastStream& stream = codec.simulcastStream[i];
+    stream.width = kWidth / downscale;
+    stream.height = kHeight / downscale;
+    stream.maxFramerate = kFramerate;
+    stream.numberOfTemporalLayers = 1;
+    stream.minBitrate = kMinBitratesKbps[i];
+    stream.targetBitrate = kTargetBitratesKbps[i];
+    stream.maxBitrate = kMaxBitratesKbps[i];
+    stream.qpMax = 56;
+    stream.active = true;
+    codec.startBitrate += kTargetBitratesKbps[i];
+  }
+  return codec;
+}
+
+// Encodes |num_frames| 1080p frames as three VP8 simulcast streams, each
+// encoder using a single core, and measures the Encode() calls.
+EncodeStats RunSimulcastEncoding(bool parallel_encoding, int num_frames) {
+  std::unique_ptr<ScopedFieldTrials> field_trials;
+  if (parallel_encoding) {
+    field_trials = absl::make_unique<ScopedFieldTrials>(
+        "WebRTC-SimulcastEncoderAdapter-ParallelEncoding/Enabled/");
+  }
+  InternalEncoderFactory encoder_factory;
+  SimulcastEncoderAdapter adapter(&encoder_factory,
+                                  SdpVideoFormat(cricket::kVp8CodecName));
+  const VideoCodec codec = CreateCodecSettings();
+  const VideoEncoder::Capabilities capabilities(false);
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            adapter.InitEncode(&codec, VideoEncoder::Settings(
+                                           capabilities, /*number_of_cores=*/1,
+                                           /*max_payload_size=*/1200)));
+  EncodedImageCounter counter;
+  adapter.RegisterEncodeCompleteCallback(&counter);
+  SimulcastRateAllocator rate_allocator(codec);
+  adapter.SetRates(VideoEncoder::RateControlParameters(
+      rate_allocator.GetAllocation(codec.startBitrate * 1000, kFramerate),
+      kFramerate));
+
+  std::unique_ptr<FrameGenerator> frame_generator =
+      FrameGenerator::CreateSquareGenerator(kWidth, kHeight, absl::nullopt,
+                                            absl::nullopt);
+  EncodeStats stats;
+  int64_t latency_ns = 0;
+  int64_t max_latency_ns = 0;
+  int64_t cpu_ns = 0;
+  for (int i = 0; i < num_frames; ++i) {
+    VideoFrame frame = *frame_generator->NextFrame();
+    frame.set_timestamp(i * kRtpTicksPerFrame);
+    const int64_t start_ns = rtc::TimeNanos();
+    const int64_t start_cpu_ns = rtc::GetProcessCpuTimeNanos();
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, adapter.Encode(frame, nullptr));
+    cpu_ns += rtc::GetProcessCpuTimeNanos() - start_cpu_ns;
+    const int64_t frame_latency_ns = rtc::TimeNanos() - start_ns;
+    latency_ns += frame_latency_ns;
+    max_latency_ns = std::max(max_latency_ns, frame_latency_ns);
+  }
+  adapter.Release();
+
+  stats.num_frames = num_frames;
+  stats.num_encoded_images = counter.num_encoded_images();
+  stats.mean_latency_ms = static_cast<double>(latency_ns) /
+                          rtc::kNumNanosecsPerMillisec / num_frames;
+  stats.max_latency_ms =
+      static_cast<double>(max_latency_ns) / rtc::kNumNanosecsPerMillisec;
+  stats.cpu_ms_per_frame =
+      static_cast<double>(cpu_ns) / rtc::kNumNanosecsPerMillisec / num_frames;
+  return stats;
+}
+
+}  // namespace
+
+// Compares encoding the layers of a three stream 1080p simulcast one after the
+// other with encoding them concurrently. With enough idle cores, the parallel
+// latency should approach that of the highest resolution stream alone, at
+// roughly the same CPU cost.
+TEST(SimulcastEncoderAdapterPerformanceTest, SerialVersusParallelEncoding) {
+  const int num_frames = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                             ? kQuickNumFrames
+                             : kNumFrames;
+  for (bool parallel_encoding : {false, true}) {
+    EncodeStats stats = RunSimulcastEncoding(parallel_encoding, num_frames);
+    EXPECT_EQ(kNumStreams * num_frames, stats.num_encoded_images);
+    const std::string trace = parallel_encoding ? "parallel" : "serial";
+    PrintResult("simulcast_encode_latency", "", trace, stats.mean_latency_ms,
+                "ms", true);
+    PrintResult("simulcast_encode_max_latency", "", trace,
+                stats.max_latency_ms, "ms", false);
+    PrintResult("simulcast_encode_cpu", "", trace, stats.cpu_ms_per_frame,
+                "ms", true);
+  }
+}
+
+}  // namespace test
+}  // namespace webrtc
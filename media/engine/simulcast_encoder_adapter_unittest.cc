@@ -27,10 +27,13 @@
 #include "modules/video_coding/codecs/vp8/include/vp8.h"
 #include "modules/video_coding/include/video_codec_interface.h"
 #include "modules/video_coding/utility/simulcast_test_fixture_impl.h"
+#include "rtc_base/event.h"
+#include "test/field_trial.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 
 using ::testing::_;
+using ::testing::Invoke;
 using ::testing::Return;
 using EncoderInfo = webrtc::VideoEncoder::EncoderInfo;
 using FramerateFractions =
@@ -43,6 +46,7 @@ namespace {
 
 constexpr int kDefaultWidth = 1280;
 constexpr int kDefaultHeight = 720;
+constexpr int kEncodeTimeoutMs = 5000;
 
 const VideoEncoder::Capabilities kCapabilities(false);
 const VideoEncoder::Settings kSettings(kCapabilities, 1, 1200);
@@ -226,6 +230,7 @@ class MockVideoEncoder : public VideoEncoder {
     info.is_hardware_accelerated = is_hardware_accelerated_;
     info.has_internal_source = has_internal_source_;
     info.fps_allocation[0] = fps_allocation_;
+    info.preferred_pixel_formats = preferred_pixel_formats_;
     return info;
   }
 
@@ -275,6 +280,12 @@ class MockVideoEncoder : public VideoEncoder {
     fps_allocation_ = fps_allocation;
   }
 
+  void set_preferred_pixel_formats(
+      absl::InlinedVector<VideoFrameBuffer::Type,
+                          EncoderInfo::kMaxPreferredPixelFormats> formats) {
+    preferred_pixel_formats_ = std::move(formats);
+  }
+
   RateControlParameters last_set_rates() const { return last_set_rates_; }
 
  private:
@@ -288,6 +299,9 @@ class MockVideoEncoder : public VideoEncoder {
   int32_t init_encode_return_value_ = 0;
   VideoEncoder::RateControlParameters last_set_rates_;
   FramerateFractions fps_allocation_;
+  absl::InlinedVector<VideoFrameBuffer::Type,
+                      EncoderInfo::kMaxPreferredPixelFormats>
+      preferred_pixel_formats_ = {VideoFrameBuffer::Type::kI420};
 
   VideoCodec codec_;
   EncodedImageCallback* callback_;
@@ -379,6 +393,8 @@ class TestSimulcastEncoderAdapterFake : public ::testing::Test,
     last_encoded_image_height_ = encoded_image._encodedHeight;
     last_encoded_image_simulcast_index_ =
         encoded_image.SpatialIndex().value_or(-1);
+    encoded_image_simulcast_indices_.push_back(
+        last_encoded_image_simulcast_index_);
 
     return Result(Result::OK, encoded_image.Timestamp());
   }
@@ -481,6 +497,7 @@ class TestSimulcastEncoderAdapterFake : public ::testing::Test,
   int last_encoded_image_width_;
   int last_encoded_image_height_;
   int last_encoded_image_simulcast_index_;
+  std::vector<int> encoded_image_simulcast_indices_;
   std::unique_ptr<SimulcastRateAllocator> rate_allocator_;
 };
 
@@ -850,6 +867,29 @@ TEST_F(TestSimulcastEncoderAdapterFake,
   EXPECT_TRUE(adapter_->GetEncoderInfo().supports_native_handle);
 }
 
+TEST_F(TestSimulcastEncoderAdapterFake,
+       PreferredPixelFormatsForMultipleStreams) {
+  SimulcastTestFixtureImpl::DefaultSettings(
+      &codec_, static_cast<const int*>(kTestTemporalLayerProfile),
+      kVideoCodecVP8);
+  codec_.numberOfSimulcastStreams = 3;
+  EXPECT_EQ(0, adapter_->InitEncode(&codec_, kSettings));
+  adapter_->RegisterEncodeCompleteCallback(this);
+  ASSERT_EQ(3u, helper_->factory()->encoders().size());
+  for (MockVideoEncoder* encoder : helper_->factory()->encoders()) {
+    encoder->set_preferred_pixel_formats(
+        {VideoFrameBuffer::Type::kI010, VideoFrameBuffer::Type::kI420});
+  }
+  helper_->factory()->encoders()[1]->set_preferred_pixel_formats(
+      {VideoFrameBuffer::Type::kI420});
+  EXPECT_EQ(0, adapter_->InitEncode(&codec_, kSettings));
+  // Only the buffer types all encoders support are passed through.
+  EXPECT_THAT(adapter_->GetEncoderInfo().preferred_pixel_formats,
+              ::testing::ElementsAre(VideoFrameBuffer::Type::kI420));
+  EXPECT_FALSE(adapter_->GetEncoderInfo().SupportsBufferType(
+      VideoFrameBuffer::Type::kI010));
+}
+
 // TODO(nisse): Reuse definition in webrtc/test/fake_texture_handle.h.
 class FakeNativeBufferNoI420 : public VideoFrameBuffer {
  public:
@@ -1206,5 +1246,59 @@ TEST_F(TestSimulcastEncoderAdapterFake, SetRateDistributesBandwithAllocation) {
   }
 }
 
+TEST_F(TestSimulcastEncoderAdapterFake,
+       ParallelEncodingDeliversImagesInStreamOrder) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-SimulcastEncoderAdapter-ParallelEncoding/Enabled/");
+  adapter_.reset(helper_->CreateMockEncoderAdapter());
+  SetupCodec();
+  adapter_->SetRates(VideoEncoder::RateControlParameters(
+      rate_allocator_->GetAllocation(1200, 30), 30.0));
+
+  std::vector<MockVideoEncoder*> encoders = helper_->factory()->encoders();
+  ASSERT_EQ(3u, encoders.size());
+
+  // Make the streams finish in reverse order. This only completes if the
+  // streams are encoded concurrently.
+  rtc::Event stream_one_encoded;
+  rtc::Event stream_two_encoded;
+  EXPECT_CALL(*encoders[0], Encode(_, _))
+      .WillOnce(Invoke([&](const VideoFrame& frame,
+                           const std::vector<VideoFrameType>* frame_types) {
+        EXPECT_TRUE(stream_one_encoded.Wait(kEncodeTimeoutMs));
+        encoders[0]->SendEncodedImage(frame.width(), frame.height());
+        return WEBRTC_VIDEO_CODEC_OK;
+      }));
+  EXPECT_CALL(*encoders[1], Encode(_, _))
+      .WillOnce(Invoke([&](const VideoFrame& frame,
+                           const std::vector<VideoFrameType>* frame_types) {
+        EXPECT_TRUE(stream_two_encoded.Wait(kEncodeTimeoutMs));
+        encoders[1]->SendEncodedImage(frame.width(), frame.height());
+        stream_one_encoded.Set();
+        return WEBRTC_VIDEO_CODEC_OK;
+      }));
+  EXPECT_CALL(*encoders[2], Encode(_, _))
+      .WillOnce(Invoke([&](const VideoFrame& frame,
+                           const std::vector<VideoFrameType>* frame_types) {
+        encoders[2]->SendEncodedImage(frame.width(), frame.height());
+        stream_two_encoded.Set();
+        return WEBRTC_VIDEO_CODEC_OK;
+      }));
+
+  rtc::scoped_refptr<I420Buffer> input_buffer =
+      I420Buffer::Create(kDefaultWidth, kDefaultHeight);
+  input_buffer->InitializeData();
+  VideoFrame input_frame = VideoFrame::Builder()
+                               .set_video_frame_buffer(input_buffer)
+                               .set_timestamp_rtp(0)
+                               .set_timestamp_us(0)
+                               .set_rotation(kVideoRotation_0)
+                               .build();
+  std::vector<VideoFrameType> frame_types(3, VideoFrameType::kVideoFrameKey);
+  EXPECT_EQ(0, adapter_->Encode(input_frame, &frame_types));
+  EXPECT_THAT(encoded_image_simulcast_indices_,
+              ::testing::ElementsAre(0, 1, 2));
+}
+
 }  // namespace test
 }  // namespace webrtc
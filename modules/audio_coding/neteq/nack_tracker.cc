@@ -133,7 +133,7 @@ void NackTracker::AddToList(uint16_t sequence_number_current_received_rtp) {
     bool is_missing = IsNewerSequenceNumber(upper_bound_missing, n);
     uint32_t timestamp = EstimateTimestamp(n);
     NackElement nack_element(TimeToPlay(timestamp), timestamp, is_missing);
-    nack_list_.insert(nack_list_.end(), std::make_pair(n, nack_element));
+    nack_list_.insert(std::make_pair(n, nack_element));
   }
 }
 
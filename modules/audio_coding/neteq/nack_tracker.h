@@ -13,11 +13,11 @@
 
 #include <stddef.h>
 #include <stdint.h>
-#include <map>
 #include <vector>
 
 #include "modules/include/module_common_types_public.h"
 #include "rtc_base/gtest_prod_util.h"
+#include "rtc_base/numerics/seq_num_ring_map.h"
 
 //
 // The NackTracker class keeps track of the lost packets, an estimate of
@@ -97,6 +97,8 @@ class NackTracker {
   FRIEND_TEST_ALL_PREFIXES(NackTrackerTest, EstimateTimestampAndTimeToPlay);
 
   struct NackElement {
+    NackElement()
+        : time_to_play_ms(0), estimated_timestamp(0), is_missing(false) {}
     NackElement(int64_t initial_time_to_play_ms,
                 uint32_t initial_timestamp,
                 bool missing)
@@ -121,15 +123,7 @@ class NackTracker {
     bool is_missing;
   };
 
-  class NackListCompare {
-   public:
-    bool operator()(uint16_t sequence_number_old,
-                    uint16_t sequence_number_new) const {
-      return IsNewerSequenceNumber(sequence_number_new, sequence_number_old);
-    }
-  };
-
-  typedef std::map<uint16_t, NackElement, NackListCompare> NackList;
+  typedef SeqNumRingMap<NackElement> NackList;
 
   // Constructor.
   explicit NackTracker(int nack_threshold_packets);
@@ -11,6 +11,8 @@
 #ifndef MODULES_AUDIO_CODING_NETEQ_PACKET_BUFFER_H_
 #define MODULES_AUDIO_CODING_NETEQ_PACKET_BUFFER_H_
 
+#include <vector>
+
 #include "absl/types/optional.h"
 #include "modules/audio_coding/neteq/decoder_database.h"
 #include "modules/audio_coding/neteq/packet.h"
@@ -23,7 +25,9 @@ class DecoderDatabase;
 class StatisticsCalculator;
 class TickTimer;
 
-// This is the actual buffer holding the packets before decoding.
+// This is the actual buffer holding the packets before decoding. The packets
+// are stored in a fixed-capacity ring, allocated once at construction, so that
+// inserting and extracting packets does not allocate memory.
 class PacketBuffer {
  public:
   enum BufferReturnCodes {
@@ -144,8 +148,32 @@ class PacketBuffer {
   }
 
  private:
+  // Returns the packet at position |i| counted from the front of the buffer.
+  Packet& PacketAt(size_t i) {
+    return buffer_[(begin_ + i) % buffer_.size()];
+  }
+  const Packet& PacketAt(size_t i) const {
+    return buffer_[(begin_ + i) % buffer_.size()];
+  }
+
+  // Inserts |packet| at position |pos|, shifting the packets on the shorter
+  // side of |pos| one step. Inserting at the back is O(1).
+  void InsertAt(size_t pos, Packet&& packet);
+
+  // Removes the first packet in the buffer.
+  void PopFront();
+
+  // Removes all packets for which |predicate| returns true, keeping the
+  // relative order of the remaining packets.
+  template <typename Predicate>
+  void RemoveIf(Predicate predicate);
+
   size_t max_number_of_packets_;
-  PacketList buffer_;
+  // Ring of |max_number_of_packets_| slots. The |size_| packets starting at
+  // |begin_| are in use and sorted, with the next packet to decode first.
+  std::vector<Packet> buffer_;
+  size_t begin_ = 0;
+  size_t size_ = 0;
   const TickTimer* tick_timer_;
   RTC_DISALLOW_COPY_AND_ASSIGN(PacketBuffer);
 };
@@ -434,6 +434,39 @@ TEST(PacketBuffer, Reordering) {
   EXPECT_CALL(decoder_database, Die());  // Called when object is deleted.
 }
 
+// Test that packets stay in order when the buffer is repeatedly filled and
+// drained, so that insertions wrap around the end of the internal ring.
+TEST(PacketBuffer, ReorderingAcrossWrapAround) {
+  TickTimer tick_timer;
+  PacketBuffer buffer(10, &tick_timer);  // 10 packets.
+  const uint32_t start_ts = 4711;
+  const uint32_t ts_increment = 10;
+  PacketGenerator gen(17, start_ts, 0, ts_increment);
+  const int payload_len = 10;
+  StrictMock<MockStatisticsCalculator> mock_stats;
+
+  uint32_t current_ts = start_ts;
+  for (int round = 0; round < 7; ++round) {
+    // Insert 6 packets with every pair swapped, then extract 6 packets.
+    for (int i = 0; i < 3; ++i) {
+      Packet first = gen.NextPacket(payload_len);
+      Packet second = gen.NextPacket(payload_len);
+      EXPECT_EQ(PacketBuffer::kOK,
+                buffer.InsertPacket(std::move(second), &mock_stats));
+      EXPECT_EQ(PacketBuffer::kOK,
+                buffer.InsertPacket(std::move(first), &mock_stats));
+    }
+    EXPECT_EQ(6u, buffer.NumPacketsInBuffer());
+    for (int i = 0; i < 6; ++i) {
+      const absl::optional<Packet> packet = buffer.GetNextPacket();
+      ASSERT_TRUE(packet);
+      EXPECT_EQ(current_ts, packet->timestamp);
+      current_ts += ts_increment;
+    }
+    EXPECT_TRUE(buffer.Empty());
+  }
+}
+
 // The test first inserts a packet with narrow-band CNG, then a packet with
 // wide-band speech. The expected behavior of the packet buffer is to detect a
 // change in sample rate, even though no speech packet has been inserted before,
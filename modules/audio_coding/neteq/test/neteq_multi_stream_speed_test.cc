@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "api/audio_codecs/builtin_audio_decoder_factory.h"
+#include "modules/audio_coding/neteq/tools/neteq_multi_stream_test.h"
+#include "modules/audio_coding/neteq/tools/neteq_packet_source_input.h"
+#include "modules/audio_coding/neteq/tools/neteq_test.h"
+#include "modules/audio_coding/neteq/tools/rtp_file_source.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/flags.h"
+#include "test/testsupport/file_utils.h"
+
+// Define command line flags.
+WEBRTC_DEFINE_int(num_streams, 100, "Number of simultaneous NetEq streams.");
+WEBRTC_DEFINE_int(num_threads, 4, "Number of worker threads.");
+WEBRTC_DEFINE_string(input_file,
+                     "",
+                     "RTP dump replayed by every stream; default is the "
+                     "neteq_opus.rtp resource.");
+WEBRTC_DEFINE_bool(help, false, "Print this message.");
+
+int main(int argc, char* argv[]) {
+  std::string program_name = argv[0];
+  std::string usage =
+      "Tool for measuring the speed of many NetEq instances running on a "
+      "pool of worker threads.\n"
+      "Usage: " +
+      program_name +
+      " [options]\n\n"
+      "  --num_streams=N        number of streams; default is 100\n"
+      "  --num_threads=N        number of worker threads; default is 4\n"
+      "  --input_file=F         RTP dump to replay in every stream\n";
+  if (rtc::FlagList::SetFlagsFromCommandLine(&argc, argv, true) || FLAG_help ||
+      argc != 1) {
+    printf("%s", usage.c_str());
+    if (FLAG_help) {
+      rtc::FlagList::Print(nullptr, false);
+      return 0;
+    }
+    return 1;
+  }
+  RTC_CHECK_GT(FLAG_num_streams, 0);
+  RTC_CHECK_GT(FLAG_num_threads, 0);
+
+  const std::string input_file =
+      strlen(FLAG_input_file) > 0
+          ? std::string(FLAG_input_file)
+          : webrtc::test::ResourcePath("audio_coding/neteq_opus", "rtp");
+
+  webrtc::test::NetEqMultiStreamTest multi_stream_test(FLAG_num_threads);
+  auto decoder_factory = webrtc::CreateBuiltinAudioDecoderFactory();
+  const webrtc::test::NetEqPacketSourceInput::RtpHeaderExtensionMap
+      no_extensions;
+  for (int i = 0; i < FLAG_num_streams; ++i) {
+    std::unique_ptr<webrtc::test::NetEqInput> input(
+        new webrtc::test::NetEqRtpDumpInput(input_file, no_extensions,
+                                            absl::nullopt));
+    webrtc::NetEq::Config config;
+    config.sample_rate_hz = 48000;
+    multi_stream_test.AddStream(absl::make_unique<webrtc::test::NetEqTest>(
+        config, decoder_factory,
+        webrtc::test::NetEqTest::StandardDecoderMap(), nullptr,
+        std::move(input), nullptr, webrtc::test::NetEqTest::Callbacks()));
+  }
+
+  const webrtc::test::NetEqMultiStreamTest::Stats stats =
+      multi_stream_test.Run();
+
+  std::cout << "Simulation done" << std::endl;
+  std::cout << "Streams = " << stats.num_streams
+            << ", threads = " << stats.num_threads << std::endl;
+  std::cout << "Simulated time = " << stats.simulation_time_ms << " ms"
+            << std::endl;
+  std::cout << "Wall-clock time = " << stats.wall_time_ms << " ms"
+            << std::endl;
+  std::cout << "CPU time = " << stats.cpu_time_ms << " ms" << std::endl;
+  std::cout << "Real-time streams per core = "
+            << (stats.cpu_time_ms > 0
+                    ? static_cast<double>(stats.simulation_time_ms) *
+                          stats.num_streams / stats.cpu_time_ms
+                    : 0.0)
+            << std::endl;
+  std::cout << "Step CPU mean/max = " << stats.mean_step_cpu_us << "/"
+            << stats.max_step_cpu_us << " us" << std::endl;
+  std::cout << "Step latency mean/max = " << stats.mean_step_latency_us << "/"
+            << stats.max_step_latency_us << " us" << std::endl;
+  std::cout << "Late rounds = " << stats.num_late_rounds << " of "
+            << stats.num_rounds << std::endl;
+  return 0;
+}
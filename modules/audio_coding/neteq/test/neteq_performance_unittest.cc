@@ -8,6 +8,8 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <string>
+
 #include "modules/audio_coding/neteq/tools/neteq_performance_test.h"
 #include "system_wrappers/include/field_trial.h"
 #include "test/gtest.h"
@@ -47,3 +49,24 @@ TEST(NetEqPerformanceTest, RunClean) {
   webrtc::test::PrintResult("neteq_performance", "", "0_pl_0_drift", runtime,
                             "ms", true);
 }
+
+// Measures the CPU cost of the packet buffer alone, both for in-order arrival
+// and with every 5th packet swapped with its successor.
+TEST(NetEqPerformanceTest, PacketBuffer) {
+  const int kNumPackets = 10000000;
+  const int kQuickNumPackets = 100000;
+  const int num_packets =
+      webrtc::field_trial::IsEnabled("WebRTC-QuickPerfTest") ? kQuickNumPackets
+                                                             : kNumPackets;
+  for (int reorder_period : {0, 5}) {
+    webrtc::test::NetEqPerformanceTest::PacketBufferResult result =
+        webrtc::test::NetEqPerformanceTest::RunPacketBuffer(num_packets,
+                                                            reorder_period);
+    const std::string trace =
+        reorder_period == 0 ? "in_order" : "reorder_every_5";
+    webrtc::test::PrintResult("neteq_packet_buffer_insert", "", trace,
+                              result.insert_cpu_ns_per_packet, "ns", true);
+    webrtc::test::PrintResult("neteq_packet_buffer_get", "", trace,
+                              result.get_cpu_ns_per_packet, "ns", true);
+  }
+}
@@ -0,0 +1,189 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_coding/neteq/tools/neteq_multi_stream_test.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/time_utils.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+
+constexpr int64_t kOutputPeriodMs = 10;
+
+}  // namespace
+
+NetEqMultiStreamTest::Stream::Stream(std::unique_ptr<NetEqTest> test)
+    : test(std::move(test)) {}
+
+NetEqMultiStreamTest::Worker::Worker(NetEqMultiStreamTest* parent, int index)
+    : parent(parent),
+      thread(absl::make_unique<rtc::PlatformThread>(
+          &NetEqMultiStreamTest::WorkerThread,
+          this,
+          "NetEqWorker" + std::to_string(index))) {}
+
+NetEqMultiStreamTest::NetEqMultiStreamTest(int num_threads) {
+  RTC_CHECK_GT(num_threads, 0);
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.push_back(absl::make_unique<Worker>(this, i));
+  }
+}
+
+NetEqMultiStreamTest::~NetEqMultiStreamTest() = default;
+
+void NetEqMultiStreamTest::AddStream(std::unique_ptr<NetEqTest> stream) {
+  RTC_CHECK(!has_run_);
+  streams_.push_back(absl::make_unique<Stream>(std::move(stream)));
+}
+
+NetEqMultiStreamTest::Stats NetEqMultiStreamTest::Run() {
+  RTC_CHECK(!has_run_);
+  has_run_ = true;
+
+  for (auto& worker : workers_) {
+    worker->thread->Start();
+  }
+
+  Stats stats;
+  stats.num_streams = static_cast<int>(streams_.size());
+  stats.num_threads = static_cast<int>(workers_.size());
+  const int64_t start_ns = rtc::TimeNanos();
+  int64_t round_time_ms = 0;
+  while (true) {
+    // Collect the streams that have not yet produced audio for this round, and
+    // order them so that the stream that is furthest behind goes first.
+    due_streams_.clear();
+    bool all_finished = true;
+    for (auto& stream : streams_) {
+      if (stream->finished) {
+        continue;
+      }
+      all_finished = false;
+      if (stream->time_ms <= round_time_ms) {
+        due_streams_.push_back(stream.get());
+      }
+    }
+    if (all_finished) {
+      break;
+    }
+    std::stable_sort(due_streams_.begin(), due_streams_.end(),
+                     [](const Stream* a, const Stream* b) {
+                       return a->time_ms < b->time_ms;
+                     });
+
+    if (!due_streams_.empty()) {
+      round_start_ns_ = rtc::TimeNanos();
+      next_due_stream_.store(0);
+      pending_workers_.store(static_cast<int>(workers_.size()));
+      for (auto& worker : workers_) {
+        worker->start.Set();
+      }
+      round_done_.Wait(rtc::Event::kForever, rtc::Event::kForever);
+      const int64_t round_ns = rtc::TimeNanos() - round_start_ns_;
+      ++stats.num_rounds;
+      if (round_ns > kOutputPeriodMs * rtc::kNumNanosecsPerMillisec) {
+        ++stats.num_late_rounds;
+      }
+    }
+    round_time_ms += kOutputPeriodMs;
+  }
+  stats.wall_time_ms =
+      (rtc::TimeNanos() - start_ns) / rtc::kNumNanosecsPerMillisec;
+
+  quit_ = true;
+  for (auto& worker : workers_) {
+    worker->start.Set();
+    worker->thread->Stop();
+  }
+
+  int64_t cpu_ns = 0;
+  int64_t latency_ns = 0;
+  for (const auto& worker : workers_) {
+    const WorkerStats& w = worker->stats;
+    stats.num_steps += w.num_steps;
+    cpu_ns += w.cpu_ns;
+    latency_ns += w.latency_ns;
+    stats.max_step_cpu_us =
+        std::max(stats.max_step_cpu_us,
+                 static_cast<double>(w.max_cpu_ns) /
+                     rtc::kNumNanosecsPerMicrosec);
+    stats.max_step_latency_us =
+        std::max(stats.max_step_latency_us,
+                 static_cast<double>(w.max_latency_ns) /
+                     rtc::kNumNanosecsPerMicrosec);
+  }
+  stats.cpu_time_ms = cpu_ns / rtc::kNumNanosecsPerMillisec;
+  if (stats.num_steps > 0) {
+    stats.mean_step_cpu_us = static_cast<double>(cpu_ns) /
+                             rtc::kNumNanosecsPerMicrosec / stats.num_steps;
+    stats.mean_step_latency_us = static_cast<double>(latency_ns) /
+                                 rtc::kNumNanosecsPerMicrosec /
+                                 stats.num_steps;
+  }
+  for (const auto& stream : streams_) {
+    stats.simulation_time_ms =
+        std::max(stats.simulation_time_ms, stream->time_ms);
+  }
+  return stats;
+}
+
+void NetEqMultiStreamTest::WorkerThread(void* obj) {
+  Worker* worker = static_cast<Worker*>(obj);
+  worker->parent->WorkerLoop(worker);
+}
+
+void NetEqMultiStreamTest::WorkerLoop(Worker* worker) {
+  while (true) {
+    worker->start.Wait(rtc::Event::kForever, rtc::Event::kForever);
+    if (quit_) {
+      return;
+    }
+    ProcessRound(worker);
+    if (pending_workers_.fetch_sub(1) == 1) {
+      round_done_.Set();
+    }
+  }
+}
+
+void NetEqMultiStreamTest::ProcessRound(Worker* worker) {
+  while (true) {
+    const size_t index = next_due_stream_.fetch_add(1);
+    if (index >= due_streams_.size()) {
+      return;
+    }
+    Stream* stream = due_streams_[index];
+    const int64_t cpu_start_ns = rtc::GetThreadCpuTimeNanos();
+    NetEqSimulator::SimulationStepResult result =
+        stream->test->RunToNextGetAudio();
+    const int64_t cpu_ns = rtc::GetThreadCpuTimeNanos() - cpu_start_ns;
+    const int64_t latency_ns = rtc::TimeNanos() - round_start_ns_;
+
+    stream->time_ms += result.simulation_step_ms;
+    stream->finished = result.is_simulation_finished;
+
+    WorkerStats& stats = worker->stats;
+    ++stats.num_steps;
+    stats.cpu_ns += cpu_ns;
+    stats.max_cpu_ns = std::max(stats.max_cpu_ns, cpu_ns);
+    stats.latency_ns += latency_ns;
+    stats.max_latency_ns = std::max(stats.max_latency_ns, latency_ns);
+  }
+}
+
+}  // namespace test
+}  // namespace webrtc
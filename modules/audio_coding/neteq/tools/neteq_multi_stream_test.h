@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_CODING_NETEQ_TOOLS_NETEQ_MULTI_STREAM_TEST_H_
+#define MODULES_AUDIO_CODING_NETEQ_TOOLS_NETEQ_MULTI_STREAM_TEST_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "modules/audio_coding/neteq/tools/neteq_test.h"
+#include "rtc_base/constructor_magic.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+
+namespace webrtc {
+namespace test {
+
+// Drives many independent NetEqTest simulations, e.g. one per received audio
+// stream on a server, without any audio device. The simulations advance in
+// rounds of one output period (10 ms). In each round, every stream that is due
+// is stepped to its next GetAudio event; the due streams are handed out to a
+// pool of worker threads in deadline order, i.e. the stream that is furthest
+// behind in simulated time goes first. The streams run as fast as the workers
+// allow, and the CPU time and latency of each step are aggregated into Stats.
+class NetEqMultiStreamTest {
+ public:
+  struct Stats {
+    int num_streams = 0;
+    int num_threads = 0;
+    // Simulated duration of the longest stream.
+    int64_t simulation_time_ms = 0;
+    // Wall-clock time for running all streams to the end.
+    int64_t wall_time_ms = 0;
+    // Thread CPU time spent stepping the streams, summed over all workers.
+    int64_t cpu_time_ms = 0;
+    // Number of GetAudio steps, over all streams.
+    int64_t num_steps = 0;
+    double mean_step_cpu_us = 0.0;
+    double max_step_cpu_us = 0.0;
+    // Wall-clock time from the start of a round until a stream's step has
+    // completed, i.e. until its 10 ms of audio would have been available.
+    double mean_step_latency_us = 0.0;
+    double max_step_latency_us = 0.0;
+    // Number of rounds that took longer than the output period, meaning that
+    // the worker pool could not have kept up with real-time playout.
+    int64_t num_rounds = 0;
+    int64_t num_late_rounds = 0;
+  };
+
+  explicit NetEqMultiStreamTest(int num_threads);
+  ~NetEqMultiStreamTest();
+
+  // Adds a stream to the simulation. Must be called before Run().
+  void AddStream(std::unique_ptr<NetEqTest> stream);
+
+  // Runs all streams until their inputs have ended, and returns the aggregated
+  // statistics. Can only be called once.
+  Stats Run();
+
+ private:
+  struct Stream {
+    explicit Stream(std::unique_ptr<NetEqTest> test);
+    std::unique_ptr<NetEqTest> test;
+    int64_t time_ms = 0;
+    bool finished = false;
+  };
+
+  // Statistics collected by one worker; merged into Stats after the run.
+  struct WorkerStats {
+    int64_t num_steps = 0;
+    int64_t cpu_ns = 0;
+    int64_t max_cpu_ns = 0;
+    int64_t latency_ns = 0;
+    int64_t max_latency_ns = 0;
+  };
+
+  struct Worker {
+    Worker(NetEqMultiStreamTest* parent, int index);
+    NetEqMultiStreamTest* const parent;
+    rtc::Event start;
+    WorkerStats stats;
+    std::unique_ptr<rtc::PlatformThread> thread;
+  };
+
+  static void WorkerThread(void* obj);
+  void WorkerLoop(Worker* worker);
+  // Steps the due streams, fetching them from |due_streams_| until there are
+  // none left.
+  void ProcessRound(Worker* worker);
+
+  std::vector<std::unique_ptr<Stream>> streams_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  bool has_run_ = false;
+
+  // Round state. Written by the driver thread before the workers are
+  // released, and only read by the workers during the round.
+  std::vector<Stream*> due_streams_;
+  int64_t round_start_ns_ = 0;
+  bool quit_ = false;
+  std::atomic<size_t> next_due_stream_{0};
+  std::atomic<int> pending_workers_{0};
+  rtc::Event round_done_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(NetEqMultiStreamTest);
+};
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_CODING_NETEQ_TOOLS_NETEQ_MULTI_STREAM_TEST_H_
@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Unit tests for the NetEqMultiStreamTest driver.
+
+#include "modules/audio_coding/neteq/tools/neteq_multi_stream_test.h"
+
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/audio_codecs/builtin_audio_decoder_factory.h"
+#include "modules/audio_coding/codecs/pcm16b/audio_encoder_pcm16b.h"
+#include "modules/audio_coding/neteq/tools/audio_sink.h"
+#include "modules/audio_coding/neteq/tools/encode_neteq_input.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+
+constexpr int kSampleRateHz = 16000;
+constexpr int kPayloadType = 100;
+
+// An input sample generator which generates a constant sample value, so that
+// the output of each stream can be told apart from the others.
+class ConstantSampleGenerator : public EncodeNetEqInput::Generator {
+ public:
+  explicit ConstantSampleGenerator(int16_t value) : value_(value) {}
+
+  rtc::ArrayView<const int16_t> Generate(size_t num_samples) override {
+    vec_.assign(num_samples, value_);
+    return vec_;
+  }
+
+ private:
+  const int16_t value_;
+  std::vector<int16_t> vec_;
+};
+
+// Records how much audio a stream has produced, and the last output block.
+class RecordingSink : public AudioSink {
+ public:
+  bool WriteArray(const int16_t* audio, size_t num_samples) override {
+    ++num_writes_;
+    num_samples_ += num_samples;
+    last_block_.assign(audio, audio + num_samples);
+    return true;
+  }
+
+  int num_writes() const { return num_writes_; }
+  size_t num_samples() const { return num_samples_; }
+  const std::vector<int16_t>& last_block() const { return last_block_; }
+
+ private:
+  int num_writes_ = 0;
+  size_t num_samples_ = 0;
+  std::vector<int16_t> last_block_;
+};
+
+// Creates a NetEqTest that plays out |run_time_ms| of PCM16b encoded audio
+// with the constant sample value |value|. The output is written to |sink|.
+std::unique_ptr<NetEqTest> CreateStream(int16_t value,
+                                        int64_t run_time_ms,
+                                        RecordingSink** sink) {
+  NetEq::Config config;
+  config.for_test_no_time_stretching = true;
+
+  AudioEncoderPcm16B::Config encoder_config;
+  encoder_config.sample_rate_hz = kSampleRateHz;
+  encoder_config.payload_type = kPayloadType;
+  auto input = absl::make_unique<EncodeNetEqInput>(
+      absl::make_unique<ConstantSampleGenerator>(value),
+      absl::make_unique<AudioEncoderPcm16B>(encoder_config), run_time_ms);
+
+  NetEqTest::DecoderMap decoders;
+  decoders.emplace(kPayloadType, SdpAudioFormat("l16", kSampleRateHz, 1));
+
+  auto output = absl::make_unique<RecordingSink>();
+  *sink = output.get();
+
+  return absl::make_unique<NetEqTest>(
+      config, CreateBuiltinAudioDecoderFactory(), decoders, nullptr,
+      std::move(input), std::move(output), NetEqTest::Callbacks());
+}
+
+}  // namespace
+
+TEST(NetEqMultiStreamTest, RunsAllStreamsToTheEnd) {
+  struct StreamConfig {
+    int16_t value;
+    int64_t run_time_ms;
+  };
+  const StreamConfig kStreams[] = {{1000, 500}, {2000, 1000}, {-3000, 1500}};
+  constexpr int kNumThreads = 2;
+
+  NetEqMultiStreamTest multi_stream_test(kNumThreads);
+  std::vector<RecordingSink*> sinks;
+  for (const StreamConfig& stream : kStreams) {
+    RecordingSink* sink = nullptr;
+    multi_stream_test.AddStream(
+        CreateStream(stream.value, stream.run_time_ms, &sink));
+    sinks.push_back(sink);
+  }
+
+  const NetEqMultiStreamTest::Stats stats = multi_stream_test.Run();
+
+  EXPECT_EQ(3, stats.num_streams);
+  EXPECT_EQ(kNumThreads, stats.num_threads);
+  EXPECT_LE(kStreams[2].run_time_ms, stats.simulation_time_ms);
+  EXPECT_GT(stats.num_rounds, 0);
+  EXPECT_LE(stats.num_late_rounds, stats.num_rounds);
+  EXPECT_LE(stats.mean_step_cpu_us, stats.max_step_cpu_us);
+  EXPECT_LE(stats.mean_step_latency_us, stats.max_step_latency_us);
+
+  // Every output block comes from exactly one step of one stream.
+  int total_writes = 0;
+  for (const RecordingSink* sink : sinks) {
+    total_writes += sink->num_writes();
+  }
+  EXPECT_EQ(total_writes, stats.num_steps);
+
+  // Each stream must have played out at least its own input, and must end on
+  // its own signal rather than on another stream's.
+  for (size_t i = 0; i < sinks.size(); ++i) {
+    SCOPED_TRACE(i);
+    const RecordingSink& sink = *sinks[i];
+    EXPECT_LE(kStreams[i].run_time_ms * kSampleRateHz / 1000,
+              static_cast<int64_t>(sink.num_samples()));
+    ASSERT_EQ(static_cast<size_t>(kSampleRateHz / 100),
+              sink.last_block().size());
+    for (int16_t sample : sink.last_block()) {
+      EXPECT_EQ(kStreams[i].value, sample);
+    }
+  }
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -10,13 +10,20 @@
 
 #include "modules/audio_coding/neteq/tools/neteq_performance_test.h"
 
+#include <utility>
+#include <vector>
+
 #include "api/audio/audio_frame.h"
 #include "api/audio_codecs/builtin_audio_decoder_factory.h"
 #include "modules/audio_coding/codecs/pcm16b/pcm16b.h"
 #include "modules/audio_coding/neteq/include/neteq.h"
+#include "modules/audio_coding/neteq/packet_buffer.h"
+#include "modules/audio_coding/neteq/statistics_calculator.h"
+#include "modules/audio_coding/neteq/tick_timer.h"
 #include "modules/audio_coding/neteq/tools/audio_loop.h"
 #include "modules/audio_coding/neteq/tools/rtp_generator.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/cpu_time.h"
 #include "system_wrappers/include/clock.h"
 #include "test/testsupport/file_utils.h"
 
@@ -124,5 +131,66 @@ int64_t NetEqPerformanceTest::Run(int runtime_ms,
   return end_time_ms - start_time_ms;
 }
 
+NetEqPerformanceTest::PacketBufferResult NetEqPerformanceTest::RunPacketBuffer(
+    int num_packets,
+    int reorder_period) {
+  // Same limit as the default NetEq configuration; each batch fills the
+  // buffer half way so that it is never flushed.
+  const size_t kMaxPacketsInBuffer = 200;
+  const int kBatchSize = 100;
+  const uint32_t kFrameSizeSamples = 960;  // 20 ms at 48 kHz.
+  const size_t kPayloadSizeBytes = 160;
+  const uint8_t kPayloadType = 111;
+
+  TickTimer tick_timer;
+  StatisticsCalculator stats;
+  PacketBuffer buffer(kMaxPacketsInBuffer, &tick_timer);
+
+  // Payload buffers are allocated up front so that only the buffer operations
+  // are measured.
+  std::vector<Packet> batch(kBatchSize);
+  uint16_t sequence_number = 0;
+  int64_t insert_ns = 0;
+  int64_t get_ns = 0;
+  int packets_done = 0;
+  while (packets_done < num_packets) {
+    for (Packet& packet : batch) {
+      packet.sequence_number = sequence_number++;
+      packet.timestamp = packet.sequence_number * kFrameSizeSamples;
+      packet.payload_type = kPayloadType;
+      packet.payload.SetSize(kPayloadSizeBytes);
+    }
+    if (reorder_period > 0) {
+      for (int i = reorder_period - 1; i + 1 < kBatchSize;
+           i += reorder_period) {
+        std::swap(batch[i], batch[i + 1]);
+      }
+    }
+
+    int64_t start_ns = rtc::GetThreadCpuTimeNanos();
+    for (Packet& packet : batch) {
+      RTC_CHECK_EQ(PacketBuffer::kOK,
+                   buffer.InsertPacket(std::move(packet), &stats));
+    }
+    int64_t inserted_ns = rtc::GetThreadCpuTimeNanos();
+    for (Packet& packet : batch) {
+      absl::optional<Packet> next = buffer.GetNextPacket();
+      RTC_CHECK(next);
+      packet = std::move(*next);
+    }
+    int64_t end_ns = rtc::GetThreadCpuTimeNanos();
+
+    insert_ns += inserted_ns - start_ns;
+    get_ns += end_ns - inserted_ns;
+    packets_done += kBatchSize;
+  }
+
+  PacketBufferResult result;
+  result.insert_cpu_ns_per_packet =
+      static_cast<double>(insert_ns) / packets_done;
+  result.get_cpu_ns_per_packet = static_cast<double>(get_ns) / packets_done;
+  return result;
+}
+
 }  // namespace test
 }  // namespace webrtc
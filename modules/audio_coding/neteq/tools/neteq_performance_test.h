@@ -24,6 +24,18 @@ class NetEqPerformanceTest {
   //   |drift_factor|: clock drift in [0, 1].
   // Returns the runtime in ms.
   static int64_t Run(int runtime_ms, int lossrate, double drift_factor);
+
+  struct PacketBufferResult {
+    double insert_cpu_ns_per_packet = 0.0;
+    double get_cpu_ns_per_packet = 0.0;
+  };
+
+  // Runs a micro-benchmark of the NetEq packet buffer in isolation, inserting
+  // |num_packets| packets in batches and then extracting them again. Every
+  // |reorder_period|-th packet is swapped with its successor; 0 means that all
+  // packets arrive in order. Returns the thread CPU time spent per packet.
+  static PacketBufferResult RunPacketBuffer(int num_packets,
+                                            int reorder_period);
 };
 
 }  // namespace test
@@ -0,0 +1,35 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/congestion_controller/coupled/coupled_factory.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+
+namespace webrtc {
+
+CoupledNetworkControllerFactory::CoupledNetworkControllerFactory(
+    std::unique_ptr<NetworkControllerFactoryInterface> factory)
+    : factory_(std::move(factory)) {}
+
+CoupledNetworkControllerFactory::~CoupledNetworkControllerFactory() = default;
+
+std::unique_ptr<NetworkControllerInterface>
+CoupledNetworkControllerFactory::Create(NetworkControllerConfig config) {
+  return absl::make_unique<CoupledNetworkController>(
+      config, factory_->Create(config), &group_);
+}
+
+TimeDelta CoupledNetworkControllerFactory::GetProcessInterval() const {
+  return factory_->GetProcessInterval();
+}
+
+}  // namespace webrtc
@@ -0,0 +1,41 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_CONGESTION_CONTROLLER_COUPLED_COUPLED_FACTORY_H_
+#define MODULES_CONGESTION_CONTROLLER_COUPLED_COUPLED_FACTORY_H_
+
+#include <memory>
+
+#include "api/transport/network_control.h"
+#include "api/units/time_delta.h"
+#include "modules/congestion_controller/coupled/coupled_network_controller.h"
+
+namespace webrtc {
+
+// Creates controllers from |factory| that are coupled with all other
+// controllers created by this factory, for transports sharing a bottleneck.
+// Must outlive the controllers it creates.
+class CoupledNetworkControllerFactory
+    : public NetworkControllerFactoryInterface {
+ public:
+  explicit CoupledNetworkControllerFactory(
+      std::unique_ptr<NetworkControllerFactoryInterface> factory);
+  ~CoupledNetworkControllerFactory() override;
+  std::unique_ptr<NetworkControllerInterface> Create(
+      NetworkControllerConfig config) override;
+  TimeDelta GetProcessInterval() const override;
+
+ private:
+  const std::unique_ptr<NetworkControllerFactoryInterface> factory_;
+  CoupledNetworkControllerGroup group_;
+};
+}  // namespace webrtc
+
+#endif  // MODULES_CONGESTION_CONTROLLER_COUPLED_COUPLED_FACTORY_H_
@@ -0,0 +1,272 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/congestion_controller/coupled/coupled_network_controller.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+CoupledNetworkControllerGroup::CoupledNetworkControllerGroup() = default;
+
+CoupledNetworkControllerGroup::~CoupledNetworkControllerGroup() {
+  RTC_DCHECK(members_.empty());
+}
+
+int CoupledNetworkControllerGroup::AddMember() {
+  rtc::CritScope cs(&lock_);
+  int member_id = next_member_id_++;
+  members_[member_id] = Member();
+  Allocate();
+  return member_id;
+}
+
+void CoupledNetworkControllerGroup::RemoveMember(int member_id) {
+  rtc::CritScope cs(&lock_);
+  members_.erase(member_id);
+  if (members_.empty())
+    pooled_rate_bps_.reset();
+  Allocate();
+}
+
+void CoupledNetworkControllerGroup::SetRateLimits(int member_id,
+                                                  DataRate min_rate,
+                                                  DataRate max_rate) {
+  rtc::CritScope cs(&lock_);
+  RTC_DCHECK(members_.find(member_id) != members_.end());
+  Member& member = members_[member_id];
+  member.min_rate = min_rate;
+  member.max_rate = std::max(min_rate, max_rate);
+  Allocate();
+}
+
+void CoupledNetworkControllerGroup::OnTargetRate(int member_id,
+                                                 DataRate target_rate) {
+  rtc::CritScope cs(&lock_);
+  RTC_DCHECK(members_.find(member_id) != members_.end());
+  Member& member = members_[member_id];
+  if (!pooled_rate_bps_) {
+    pooled_rate_bps_ = target_rate.bps<double>();
+  } else if (member.controller_rate && !member.controller_rate->IsZero()) {
+    // The member's controller doesn't know that the member sends at its share
+    // rather than at the controller's rate, so apply the relative change of
+    // the controller's rate to the share.
+    *pooled_rate_bps_ += member.share.bps<double>() *
+                         (target_rate / *member.controller_rate - 1);
+  }
+  // A member joining the group takes its share out of the pool, rather than
+  // adding its start rate to it.
+  member.controller_rate = target_rate;
+  Allocate();
+}
+
+absl::optional<DataRate> CoupledNetworkControllerGroup::GetShare(
+    int member_id) const {
+  rtc::CritScope cs(&lock_);
+  RTC_DCHECK(members_.find(member_id) != members_.end());
+  if (!pooled_rate_bps_)
+    return absl::nullopt;
+  return members_.at(member_id).share;
+}
+
+bool CoupledNetworkControllerGroup::IsProbingMember(int member_id) const {
+  rtc::CritScope cs(&lock_);
+  return !members_.empty() && members_.begin()->first == member_id;
+}
+
+void CoupledNetworkControllerGroup::Allocate() {
+  if (!pooled_rate_bps_)
+    return;
+  double min_sum_bps = 0;
+  double max_sum_bps = 0;
+  for (const auto& it : members_) {
+    min_sum_bps += it.second.min_rate.bps<double>();
+    max_sum_bps += it.second.max_rate.IsFinite()
+                       ? it.second.max_rate.bps<double>()
+                       : std::numeric_limits<double>::infinity();
+  }
+  // Don't hand out more than the members can use, nor less than they need.
+  // The pool itself is left as is, so that it is still there when the limits
+  // change again, e.g. after a period in which no member had any streams.
+  const double allocated_bps =
+      std::max(min_sum_bps, std::min(*pooled_rate_bps_, max_sum_bps));
+
+  std::vector<Member*> unsaturated_members;
+  for (auto& it : members_) {
+    it.second.share = it.second.min_rate;
+    if (it.second.max_rate > it.second.min_rate)
+      unsaturated_members.push_back(&it.second);
+  }
+  double remaining_bps = allocated_bps - min_sum_bps;
+  while (!unsaturated_members.empty() && remaining_bps > 0) {
+    const double even_share_bps = remaining_bps / unsaturated_members.size();
+    // Members that can't use an even share get what they can use, and the
+    // rest is split again between the others.
+    auto saturated = std::partition(
+        unsaturated_members.begin(), unsaturated_members.end(),
+        [even_share_bps](const Member* member) {
+          return (member->max_rate - member->share).bps<double>() >
+                 even_share_bps;
+        });
+    if (saturated == unsaturated_members.end()) {
+      for (Member* member : unsaturated_members)
+        member->share += DataRate::bps(even_share_bps);
+      break;
+    }
+    for (auto it = saturated; it != unsaturated_members.end(); ++it) {
+      remaining_bps -= ((*it)->max_rate - (*it)->share).bps<double>();
+      (*it)->share = (*it)->max_rate;
+    }
+    unsaturated_members.erase(saturated, unsaturated_members.end());
+  }
+}
+
+CoupledNetworkController::CoupledNetworkController(
+    NetworkControllerConfig config,
+    std::unique_ptr<NetworkControllerInterface> controller,
+    CoupledNetworkControllerGroup* group)
+    : controller_(std::move(controller)),
+      group_(group),
+      member_id_(group->AddMember()),
+      constraints_(config.constraints),
+      max_total_allocated_bitrate_(
+          config.stream_based_config.max_total_allocated_bitrate) {
+  UpdateRateLimits();
+}
+
+CoupledNetworkController::~CoupledNetworkController() {
+  group_->RemoveMember(member_id_);
+}
+
+NetworkControlUpdate CoupledNetworkController::OnNetworkAvailability(
+    NetworkAvailability msg) {
+  return Couple(controller_->OnNetworkAvailability(msg));
+}
+
+NetworkControlUpdate CoupledNetworkController::OnNetworkRouteChange(
+    NetworkRouteChange msg) {
+  return Couple(controller_->OnNetworkRouteChange(msg));
+}
+
+NetworkControlUpdate CoupledNetworkController::OnProcessInterval(
+    ProcessInterval msg) {
+  return Couple(controller_->OnProcessInterval(msg));
+}
+
+NetworkControlUpdate CoupledNetworkController::OnRemoteBitrateReport(
+    RemoteBitrateReport msg) {
+  return Couple(controller_->OnRemoteBitrateReport(msg));
+}
+
+NetworkControlUpdate CoupledNetworkController::OnRoundTripTimeUpdate(
+    RoundTripTimeUpdate msg) {
+  return Couple(controller_->OnRoundTripTimeUpdate(msg));
+}
+
+NetworkControlUpdate CoupledNetworkController::OnSentPacket(SentPacket msg) {
+  return Couple(controller_->OnSentPacket(msg));
+}
+
+NetworkControlUpdate CoupledNetworkController::OnReceivedPacket(
+    ReceivedPacket msg) {
+  return Couple(controller_->OnReceivedPacket(msg));
+}
+
+NetworkControlUpdate CoupledNetworkController::OnStreamsConfig(
+    StreamsConfig msg) {
+  if (msg.max_total_allocated_bitrate) {
+    max_total_allocated_bitrate_ = msg.max_total_allocated_bitrate;
+    UpdateRateLimits();
+  }
+  return Couple(controller_->OnStreamsConfig(msg));
+}
+
+NetworkControlUpdate CoupledNetworkController::OnTargetRateConstraints(
+    TargetRateConstraints msg) {
+  constraints_ = msg;
+  UpdateRateLimits();
+  return Couple(controller_->OnTargetRateConstraints(msg));
+}
+
+NetworkControlUpdate CoupledNetworkController::OnTransportLossReport(
+    TransportLossReport msg) {
+  return Couple(controller_->OnTransportLossReport(msg));
+}
+
+NetworkControlUpdate CoupledNetworkController::OnTransportPacketsFeedback(
+    TransportPacketsFeedback msg) {
+  return Couple(controller_->OnTransportPacketsFeedback(msg));
+}
+
+NetworkControlUpdate CoupledNetworkController::OnNetworkStateEstimate(
+    NetworkStateEstimate msg) {
+  return Couple(controller_->OnNetworkStateEstimate(msg));
+}
+
+void CoupledNetworkController::UpdateRateLimits() {
+  DataRate max_rate =
+      constraints_.max_data_rate.value_or(DataRate::PlusInfinity());
+  // Like BitrateAllocator, don't give a member more than its streams can use.
+  // A max of zero means that the member has no streams, not that it can't
+  // use any bandwidth.
+  if (max_total_allocated_bitrate_ && !max_total_allocated_bitrate_->IsZero())
+    max_rate = std::min(max_rate, *max_total_allocated_bitrate_);
+  group_->SetRateLimits(member_id_,
+                        constraints_.min_data_rate.value_or(DataRate::Zero()),
+                        max_rate);
+}
+
+NetworkControlUpdate CoupledNetworkController::Couple(
+    NetworkControlUpdate update) {
+  if (update.target_rate) {
+    last_target_rate_ = update.target_rate;
+    group_->OnTargetRate(member_id_, update.target_rate->target_rate);
+  }
+  if (update.pacer_config)
+    last_pacer_config_ = update.pacer_config;
+  if (update.congestion_window)
+    last_congestion_window_ = update.congestion_window;
+  if (!group_->IsProbingMember(member_id_))
+    update.probe_cluster_configs.clear();
+
+  absl::optional<DataRate> share = group_->GetShare(member_id_);
+  if (!share || !last_target_rate_)
+    return update;
+  if (share == last_share_ && !update.target_rate && !update.pacer_config &&
+      !update.congestion_window) {
+    return update;
+  }
+  last_share_ = share;
+
+  // Scale the pacing and congestion window of the wrapped controller by the
+  // share relative to its own target rate.
+  const DataRate target_rate = last_target_rate_->target_rate;
+  const double scale = target_rate.IsZero() ? 1.0 : *share / target_rate;
+  update.target_rate = last_target_rate_;
+  update.target_rate->target_rate = *share;
+  if (last_pacer_config_) {
+    update.pacer_config = last_pacer_config_;
+    if (last_pacer_config_->data_window.IsFinite()) {
+      update.pacer_config->data_window =
+          last_pacer_config_->data_window * scale;
+    }
+    update.pacer_config->pad_window = last_pacer_config_->pad_window * scale;
+  }
+  if (last_congestion_window_ && last_congestion_window_->IsFinite())
+    update.congestion_window = *last_congestion_window_ * scale;
+  return update;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,124 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_CONGESTION_CONTROLLER_COUPLED_COUPLED_NETWORK_CONTROLLER_H_
+#define MODULES_CONGESTION_CONTROLLER_COUPLED_COUPLED_NETWORK_CONTROLLER_H_
+
+#include <map>
+#include <memory>
+
+#include "absl/types/optional.h"
+#include "api/transport/network_control.h"
+#include "api/transport/network_types.h"
+#include "api/units/data_rate.h"
+#include "api/units/data_size.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Shares one bandwidth estimate between network controllers whose transports
+// go through the same bottleneck, e.g. several transports from a server to
+// the same client network. The estimates of the members' own controllers are
+// pooled, in the way of the flow state exchange of RFC 8699, and the pool is
+// split between the members like BitrateAllocator splits bandwidth between
+// streams: every member gets its min rate, and the rest is split evenly
+// without giving any member more than its max rate.
+//
+// Thread safe, since the members usually run on different task queues.
+class CoupledNetworkControllerGroup {
+ public:
+  CoupledNetworkControllerGroup();
+  ~CoupledNetworkControllerGroup();
+
+  // Returns the id of the new member.
+  int AddMember();
+  // The share of a removed member is split between the remaining members.
+  void RemoveMember(int member_id);
+
+  void SetRateLimits(int member_id, DataRate min_rate, DataRate max_rate);
+
+  // Updates the pool with a new target rate from the member's controller.
+  void OnTargetRate(int member_id, DataRate target_rate);
+
+  // Returns the member's share of the pool, or nullopt until the pool has an
+  // estimate.
+  absl::optional<DataRate> GetShare(int member_id) const;
+
+  // Only the oldest member probes, so that the members don't probe the
+  // bottleneck at the same time. The others benefit from its probes through
+  // the pool.
+  bool IsProbingMember(int member_id) const;
+
+ private:
+  struct Member {
+    DataRate min_rate = DataRate::Zero();
+    DataRate max_rate = DataRate::PlusInfinity();
+    absl::optional<DataRate> controller_rate;
+    DataRate share = DataRate::Zero();
+  };
+
+  void Allocate() RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  rtc::CriticalSection lock_;
+  int next_member_id_ RTC_GUARDED_BY(lock_) = 0;
+  std::map<int, Member> members_ RTC_GUARDED_BY(lock_);
+  absl::optional<double> pooled_rate_bps_ RTC_GUARDED_BY(lock_);
+};
+
+// Network controller taking part in a CoupledNetworkControllerGroup. It feeds
+// the target rate of the wrapped controller to the group, and replaces it with
+// its share of the group's pool. The pacing rates and congestion window are
+// scaled to match.
+class CoupledNetworkController : public NetworkControllerInterface {
+ public:
+  CoupledNetworkController(
+      NetworkControllerConfig config,
+      std::unique_ptr<NetworkControllerInterface> controller,
+      CoupledNetworkControllerGroup* group);
+  ~CoupledNetworkController() override;
+
+  NetworkControlUpdate OnNetworkAvailability(NetworkAvailability msg) override;
+  NetworkControlUpdate OnNetworkRouteChange(NetworkRouteChange msg) override;
+  NetworkControlUpdate OnProcessInterval(ProcessInterval msg) override;
+  NetworkControlUpdate OnRemoteBitrateReport(RemoteBitrateReport msg) override;
+  NetworkControlUpdate OnRoundTripTimeUpdate(RoundTripTimeUpdate msg) override;
+  NetworkControlUpdate OnSentPacket(SentPacket msg) override;
+  NetworkControlUpdate OnReceivedPacket(ReceivedPacket msg) override;
+  NetworkControlUpdate OnStreamsConfig(StreamsConfig msg) override;
+  NetworkControlUpdate OnTargetRateConstraints(
+      TargetRateConstraints msg) override;
+  NetworkControlUpdate OnTransportLossReport(TransportLossReport msg) override;
+  NetworkControlUpdate OnTransportPacketsFeedback(
+      TransportPacketsFeedback msg) override;
+  NetworkControlUpdate OnNetworkStateEstimate(
+      NetworkStateEstimate msg) override;
+
+ private:
+  void UpdateRateLimits();
+  // Applies the member's share of the pool to |update|, which also picks up
+  // changes of the share caused by the other members.
+  NetworkControlUpdate Couple(NetworkControlUpdate update);
+
+  const std::unique_ptr<NetworkControllerInterface> controller_;
+  CoupledNetworkControllerGroup* const group_;
+  const int member_id_;
+  TargetRateConstraints constraints_;
+  absl::optional<DataRate> max_total_allocated_bitrate_;
+
+  absl::optional<TargetTransferRate> last_target_rate_;
+  absl::optional<PacerConfig> last_pacer_config_;
+  absl::optional<DataSize> last_congestion_window_;
+  absl::optional<DataRate> last_share_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_CONGESTION_CONTROLLER_COUPLED_COUPLED_NETWORK_CONTROLLER_H_
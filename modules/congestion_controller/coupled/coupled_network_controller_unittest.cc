@@ -0,0 +1,283 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/congestion_controller/coupled/coupled_network_controller.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+// Returns the update set by the test on the next process interval.
+class FakeNetworkController : public NetworkControllerInterface {
+ public:
+  void SetNextUpdate(DataRate target_rate, bool probe = false) {
+    next_update_ = NetworkControlUpdate();
+    next_update_.target_rate = TargetTransferRate();
+    next_update_.target_rate->target_rate = target_rate;
+    next_update_.pacer_config = PacerConfig();
+    next_update_.pacer_config->time_window = TimeDelta::seconds(1);
+    next_update_.pacer_config->data_window =
+        target_rate * TimeDelta::seconds(1);
+    next_update_.congestion_window = target_rate * TimeDelta::ms(100);
+    if (probe)
+      next_update_.probe_cluster_configs.emplace_back();
+  }
+
+  NetworkControlUpdate OnNetworkAvailability(NetworkAvailability) override {
+    return NetworkControlUpdate();
+  }
+  NetworkControlUpdate OnNetworkRouteChange(NetworkRouteChange) override {
+    return NetworkControlUpdate();
+  }
+  NetworkControlUpdate OnProcessInterval(ProcessInterval) override {
+    NetworkControlUpdate update = next_update_;
+    next_update_ = NetworkControlUpdate();
+    return update;
+  }
+  NetworkControlUpdate OnRemoteBitrateReport(RemoteBitrateReport) override {
+    return NetworkControlUpdate();
+  }
+  NetworkControlUpdate OnRoundTripTimeUpdate(RoundTripTimeUpdate) override {
+    return NetworkControlUpdate();
+  }
+  NetworkControlUpdate OnSentPacket(SentPacket) override {
+    return NetworkControlUpdate();
+  }
+  NetworkControlUpdate OnReceivedPacket(ReceivedPacket) override {
+    return NetworkControlUpdate();
+  }
+  NetworkControlUpdate OnStreamsConfig(StreamsConfig) override {
+    return NetworkControlUpdate();
+  }
+  NetworkControlUpdate OnTargetRateConstraints(
+      TargetRateConstraints) override {
+    return NetworkControlUpdate();
+  }
+  NetworkControlUpdate OnTransportLossReport(TransportLossReport) override {
+    return NetworkControlUpdate();
+  }
+  NetworkControlUpdate OnTransportPacketsFeedback(
+      TransportPacketsFeedback) override {
+    return NetworkControlUpdate();
+  }
+  NetworkControlUpdate OnNetworkStateEstimate(NetworkStateEstimate) override {
+    return NetworkControlUpdate();
+  }
+
+ private:
+  NetworkControlUpdate next_update_;
+};
+
+struct TestController {
+  FakeNetworkController* fake;
+  std::unique_ptr<CoupledNetworkController> coupled;
+};
+
+TestController CreateController(CoupledNetworkControllerGroup* group,
+                                NetworkControllerConfig config = {}) {
+  auto fake = absl::make_unique<FakeNetworkController>();
+  TestController controller;
+  controller.fake = fake.get();
+  controller.coupled = absl::make_unique<CoupledNetworkController>(
+      config, std::move(fake), group);
+  return controller;
+}
+
+}  // namespace
+
+TEST(CoupledNetworkControllerGroupTest, NoShareBeforeFirstEstimate) {
+  CoupledNetworkControllerGroup group;
+  int member_id = group.AddMember();
+  EXPECT_FALSE(group.GetShare(member_id));
+  group.OnTargetRate(member_id, DataRate::kbps(300));
+  EXPECT_EQ(group.GetShare(member_id), DataRate::kbps(300));
+  group.RemoveMember(member_id);
+}
+
+TEST(CoupledNetworkControllerGroupTest, NewMemberTakesShareFromPool) {
+  CoupledNetworkControllerGroup group;
+  int first_id = group.AddMember();
+  group.OnTargetRate(first_id, DataRate::kbps(1000));
+  int second_id = group.AddMember();
+  EXPECT_EQ(group.GetShare(first_id), DataRate::kbps(500));
+  EXPECT_EQ(group.GetShare(second_id), DataRate::kbps(500));
+  // The start rate of the new member doesn't add to the pool.
+  group.OnTargetRate(second_id, DataRate::kbps(300));
+  EXPECT_EQ(group.GetShare(first_id), DataRate::kbps(500));
+  EXPECT_EQ(group.GetShare(second_id), DataRate::kbps(500));
+  group.RemoveMember(first_id);
+  EXPECT_EQ(group.GetShare(second_id), DataRate::kbps(1000));
+  group.RemoveMember(second_id);
+}
+
+TEST(CoupledNetworkControllerGroupTest, AppliesRelativeChangeToShare) {
+  CoupledNetworkControllerGroup group;
+  int first_id = group.AddMember();
+  int second_id = group.AddMember();
+  group.OnTargetRate(first_id, DataRate::kbps(1000));
+  group.OnTargetRate(second_id, DataRate::kbps(1000));
+  EXPECT_EQ(group.GetShare(first_id), DataRate::kbps(500));
+  // A drop of 20% of the estimate of the first member reduces its share of
+  // 500 kbps by 100 kbps.
+  group.OnTargetRate(first_id, DataRate::kbps(800));
+  EXPECT_EQ(group.GetShare(first_id), DataRate::kbps(450));
+  EXPECT_EQ(group.GetShare(second_id), DataRate::kbps(450));
+  // An increase of 50% of the estimate of the second member increases its
+  // share of 450 kbps by 225 kbps.
+  group.OnTargetRate(second_id, DataRate::kbps(1500));
+  EXPECT_EQ(group.GetShare(first_id), DataRate::bps(562500));
+  EXPECT_EQ(group.GetShare(second_id), DataRate::bps(562500));
+  group.RemoveMember(first_id);
+  group.RemoveMember(second_id);
+}
+
+TEST(CoupledNetworkControllerGroupTest, SplitsLikeBitrateAllocator) {
+  CoupledNetworkControllerGroup group;
+  int first_id = group.AddMember();
+  int second_id = group.AddMember();
+  int third_id = group.AddMember();
+  group.SetRateLimits(first_id, DataRate::kbps(100), DataRate::kbps(200));
+  group.SetRateLimits(second_id, DataRate::kbps(400), DataRate::PlusInfinity());
+  group.OnTargetRate(third_id, DataRate::kbps(1000));
+  // The first member is capped at its max, the rest is split evenly on top of
+  // the min rates.
+  EXPECT_EQ(group.GetShare(first_id), DataRate::kbps(200));
+  EXPECT_EQ(group.GetShare(second_id), DataRate::kbps(600));
+  EXPECT_EQ(group.GetShare(third_id), DataRate::kbps(200));
+
+  // The pool is never below the sum of the min rates.
+  group.SetRateLimits(third_id, DataRate::kbps(600), DataRate::PlusInfinity());
+  EXPECT_EQ(group.GetShare(first_id), DataRate::kbps(100));
+  EXPECT_EQ(group.GetShare(second_id), DataRate::kbps(400));
+  EXPECT_EQ(group.GetShare(third_id), DataRate::kbps(600));
+  group.RemoveMember(first_id);
+  group.RemoveMember(second_id);
+  group.RemoveMember(third_id);
+}
+
+TEST(CoupledNetworkControllerGroupTest, KeepsPoolWhileMembersCantUseIt) {
+  CoupledNetworkControllerGroup group;
+  int first_id = group.AddMember();
+  int second_id = group.AddMember();
+  group.OnTargetRate(first_id, DataRate::kbps(1000));
+  group.OnTargetRate(second_id, DataRate::kbps(1000));
+  EXPECT_EQ(group.GetShare(first_id), DataRate::kbps(500));
+
+  group.SetRateLimits(first_id, DataRate::Zero(), DataRate::Zero());
+  group.SetRateLimits(second_id, DataRate::Zero(), DataRate::Zero());
+  EXPECT_EQ(group.GetShare(first_id), DataRate::Zero());
+  EXPECT_EQ(group.GetShare(second_id), DataRate::Zero());
+  // Without a share, changes of the controllers' estimates don't move the
+  // pool.
+  group.OnTargetRate(first_id, DataRate::kbps(800));
+  group.OnTargetRate(second_id, DataRate::kbps(1200));
+
+  // The pool is still there once the members can use it again.
+  group.SetRateLimits(first_id, DataRate::Zero(), DataRate::PlusInfinity());
+  group.SetRateLimits(second_id, DataRate::Zero(), DataRate::PlusInfinity());
+  EXPECT_EQ(group.GetShare(first_id), DataRate::kbps(500));
+  EXPECT_EQ(group.GetShare(second_id), DataRate::kbps(500));
+  group.RemoveMember(first_id);
+  group.RemoveMember(second_id);
+}
+
+TEST(CoupledNetworkControllerTest, ReplacesTargetRateWithShare) {
+  CoupledNetworkControllerGroup group;
+  TestController first = CreateController(&group);
+  TestController second = CreateController(&group);
+
+  first.fake->SetNextUpdate(DataRate::kbps(1000));
+  NetworkControlUpdate update =
+      first.coupled->OnProcessInterval(ProcessInterval());
+  ASSERT_TRUE(update.target_rate);
+  EXPECT_EQ(update.target_rate->target_rate, DataRate::kbps(500));
+  ASSERT_TRUE(update.pacer_config);
+  EXPECT_EQ(update.pacer_config->data_rate(), DataRate::kbps(500));
+  ASSERT_TRUE(update.congestion_window);
+  EXPECT_EQ(*update.congestion_window,
+            DataRate::kbps(500) * TimeDelta::ms(100));
+
+  // The second member picks up its share before its own controller has an
+  // estimate.
+  second.fake->SetNextUpdate(DataRate::kbps(300));
+  update = second.coupled->OnProcessInterval(ProcessInterval());
+  ASSERT_TRUE(update.target_rate);
+  EXPECT_EQ(update.target_rate->target_rate, DataRate::kbps(500));
+  EXPECT_EQ(update.pacer_config->data_rate(), DataRate::kbps(500));
+}
+
+TEST(CoupledNetworkControllerTest, UpdatesWhenOtherMemberChangesShare) {
+  CoupledNetworkControllerGroup group;
+  TestController first = CreateController(&group);
+  first.fake->SetNextUpdate(DataRate::kbps(1000));
+  first.coupled->OnProcessInterval(ProcessInterval());
+  EXPECT_FALSE(first.coupled->OnProcessInterval(ProcessInterval()).target_rate);
+
+  {
+    TestController second = CreateController(&group);
+    NetworkControlUpdate update =
+        first.coupled->OnProcessInterval(ProcessInterval());
+    ASSERT_TRUE(update.target_rate);
+    EXPECT_EQ(update.target_rate->target_rate, DataRate::kbps(500));
+  }
+  NetworkControlUpdate update =
+      first.coupled->OnProcessInterval(ProcessInterval());
+  ASSERT_TRUE(update.target_rate);
+  EXPECT_EQ(update.target_rate->target_rate, DataRate::kbps(1000));
+}
+
+TEST(CoupledNetworkControllerTest, OnlyOldestMemberProbes) {
+  CoupledNetworkControllerGroup group;
+  TestController first = CreateController(&group);
+  TestController second = CreateController(&group);
+  first.fake->SetNextUpdate(DataRate::kbps(300), /*probe=*/true);
+  second.fake->SetNextUpdate(DataRate::kbps(300), /*probe=*/true);
+  EXPECT_EQ(first.coupled->OnProcessInterval(ProcessInterval())
+                .probe_cluster_configs.size(),
+            1u);
+  EXPECT_TRUE(second.coupled->OnProcessInterval(ProcessInterval())
+                  .probe_cluster_configs.empty());
+}
+
+TEST(CoupledNetworkControllerTest, UsesConstraintsAsRateLimits) {
+  CoupledNetworkControllerGroup group;
+  NetworkControllerConfig config;
+  config.constraints.max_data_rate = DataRate::kbps(200);
+  TestController first = CreateController(&group, config);
+  TestController second = CreateController(&group);
+
+  first.fake->SetNextUpdate(DataRate::kbps(1000));
+  NetworkControlUpdate update =
+      first.coupled->OnProcessInterval(ProcessInterval());
+  EXPECT_EQ(update.target_rate->target_rate, DataRate::kbps(200));
+
+  StreamsConfig streams_config;
+  streams_config.max_total_allocated_bitrate = DataRate::kbps(100);
+  first.coupled->OnStreamsConfig(streams_config);
+  second.fake->SetNextUpdate(DataRate::kbps(1000));
+  update = second.coupled->OnProcessInterval(ProcessInterval());
+  EXPECT_EQ(update.target_rate->target_rate, DataRate::kbps(900));
+
+  // A max total allocated bitrate of zero, i.e. no streams, is no limit.
+  streams_config.max_total_allocated_bitrate = DataRate::Zero();
+  update = first.coupled->OnStreamsConfig(streams_config);
+  ASSERT_TRUE(update.target_rate);
+  EXPECT_EQ(update.target_rate->target_rate, DataRate::kbps(200));
+  update = second.coupled->OnProcessInterval(ProcessInterval());
+  ASSERT_TRUE(update.target_rate);
+  EXPECT_EQ(update.target_rate->target_rate, DataRate::kbps(800));
+}
+
+}  // namespace webrtc
@@ -18,7 +18,7 @@
 
 namespace webrtc {
 void ComparePacketFeedbackVectors(const std::vector<PacketFeedback>& truth,
-                                  const std::vector<PacketFeedback>& input) {
+                                  rtc::ArrayView<const PacketFeedback> input) {
   ASSERT_EQ(truth.size(), input.size());
   size_t len = truth.size();
   // truth contains the input data for the test, and input is what will be
@@ -13,11 +13,12 @@
 
 #include <vector>
 
+#include "api/array_view.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 
 namespace webrtc {
 void ComparePacketFeedbackVectors(const std::vector<PacketFeedback>& truth,
-                                  const std::vector<PacketFeedback>& input);
+                                  rtc::ArrayView<const PacketFeedback> input);
 }  // namespace webrtc
 
 #endif  // MODULES_CONGESTION_CONTROLLER_RTP_CONGESTION_CONTROLLER_UNITTESTS_HELPER_H_
@@ -18,6 +18,14 @@
 #include "rtc_base/logging.h"
 
 namespace webrtc {
+namespace {
+
+// Enough for a few seconds of packets of a typical call, before growing.
+constexpr int64_t kMinCapacity = 1024;
+
+}  // namespace
+
+constexpr int64_t SendTimeHistory::kMaxNumberOfPackets;
 
 SendTimeHistory::SendTimeHistory(int64_t packet_age_limit_ms)
     : packet_age_limit_ms_(packet_age_limit_ms) {}
@@ -25,19 +33,42 @@ SendTimeHistory::SendTimeHistory(int64_t packet_age_limit_ms)
 SendTimeHistory::~SendTimeHistory() {}
 
 void SendTimeHistory::RemoveOld(int64_t at_time_ms) {
-  while (!history_.empty() &&
-         at_time_ms - history_.begin()->second.creation_time_ms >
+  while (first_seq_num_ < end_seq_num_ &&
+         at_time_ms - Slot(first_seq_num_)->creation_time_ms >
              packet_age_limit_ms_) {
     // TODO(sprang): Warn if erasing (too many) old items?
-    RemovePacketBytes(history_.begin()->second);
-    history_.erase(history_.begin());
+    RemovePacketBytes(*Slot(first_seq_num_));
+    RemoveFirst();
   }
 }
 
 void SendTimeHistory::AddNewPacket(PacketFeedback packet) {
-  packet.long_sequence_number =
+  const int64_t unwrapped_seq_num =
       seq_num_unwrapper_.Unwrap(packet.sequence_number);
-  history_.insert(std::make_pair(packet.long_sequence_number, packet));
+  packet.long_sequence_number = unwrapped_seq_num;
+  if (first_seq_num_ < end_seq_num_ &&
+      end_seq_num_ - unwrapped_seq_num > kMaxNumberOfPackets) {
+    RTC_LOG(LS_WARNING) << "Ignoring packet too old to get feedback for.";
+    return;
+  }
+  // Make room for the packet by dropping the oldest packets.
+  while (first_seq_num_ < end_seq_num_ &&
+         unwrapped_seq_num - first_seq_num_ >= kMaxNumberOfPackets) {
+    RemovePacketBytes(*Slot(first_seq_num_));
+    RemoveFirst();
+  }
+  if (first_seq_num_ == end_seq_num_) {
+    first_seq_num_ = unwrapped_seq_num;
+    end_seq_num_ = unwrapped_seq_num;
+  }
+  Reserve(std::max(end_seq_num_, unwrapped_seq_num + 1) -
+          std::min(first_seq_num_, unwrapped_seq_num));
+  absl::optional<PacketFeedback>& slot = Slot(unwrapped_seq_num);
+  if (!slot) {
+    slot.emplace(packet);
+    first_seq_num_ = std::min(first_seq_num_, unwrapped_seq_num);
+    end_seq_num_ = std::max(end_seq_num_, unwrapped_seq_num + 1);
+  }
   if (packet.send_time_ms >= 0) {
     AddPacketBytes(packet);
     last_send_time_ms_ = std::max(last_send_time_ms_, packet.send_time_ms);
@@ -56,20 +87,20 @@ void SendTimeHistory::AddUntracked(size_t packet_size, int64_t send_time_ms) {
 SendTimeHistory::Status SendTimeHistory::OnSentPacket(uint16_t sequence_number,
                                                       int64_t send_time_ms) {
   int64_t unwrapped_seq_num = seq_num_unwrapper_.Unwrap(sequence_number);
-  auto it = history_.find(unwrapped_seq_num);
-  if (it == history_.end())
+  PacketFeedback* packet = Find(unwrapped_seq_num);
+  if (!packet)
     return Status::kNotAdded;
-  bool packet_retransmit = it->second.send_time_ms >= 0;
-  it->second.send_time_ms = send_time_ms;
+  bool packet_retransmit = packet->send_time_ms >= 0;
+  packet->send_time_ms = send_time_ms;
   last_send_time_ms_ = std::max(last_send_time_ms_, send_time_ms);
   if (!packet_retransmit)
-    AddPacketBytes(it->second);
+    AddPacketBytes(*packet);
   if (pending_untracked_size_ > 0) {
     if (send_time_ms < last_untracked_send_time_ms_)
       RTC_LOG(LS_WARNING)
           << "appending acknowledged data for out of order packet. (Diff: "
           << last_untracked_send_time_ms_ - send_time_ms << " ms.)";
-    it->second.unacknowledged_data += pending_untracked_size_;
+    packet->unacknowledged_data += pending_untracked_size_;
     pending_untracked_size_ = 0;
   }
   return packet_retransmit ? Status::kDuplicate : Status::kOk;
@@ -80,9 +111,9 @@ absl::optional<PacketFeedback> SendTimeHistory::GetPacket(
   int64_t unwrapped_seq_num =
       seq_num_unwrapper_.UnwrapWithoutUpdate(sequence_number);
   absl::optional<PacketFeedback> optional_feedback;
-  auto it = history_.find(unwrapped_seq_num);
-  if (it != history_.end())
-    optional_feedback.emplace(it->second);
+  const PacketFeedback* packet = Find(unwrapped_seq_num);
+  if (packet)
+    optional_feedback.emplace(*packet);
   return optional_feedback;
 }
 
@@ -93,17 +124,19 @@ bool SendTimeHistory::GetFeedback(PacketFeedback* packet_feedback,
       seq_num_unwrapper_.Unwrap(packet_feedback->sequence_number);
   UpdateAckedSeqNum(unwrapped_seq_num);
   RTC_DCHECK_GE(*last_ack_seq_num_, 0);
-  auto it = history_.find(unwrapped_seq_num);
-  if (it == history_.end())
+  const PacketFeedback* packet = Find(unwrapped_seq_num);
+  if (!packet)
     return false;
 
   // Save arrival_time not to overwrite it.
   int64_t arrival_time_ms = packet_feedback->arrival_time_ms;
-  *packet_feedback = it->second;
+  *packet_feedback = *packet;
   packet_feedback->arrival_time_ms = arrival_time_ms;
 
-  if (remove)
-    history_.erase(it);
+  if (remove) {
+    Slot(unwrapped_seq_num).reset();
+    TrimMissingPackets();
+  }
   return true;
 }
 
@@ -120,11 +153,50 @@ DataSize SendTimeHistory::GetOutstandingData(uint16_t local_net_id,
 absl::optional<int64_t> SendTimeHistory::GetFirstUnackedSendTime() const {
   if (!last_ack_seq_num_)
     return absl::nullopt;
-  auto it = history_.find(*last_ack_seq_num_);
-  if (it == history_.end() ||
-      it->second.send_time_ms == PacketFeedback::kNoSendTime)
+  const PacketFeedback* packet = Find(*last_ack_seq_num_);
+  if (!packet || packet->send_time_ms == PacketFeedback::kNoSendTime)
     return absl::nullopt;
-  return it->second.send_time_ms;
+  return packet->send_time_ms;
+}
+
+const PacketFeedback* SendTimeHistory::Find(int64_t unwrapped_seq_num) const {
+  if (unwrapped_seq_num < first_seq_num_ || unwrapped_seq_num >= end_seq_num_)
+    return nullptr;
+  const absl::optional<PacketFeedback>& slot =
+      history_[unwrapped_seq_num & (history_.size() - 1)];
+  return slot ? &*slot : nullptr;
+}
+
+PacketFeedback* SendTimeHistory::Find(int64_t unwrapped_seq_num) {
+  return const_cast<PacketFeedback*>(
+      static_cast<const SendTimeHistory*>(this)->Find(unwrapped_seq_num));
+}
+
+void SendTimeHistory::Reserve(int64_t size) {
+  RTC_DCHECK_LE(size, kMaxNumberOfPackets);
+  if (size <= static_cast<int64_t>(history_.size()))
+    return;
+  int64_t capacity =
+      std::max(static_cast<int64_t>(history_.size()), kMinCapacity);
+  while (capacity < size)
+    capacity *= 2;
+  std::vector<absl::optional<PacketFeedback>> history(capacity);
+  for (int64_t seq = first_seq_num_; seq < end_seq_num_; ++seq)
+    history[seq & (capacity - 1)] = std::move(Slot(seq));
+  history_ = std::move(history);
+}
+
+void SendTimeHistory::RemoveFirst() {
+  RTC_DCHECK_LT(first_seq_num_, end_seq_num_);
+  Slot(first_seq_num_).reset();
+  TrimMissingPackets();
+}
+
+void SendTimeHistory::TrimMissingPackets() {
+  while (first_seq_num_ < end_seq_num_ && !Slot(first_seq_num_))
+    ++first_seq_num_;
+  while (first_seq_num_ < end_seq_num_ && !Slot(end_seq_num_ - 1))
+    --end_seq_num_;
 }
 
 void SendTimeHistory::AddPacketBytes(const PacketFeedback& packet) {
@@ -156,13 +228,15 @@ void SendTimeHistory::UpdateAckedSeqNum(int64_t acked_seq_num) {
   if (last_ack_seq_num_ && *last_ack_seq_num_ >= acked_seq_num)
     return;
 
-  auto unacked_it = history_.begin();
+  int64_t unacked_seq_num = first_seq_num_;
   if (last_ack_seq_num_)
-    unacked_it = history_.lower_bound(*last_ack_seq_num_);
+    unacked_seq_num = std::max(unacked_seq_num, *last_ack_seq_num_);
 
-  auto newly_acked_end = history_.upper_bound(acked_seq_num);
-  for (; unacked_it != newly_acked_end; ++unacked_it) {
-    RemovePacketBytes(unacked_it->second);
+  const int64_t newly_acked_end = std::min(end_seq_num_, acked_seq_num + 1);
+  for (; unacked_seq_num < newly_acked_end; ++unacked_seq_num) {
+    const PacketFeedback* packet = Find(unacked_seq_num);
+    if (packet)
+      RemovePacketBytes(*packet);
   }
   last_ack_seq_num_.emplace(acked_seq_num);
 }
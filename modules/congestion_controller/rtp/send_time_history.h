@@ -13,7 +13,9 @@
 
 #include <map>
 #include <utility>
+#include <vector>
 
+#include "absl/types/optional.h"
 #include "api/units/data_size.h"
 #include "modules/include/module_common_types.h"
 #include "rtc_base/constructor_magic.h"
@@ -55,6 +57,23 @@ class SendTimeHistory {
  private:
   using RemoteAndLocalNetworkId = std::pair<uint16_t, uint16_t>;
 
+  // The feedback for a packet can only be looked up as long as its 16 bit
+  // sequence number unwraps to the same value, so the history doesn't need to
+  // span more sequence numbers than this.
+  static constexpr int64_t kMaxNumberOfPackets = 1 << 15;
+
+  absl::optional<PacketFeedback>& Slot(int64_t unwrapped_seq_num) {
+    return history_[unwrapped_seq_num & (history_.size() - 1)];
+  }
+  const PacketFeedback* Find(int64_t unwrapped_seq_num) const;
+  PacketFeedback* Find(int64_t unwrapped_seq_num);
+  // Grows |history_| to hold at least |size| sequence numbers.
+  void Reserve(int64_t size);
+  // Removes the first packet in the history, and the missing packets after it.
+  void RemoveFirst();
+  // Trims the missing packets at either end of the history.
+  void TrimMissingPackets();
+
   void AddPacketBytes(const PacketFeedback& packet);
   void RemovePacketBytes(const PacketFeedback& packet);
   void UpdateAckedSeqNum(int64_t acked_seq_num);
@@ -63,7 +82,13 @@ class SendTimeHistory {
   int64_t last_send_time_ms_ = -1;
   int64_t last_untracked_send_time_ms_ = -1;
   SequenceNumberUnwrapper seq_num_unwrapper_;
-  std::map<int64_t, PacketFeedback> history_;
+  // Ring buffer of the packets with unwrapped sequence numbers in
+  // [|first_seq_num_|, |end_seq_num_|), indexed by sequence number. Its size
+  // is a power of two, and the first and last packets are present unless the
+  // history is empty.
+  std::vector<absl::optional<PacketFeedback>> history_;
+  int64_t first_seq_num_ = 0;
+  int64_t end_seq_num_ = 0;
   absl::optional<int64_t> last_ack_seq_num_;
   std::map<RemoteAndLocalNetworkId, size_t> in_flight_bytes_;
 
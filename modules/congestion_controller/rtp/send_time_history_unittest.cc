@@ -225,6 +225,20 @@ TEST_F(SendTimeHistoryTest, HistorySizeWithWraparound) {
   EXPECT_TRUE(history_.GetFeedback(&packet10, false));
 }
 
+TEST_F(SendTimeHistoryTest, HistorySizeLimitedBySequenceNumberRange) {
+  // Send more packets at once than 15 bits of sequence numbers can tell apart.
+  const int kNumPackets = 40000;
+  const int kMaxNumPackets = 1 << 15;
+  for (int i = 0; i < kNumPackets; ++i)
+    AddPacketWithSendTime(static_cast<uint16_t>(i), 1, 0, PacedPacketInfo());
+
+  // The oldest packets are dropped, together with their outstanding data.
+  EXPECT_EQ(DataSize::bytes(kMaxNumPackets), history_.GetOutstandingData(0, 0));
+  EXPECT_FALSE(history_.GetPacket(kNumPackets - kMaxNumPackets - 1));
+  EXPECT_TRUE(history_.GetPacket(kNumPackets - kMaxNumPackets));
+  EXPECT_TRUE(history_.GetPacket(kNumPackets - 1));
+}
+
 TEST_F(SendTimeHistoryTest, InterlievedGetAndRemove) {
   const uint16_t kSeqNo = 1;
   const int64_t kTimestamp = 2;
@@ -137,8 +137,8 @@ TransportFeedbackAdapter::ProcessTransportFeedback(
     Timestamp feedback_receive_time) {
   DataSize prior_in_flight = GetOutstandingData();
 
-  last_packet_feedback_vector_ =
-      GetPacketFeedbackVector(feedback, feedback_receive_time);
+  GetPacketFeedbackVector(feedback, feedback_receive_time,
+                          &last_packet_feedback_vector_);
   {
     rtc::CritScope cs(&observers_lock_);
     for (auto* observer : observers_) {
@@ -146,12 +146,12 @@ TransportFeedbackAdapter::ProcessTransportFeedback(
     }
   }
 
-  std::vector<PacketFeedback> feedback_vector = last_packet_feedback_vector_;
-  if (feedback_vector.empty())
+  if (last_packet_feedback_vector_.empty())
     return absl::nullopt;
 
   TransportPacketsFeedback msg;
-  for (const PacketFeedback& rtp_feedback : feedback_vector) {
+  msg.packet_feedbacks.reserve(last_packet_feedback_vector_.size());
+  for (const PacketFeedback& rtp_feedback : last_packet_feedback_vector_) {
     if (rtp_feedback.send_time_ms != PacketFeedback::kNoSendTime) {
       auto feedback = NetworkPacketFeedbackFromRtpPacketFeedback(rtp_feedback);
       msg.packet_feedbacks.push_back(feedback);
@@ -187,9 +187,10 @@ DataSize TransportFeedbackAdapter::GetOutstandingData() const {
   return send_time_history_.GetOutstandingData(local_net_id_, remote_net_id_);
 }
 
-std::vector<PacketFeedback> TransportFeedbackAdapter::GetPacketFeedbackVector(
+void TransportFeedbackAdapter::GetPacketFeedbackVector(
     const rtcp::TransportFeedback& feedback,
-    Timestamp feedback_time) {
+    Timestamp feedback_time,
+    std::vector<PacketFeedback>* packet_feedback_vector) {
   // Add timestamp deltas to a local time base selected on first packet arrival.
   // This won't be the true time base, but makes it easier to manually inspect
   // time stamps.
@@ -200,12 +201,14 @@ std::vector<PacketFeedback> TransportFeedbackAdapter::GetPacketFeedbackVector(
   }
   last_timestamp_us_ = feedback.GetBaseTimeUs();
 
-  std::vector<PacketFeedback> packet_feedback_vector;
+  // Clearing keeps the capacity, so that the vector doesn't need to allocate
+  // for every transport feedback.
+  packet_feedback_vector->clear();
   if (feedback.GetPacketStatusCount() == 0) {
     RTC_LOG(LS_INFO) << "Empty transport feedback packet received.";
-    return packet_feedback_vector;
+    return;
   }
-  packet_feedback_vector.reserve(feedback.GetPacketStatusCount());
+  packet_feedback_vector->reserve(feedback.GetPacketStatusCount());
   {
     rtc::CritScope cs(&lock_);
     size_t failed_lookups = 0;
@@ -223,7 +226,7 @@ std::vector<PacketFeedback> TransportFeedbackAdapter::GetPacketFeedbackVector(
           ++failed_lookups;
         if (packet_feedback.local_net_id == local_net_id_ &&
             packet_feedback.remote_net_id == remote_net_id_) {
-          packet_feedback_vector.push_back(packet_feedback);
+          packet_feedback_vector->push_back(packet_feedback);
         }
       }
 
@@ -235,7 +238,7 @@ std::vector<PacketFeedback> TransportFeedbackAdapter::GetPacketFeedbackVector(
         ++failed_lookups;
       if (packet_feedback.local_net_id == local_net_id_ &&
           packet_feedback.remote_net_id == remote_net_id_) {
-        packet_feedback_vector.push_back(packet_feedback);
+        packet_feedback_vector->push_back(packet_feedback);
       }
 
       ++seq_num;
@@ -247,10 +250,9 @@ std::vector<PacketFeedback> TransportFeedbackAdapter::GetPacketFeedbackVector(
                           << ". Send time history too small?";
     }
   }
-  return packet_feedback_vector;
 }
 
-std::vector<PacketFeedback>
+rtc::ArrayView<const PacketFeedback>
 TransportFeedbackAdapter::GetTransportFeedbackVector() const {
   return last_packet_feedback_vector_;
 }
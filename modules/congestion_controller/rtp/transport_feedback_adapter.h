@@ -14,6 +14,7 @@
 #include <deque>
 #include <vector>
 
+#include "api/array_view.h"
 #include "api/transport/network_types.h"
 #include "modules/congestion_controller/rtp/send_time_history.h"
 #include "rtc_base/critical_section.h"
@@ -48,7 +49,9 @@ class TransportFeedbackAdapter {
       const rtcp::TransportFeedback& feedback,
       Timestamp feedback_time);
 
-  std::vector<PacketFeedback> GetTransportFeedbackVector() const;
+  // Returns the packet feedback from the last transport feedback. The storage
+  // is reused by the next transport feedback.
+  rtc::ArrayView<const PacketFeedback> GetTransportFeedbackVector() const;
 
   void SetNetworkIds(uint16_t local_id, uint16_t remote_id);
 
@@ -57,9 +60,10 @@ class TransportFeedbackAdapter {
  private:
   void OnTransportFeedback(const rtcp::TransportFeedback& feedback);
 
-  std::vector<PacketFeedback> GetPacketFeedbackVector(
+  void GetPacketFeedbackVector(
       const rtcp::TransportFeedback& feedback,
-      Timestamp feedback_time);
+      Timestamp feedback_time,
+      std::vector<PacketFeedback>* packet_feedback_vector);
 
   const bool allow_duplicates_;
 
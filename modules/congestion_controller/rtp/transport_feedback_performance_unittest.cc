@@ -0,0 +1,149 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "api/rtp_headers.h"
+#include "api/transport/field_trial_based_config.h"
+#include "modules/congestion_controller/rtp/transport_feedback_adapter.h"
+#include "modules/remote_bitrate_estimator/remote_estimator_proxy.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h"
+#include "rtc_base/network/sent_packet.h"
+#include "rtc_base/random.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/clock.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumSeconds = 20;
+constexpr int kQuickNumSeconds = 1;
+// 10000 packets per second.
+constexpr int kPacketsPerMs = 10;
+constexpr size_t kPacketSize = 1200;
+constexpr uint32_t kSsrc = 0x1234;
+constexpr int64_t kNetworkDelayMs = 50;
+constexpr int kLossPercent = 2;
+constexpr int64_t kFeedbackIntervalMs = 100;
+
+class FeedbackCollector : public TransportFeedbackSenderInterface {
+ public:
+  bool SendTransportFeedback(rtcp::TransportFeedback* packet) override {
+    feedback_packets_.push_back(std::move(*packet));
+    return true;
+  }
+
+  std::vector<rtcp::TransportFeedback>* feedback_packets() {
+    return &feedback_packets_;
+  }
+
+ private:
+  std::vector<rtcp::TransportFeedback> feedback_packets_;
+};
+
+}  // namespace
+
+// Sends 10000 packets per second through TransportFeedbackAdapter, a network
+// with random loss, and RemoteEstimatorProxy, which sends transport feedback
+// every 100 ms that is then processed by TransportFeedbackAdapter. Reports the
+// per packet cost of each side of transport-wide congestion control.
+TEST(TransportFeedbackPerformanceTest, TenThousandPacketsPerSecond) {
+  const int num_seconds = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                              ? kQuickNumSeconds
+                              : kNumSeconds;
+  SimulatedClock clock(1000000);
+  FieldTrialBasedConfig field_trial_config;
+  FeedbackCollector feedback_collector;
+  RemoteEstimatorProxy proxy(&clock, &feedback_collector, &field_trial_config);
+  proxy.SetSendPeriodicFeedback(true);
+  TransportFeedbackAdapter adapter;
+  Random random(0x5eed);
+
+  // Packets in flight, as transport sequence numbers and arrival times.
+  std::deque<std::pair<uint16_t, int64_t>> network;
+  uint16_t transport_seq_num = 0;
+  int64_t send_ns = 0;
+  int64_t receive_ns = 0;
+  int64_t feedback_ns = 0;
+  int num_packets = 0;
+  int num_received_packets = 0;
+  size_t num_packet_feedbacks = 0;
+  for (int64_t now_ms = 0; now_ms < num_seconds * 1000; ++now_ms) {
+    clock.AdvanceTimeMilliseconds(1);
+    const int64_t start_ns = rtc::TimeNanos();
+    for (int i = 0; i < kPacketsPerMs; ++i) {
+      RtpPacketSendInfo packet_info;
+      packet_info.transport_sequence_number = transport_seq_num;
+      packet_info.ssrc = kSsrc;
+      packet_info.length = kPacketSize;
+      adapter.AddPacket(packet_info, 0, clock.CurrentTime());
+      rtc::SentPacket sent_packet(transport_seq_num,
+                                  clock.TimeInMilliseconds());
+      sent_packet.info.included_in_feedback = true;
+      adapter.ProcessSentPacket(sent_packet);
+      ++num_packets;
+      if (random.Rand(1, 100) > kLossPercent) {
+        network.emplace_back(transport_seq_num,
+                             clock.TimeInMilliseconds() + kNetworkDelayMs);
+      }
+      ++transport_seq_num;
+    }
+    const int64_t sent_ns = rtc::TimeNanos();
+    send_ns += sent_ns - start_ns;
+
+    RTPHeader header;
+    header.ssrc = kSsrc;
+    header.extension.hasTransportSequenceNumber = true;
+    while (!network.empty() &&
+           network.front().second <= clock.TimeInMilliseconds()) {
+      header.extension.transportSequenceNumber = network.front().first;
+      proxy.IncomingPacket(network.front().second, kPacketSize, header);
+      network.pop_front();
+      ++num_received_packets;
+    }
+    if (now_ms % kFeedbackIntervalMs == 0)
+      proxy.Process();
+    const int64_t received_ns = rtc::TimeNanos();
+    receive_ns += received_ns - sent_ns;
+
+    // The feedback skips the network delay, which doesn't affect its cost.
+    for (const rtcp::TransportFeedback& feedback :
+         *feedback_collector.feedback_packets()) {
+      absl::optional<TransportPacketsFeedback> msg =
+          adapter.ProcessTransportFeedback(feedback, clock.CurrentTime());
+      if (msg)
+        num_packet_feedbacks += msg->packet_feedbacks.size();
+    }
+    feedback_collector.feedback_packets()->clear();
+    feedback_ns += rtc::TimeNanos() - received_ns;
+  }
+
+  EXPECT_GT(num_packet_feedbacks, 0u);
+  test::PrintResult("twcc_send_time_per_packet", "", "10k_packets_per_second",
+                    static_cast<double>(send_ns) / num_packets, "ns", true);
+  test::PrintResult("twcc_receive_time_per_packet", "",
+                    "10k_packets_per_second",
+                    static_cast<double>(receive_ns) / num_received_packets,
+                    "ns", true);
+  test::PrintResult("twcc_feedback_time_per_packet", "",
+                    "10k_packets_per_second",
+                    static_cast<double>(feedback_ns) / num_packet_feedbacks,
+                    "ns", true);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,128 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/remote_bitrate_estimator/packet_arrival_map.h"
+
+#include <algorithm>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+namespace {
+
+// Room for a second of packets at the rates of typical calls, to avoid
+// growing the buffer more than a few times.
+constexpr int64_t kMinCapacity = 128;
+
+}  // namespace
+
+constexpr int PacketArrivalTimeMap::kMaxNumberOfPackets;
+constexpr int64_t PacketArrivalTimeMap::kNotReceived;
+
+PacketArrivalTimeMap::PacketArrivalTimeMap() = default;
+
+PacketArrivalTimeMap::~PacketArrivalTimeMap() = default;
+
+bool PacketArrivalTimeMap::has_received(int64_t sequence_number) const {
+  return sequence_number >= begin_sequence_number_ &&
+         sequence_number < end_sequence_number_ &&
+         arrival_time(sequence_number) != kNotReceived;
+}
+
+int64_t PacketArrivalTimeMap::get(int64_t sequence_number) const {
+  RTC_DCHECK(has_received(sequence_number));
+  return arrival_time(sequence_number);
+}
+
+int64_t PacketArrivalTimeMap::NextReceived(int64_t sequence_number) const {
+  sequence_number = std::max(sequence_number, begin_sequence_number_);
+  while (sequence_number < end_sequence_number_ &&
+         arrival_time(sequence_number) == kNotReceived) {
+    ++sequence_number;
+  }
+  return std::min(sequence_number, end_sequence_number_);
+}
+
+void PacketArrivalTimeMap::AddPacket(int64_t sequence_number,
+                                     int64_t arrival_time_ms) {
+  RTC_DCHECK_GE(arrival_time_ms, 0);
+  if (empty()) {
+    Reserve(1);
+    begin_sequence_number_ = sequence_number;
+    end_sequence_number_ = sequence_number + 1;
+    arrival_time(sequence_number) = arrival_time_ms;
+    return;
+  }
+
+  if (sequence_number < begin_sequence_number_) {
+    if (end_sequence_number_ - sequence_number > kMaxNumberOfPackets)
+      return;
+    Reserve(end_sequence_number_ - sequence_number);
+    Clear(sequence_number + 1, begin_sequence_number_);
+    begin_sequence_number_ = sequence_number;
+  } else if (sequence_number >= end_sequence_number_) {
+    if (sequence_number - begin_sequence_number_ >= kMaxNumberOfPackets) {
+      EraseTo(sequence_number - kMaxNumberOfPackets + 1);
+      if (empty()) {
+        begin_sequence_number_ = sequence_number;
+        end_sequence_number_ = sequence_number;
+      }
+    }
+    Reserve(sequence_number + 1 - begin_sequence_number_);
+    Clear(end_sequence_number_, sequence_number);
+    end_sequence_number_ = sequence_number + 1;
+  } else if (arrival_time(sequence_number) != kNotReceived) {
+    return;
+  }
+  arrival_time(sequence_number) = arrival_time_ms;
+}
+
+void PacketArrivalTimeMap::EraseTo(int64_t sequence_number) {
+  if (sequence_number >= end_sequence_number_) {
+    begin_sequence_number_ = end_sequence_number_;
+    return;
+  }
+  if (sequence_number > begin_sequence_number_)
+    begin_sequence_number_ = NextReceived(sequence_number);
+}
+
+void PacketArrivalTimeMap::RemoveOldPackets(int64_t sequence_number,
+                                            int64_t arrival_time_limit_ms) {
+  while (!empty() && begin_sequence_number_ < sequence_number &&
+         arrival_time(begin_sequence_number_) <= arrival_time_limit_ms) {
+    begin_sequence_number_ = NextReceived(begin_sequence_number_ + 1);
+  }
+}
+
+void PacketArrivalTimeMap::Reserve(int64_t size) {
+  RTC_DCHECK_LE(size, kMaxNumberOfPackets);
+  if (size <= capacity_)
+    return;
+  int64_t new_capacity = std::max(capacity_, kMinCapacity);
+  while (new_capacity < size)
+    new_capacity *= 2;
+  std::unique_ptr<int64_t[]> new_arrival_times(new int64_t[new_capacity]);
+  for (int64_t sequence_number = begin_sequence_number_;
+       sequence_number < end_sequence_number_; ++sequence_number) {
+    new_arrival_times[sequence_number & (new_capacity - 1)] =
+        arrival_time(sequence_number);
+  }
+  arrival_times_ = std::move(new_arrival_times);
+  capacity_ = new_capacity;
+}
+
+void PacketArrivalTimeMap::Clear(int64_t begin, int64_t end) {
+  for (int64_t sequence_number = begin; sequence_number < end;
+       ++sequence_number) {
+    arrival_time(sequence_number) = kNotReceived;
+  }
+}
+
+}  // namespace webrtc
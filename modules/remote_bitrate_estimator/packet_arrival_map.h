@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_REMOTE_BITRATE_ESTIMATOR_PACKET_ARRIVAL_MAP_H_
+#define MODULES_REMOTE_BITRATE_ESTIMATOR_PACKET_ARRIVAL_MAP_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+namespace webrtc {
+
+// PacketArrivalTimeMap maps unwrapped transport sequence numbers to arrival
+// times, for the packets that have been received. The arrival times are kept
+// in a ring buffer indexed by sequence number, which only grows with the range
+// of sequence numbers, so that adding, looking up and removing packets doesn't
+// allocate memory once the buffer is large enough.
+//
+// Unless the map is empty, its first and last sequence numbers are always
+// received packets.
+class PacketArrivalTimeMap {
+ public:
+  // Impossible to request feedback older than what can be represented by 15
+  // bits.
+  static constexpr int kMaxNumberOfPackets = (1 << 15);
+
+  PacketArrivalTimeMap();
+  ~PacketArrivalTimeMap();
+
+  bool empty() const { return begin_sequence_number_ == end_sequence_number_; }
+
+  // The first sequence number in the map, or end_sequence_number() if empty.
+  int64_t begin_sequence_number() const { return begin_sequence_number_; }
+
+  // One past the last sequence number in the map.
+  int64_t end_sequence_number() const { return end_sequence_number_; }
+
+  bool has_received(int64_t sequence_number) const;
+
+  // Returns the arrival time of |sequence_number|, which must be received.
+  int64_t get(int64_t sequence_number) const;
+
+  // Returns the first received sequence number not before |sequence_number|,
+  // or end_sequence_number() if there is none.
+  int64_t NextReceived(int64_t sequence_number) const;
+
+  // Records the arrival of |sequence_number|, unless it has already been
+  // received. To keep the range of sequence numbers below
+  // |kMaxNumberOfPackets|, packets too old compared to the newest packet are
+  // ignored, and adding a newer packet removes the packets falling out of
+  // range.
+  void AddPacket(int64_t sequence_number, int64_t arrival_time_ms);
+
+  // Removes all packets before |sequence_number|.
+  void EraseTo(int64_t sequence_number);
+
+  // Removes packets from the beginning of the map for as long as they are
+  // before |sequence_number| and arrived at or before |arrival_time_limit_ms|.
+  void RemoveOldPackets(int64_t sequence_number, int64_t arrival_time_limit_ms);
+
+ private:
+  static constexpr int64_t kNotReceived = -1;
+
+  int64_t& arrival_time(int64_t sequence_number) {
+    return arrival_times_[sequence_number & (capacity_ - 1)];
+  }
+  int64_t arrival_time(int64_t sequence_number) const {
+    return arrival_times_[sequence_number & (capacity_ - 1)];
+  }
+
+  // Grows the ring buffer to hold at least |size| sequence numbers.
+  void Reserve(int64_t size);
+  // Marks the sequence numbers in [|begin|, |end|) as not received.
+  void Clear(int64_t begin, int64_t end);
+
+  std::unique_ptr<int64_t[]> arrival_times_;
+  int64_t capacity_ = 0;
+  int64_t begin_sequence_number_ = 0;
+  int64_t end_sequence_number_ = 0;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_REMOTE_BITRATE_ESTIMATOR_PACKET_ARRIVAL_MAP_H_
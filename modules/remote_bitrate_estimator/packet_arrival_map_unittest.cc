@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/remote_bitrate_estimator/packet_arrival_map.h"
+
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+TEST(PacketArrivalMapTest, IsConsistentWhenEmpty) {
+  PacketArrivalTimeMap map;
+
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin_sequence_number(), map.end_sequence_number());
+  EXPECT_FALSE(map.has_received(0));
+  EXPECT_EQ(map.NextReceived(0), map.end_sequence_number());
+}
+
+TEST(PacketArrivalMapTest, InsertsFirstItemIntoMap) {
+  PacketArrivalTimeMap map;
+
+  map.AddPacket(42, 10);
+  EXPECT_FALSE(map.empty());
+  EXPECT_EQ(map.begin_sequence_number(), 42);
+  EXPECT_EQ(map.end_sequence_number(), 43);
+
+  EXPECT_FALSE(map.has_received(41));
+  EXPECT_TRUE(map.has_received(42));
+  EXPECT_FALSE(map.has_received(43));
+  EXPECT_EQ(map.get(42), 10);
+}
+
+TEST(PacketArrivalMapTest, InsertsWithGaps) {
+  PacketArrivalTimeMap map;
+
+  map.AddPacket(42, 10);
+  map.AddPacket(45, 11);
+  EXPECT_EQ(map.begin_sequence_number(), 42);
+  EXPECT_EQ(map.end_sequence_number(), 46);
+
+  EXPECT_TRUE(map.has_received(42));
+  EXPECT_FALSE(map.has_received(43));
+  EXPECT_FALSE(map.has_received(44));
+  EXPECT_TRUE(map.has_received(45));
+  EXPECT_EQ(map.get(45), 11);
+  EXPECT_EQ(map.NextReceived(43), 45);
+}
+
+TEST(PacketArrivalMapTest, InsertsBeforeAndIntoGaps) {
+  PacketArrivalTimeMap map;
+
+  map.AddPacket(42, 10);
+  map.AddPacket(45, 11);
+  map.AddPacket(40, 12);
+  map.AddPacket(44, 13);
+  EXPECT_EQ(map.begin_sequence_number(), 40);
+  EXPECT_EQ(map.end_sequence_number(), 46);
+
+  EXPECT_TRUE(map.has_received(40));
+  EXPECT_FALSE(map.has_received(41));
+  EXPECT_TRUE(map.has_received(42));
+  EXPECT_FALSE(map.has_received(43));
+  EXPECT_EQ(map.get(44), 13);
+}
+
+TEST(PacketArrivalMapTest, KeepsFirstArrivalTime) {
+  PacketArrivalTimeMap map;
+
+  map.AddPacket(42, 10);
+  map.AddPacket(42, 11);
+  EXPECT_EQ(map.get(42), 10);
+}
+
+TEST(PacketArrivalMapTest, GrowsWithoutLosingPackets) {
+  PacketArrivalTimeMap map;
+
+  for (int64_t seq = 1000; seq < 3000; seq += 2)
+    map.AddPacket(seq, seq + 5);
+  // Prepend enough to grow the buffer again.
+  map.AddPacket(0, 0);
+  EXPECT_EQ(map.begin_sequence_number(), 0);
+  EXPECT_EQ(map.end_sequence_number(), 2999);
+
+  for (int64_t seq = 1000; seq < 3000; ++seq) {
+    EXPECT_EQ(map.has_received(seq), seq % 2 == 0);
+    if (seq % 2 == 0)
+      EXPECT_EQ(map.get(seq), seq + 5);
+  }
+  EXPECT_FALSE(map.has_received(1));
+}
+
+TEST(PacketArrivalMapTest, LimitsRangeOfSequenceNumbers) {
+  PacketArrivalTimeMap map;
+
+  map.AddPacket(0, 10);
+  map.AddPacket(10, 11);
+  map.AddPacket(PacketArrivalTimeMap::kMaxNumberOfPackets, 12);
+  EXPECT_EQ(map.begin_sequence_number(), 10);
+  EXPECT_FALSE(map.has_received(0));
+
+  // Too old to be added.
+  map.AddPacket(0, 13);
+  EXPECT_EQ(map.begin_sequence_number(), 10);
+
+  map.AddPacket(3 * PacketArrivalTimeMap::kMaxNumberOfPackets, 14);
+  EXPECT_EQ(map.begin_sequence_number(),
+            3 * PacketArrivalTimeMap::kMaxNumberOfPackets);
+  EXPECT_EQ(map.end_sequence_number(),
+            3 * PacketArrivalTimeMap::kMaxNumberOfPackets + 1);
+}
+
+TEST(PacketArrivalMapTest, ErasesToReceivedPacket) {
+  PacketArrivalTimeMap map;
+
+  map.AddPacket(42, 10);
+  map.AddPacket(43, 11);
+  map.AddPacket(45, 12);
+  map.AddPacket(46, 13);
+
+  map.EraseTo(44);
+  EXPECT_EQ(map.begin_sequence_number(), 45);
+  EXPECT_EQ(map.end_sequence_number(), 47);
+
+  map.EraseTo(47);
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(PacketArrivalMapTest, RemovesOldPackets) {
+  PacketArrivalTimeMap map;
+
+  map.AddPacket(42, 10);
+  map.AddPacket(43, 11);
+  map.AddPacket(44, 20);
+  map.AddPacket(46, 12);
+
+  // Stops at packets arriving after the time limit.
+  map.RemoveOldPackets(46, 12);
+  EXPECT_EQ(map.begin_sequence_number(), 44);
+
+  // Stops at the sequence number.
+  map.RemoveOldPackets(45, 20);
+  EXPECT_EQ(map.begin_sequence_number(), 46);
+  EXPECT_EQ(map.end_sequence_number(), 47);
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -21,9 +21,6 @@
 
 namespace webrtc {
 
-// Impossible to request feedback older than what can be represented by 15 bits.
-const int RemoteEstimatorProxy::kMaxNumberOfPackets = (1 << 15);
-
 // The maximum allowed value for a timestamp in milliseconds. This is lower
 // than the numerical limit since we often convert to microseconds.
 static constexpr int64_t kMaxTimeMs =
@@ -128,16 +125,21 @@ void RemoteEstimatorProxy::OnPacketArrival(
 
   int64_t seq = unwrapper_.Unwrap(sequence_number);
 
+  // Packets too old to fit in the range of sequence numbers to send feedback
+  // for are ignored.
+  if (!packet_arrival_times_.empty() &&
+      seq < packet_arrival_times_.end_sequence_number() -
+                PacketArrivalTimeMap::kMaxNumberOfPackets) {
+    return;
+  }
+
   if (send_periodic_feedback_) {
     if (periodic_window_start_seq_ &&
-        packet_arrival_times_.lower_bound(*periodic_window_start_seq_) ==
-            packet_arrival_times_.end()) {
+        *periodic_window_start_seq_ >=
+            packet_arrival_times_.end_sequence_number()) {
       // Start new feedback packet, cull old packets.
-      for (auto it = packet_arrival_times_.begin();
-           it != packet_arrival_times_.end() && it->first < seq &&
-           arrival_time - it->second >= send_config_.back_window->ms();) {
-        it = packet_arrival_times_.erase(it);
-      }
+      packet_arrival_times_.RemoveOldPackets(
+          seq, arrival_time - send_config_.back_window->ms());
     }
     if (!periodic_window_start_seq_ || seq < *periodic_window_start_seq_) {
       periodic_window_start_seq_ = seq;
@@ -145,23 +147,18 @@ void RemoteEstimatorProxy::OnPacketArrival(
   }
 
   // We are only interested in the first time a packet is received.
-  if (packet_arrival_times_.find(seq) != packet_arrival_times_.end())
+  if (packet_arrival_times_.has_received(seq))
     return;
 
-  packet_arrival_times_[seq] = arrival_time;
-
-  // Limit the range of sequence numbers to send feedback for.
-  auto first_arrival_time_to_keep = packet_arrival_times_.lower_bound(
-      packet_arrival_times_.rbegin()->first - kMaxNumberOfPackets);
-  if (first_arrival_time_to_keep != packet_arrival_times_.begin()) {
-    packet_arrival_times_.erase(packet_arrival_times_.begin(),
-                                first_arrival_time_to_keep);
-    if (send_periodic_feedback_) {
-      // |packet_arrival_times_| cannot be empty since we just added one element
-      // and the last element is not deleted.
-      RTC_DCHECK(!packet_arrival_times_.empty());
-      periodic_window_start_seq_ = packet_arrival_times_.begin()->first;
-    }
+  // Adding the packet limits the range of sequence numbers to send feedback
+  // for, by removing the packets falling out of range.
+  const bool had_packets = !packet_arrival_times_.empty();
+  const int64_t begin_sequence_number =
+      packet_arrival_times_.begin_sequence_number();
+  packet_arrival_times_.AddPacket(seq, arrival_time);
+  if (send_periodic_feedback_ && had_packets &&
+      packet_arrival_times_.begin_sequence_number() > begin_sequence_number) {
+    periodic_window_start_seq_ = packet_arrival_times_.begin_sequence_number();
   }
 
   if (feedback_request) {
@@ -177,15 +174,13 @@ void RemoteEstimatorProxy::SendPeriodicFeedbacks() {
   if (!periodic_window_start_seq_)
     return;
 
-  for (auto begin_iterator =
-           packet_arrival_times_.lower_bound(*periodic_window_start_seq_);
-       begin_iterator != packet_arrival_times_.cend();
-       begin_iterator =
-           packet_arrival_times_.lower_bound(*periodic_window_start_seq_)) {
+  while (*periodic_window_start_seq_ <
+         packet_arrival_times_.end_sequence_number()) {
     rtcp::TransportFeedback feedback_packet;
     periodic_window_start_seq_ = BuildFeedbackPacket(
         feedback_packet_count_++, media_ssrc_, *periodic_window_start_seq_,
-        begin_iterator, packet_arrival_times_.cend(), &feedback_packet);
+        packet_arrival_times_, packet_arrival_times_.end_sequence_number(),
+        &feedback_packet);
 
     RTC_DCHECK(feedback_sender_ != nullptr);
     feedback_sender_->SendTransportFeedback(&feedback_packet);
@@ -205,16 +200,13 @@ void RemoteEstimatorProxy::SendFeedbackOnRequest(
 
   int64_t first_sequence_number =
       sequence_number - feedback_request.sequence_count + 1;
-  auto begin_iterator =
-      packet_arrival_times_.lower_bound(first_sequence_number);
-  auto end_iterator = packet_arrival_times_.upper_bound(sequence_number);
 
   BuildFeedbackPacket(feedback_packet_count_++, media_ssrc_,
-                      first_sequence_number, begin_iterator, end_iterator,
-                      &feedback_packet);
+                      first_sequence_number, packet_arrival_times_,
+                      sequence_number + 1, &feedback_packet);
 
   // Clear up to the first packet that is included in this feedback packet.
-  packet_arrival_times_.erase(packet_arrival_times_.begin(), begin_iterator);
+  packet_arrival_times_.EraseTo(first_sequence_number);
 
   RTC_DCHECK(feedback_sender_ != nullptr);
   feedback_sender_->SendTransportFeedback(&feedback_packet);
@@ -224,10 +216,12 @@ int64_t RemoteEstimatorProxy::BuildFeedbackPacket(
     uint8_t feedback_packet_count,
     uint32_t media_ssrc,
     int64_t base_sequence_number,
-    std::map<int64_t, int64_t>::const_iterator begin_iterator,
-    std::map<int64_t, int64_t>::const_iterator end_iterator,
+    const PacketArrivalTimeMap& packet_arrival_times,
+    int64_t end_sequence_number,
     rtcp::TransportFeedback* feedback_packet) {
-  RTC_DCHECK(begin_iterator != end_iterator);
+  const int64_t first_sequence_number =
+      packet_arrival_times.NextReceived(base_sequence_number);
+  RTC_DCHECK_LT(first_sequence_number, end_sequence_number);
 
   // TODO(sprang): Measure receive times in microseconds and remove the
   // conversions below.
@@ -235,22 +229,25 @@ int64_t RemoteEstimatorProxy::BuildFeedbackPacket(
   // Base sequence number is the expected first sequence number. This is known,
   // but we might not have actually received it, so the base time shall be the
   // time of the first received packet in the feedback.
-  feedback_packet->SetBase(static_cast<uint16_t>(base_sequence_number & 0xFFFF),
-                           begin_iterator->second * 1000);
+  feedback_packet->SetBase(
+      static_cast<uint16_t>(base_sequence_number & 0xFFFF),
+      packet_arrival_times.get(first_sequence_number) * 1000);
   feedback_packet->SetFeedbackSequenceNumber(feedback_packet_count);
   int64_t next_sequence_number = base_sequence_number;
-  for (auto it = begin_iterator; it != end_iterator; ++it) {
+  for (int64_t seq = first_sequence_number; seq < end_sequence_number;
+       seq = packet_arrival_times.NextReceived(seq + 1)) {
     if (!feedback_packet->AddReceivedPacket(
-            static_cast<uint16_t>(it->first & 0xFFFF), it->second * 1000)) {
+            static_cast<uint16_t>(seq & 0xFFFF),
+            packet_arrival_times.get(seq) * 1000)) {
       // If we can't even add the first seq to the feedback packet, we won't be
       // able to build it at all.
-      RTC_CHECK(begin_iterator != it);
+      RTC_CHECK_NE(first_sequence_number, seq);
 
       // Could not add timestamp, feedback packet might be full. Return and
       // try again with a fresh packet.
       break;
     }
-    next_sequence_number = it->first + 1;
+    next_sequence_number = seq + 1;
   }
   return next_sequence_number;
 }
@@ -12,12 +12,15 @@
 #define MODULES_RTP_RTCP_INCLUDE_FLEXFEC_RECEIVER_H_
 
 #include <stdint.h>
+#include <map>
 #include <memory>
 
+#include "absl/types/optional.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/include/ulpfec_receiver.h"
 #include "modules/rtp_rtcp/source/forward_error_correction.h"
 #include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "rtc_base/numerics/sequence_number_util.h"
 #include "rtc_base/synchronization/sequence_checker.h"
 #include "rtc_base/thread_annotations.h"
 
@@ -52,6 +55,11 @@ class FlexfecReceiver {
       const ForwardErrorCorrection::ReceivedPacket& received_packet);
 
  private:
+  // Keeps track of the media packets that are missing, for the recovery delay
+  // in |packet_counter_|.
+  void UpdateMissingMediaPackets(uint16_t seq_num, int64_t now_ms);
+  int64_t RecoveryDelayMs(uint16_t seq_num, int64_t now_ms);
+
   // Config.
   const uint32_t ssrc_;
   const uint32_t protected_media_ssrc_;
@@ -67,6 +75,14 @@ class FlexfecReceiver {
   Clock* const clock_;
   int64_t last_recovered_packet_ms_ RTC_GUARDED_BY(sequence_checker_);
   FecPacketCounter packet_counter_ RTC_GUARDED_BY(sequence_checker_);
+  SeqNumUnwrapper<uint16_t> media_seq_num_unwrapper_
+      RTC_GUARDED_BY(sequence_checker_);
+  absl::optional<int64_t> last_media_seq_num_
+      RTC_GUARDED_BY(sequence_checker_);
+  // Unwrapped sequence numbers of missing media packets, mapped to the time
+  // they were found to be missing.
+  std::map<int64_t, int64_t> missing_media_packets_
+      RTC_GUARDED_BY(sequence_checker_);
 
   SequenceChecker sequence_checker_;
 };
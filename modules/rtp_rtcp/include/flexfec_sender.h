@@ -20,6 +20,7 @@
 #include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/source/rtp_header_extension_size.h"
+#include "modules/rtp_rtcp/source/sliding_window_fec_generator.h"
 #include "modules/rtp_rtcp/source/ulpfec_generator.h"
 #include "rtc_base/random.h"
 
@@ -30,6 +31,12 @@ class RtpPacketToSend;
 
 // Note that this class is not thread safe, and thus requires external
 // synchronization. Currently, this is done using the lock in PayloadRouter.
+//
+// By default, FEC packets protect the media packets of one or more frames, as
+// for ULPFEC. With the field trial
+// "WebRTC-FlexFEC-SlidingWindow/Enabled,window:<packets>/", each FEC packet
+// instead protects a window of the most recent media packets, and is sent as
+// soon as the FEC rate calls for it rather than at the end of a frame.
 
 class FlexfecSender {
  public:
@@ -85,6 +92,9 @@ class FlexfecSender {
 
   // Implementation.
   UlpfecGenerator ulpfec_generator_;
+  // Set in sliding window mode, in which case it is used instead of
+  // |ulpfec_generator_|.
+  const std::unique_ptr<SlidingWindowFecGenerator> sliding_window_generator_;
   const RtpHeaderExtensionMap rtp_header_extension_map_;
   const size_t header_extensions_size_;
 };
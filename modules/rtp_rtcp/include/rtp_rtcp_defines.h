@@ -147,7 +147,7 @@ struct RTCPReportBlock {
   uint32_t delay_since_last_sender_report;
 };
 
-typedef std::list<RTCPReportBlock> ReportBlockList;
+typedef std::vector<RTCPReportBlock> ReportBlockList;
 
 struct RtpState {
   RtpState()
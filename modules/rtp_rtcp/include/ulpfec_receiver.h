@@ -24,12 +24,17 @@ struct FecPacketCounter {
       : num_packets(0),
         num_fec_packets(0),
         num_recovered_packets(0),
-        first_packet_time_ms(-1) {}
+        first_packet_time_ms(-1),
+        total_recovery_delay_ms(0) {}
 
   size_t num_packets;            // Number of received packets.
   size_t num_fec_packets;        // Number of received FEC packets.
   size_t num_recovered_packets;  // Number of recovered media packets using FEC.
   int64_t first_packet_time_ms;  // Time when first packet is received.
+  // Sum over the recovered media packets of the time from when a later media
+  // packet showed them to be missing, until they were recovered. Packets that
+  // are recovered before that count as zero. Only set by FlexfecReceiver.
+  int64_t total_recovery_delay_ms;
 };
 
 class UlpfecReceiver {
@@ -0,0 +1,229 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/test/simulated_network.h"
+#include "call/simulated_network.h"
+#include "modules/rtp_rtcp/include/flexfec_receiver.h"
+#include "modules/rtp_rtcp/include/flexfec_sender.h"
+#include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/random.h"
+#include "system_wrappers/include/clock.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumFrames = 3000;
+constexpr int kQuickNumFrames = 30;
+constexpr int kFrameIntervalMs = 33;
+constexpr int kPacketsPerFrame = 10;
+constexpr int kPacketIntervalMs = 1;
+constexpr size_t kPayloadSize = 1000;
+constexpr int kMediaPayloadType = 96;
+constexpr int kFlexfecPayloadType = 118;
+constexpr uint32_t kMediaSsrc = 0x1234;
+constexpr uint32_t kFlexfecSsrc = 0x5678;
+constexpr int kNetworkDelayMs = 50;
+// Roughly two FEC packets per frame.
+constexpr int kFecRate = 51;
+
+struct FecMode {
+  std::string name;
+  std::string field_trials;
+};
+
+struct LossModel {
+  std::string name;
+  int loss_percent;
+  int avg_burst_loss_length;
+};
+
+class RecoveredPacketTimes : public RecoveredPacketReceiver {
+ public:
+  explicit RecoveredPacketTimes(Clock* clock) : clock_(clock) {}
+
+  void OnRecoveredPacket(const uint8_t* packet, size_t length) override {
+    recovery_times_ms_[ByteReader<uint16_t>::ReadBigEndian(&packet[2])] =
+        clock_->TimeInMilliseconds();
+  }
+
+  const std::map<uint16_t, int64_t>& recovery_times_ms() const {
+    return recovery_times_ms_;
+  }
+
+ private:
+  Clock* const clock_;
+  std::map<uint16_t, int64_t> recovery_times_ms_;
+};
+
+struct TransmittedPacket {
+  std::vector<uint8_t> data;
+  bool is_fec;
+};
+
+}  // namespace
+
+// Sends 30 fps video of ten packets per frame through FlexfecSender, a lossy
+// SimulatedNetwork and FlexfecReceiver, with per frame and sliding window FEC
+// at the same FEC rate. Reports the media packets that are neither received
+// nor recovered, the FEC overhead, and the time from sending a recovered
+// packet until it is recovered.
+TEST(FlexfecPerformanceTest, RecoveryUnderLoss) {
+  const int num_frames = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                             ? kQuickNumFrames
+                             : kNumFrames;
+  const FecMode kModes[] = {
+      {"per_frame", "WebRTC-FlexFEC-SlidingWindow/Disabled/"},
+      {"sliding_window", "WebRTC-FlexFEC-SlidingWindow/Enabled/"}};
+  const LossModel kLossModels[] = {{"random_2", 2, -1},   {"random_5", 5, -1},
+                                   {"random_10", 10, -1}, {"burst_2", 2, 3},
+                                   {"burst_5", 5, 3},     {"burst_10", 10, 3}};
+
+  for (const FecMode& mode : kModes) {
+    test::ScopedFieldTrials field_trials(mode.field_trials);
+    for (const LossModel& loss_model : kLossModels) {
+      SimulatedClock clock(1000000);
+      FlexfecSender sender(kFlexfecPayloadType, kFlexfecSsrc, kMediaSsrc, "",
+                           {}, {}, nullptr /* rtp_state */, &clock);
+      FecProtectionParams params;
+      params.fec_rate = kFecRate;
+      params.max_fec_frames = 1;
+      params.fec_mask_type = kFecMaskBursty;
+      sender.SetFecParameters(params);
+      RecoveredPacketTimes recovered_packets(&clock);
+      FlexfecReceiver receiver(&clock, kFlexfecSsrc, kMediaSsrc,
+                               &recovered_packets);
+
+      BuiltInNetworkBehaviorConfig config;
+      config.queue_delay_ms = kNetworkDelayMs;
+      config.loss_percent = loss_model.loss_percent;
+      config.avg_burst_loss_length = loss_model.avg_burst_loss_length;
+      SimulatedNetwork network(config);
+
+      Random random(0x5eed);
+      std::vector<TransmittedPacket> sent_packets;
+      std::map<uint16_t, int64_t> media_send_times_ms;
+      std::map<uint16_t, bool> media_received;
+      uint16_t seq_num = 1000;
+      int num_fec_packets = 0;
+
+      auto deliver_packets = [&] {
+        for (const PacketDeliveryInfo& delivery :
+             network.DequeueDeliverablePackets(clock.TimeInMicroseconds())) {
+          if (delivery.receive_time_us == PacketDeliveryInfo::kNotReceived)
+            continue;
+          const TransmittedPacket& sent_packet =
+              sent_packets[delivery.packet_id];
+          RtpPacketReceived packet;
+          ASSERT_TRUE(
+              packet.Parse(sent_packet.data.data(), sent_packet.data.size()));
+          if (!sent_packet.is_fec)
+            media_received[packet.SequenceNumber()] = true;
+          receiver.OnRtpPacket(packet);
+        }
+      };
+      auto send_packet = [&](const RtpPacketToSend& packet, bool is_fec) {
+        network.EnqueuePacket(PacketInFlightInfo(
+            packet.size(), clock.TimeInMicroseconds(), sent_packets.size()));
+        sent_packets.push_back(
+            {std::vector<uint8_t>(packet.data(), packet.data() + packet.size()),
+             is_fec});
+      };
+
+      for (int i = 0; i < num_frames; ++i) {
+        for (int j = 0; j < kPacketsPerFrame; ++j) {
+          RtpPacketToSend packet(nullptr);
+          packet.SetPayloadType(kMediaPayloadType);
+          packet.SetMarker(j == kPacketsPerFrame - 1);
+          packet.SetSequenceNumber(seq_num);
+          packet.SetTimestamp(i * kFrameIntervalMs * 90);
+          packet.SetSsrc(kMediaSsrc);
+          uint8_t* payload = packet.AllocatePayload(kPayloadSize);
+          for (size_t k = 0; k < kPayloadSize; ++k)
+            payload[k] = random.Rand<uint8_t>();
+          send_packet(packet, false);
+          media_send_times_ms[seq_num] = clock.TimeInMilliseconds();
+          media_received[seq_num] = false;
+          ++seq_num;
+
+          ASSERT_TRUE(sender.AddRtpPacketAndGenerateFec(packet));
+          if (sender.FecAvailable()) {
+            for (const auto& fec_packet : sender.GetFecPackets()) {
+              send_packet(*fec_packet, true);
+              ++num_fec_packets;
+            }
+          }
+          clock.AdvanceTimeMilliseconds(kPacketIntervalMs);
+          deliver_packets();
+        }
+        for (int t = kPacketsPerFrame * kPacketIntervalMs;
+             t < kFrameIntervalMs; ++t) {
+          clock.AdvanceTimeMilliseconds(1);
+          deliver_packets();
+        }
+      }
+      clock.AdvanceTimeMilliseconds(2 * kNetworkDelayMs);
+      deliver_packets();
+
+      const int num_media_packets = num_frames * kPacketsPerFrame;
+      int num_lost_packets = 0;
+      int num_recovered_packets = 0;
+      int64_t total_recovery_latency_ms = 0;
+      for (const auto& it : media_received) {
+        if (it.second)
+          continue;
+        auto recovered = recovered_packets.recovery_times_ms().find(it.first);
+        if (recovered == recovered_packets.recovery_times_ms().end()) {
+          ++num_lost_packets;
+          continue;
+        }
+        ++num_recovered_packets;
+        total_recovery_latency_ms +=
+            recovered->second - media_send_times_ms[it.first];
+      }
+      const FecPacketCounter packet_counter = receiver.GetPacketCounter();
+
+      const std::string story = mode.name + "_" + loss_model.name;
+      test::PrintResult("flexfec_residual_loss", "", story,
+                        100.0 * num_lost_packets / num_media_packets, "%",
+                        false);
+      test::PrintResult("flexfec_overhead", "", story,
+                        100.0 * num_fec_packets / num_media_packets, "%",
+                        false);
+      if (num_recovered_packets > 0) {
+        test::PrintResult(
+            "flexfec_recovery_latency", "", story,
+            static_cast<double>(total_recovery_latency_ms) /
+                num_recovered_packets,
+            "ms", false);
+        test::PrintResult(
+            "flexfec_recovery_delay", "", story,
+            static_cast<double>(packet_counter.total_recovery_delay_ms) /
+                packet_counter.num_recovered_packets,
+            "ms", false);
+      }
+    }
+  }
+}
+
+}  // namespace webrtc
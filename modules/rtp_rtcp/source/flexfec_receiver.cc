@@ -11,6 +11,7 @@
 #include "modules/rtp_rtcp/include/flexfec_receiver.h"
 
 #include <string.h>
+#include <algorithm>
 
 #include "api/array_view.h"
 #include "api/scoped_refptr.h"
@@ -27,6 +28,10 @@ constexpr size_t kMinFlexfecHeaderSize = 20;
 // How often to log the recovered packets to the text log.
 constexpr int kPacketLogIntervalMs = 10000;
 
+// Missing media packets further back than this can't be recovered, since
+// ForwardErrorCorrection doesn't keep that many packets.
+constexpr int64_t kMaxMissingMediaPackets = kUlpfecMaxMediaPackets;
+
 }  // namespace
 
 FlexfecReceiver::FlexfecReceiver(
@@ -148,6 +153,11 @@ void FlexfecReceiver::ProcessReceivedPacket(
     const ForwardErrorCorrection::ReceivedPacket& received_packet) {
   RTC_DCHECK_RUN_ON(&sequence_checker_);
 
+  if (!received_packet.is_fec) {
+    UpdateMissingMediaPackets(received_packet.seq_num,
+                              clock_->TimeInMilliseconds());
+  }
+
   // Decode.
   erasure_code_->DecodeFec(received_packet, &recovered_packets_);
 
@@ -157,7 +167,10 @@ void FlexfecReceiver::ProcessReceivedPacket(
     if (recovered_packet->returned) {
       continue;
     }
+    int64_t now_ms = clock_->TimeInMilliseconds();
     ++packet_counter_.num_recovered_packets;
+    packet_counter_.total_recovery_delay_ms +=
+        RecoveryDelayMs(recovered_packet->seq_num, now_ms);
     // Set this flag first, since OnRecoveredPacket may end up here
     // again, with the same packet.
     recovered_packet->returned = true;
@@ -165,7 +178,6 @@ void FlexfecReceiver::ProcessReceivedPacket(
     recovered_packet_receiver_->OnRecoveredPacket(
         recovered_packet->pkt->data, recovered_packet->pkt->length);
     // Periodically log the incoming packets.
-    int64_t now_ms = clock_->TimeInMilliseconds();
     if (now_ms - last_recovered_packet_ms_ > kPacketLogIntervalMs) {
       uint32_t media_ssrc =
           ForwardErrorCorrection::ParseSsrc(recovered_packet->pkt->data);
@@ -176,4 +188,36 @@ void FlexfecReceiver::ProcessReceivedPacket(
   }
 }
 
+void FlexfecReceiver::UpdateMissingMediaPackets(uint16_t seq_num,
+                                                int64_t now_ms) {
+  const int64_t unwrapped_seq_num = media_seq_num_unwrapper_.Unwrap(seq_num);
+  missing_media_packets_.erase(unwrapped_seq_num);
+  if (last_media_seq_num_ && unwrapped_seq_num <= *last_media_seq_num_)
+    return;
+  if (last_media_seq_num_) {
+    for (int64_t missing_seq_num =
+             std::max(*last_media_seq_num_ + 1,
+                      unwrapped_seq_num - kMaxMissingMediaPackets);
+         missing_seq_num < unwrapped_seq_num; ++missing_seq_num) {
+      missing_media_packets_.emplace(missing_seq_num, now_ms);
+    }
+  }
+  last_media_seq_num_ = unwrapped_seq_num;
+  while (!missing_media_packets_.empty() &&
+         missing_media_packets_.begin()->first <=
+             unwrapped_seq_num - kMaxMissingMediaPackets) {
+    missing_media_packets_.erase(missing_media_packets_.begin());
+  }
+}
+
+int64_t FlexfecReceiver::RecoveryDelayMs(uint16_t seq_num, int64_t now_ms) {
+  auto it =
+      missing_media_packets_.find(media_seq_num_unwrapper_.Unwrap(seq_num));
+  if (it == missing_media_packets_.end())
+    return 0;
+  const int64_t delay_ms = now_ms - it->second;
+  missing_media_packets_.erase(it);
+  return delay_ms;
+}
+
 }  // namespace webrtc
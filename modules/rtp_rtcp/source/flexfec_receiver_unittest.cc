@@ -16,6 +16,7 @@
 #include "modules/rtp_rtcp/source/fec_test_helper.h"
 #include "modules/rtp_rtcp/source/forward_error_correction.h"
 #include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "system_wrappers/include/clock.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 
@@ -646,4 +647,38 @@ TEST_F(FlexfecReceiverTest, CalculatesNumberOfPackets) {
   EXPECT_EQ(1U, packet_counter.num_recovered_packets);
 }
 
+TEST_F(FlexfecReceiverTest, CalculatesRecoveryDelay) {
+  const size_t kNumMediaPackets = 3;
+  const size_t kNumFecPackets = 1;
+  const int64_t kFecDelayMs = 30;
+  SimulatedClock clock(1000);
+  FlexfecReceiver receiver(&clock, kFlexfecSsrc, kMediaSsrc,
+                           &recovered_packet_receiver_);
+
+  PacketList media_packets;
+  PacketizeFrame(kNumMediaPackets, 0, &media_packets);
+  std::list<Packet*> fec_packets = EncodeFec(media_packets, kNumFecPackets);
+
+  // Drop the second media packet, which is known to be missing when the third
+  // one arrives.
+  auto media_it = media_packets.begin();
+  receiver.OnRtpPacket(ParsePacket(**media_it));
+  media_it++;
+  receiver.OnRtpPacket(ParsePacket(**std::next(media_it)));
+
+  // Receive the FEC packet later, and recover the lost media packet.
+  clock.AdvanceTimeMilliseconds(kFecDelayMs);
+  std::unique_ptr<Packet> packet_with_rtp_header =
+      packet_generator_.BuildFlexfecPacket(*fec_packets.front());
+  EXPECT_CALL(recovered_packet_receiver_,
+              OnRecoveredPacket(_, (*media_it)->length))
+      .With(
+          Args<0, 1>(ElementsAreArray((*media_it)->data, (*media_it)->length)));
+  receiver.OnRtpPacket(ParsePacket(*packet_with_rtp_header));
+
+  FecPacketCounter packet_counter = receiver.GetPacketCounter();
+  EXPECT_EQ(1U, packet_counter.num_recovered_packets);
+  EXPECT_EQ(kFecDelayMs, packet_counter.total_recovery_delay_ms);
+}
+
 }  // namespace webrtc
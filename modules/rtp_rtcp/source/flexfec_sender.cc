@@ -14,12 +14,17 @@
 #include <list>
 #include <utility>
 
+#include "absl/memory/memory.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/source/forward_error_correction.h"
+#include "modules/rtp_rtcp/source/forward_error_correction_internal.h"
 #include "modules/rtp_rtcp/source/rtp_header_extensions.h"
 #include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/experiments/field_trial_parser.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/numerics/safe_minmax.h"
+#include "system_wrappers/include/field_trial.h"
 
 namespace webrtc {
 
@@ -42,6 +47,27 @@ const int kMsToRtpTimestamp = kVideoPayloadTypeFrequency / 1000;
 // How often to log the generated FEC packets to the text log.
 constexpr int64_t kPacketLogIntervalMs = 10000;
 
+// Default number of media packets protected by each FEC packet in sliding
+// window mode. With one FEC packet per four or five media packets, most media
+// packets are protected by two FEC packets, while keeping the windows short
+// enough to be recovered when packets are lost at random.
+constexpr int kDefaultSlidingWindowSize = 8;
+
+std::unique_ptr<SlidingWindowFecGenerator> MaybeCreateSlidingWindowGenerator(
+    uint32_t ssrc,
+    uint32_t protected_media_ssrc) {
+  FieldTrialFlag enabled("Enabled");
+  FieldTrialParameter<int> window_size("window", kDefaultSlidingWindowSize);
+  ParseFieldTrial({&enabled, &window_size},
+                  field_trial::FindFullName("WebRTC-FlexFEC-SlidingWindow"));
+  if (!enabled)
+    return nullptr;
+  return absl::make_unique<SlidingWindowFecGenerator>(
+      ForwardErrorCorrection::CreateFlexfec(ssrc, protected_media_ssrc),
+      rtc::SafeClamp(window_size.Get(), 1,
+                     static_cast<int>(kUlpfecMaxMediaPackets)));
+}
+
 RtpHeaderExtensionMap RegisterSupportedExtensions(
     const std::vector<RtpExtension>& rtp_header_extensions) {
   RtpHeaderExtensionMap map;
@@ -91,6 +117,8 @@ FlexfecSender::FlexfecSender(
                          : random_.Rand(1, kMaxInitRtpSeqNumber)),
       ulpfec_generator_(
           ForwardErrorCorrection::CreateFlexfec(ssrc, protected_media_ssrc)),
+      sliding_window_generator_(
+          MaybeCreateSlidingWindowGenerator(ssrc, protected_media_ssrc)),
       rtp_header_extension_map_(
           RegisterSupportedExtensions(rtp_header_extensions)),
       header_extensions_size_(
@@ -102,9 +130,14 @@ FlexfecSender::FlexfecSender(
 
 FlexfecSender::~FlexfecSender() = default;
 
-// We are reusing the implementation from UlpfecGenerator for SetFecParameters,
-// AddRtpPacketAndGenerateFec, and FecAvailable.
+// We are reusing the implementation from UlpfecGenerator or
+// SlidingWindowFecGenerator for SetFecParameters, AddRtpPacketAndGenerateFec,
+// and FecAvailable.
 void FlexfecSender::SetFecParameters(const FecProtectionParams& params) {
+  if (sliding_window_generator_) {
+    sliding_window_generator_->SetFecParameters(params);
+    return;
+  }
   ulpfec_generator_.SetFecParameters(params);
 }
 
@@ -112,18 +145,29 @@ bool FlexfecSender::AddRtpPacketAndGenerateFec(const RtpPacketToSend& packet) {
   // TODO(brandtr): Generalize this SSRC check when we support multistream
   // protection.
   RTC_DCHECK_EQ(packet.Ssrc(), protected_media_ssrc_);
+  if (sliding_window_generator_) {
+    return sliding_window_generator_->AddRtpPacketAndGenerateFec(
+               packet.data(), packet.payload_size(), packet.headers_size()) ==
+           0;
+  }
   return ulpfec_generator_.AddRtpPacketAndGenerateFec(
              packet.data(), packet.payload_size(), packet.headers_size()) == 0;
 }
 
 bool FlexfecSender::FecAvailable() const {
+  if (sliding_window_generator_)
+    return sliding_window_generator_->FecAvailable();
   return ulpfec_generator_.FecAvailable();
 }
 
 std::vector<std::unique_ptr<RtpPacketToSend>> FlexfecSender::GetFecPackets() {
+  const std::list<ForwardErrorCorrection::Packet*>& generated_fec_packets =
+      sliding_window_generator_
+          ? sliding_window_generator_->generated_fec_packets_
+          : ulpfec_generator_.generated_fec_packets_;
   std::vector<std::unique_ptr<RtpPacketToSend>> fec_packets_to_send;
-  fec_packets_to_send.reserve(ulpfec_generator_.generated_fec_packets_.size());
-  for (const auto* fec_packet : ulpfec_generator_.generated_fec_packets_) {
+  fec_packets_to_send.reserve(generated_fec_packets.size());
+  for (const auto* fec_packet : generated_fec_packets) {
     std::unique_ptr<RtpPacketToSend> fec_packet_to_send(
         new RtpPacketToSend(&rtp_header_extension_map_));
     fec_packet_to_send->set_packet_type(
@@ -157,7 +201,11 @@ std::vector<std::unique_ptr<RtpPacketToSend>> FlexfecSender::GetFecPackets() {
 
     fec_packets_to_send.push_back(std::move(fec_packet_to_send));
   }
-  ulpfec_generator_.ResetState();
+  if (sliding_window_generator_) {
+    sliding_window_generator_->ResetState();
+  } else {
+    ulpfec_generator_.ResetState();
+  }
 
   int64_t now_ms = clock_->TimeInMilliseconds();
   if (!fec_packets_to_send.empty() &&
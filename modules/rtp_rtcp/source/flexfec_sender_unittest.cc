@@ -11,20 +11,26 @@
 #include <vector>
 
 #include "api/rtp_parameters.h"
+#include "modules/rtp_rtcp/include/flexfec_receiver.h"
 #include "modules/rtp_rtcp/include/flexfec_sender.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/mocks/mock_recovered_packet_receiver.h"
 #include "modules/rtp_rtcp/source/fec_test_helper.h"
 #include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
 #include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
 #include "modules/rtp_rtcp/source/rtp_sender.h"
 #include "modules/rtp_rtcp/source/rtp_utility.h"
 #include "system_wrappers/include/clock.h"
+#include "test/field_trial.h"
+#include "test/gmock.h"
 #include "test/gtest.h"
 
 namespace webrtc {
 
 namespace {
 
+using ::testing::_;
 using RtpUtility::Word32Align;
 using test::fec::AugmentedPacket;
 using test::fec::AugmentedPacketGenerator;
@@ -192,6 +198,93 @@ TEST(FlexfecSenderTest, ProtectTwoFramesWithTwoFecPackets) {
   }
 }
 
+TEST(FlexfecSenderTest, SlidingWindowGeneratesFecAtFecRate) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-FlexFEC-SlidingWindow/Enabled,window:8/");
+  // One FEC packet per four media packets.
+  FecProtectionParams params;
+  params.fec_rate = 64;
+  params.max_fec_frames = 1;
+  params.fec_mask_type = kFecMaskRandom;
+  constexpr size_t kNumFrames = 3;
+  constexpr size_t kNumPacketsPerFrame = 4;
+  SimulatedClock clock(kInitialSimulatedClockTime);
+  FlexfecSender sender(kFlexfecPayloadType, kFlexfecSsrc, kMediaSsrc, kNoMid,
+                       kNoRtpHeaderExtensions, kNoRtpHeaderExtensionSizes,
+                       nullptr /* rtp_state */, &clock);
+  sender.SetFecParameters(params);
+
+  AugmentedPacketGenerator packet_generator(kMediaSsrc);
+  size_t num_fec_packets = 0;
+  for (size_t i = 0; i < kNumFrames; ++i) {
+    packet_generator.NewFrame(kNumPacketsPerFrame);
+    for (size_t j = 0; j < kNumPacketsPerFrame; ++j) {
+      std::unique_ptr<AugmentedPacket> packet =
+          packet_generator.NextPacket(i, kPayloadLength);
+      RtpPacketToSend rtp_packet(nullptr);
+      rtp_packet.Parse(packet->data, packet->length);
+      EXPECT_TRUE(sender.AddRtpPacketAndGenerateFec(rtp_packet));
+      // FEC packets are available as soon as the rate calls for them, not
+      // only at the end of a frame.
+      EXPECT_EQ(j % 4 == 3, sender.FecAvailable());
+      num_fec_packets += sender.GetFecPackets().size();
+    }
+  }
+  EXPECT_EQ(kNumFrames * kNumPacketsPerFrame / 4, num_fec_packets);
+}
+
+TEST(FlexfecSenderTest, SlidingWindowFecRecoversLossInEarlierFrame) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-FlexFEC-SlidingWindow/Enabled,window:8/");
+  // Half an FEC packet per eight media packets, which is sent at the end of
+  // the second frame and protects both frames.
+  FecProtectionParams params;
+  params.fec_rate = 16;
+  params.max_fec_frames = 1;
+  params.fec_mask_type = kFecMaskRandom;
+  constexpr size_t kNumFrames = 2;
+  constexpr size_t kNumPacketsPerFrame = 4;
+  constexpr size_t kLostPacket = 1;
+  SimulatedClock clock(kInitialSimulatedClockTime);
+  FlexfecSender sender(kFlexfecPayloadType, kFlexfecSsrc, kMediaSsrc, kNoMid,
+                       kNoRtpHeaderExtensions, kNoRtpHeaderExtensionSizes,
+                       nullptr /* rtp_state */, &clock);
+  sender.SetFecParameters(params);
+  ::testing::StrictMock<MockRecoveredPacketReceiver> recovered_packet_receiver;
+  FlexfecReceiver receiver(&clock, kFlexfecSsrc, kMediaSsrc,
+                           &recovered_packet_receiver);
+
+  AugmentedPacketGenerator packet_generator(kMediaSsrc);
+  size_t lost_packet_length = 0;
+  for (size_t i = 0; i < kNumFrames; ++i) {
+    packet_generator.NewFrame(kNumPacketsPerFrame);
+    for (size_t j = 0; j < kNumPacketsPerFrame; ++j) {
+      std::unique_ptr<AugmentedPacket> packet =
+          packet_generator.NextPacket(i, kPayloadLength);
+      RtpPacketToSend rtp_packet(nullptr);
+      rtp_packet.Parse(packet->data, packet->length);
+      EXPECT_TRUE(sender.AddRtpPacketAndGenerateFec(rtp_packet));
+      if (i * kNumPacketsPerFrame + j == kLostPacket) {
+        lost_packet_length = packet->length;
+        continue;
+      }
+      RtpPacketReceived received_packet;
+      ASSERT_TRUE(received_packet.Parse(packet->data, packet->length));
+      receiver.OnRtpPacket(received_packet);
+    }
+  }
+
+  std::vector<std::unique_ptr<RtpPacketToSend>> fec_packets =
+      sender.GetFecPackets();
+  ASSERT_EQ(1U, fec_packets.size());
+  RtpPacketReceived received_fec_packet;
+  ASSERT_TRUE(received_fec_packet.Parse(fec_packets.front()->data(),
+                                        fec_packets.front()->size()));
+  EXPECT_CALL(recovered_packet_receiver,
+              OnRecoveredPacket(_, lost_packet_length));
+  receiver.OnRtpPacket(received_fec_packet);
+}
+
 // In the tests, we only consider RTP header extensions that are useful for BWE.
 TEST(FlexfecSenderTest, NoRtpHeaderExtensionsForBweByDefault) {
   const std::vector<RtpExtension> kRtpHeaderExtensions{};
@@ -11,6 +11,7 @@
 #include "modules/rtp_rtcp/source/forward_error_correction.h"
 
 #include <string.h>
+
 #include <algorithm>
 #include <utility>
 
@@ -24,12 +25,50 @@
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/numerics/mod_ops.h"
+#include "rtc_base/system/arch.h"
+
+#if defined(WEBRTC_HAS_NEON)
+#include <arm_neon.h>
+#endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include <emmintrin.h>
+#endif
 
 namespace webrtc {
 
 namespace {
 // Transport header size in bytes. Assume UDP/IPv4 as a reasonable minimum.
 constexpr size_t kTransportOverhead = 28;
+
+// XORs |length| bytes of |src| into |dst|, 16 bytes at a time where SSE2 or
+// NEON is available and 8 bytes at a time for the remainder.
+void XorBytes(const uint8_t* src, size_t length, uint8_t* dst) {
+  size_t i = 0;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  for (; i + 16 <= length; i += 16) {
+    const __m128i s =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i]));
+    const __m128i d =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&dst[i]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[i]), _mm_xor_si128(d, s));
+  }
+#elif defined(WEBRTC_HAS_NEON)
+  for (; i + 16 <= length; i += 16) {
+    vst1q_u8(&dst[i], veorq_u8(vld1q_u8(&dst[i]), vld1q_u8(&src[i])));
+  }
+#endif
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t s;
+    uint64_t d;
+    memcpy(&s, &src[i], sizeof(s));
+    memcpy(&d, &dst[i], sizeof(d));
+    d ^= s;
+    memcpy(&dst[i], &d, sizeof(d));
+  }
+  for (; i < length; ++i) {
+    dst[i] ^= src[i];
+  }
+}
 }  // namespace
 
 ForwardErrorCorrection::Packet::Packet() : length(0), data(), ref_count_(0) {}
@@ -149,8 +188,8 @@ int ForwardErrorCorrection::EncodeFec(const PacketList& media_packets,
     return 0;
   }
   for (int i = 0; i < num_fec_packets; ++i) {
-    memset(generated_fec_packets_[i].data, 0, IP_PACKET_SIZE);
-    // Use this as a marker for untouched packets.
+    // Use this as a marker for untouched packets. The packet data is cleared
+    // by GenerateFecPayloads() as the packet grows.
     generated_fec_packets_[i].length = 0;
     fec_packets->push_back(&generated_fec_packets_[i]);
   }
@@ -184,6 +223,49 @@ int ForwardErrorCorrection::EncodeFec(const PacketList& media_packets,
   return 0;
 }
 
+int ForwardErrorCorrection::EncodeSlidingWindowFec(
+    const PacketList& media_packets,
+    std::list<Packet*>* fec_packets) {
+  RTC_DCHECK(!media_packets.empty());
+  RTC_DCHECK(fec_packets->empty());
+  for (const auto& media_packet : media_packets) {
+    RTC_DCHECK(media_packet);
+    if (media_packet->length < kRtpHeaderSize) {
+      RTC_LOG(LS_WARNING) << "Media packet " << media_packet->length
+                          << " bytes "
+                          << "is smaller than RTP header.";
+      return -1;
+    }
+  }
+  const uint16_t seq_num_base =
+      ParseSequenceNumber(media_packets.front()->data);
+  const size_t num_mask_bits =
+      static_cast<uint16_t>(ParseSequenceNumber(media_packets.back()->data) -
+                            seq_num_base) +
+      1;
+  if (num_mask_bits > fec_header_writer_->MaxMediaPackets()) {
+    RTC_LOG(LS_WARNING) << "Can't protect " << num_mask_bits
+                        << " sequence numbers with one FEC packet.";
+    return -1;
+  }
+
+  // Protect every media packet, leaving zeros for any sequence number gaps.
+  packet_mask_size_ = internal::PacketMaskSize(num_mask_bits);
+  memset(packet_masks_, 0, packet_mask_size_);
+  for (const auto& media_packet : media_packets) {
+    const uint16_t bit_index = static_cast<uint16_t>(
+        ParseSequenceNumber(media_packet->data) - seq_num_base);
+    RTC_DCHECK_LT(bit_index, num_mask_bits);
+    packet_masks_[bit_index / 8] |= 1 << (7 - bit_index % 8);
+  }
+
+  generated_fec_packets_[0].length = 0;
+  GenerateFecPayloads(media_packets, 1);
+  FinalizeFecHeaders(1, ParseSsrc(media_packets.front()->data), seq_num_base);
+  fec_packets->push_back(&generated_fec_packets_[0]);
+  return 0;
+}
+
 int ForwardErrorCorrection::NumFecPackets(int num_media_packets,
                                           int protection_factor) {
   // Result in Q0 with an unsigned round.
@@ -220,12 +302,18 @@ void ForwardErrorCorrection::GenerateFecPayloads(
         bool first_protected_packet = (fec_packet->length == 0);
         size_t fec_packet_length = fec_header_size + media_payload_length;
         if (fec_packet_length > fec_packet->length) {
-          // Recall that XORing with zero (which the FEC packets are prefilled
-          // with) is the identity operator, thus all prior XORs are
-          // still correct even though we expand the packet length here.
+          if (!first_protected_packet) {
+            // Recall that XORing with zero is the identity operator, thus all
+            // prior XORs are still correct when we zero-fill the bytes that
+            // expand the packet length here.
+            memset(&fec_packet->data[fec_packet->length], 0,
+                   fec_packet_length - fec_packet->length);
+          }
           fec_packet->length = fec_packet_length;
         }
         if (first_protected_packet) {
+          // Clear the fields of the FEC header that are not written below.
+          memset(&fec_packet->data[0], 0, fec_header_size);
           // Write P, X, CC, M, and PT recovery fields.
           // Note that bits 0, 1, and 16 are overwritten in FinalizeFecHeaders.
           memcpy(&fec_packet->data[0], &media_packet->data[0], 2);
@@ -610,9 +698,7 @@ void ForwardErrorCorrection::XorPayloads(const Packet& src,
   // XOR the payload.
   RTC_DCHECK_LE(kRtpHeaderSize + payload_length, sizeof(src.data));
   RTC_DCHECK_LE(dst_offset + payload_length, sizeof(dst->data));
-  for (size_t i = 0; i < payload_length; ++i) {
-    dst->data[dst_offset + i] ^= src.data[kRtpHeaderSize + i];
-  }
+  XorBytes(&src.data[kRtpHeaderSize], payload_length, &dst->data[dst_offset]);
 }
 
 bool ForwardErrorCorrection::RecoverPacket(const ReceivedFecPacket& fec_packet,
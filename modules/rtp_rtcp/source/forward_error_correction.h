@@ -194,6 +194,20 @@ class ForwardErrorCorrection {
                 FecMaskType fec_mask_type,
                 std::list<Packet*>* fec_packets);
 
+  // Generates a single FEC packet protecting all of |media_packets|. Unlike
+  // EncodeFec(), the media packets need not belong to the same frame, which
+  // lets the protection slide across frame boundaries. The packets must be
+  // sorted by sequence number, and span at most as many sequence numbers as
+  // an FEC packet can protect.
+  //
+  // The generated packet is appended to |fec_packets|, which must be empty on
+  // entry, and is valid until the next call to EncodeFec() or
+  // EncodeSlidingWindowFec().
+  //
+  // Returns 0 on success, -1 on failure.
+  int EncodeSlidingWindowFec(const PacketList& media_packets,
+                             std::list<Packet*>* fec_packets);
+
   // Decodes a list of received media and FEC packets. It will parse the
   // |received_packets|, storing FEC packets internally, and move
   // media packets to |recovered_packets|. The recovered list will be
@@ -0,0 +1,150 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "modules/rtp_rtcp/source/fec_test_helper.h"
+#include "modules/rtp_rtcp/source/forward_error_correction.h"
+#include "rtc_base/random.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumFrames = 2000;
+constexpr int kQuickNumFrames = 2;
+constexpr uint32_t kMediaSsrc = 0x1234;
+constexpr uint32_t kFlexfecSsrc = 0x5678;
+constexpr uint16_t kFirstSeqNum = 1000;
+constexpr size_t kMediaPacketSize = 1200;
+
+struct FecScheme {
+  std::string name;
+  uint32_t fec_ssrc;
+  std::unique_ptr<ForwardErrorCorrection> (*create)();
+};
+
+std::unique_ptr<ForwardErrorCorrection> CreateUlpfec() {
+  return ForwardErrorCorrection::CreateUlpfec(kMediaSsrc);
+}
+
+std::unique_ptr<ForwardErrorCorrection> CreateFlexfec() {
+  return ForwardErrorCorrection::CreateFlexfec(kFlexfecSsrc, kMediaSsrc);
+}
+
+std::unique_ptr<ForwardErrorCorrection::ReceivedPacket> CreateReceivedPacket(
+    const ForwardErrorCorrection::Packet& packet,
+    bool is_fec,
+    uint32_t ssrc,
+    uint16_t seq_num) {
+  std::unique_ptr<ForwardErrorCorrection::ReceivedPacket> received_packet(
+      new ForwardErrorCorrection::ReceivedPacket());
+  received_packet->pkt = new ForwardErrorCorrection::Packet();
+  received_packet->pkt->length = packet.length;
+  memcpy(received_packet->pkt->data, packet.data, packet.length);
+  received_packet->is_fec = is_fec;
+  received_packet->ssrc = ssrc;
+  received_packet->seq_num = seq_num;
+  return received_packet;
+}
+
+}  // namespace
+
+// Measures generating FEC packets for a frame, and recovering its first media
+// packet from the rest of the frame and the FEC packets, for ULPFEC and
+// FlexFEC at varying frame sizes and protection factors.
+TEST(ForwardErrorCorrectionPerformanceTest, EncodeAndDecode) {
+  const int num_frames = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                             ? kQuickNumFrames
+                             : kNumFrames;
+  const FecScheme kSchemes[] = {{"ulpfec", kMediaSsrc, &CreateUlpfec},
+                                {"flexfec", kFlexfecSsrc, &CreateFlexfec}};
+  const int kNumMediaPackets[] = {4, 12, 48};
+  // Roughly 10%, 30%, 50% and 100% overhead.
+  const uint8_t kProtectionFactors[] = {26, 77, 128, 255};
+
+  for (const FecScheme& scheme : kSchemes) {
+    std::unique_ptr<ForwardErrorCorrection> fec = scheme.create();
+    for (int num_media_packets : kNumMediaPackets) {
+      Random random(0x5eed);
+      test::fec::MediaPacketGenerator generator(
+          kMediaPacketSize, kMediaPacketSize, kMediaSsrc, &random);
+      ForwardErrorCorrection::PacketList media_packets =
+          generator.ConstructMediaPackets(num_media_packets, kFirstSeqNum);
+
+      for (uint8_t protection_factor : kProtectionFactors) {
+        std::list<ForwardErrorCorrection::Packet*> fec_packets;
+        const int64_t start_ns = rtc::TimeNanos();
+        for (int i = 0; i < num_frames; ++i) {
+          fec_packets.clear();
+          ASSERT_EQ(0, fec->EncodeFec(media_packets, protection_factor, 0,
+                                      false, kFecMaskBursty, &fec_packets));
+        }
+        const int64_t encode_ns = rtc::TimeNanos() - start_ns;
+
+        // Lose the first media packet.
+        std::vector<std::unique_ptr<ForwardErrorCorrection::ReceivedPacket>>
+            received_packets;
+        uint16_t seq_num = kFirstSeqNum;
+        for (const auto& media_packet : media_packets) {
+          if (seq_num != kFirstSeqNum) {
+            received_packets.push_back(CreateReceivedPacket(
+                *media_packet, false, kMediaSsrc, seq_num));
+          }
+          ++seq_num;
+        }
+        for (const ForwardErrorCorrection::Packet* fec_packet : fec_packets) {
+          received_packets.push_back(CreateReceivedPacket(
+              *fec_packet, true, scheme.fec_ssrc, seq_num++));
+        }
+
+        std::unique_ptr<ForwardErrorCorrection> decoder = scheme.create();
+        ForwardErrorCorrection::RecoveredPacketList recovered_packets;
+        const int64_t decode_start_ns = rtc::TimeNanos();
+        for (int i = 0; i < num_frames; ++i) {
+          decoder->ResetState(&recovered_packets);
+          for (const auto& received_packet : received_packets)
+            decoder->DecodeFec(*received_packet, &recovered_packets);
+        }
+        const int64_t decode_ns = rtc::TimeNanos() - decode_start_ns;
+
+        ASSERT_FALSE(recovered_packets.empty());
+        const ForwardErrorCorrection::RecoveredPacket& recovered =
+            *recovered_packets.front();
+        EXPECT_TRUE(recovered.was_recovered);
+        EXPECT_EQ(kFirstSeqNum, recovered.seq_num);
+        EXPECT_EQ(0, memcmp(recovered.pkt->data, media_packets.front()->data,
+                            media_packets.front()->length));
+
+        const std::string story = scheme.name + "_" +
+                                  std::to_string(num_media_packets) +
+                                  "_packets_" +
+                                  std::to_string(protection_factor);
+        test::PrintResult("fec_encode_time_per_frame", "", story,
+                          static_cast<double>(encode_ns) / num_frames / 1000,
+                          "us", true);
+        test::PrintResult("fec_decode_time_per_frame", "", story,
+                          static_cast<double>(decode_ns) / num_frames / 1000,
+                          "us", true);
+      }
+    }
+  }
+}
+
+}  // namespace webrtc
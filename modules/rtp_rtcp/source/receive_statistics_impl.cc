@@ -10,9 +10,11 @@
 
 #include "modules/rtp_rtcp/source/receive_statistics_impl.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -356,15 +358,11 @@ ReceiveStatisticsImpl::ReceiveStatisticsImpl(
     : clock_(clock),
       last_returned_ssrc_(0),
       max_reordering_threshold_(kDefaultMaxReorderingThreshold),
+      index_(absl::make_unique<StatisticianIndex>()),
       rtcp_stats_callback_(rtcp_callback),
       rtp_stats_callback_(rtp_callback) {}
 
-ReceiveStatisticsImpl::~ReceiveStatisticsImpl() {
-  while (!statisticians_.empty()) {
-    delete statisticians_.begin()->second;
-    statisticians_.erase(statisticians_.begin());
-  }
-}
+ReceiveStatisticsImpl::~ReceiveStatisticsImpl() = default;
 
 void ReceiveStatisticsImpl::OnRtpPacket(const RtpPacketReceived& packet) {
   // StreamStatisticianImpl instance is created once and only destroyed when
@@ -384,34 +382,47 @@ void ReceiveStatisticsImpl::FecPacketReceived(const RtpPacketReceived& packet) {
 
 StreamStatisticianImpl* ReceiveStatisticsImpl::GetStatistician(
     uint32_t ssrc) const {
-  rtc::CritScope cs(&receive_statistics_lock_);
-  const auto& it = statisticians_.find(ssrc);
-  if (it == statisticians_.end())
+  ReadMostly<StatisticianIndex>::ReadScope index(index_);
+  const auto& it = index->by_ssrc.find(ssrc);
+  if (it == index->by_ssrc.end())
     return NULL;
   return it->second;
 }
 
 StreamStatisticianImpl* ReceiveStatisticsImpl::GetOrCreateStatistician(
     uint32_t ssrc) {
+  StreamStatisticianImpl* impl = GetStatistician(ssrc);
+  if (impl)
+    return impl;
+
   rtc::CritScope cs(&receive_statistics_lock_);
-  StreamStatisticianImpl*& impl = statisticians_[ssrc];
-  if (impl == nullptr) {  // new element
-    impl =
-        new StreamStatisticianImpl(ssrc, clock_, max_reordering_threshold_,
-                                   rtcp_stats_callback_, rtp_stats_callback_);
+  std::unique_ptr<StreamStatisticianImpl>& owned = statisticians_[ssrc];
+  if (owned) {
+    // Added by another thread since the lookup above.
+    return owned.get();
   }
-  return impl;
+  owned = absl::make_unique<StreamStatisticianImpl>(
+      ssrc, clock_, max_reordering_threshold_, rtcp_stats_callback_,
+      rtp_stats_callback_);
+  auto index = absl::make_unique<StatisticianIndex>();
+  index->by_ssrc.reserve(statisticians_.size());
+  index->ordered.reserve(statisticians_.size());
+  for (const auto& statistician : statisticians_) {
+    index->by_ssrc.emplace(statistician.first, statistician.second.get());
+    index->ordered.emplace_back(statistician.first, statistician.second.get());
+  }
+  index_.Publish(std::move(index));
+  return owned.get();
 }
 
 void ReceiveStatisticsImpl::SetMaxReorderingThreshold(
     int max_reordering_threshold) {
-  std::map<uint32_t, StreamStatisticianImpl*> statisticians;
   {
     rtc::CritScope cs(&receive_statistics_lock_);
     max_reordering_threshold_ = max_reordering_threshold;
-    statisticians = statisticians_;
   }
-  for (auto& statistician : statisticians) {
+  ReadMostly<StatisticianIndex>::ReadScope index(index_);
+  for (const auto& statistician : index->ordered) {
     statistician.second->SetMaxReorderingThreshold(max_reordering_threshold);
   }
 }
@@ -430,39 +441,43 @@ void ReceiveStatisticsImpl::EnableRetransmitDetection(uint32_t ssrc,
 
 std::vector<rtcp::ReportBlock> ReceiveStatisticsImpl::RtcpReportBlocks(
     size_t max_blocks) {
-  std::map<uint32_t, StreamStatisticianImpl*> statisticians;
+  // Pick the candidates, starting after the ssrc reported last, without
+  // blocking the packet path. Statistics are read outside of the read scope,
+  // since they call out to |rtcp_stats_callback_|.
+  std::vector<StatisticianIndex::Entry> candidates;
   {
-    rtc::CritScope cs(&receive_statistics_lock_);
-    statisticians = statisticians_;
+    ReadMostly<StatisticianIndex>::ReadScope index(index_);
+    const auto& ordered = index->ordered;
+    const auto start_it = std::upper_bound(
+        ordered.begin(), ordered.end(), last_returned_ssrc_,
+        [](uint32_t ssrc, const StatisticianIndex::Entry& entry) {
+          return ssrc < entry.first;
+        });
+    candidates.reserve(ordered.size());
+    candidates.insert(candidates.end(), start_it, ordered.end());
+    candidates.insert(candidates.end(), ordered.begin(), start_it);
   }
   std::vector<rtcp::ReportBlock> result;
-  result.reserve(std::min(max_blocks, statisticians.size()));
-  auto add_report_block = [&result](uint32_t media_ssrc,
-                                    StreamStatisticianImpl* statistician) {
+  result.reserve(std::min(max_blocks, candidates.size()));
+  for (const auto& candidate : candidates) {
+    if (result.size() >= max_blocks)
+      break;
     // Do we have receive statistics to send?
     RtcpStatistics stats;
-    if (!statistician->GetActiveStatisticsAndReset(&stats))
-      return;
+    if (!candidate.second->GetActiveStatisticsAndReset(&stats))
+      continue;
     result.emplace_back();
     rtcp::ReportBlock& block = result.back();
-    block.SetMediaSsrc(media_ssrc);
+    block.SetMediaSsrc(candidate.first);
     block.SetFractionLost(stats.fraction_lost);
     if (!block.SetCumulativeLost(stats.packets_lost)) {
       RTC_LOG(LS_WARNING) << "Cumulative lost is oversized.";
       result.pop_back();
-      return;
+      continue;
     }
     block.SetExtHighestSeqNum(stats.extended_highest_sequence_number);
     block.SetJitter(stats.jitter);
-  };
-
-  const auto start_it = statisticians.upper_bound(last_returned_ssrc_);
-  for (auto it = start_it;
-       result.size() < max_blocks && it != statisticians.end(); ++it)
-    add_report_block(it->first, it->second);
-  for (auto it = statisticians.begin();
-       result.size() < max_blocks && it != start_it; ++it)
-    add_report_block(it->first, it->second);
+  }
 
   if (!result.empty())
     last_returned_ssrc_ = result.back().source_ssrc();
@@ -15,12 +15,16 @@
 
 #include <algorithm>
 #include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "absl/types/optional.h"
 #include "modules/include/module_common_types_public.h"
 #include "rtc_base/critical_section.h"
 #include "rtc_base/rate_statistics.h"
+#include "rtc_base/synchronization/read_mostly.h"
 #include "rtc_base/thread_annotations.h"
 
 namespace webrtc {
@@ -132,14 +136,28 @@ class ReceiveStatisticsImpl : public ReceiveStatistics {
   void EnableRetransmitDetection(uint32_t ssrc, bool enable) override;
 
  private:
+  // Lookup tables for the statisticians, replaced whenever one is added.
+  // Statisticians are only destroyed with ReceiveStatisticsImpl, so pointers
+  // taken from an old index stay valid.
+  struct StatisticianIndex {
+    using Entry = std::pair<uint32_t, StreamStatisticianImpl*>;
+
+    std::unordered_map<uint32_t, StreamStatisticianImpl*> by_ssrc;
+    // Sorted by ssrc, for sending report blocks round robin.
+    std::vector<Entry> ordered;
+  };
+
   StreamStatisticianImpl* GetOrCreateStatistician(uint32_t ssrc);
 
   Clock* const clock_;
   rtc::CriticalSection receive_statistics_lock_;
   uint32_t last_returned_ssrc_;
   int max_reordering_threshold_ RTC_GUARDED_BY(receive_statistics_lock_);
-  std::map<uint32_t, StreamStatisticianImpl*> statisticians_
+  std::map<uint32_t, std::unique_ptr<StreamStatisticianImpl>> statisticians_
       RTC_GUARDED_BY(receive_statistics_lock_);
+  // Read on the packet and RTCP paths without taking
+  // |receive_statistics_lock_|; published with it held.
+  ReadMostly<StatisticianIndex> index_;
 
   RtcpStatisticsCallback* const rtcp_stats_callback_;
   StreamDataCountersCallback* const rtp_stats_callback_;
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "modules/rtp_rtcp/include/receive_statistics.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/report_block.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/clock.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumSsrcs = 500;
+constexpr int kNumSeconds = 20;
+constexpr int kQuickNumSeconds = 1;
+// Each stream sends a packet every 20 ms, as audio does, so the receiver sees
+// 25 packets per ms.
+constexpr int kPacketIntervalMs = 20;
+// An RTCP report carries at most 31 report blocks, and is sent every 5 ms so
+// that every stream is reported on about once per second.
+constexpr size_t kMaxReportBlocks = 31;
+constexpr int64_t kReportIntervalMs = 5;
+
+}  // namespace
+
+// Measures the per packet cost of receive statistics, and the cost of
+// producing RTCP report blocks, for a transport that carries many streams.
+TEST(ReceiveStatisticsPerformanceTest, ManySsrcs) {
+  const int num_seconds = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                              ? kQuickNumSeconds
+                              : kNumSeconds;
+  SimulatedClock clock(0);
+  std::unique_ptr<ReceiveStatistics> statistics =
+      ReceiveStatistics::Create(&clock, nullptr, nullptr);
+
+  std::vector<RtpPacketReceived> packets(kNumSsrcs);
+  for (int i = 0; i < kNumSsrcs; ++i) {
+    packets[i].SetSsrc(0x1000 + 7919 * i);
+    packets[i].set_payload_type_frequency(48000);
+    packets[i].SetPayloadSize(100);
+  }
+
+  int64_t packet_ns = 0;
+  int64_t report_ns = 0;
+  int num_packets = 0;
+  int num_reports = 0;
+  size_t num_report_blocks = 0;
+  for (int64_t now_ms = 0; now_ms < num_seconds * 1000; ++now_ms) {
+    clock.AdvanceTimeMilliseconds(1);
+    const int64_t start_ns = rtc::TimeNanos();
+    // Spread the streams evenly over the packet interval.
+    for (int i = now_ms % kPacketIntervalMs; i < kNumSsrcs;
+         i += kPacketIntervalMs) {
+      RtpPacketReceived& packet = packets[i];
+      packet.SetSequenceNumber(packet.SequenceNumber() + 1);
+      packet.SetTimestamp(packet.Timestamp() + 960);
+      statistics->OnRtpPacket(packet);
+      ++num_packets;
+    }
+    const int64_t packets_done_ns = rtc::TimeNanos();
+    packet_ns += packets_done_ns - start_ns;
+
+    if (now_ms % kReportIntervalMs == 0) {
+      num_report_blocks +=
+          statistics->RtcpReportBlocks(kMaxReportBlocks).size();
+      report_ns += rtc::TimeNanos() - packets_done_ns;
+      ++num_reports;
+    }
+  }
+
+  EXPECT_GT(num_report_blocks, 0u);
+  test::PrintResult("receive_statistics_time_per_packet", "", "500_ssrcs",
+                    static_cast<double>(packet_ns) / num_packets, "ns", true);
+  test::PrintResult("receive_statistics_time_per_report", "", "500_ssrcs",
+                    static_cast<double>(report_ns) / num_reports, "ns", true);
+}
+
+}  // namespace webrtc
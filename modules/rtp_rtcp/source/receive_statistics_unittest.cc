@@ -172,6 +172,23 @@ TEST_F(ReceiveStatisticsTest,
               UnorderedElementsAre(kSsrc1, kSsrc2, kSsrc3, kSsrc4));
 }
 
+TEST_F(ReceiveStatisticsTest, StatisticianOutlivesAddingMoreStreams) {
+  receive_statistics_->OnRtpPacket(packet1_);
+  StreamStatistician* statistician =
+      receive_statistics_->GetStatistician(kSsrc1);
+  ASSERT_TRUE(statistician != nullptr);
+
+  for (uint32_t ssrc = 1000; ssrc < 1100; ++ssrc) {
+    receive_statistics_->OnRtpPacket(CreateRtpPacket(ssrc, kPacketSize1));
+  }
+  EXPECT_EQ(statistician, receive_statistics_->GetStatistician(kSsrc1));
+  EXPECT_THAT(receive_statistics_->RtcpReportBlocks(200), SizeIs(101));
+
+  uint32_t packets_received = 0;
+  statistician->GetDataCounters(nullptr, &packets_received);
+  EXPECT_EQ(1u, packets_received);
+}
+
 TEST_F(ReceiveStatisticsTest, ActiveStatisticians) {
   receive_statistics_->OnRtpPacket(packet1_);
   IncrementSequenceNumber(&packet1_);
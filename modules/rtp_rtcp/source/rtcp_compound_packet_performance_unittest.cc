@@ -0,0 +1,144 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "api/call/transport.h"
+#include "modules/rtp_rtcp/include/receive_statistics.h"
+#include "modules/rtp_rtcp/source/rtcp_receiver.h"
+#include "modules/rtp_rtcp/source/rtcp_sender.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/clock.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumReports = 20000;
+constexpr int kQuickNumReports = 100;
+// Enough remote streams to fill the report blocks of one report.
+constexpr int kNumRemoteSsrcs = 31;
+constexpr int kNumNackedPackets = 16;
+constexpr uint32_t kSenderSsrc = 0x11111;
+constexpr uint32_t kReceiverSsrc = 0x22222;
+constexpr int64_t kReportIntervalMs = 100;
+
+class CapturingTransport : public Transport {
+ public:
+  bool SendRtp(const uint8_t* packet,
+               size_t length,
+               const PacketOptions& options) override {
+    return false;
+  }
+  bool SendRtcp(const uint8_t* packet, size_t length) override {
+    packets_.emplace_back(packet, length);
+    return true;
+  }
+
+  std::vector<rtc::Buffer>* packets() { return &packets_; }
+
+ private:
+  std::vector<rtc::Buffer> packets_;
+};
+
+class NullModuleRtpRtcp : public RTCPReceiver::ModuleRtpRtcp {
+ public:
+  void SetTmmbn(std::vector<rtcp::TmmbItem> bounding_set) override {}
+  void OnRequestSendReport() override {}
+  void OnReceivedNack(
+      const std::vector<uint16_t>& nack_sequence_numbers) override {}
+  void OnReceivedRtcpReportBlocks(
+      const ReportBlockList& report_blocks) override {}
+};
+
+}  // namespace
+
+// Measures building compound RTCP packets with a sender report, SDES, a full
+// set of report blocks and a NACK, and parsing them on the other side. The
+// build time includes producing the report blocks from ReceiveStatistics.
+TEST(RtcpCompoundPacketPerformanceTest, BuildAndParseReports) {
+  const int num_reports = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                              ? kQuickNumReports
+                              : kNumReports;
+  SimulatedClock clock(1000000);
+  std::unique_ptr<ReceiveStatistics> statistics =
+      ReceiveStatistics::Create(&clock, nullptr, nullptr);
+  std::vector<RtpPacketReceived> media_packets(kNumRemoteSsrcs);
+  std::set<uint32_t> remote_ssrcs;
+  for (int i = 0; i < kNumRemoteSsrcs; ++i) {
+    media_packets[i].SetSsrc(kReceiverSsrc + i);
+    media_packets[i].set_payload_type_frequency(90000);
+    media_packets[i].SetPayloadSize(1000);
+    remote_ssrcs.insert(kReceiverSsrc + i);
+  }
+
+  CapturingTransport transport;
+  RTCPSender sender(false, &clock, statistics.get(), nullptr, nullptr,
+                    &transport, kReportIntervalMs);
+  sender.SetSSRC(kSenderSsrc);
+  sender.SetRemoteSSRC(kReceiverSsrc);
+  sender.SetCNAME("rtcp_compound_packet_performance_test");
+  sender.SetRTCPStatus(RtcpMode::kCompound);
+  RTCPSender::FeedbackState feedback_state;
+  ASSERT_EQ(0, sender.SetSendingStatus(feedback_state, true));
+
+  NullModuleRtpRtcp module;
+  RTCPReceiver receiver(&clock, false, nullptr, nullptr, nullptr, nullptr,
+                        nullptr, nullptr, kReportIntervalMs, &module);
+  receiver.SetSsrcs(kReceiverSsrc, remote_ssrcs);
+  receiver.SetRemoteSSRC(kSenderSsrc);
+
+  uint16_t nack_list[kNumNackedPackets];
+  int64_t build_ns = 0;
+  int64_t parse_ns = 0;
+  size_t num_packets = 0;
+  for (int i = 0; i < num_reports; ++i) {
+    clock.AdvanceTimeMilliseconds(kReportIntervalMs);
+    for (RtpPacketReceived& packet : media_packets) {
+      packet.SetSequenceNumber(packet.SequenceNumber() + 1);
+      packet.SetTimestamp(packet.Timestamp() + 9000);
+      statistics->OnRtpPacket(packet);
+    }
+    for (int j = 0; j < kNumNackedPackets; ++j)
+      nack_list[j] = static_cast<uint16_t>(i * kNumNackedPackets + 2 * j);
+    sender.SetLastRtpTime(i * 9000, clock.TimeInMilliseconds());
+    transport.packets()->clear();
+
+    const int64_t start_ns = rtc::TimeNanos();
+    ASSERT_EQ(0, sender.SendRTCP(feedback_state, kRtcpNack, kNumNackedPackets,
+                                 nack_list));
+    const int64_t built_ns = rtc::TimeNanos();
+    for (const rtc::Buffer& packet : *transport.packets())
+      receiver.IncomingPacket(packet.data(), packet.size());
+    const int64_t parsed_ns = rtc::TimeNanos();
+
+    build_ns += built_ns - start_ns;
+    parse_ns += parsed_ns - built_ns;
+    num_packets += transport.packets()->size();
+  }
+
+  std::vector<RTCPReportBlock> report_blocks;
+  receiver.StatisticsReceived(&report_blocks);
+  EXPECT_EQ(static_cast<size_t>(kNumRemoteSsrcs), report_blocks.size());
+  test::PrintResult("rtcp_compound_build_time", "", "sr_31_blocks_nack",
+                    static_cast<double>(build_ns) / num_reports, "ns", true);
+  test::PrintResult("rtcp_compound_parse_time", "", "sr_31_blocks_nack",
+                    static_cast<double>(parse_ns) / num_packets, "ns", true);
+}
+
+}  // namespace webrtc
@@ -989,12 +989,20 @@ void RTCPReceiver::TriggerCallbacksFromRtcpPacket(
     NotifyTmmbrUpdated();
   }
   uint32_t local_ssrc;
-  std::set<uint32_t> registered_ssrcs;
+  bool transport_feedback_to_us = false;
   {
     // We don't want to hold this critsect when triggering the callbacks below.
     rtc::CritScope lock(&rtcp_receiver_lock_);
     local_ssrc = main_ssrc_;
-    registered_ssrcs = registered_ssrcs_;
+    // Check where transport feedback is addressed to while holding the lock,
+    // instead of copying |registered_ssrcs_| for every incoming packet.
+    if (packet_information.transport_feedback) {
+      uint32_t media_source_ssrc =
+          packet_information.transport_feedback->media_ssrc();
+      transport_feedback_to_us =
+          media_source_ssrc == local_ssrc ||
+          registered_ssrcs_.find(media_source_ssrc) != registered_ssrcs_.end();
+    }
   }
   if (!receiver_only_ && (packet_information.packet_type_flags & kRtcpSrReq)) {
     rtp_rtcp_->OnRequestSendReport();
@@ -1060,10 +1068,7 @@ void RTCPReceiver::TriggerCallbacksFromRtcpPacket(
 
   if (transport_feedback_observer_ &&
       (packet_information.packet_type_flags & kRtcpTransportFeedback)) {
-    uint32_t media_source_ssrc =
-        packet_information.transport_feedback->media_ssrc();
-    if (media_source_ssrc == local_ssrc ||
-        registered_ssrcs.find(media_source_ssrc) != registered_ssrcs.end()) {
+    if (transport_feedback_to_us) {
       transport_feedback_observer_->OnTransportFeedback(
           *packet_information.transport_feedback);
     }
@@ -593,6 +593,15 @@ TEST_F(RtcpSenderTest, TmmbrIncludedInCompoundPacketIfEnabled) {
   EXPECT_FALSE(rtcp_sender_->TMMBR());
 }
 
+TEST_F(RtcpSenderTest, NothingSentIfTmmbrCannotBeBuilt) {
+  rtcp_sender_->SetRTCPStatus(RtcpMode::kCompound);
+  rtcp_sender_->SetTMMBRStatus(true);
+  // Without a target bitrate there is no TMMBR to send, and the rest of the
+  // compound packet is dropped as well.
+  EXPECT_EQ(-1, rtcp_sender_->SendRTCP(feedback_state(), kRtcpReport));
+  EXPECT_EQ(0U, parser()->processed_rtcp_packets());
+}
+
 TEST_F(RtcpSenderTest, SendTmmbn) {
   rtcp_sender_->SetRTCPStatus(RtcpMode::kCompound);
   rtcp_sender_->SetSendingStatus(feedback_state(), true);
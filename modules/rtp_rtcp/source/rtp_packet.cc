@@ -119,6 +119,7 @@ void RtpPacket::CopyHeaderFrom(const RtpPacket& packet) {
   payload_offset_ = packet.payload_offset_;
   extensions_ = packet.extensions_;
   extension_entries_ = packet.extension_entries_;
+  extension_index_ = packet.extension_index_;
   extensions_size_ = packet.extensions_size_;
   buffer_.SetData(packet.data(), packet.headers_size());
   // Reset payload and padding.
@@ -319,8 +320,9 @@ rtc::ArrayView<uint8_t> RtpPacket::AllocateRawExtension(int id, size_t length) {
   const uint16_t extension_info_offset = rtc::dchecked_cast<uint16_t>(
       extensions_offset + extensions_size_ + extension_header_size);
   const uint8_t extension_info_length = rtc::dchecked_cast<uint8_t>(length);
-  extension_entries_.emplace_back(id, extension_info_length,
-                                  extension_info_offset);
+  ExtensionInfo& extension_info = AppendExtensionInfo(id);
+  extension_info.length = extension_info_length;
+  extension_info.offset = extension_info_offset;
 
   extensions_size_ = new_extensions_size;
 
@@ -433,6 +435,7 @@ void RtpPacket::Clear() {
   padding_size_ = 0;
   extensions_size_ = 0;
   extension_entries_.clear();
+  extension_index_.fill(0);
 
   memset(WriteAt(0), 0, kFixedHeaderSize);
   buffer_.SetSize(kFixedHeaderSize);
@@ -473,6 +476,7 @@ bool RtpPacket::ParseBuffer(const uint8_t* buffer, size_t size) {
 
   extensions_size_ = 0;
   extension_entries_.clear();
+  extension_index_.fill(0);
   if (has_extension) {
     /* RTP header extension, RFC 3550.
      0                   1                   2                   3
@@ -558,6 +562,10 @@ bool RtpPacket::ParseBuffer(const uint8_t* buffer, size_t size) {
 }
 
 const RtpPacket::ExtensionInfo* RtpPacket::FindExtensionInfo(int id) const {
+  if (id <= RtpExtension::kOneByteHeaderExtensionMaxId) {
+    const uint8_t index = extension_index_[id];
+    return index == 0 ? nullptr : &extension_entries_[index - 1];
+  }
   for (const ExtensionInfo& extension : extension_entries_) {
     if (extension.id == id) {
       return &extension;
@@ -567,12 +575,28 @@ const RtpPacket::ExtensionInfo* RtpPacket::FindExtensionInfo(int id) const {
 }
 
 RtpPacket::ExtensionInfo& RtpPacket::FindOrCreateExtensionInfo(int id) {
-  for (ExtensionInfo& extension : extension_entries_) {
-    if (extension.id == id) {
-      return extension;
+  if (id <= RtpExtension::kOneByteHeaderExtensionMaxId) {
+    const uint8_t index = extension_index_[id];
+    if (index != 0) {
+      return extension_entries_[index - 1];
+    }
+  } else {
+    for (ExtensionInfo& extension : extension_entries_) {
+      if (extension.id == id) {
+        return extension;
+      }
     }
   }
-  extension_entries_.emplace_back(id);
+  return AppendExtensionInfo(id);
+}
+
+RtpPacket::ExtensionInfo& RtpPacket::AppendExtensionInfo(int id) {
+  extension_entries_.emplace_back(rtc::dchecked_cast<uint8_t>(id));
+  if (id <= RtpExtension::kOneByteHeaderExtensionMaxId) {
+    // Ids are unique and id 0 is never stored, so the index fits in a byte.
+    extension_index_[id] =
+        rtc::dchecked_cast<uint8_t>(extension_entries_.size());
+  }
   return extension_entries_.back();
 }
 
@@ -10,8 +10,10 @@
 #ifndef MODULES_RTP_RTCP_SOURCE_RTP_PACKET_H_
 #define MODULES_RTP_RTCP_SOURCE_RTP_PACKET_H_
 
+#include <array>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/types/optional.h"
 #include "api/array_view.h"
 #include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
@@ -145,13 +147,16 @@ class RtpPacket {
   bool ParseBuffer(const uint8_t* buffer, size_t size);
 
   // Returns pointer to extension info for a given id. Returns nullptr if not
-  // found.
+  // found. O(1) for one-byte header ids.
   const ExtensionInfo* FindExtensionInfo(int id) const;
 
   // Returns reference to extension info for a given id. Creates a new entry
   // with the specified id if not found.
   ExtensionInfo& FindOrCreateExtensionInfo(int id);
 
+  // Adds an empty entry for an id that is not in the packet yet.
+  ExtensionInfo& AppendExtensionInfo(int id);
+
   // Allocates and returns place to store rtp header extension.
   // Returns empty arrayview on failure.
   rtc::ArrayView<uint8_t> AllocateRawExtension(int id, size_t length);
@@ -176,7 +181,14 @@ class RtpPacket {
   size_t payload_size_;
 
   ExtensionManager extensions_;
-  std::vector<ExtensionInfo> extension_entries_;
+  // Extensions in the order they appear in the packet. Typical packets carry
+  // few enough extensions to be parsed and copied without allocating.
+  absl::InlinedVector<ExtensionInfo, 8> extension_entries_;
+  // Index + 1 of the entry for each one-byte header id, or 0 if the packet has
+  // no such extension. Two-byte header ids above that range are looked up in
+  // |extension_entries_|.
+  std::array<uint8_t, RtpExtension::kOneByteHeaderExtensionMaxId + 1>
+      extension_index_;
   size_t extensions_size_ = 0;  // Unaligned.
   rtc::CopyOnWriteBuffer buffer_;
 };
@@ -0,0 +1,153 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "api/rtp_headers.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/source/rtp_dependency_descriptor_extension.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumPackets = 1000;
+constexpr int kNumRounds = 1000;
+constexpr int kQuickNumRounds = 10;
+constexpr size_t kPayloadSize = 1000;
+constexpr size_t kDependencyDescriptorSize = 8;
+constexpr char kMid[] = "video";
+constexpr char kRid[] = "hi";
+
+struct ExtensionIds {
+  std::string name;
+  bool extmap_allow_mixed;
+  int abs_send_time;
+  int transport_sequence_number;
+  int mid;
+  int rid;
+  int dependency_descriptor;
+};
+
+RtpHeaderExtensionMap MakeExtensionMap(const ExtensionIds& ids) {
+  RtpHeaderExtensionMap extensions(ids.extmap_allow_mixed);
+  extensions.Register<AbsoluteSendTime>(ids.abs_send_time);
+  extensions.Register<TransportSequenceNumber>(ids.transport_sequence_number);
+  extensions.Register<RtpMid>(ids.mid);
+  extensions.Register<RtpStreamId>(ids.rid);
+  extensions.Register<RtpDependencyDescriptorExtension>(
+      ids.dependency_descriptor);
+  // Registered, but not sent, as receivers commonly do.
+  extensions.Register<TransmissionOffset>(2);
+  extensions.Register<AudioLevel>(4);
+  extensions.Register<VideoOrientation>(13);
+  return extensions;
+}
+
+// Builds packets of a video stream that sends all registered extensions on
+// every packet, which is what a simulcast layer with MID and RID does until
+// the receiver has demuxed it.
+std::vector<rtc::CopyOnWriteBuffer> BuildPackets(
+    const RtpHeaderExtensionMap& extensions) {
+  std::vector<rtc::CopyOnWriteBuffer> packets;
+  for (int i = 0; i < kNumPackets; ++i) {
+    RtpPacketToSend packet(&extensions);
+    packet.SetPayloadType(96);
+    packet.SetSequenceNumber(i);
+    packet.SetTimestamp(i / 10 * 3000);
+    packet.SetSsrc(0x12345678);
+    packet.SetMarker(i % 10 == 9);
+    packet.SetExtension<AbsoluteSendTime>(AbsoluteSendTime::MsTo24Bits(i));
+    packet.SetExtension<TransportSequenceNumber>(i);
+    packet.SetExtension<RtpMid>(kMid);
+    packet.SetExtension<RtpStreamId>(kRid);
+    rtc::ArrayView<uint8_t> dependency_descriptor = packet.AllocateExtension(
+        RtpDependencyDescriptorExtension::kId, kDependencyDescriptorSize);
+    memset(dependency_descriptor.data(), i, dependency_descriptor.size());
+    memset(packet.AllocatePayload(kPayloadSize), 0, kPayloadSize);
+    packets.push_back(packet.Buffer());
+  }
+  return packets;
+}
+
+}  // namespace
+
+// Measures parsing an incoming packet and reading the extensions the receive
+// path looks at, for one-byte header ids and for ids that need the two-byte
+// header.
+TEST(RtpPacketPerformanceTest, ParseAndReadExtensions) {
+  const int num_rounds = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                             ? kQuickNumRounds
+                             : kNumRounds;
+  const ExtensionIds kIds[] = {{"one_byte_header", false, 3, 5, 1, 10, 12},
+                               {"two_byte_header", true, 3, 5, 1, 20, 30}};
+  for (const ExtensionIds& ids : kIds) {
+    const RtpHeaderExtensionMap extensions = MakeExtensionMap(ids);
+    const std::vector<rtc::CopyOnWriteBuffer> packets =
+        BuildPackets(extensions);
+
+    // As in Call, every incoming packet is parsed into a new packet object.
+    int num_found = 0;
+    const int64_t start_ns = rtc::TimeNanos();
+    for (int round = 0; round < num_rounds; ++round) {
+      for (const rtc::CopyOnWriteBuffer& buffer : packets) {
+        RtpPacketReceived packet(&extensions);
+        ASSERT_TRUE(packet.Parse(buffer));
+        uint32_t abs_send_time;
+        uint16_t transport_sequence_number;
+        std::string mid;
+        std::string rid;
+        num_found += packet.GetExtension<AbsoluteSendTime>(&abs_send_time);
+        num_found += packet.GetExtension<TransportSequenceNumber>(
+            &transport_sequence_number);
+        num_found += packet.GetExtension<RtpMid>(&mid);
+        num_found += packet.GetExtension<RtpStreamId>(&rid);
+        num_found +=
+            !packet.GetRawExtension<RtpDependencyDescriptorExtension>().empty();
+      }
+    }
+    const int64_t parse_ns = rtc::TimeNanos() - start_ns;
+
+    // The receive path still builds an RTPHeader for NetEq, the jitter buffer
+    // and the receive side estimator.
+    const int64_t get_header_start_ns = rtc::TimeNanos();
+    for (int round = 0; round < num_rounds; ++round) {
+      for (const rtc::CopyOnWriteBuffer& buffer : packets) {
+        RtpPacketReceived packet(&extensions);
+        ASSERT_TRUE(packet.Parse(buffer));
+        RTPHeader header;
+        packet.GetHeader(&header);
+        num_found += header.extension.hasTransportSequenceNumber;
+      }
+    }
+    const int64_t get_header_ns = rtc::TimeNanos() - get_header_start_ns;
+
+    const int num_parsed = num_rounds * kNumPackets;
+    EXPECT_EQ(6 * num_parsed, num_found);
+    test::PrintResult("rtp_packet_parse_time", "", ids.name,
+                      static_cast<double>(parse_ns) / num_parsed, "ns", true);
+    test::PrintResult("rtp_packet_parse_and_get_header_time", "", ids.name,
+                      static_cast<double>(get_header_ns) / num_parsed, "ns",
+                      true);
+  }
+}
+
+}  // namespace webrtc
@@ -12,12 +12,14 @@
 
 #include <stddef.h>
 #include <cstdint>
-#include <vector>
 
+#include "modules/rtp_rtcp/source/byte_io.h"
 #include "modules/rtp_rtcp/source/rtp_header_extensions.h"
-#include "rtc_base/numerics/safe_conversions.h"
 
 namespace webrtc {
+namespace {
+constexpr size_t kFixedHeaderSize = 12;
+}  // namespace
 
 RtpPacketReceived::RtpPacketReceived() = default;
 RtpPacketReceived::RtpPacketReceived(const ExtensionManager* extensions)
@@ -38,10 +40,11 @@ void RtpPacketReceived::GetHeader(RTPHeader* header) const {
   header->sequenceNumber = SequenceNumber();
   header->timestamp = Timestamp();
   header->ssrc = Ssrc();
-  std::vector<uint32_t> csrcs = Csrcs();
-  header->numCSRCs = rtc::dchecked_cast<uint8_t>(csrcs.size());
-  for (size_t i = 0; i < csrcs.size(); ++i) {
-    header->arrOfCSRCs[i] = csrcs[i];
+  // Read the csrcs in place rather than through Csrcs(), which allocates.
+  header->numCSRCs = data()[0] & 0x0F;
+  for (size_t i = 0; i < header->numCSRCs; ++i) {
+    header->arrOfCSRCs[i] =
+        ByteReader<uint32_t>::ReadBigEndian(data() + kFixedHeaderSize + i * 4);
   }
   header->paddingLength = padding_size();
   header->headerLength = headers_size();
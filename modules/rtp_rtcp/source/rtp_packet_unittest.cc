@@ -606,6 +606,46 @@ TEST(RtpPacketTest, ParseSecondPacketWithFewerExtensions) {
   EXPECT_FALSE(packet.HasExtension<AudioLevel>());
 }
 
+TEST(RtpPacketTest, ParseWithOneByteAndTwoByteExtensionIds) {
+  RtpPacketToSend::ExtensionManager extensions(true);
+  extensions.Register(kRtpExtensionTransmissionTimeOffset,
+                      kTransmissionOffsetExtensionId);
+  extensions.Register(kRtpExtensionAudioLevel, kAudioLevelExtensionId);
+  extensions.Register(kRtpExtensionPlayoutDelay, kTwoByteExtensionId);
+  RtpPacketReceived packet(&extensions);
+  EXPECT_TRUE(packet.Parse(kPacketWithTwoByteExtensionIdFirst,
+                           sizeof(kPacketWithTwoByteExtensionIdFirst)));
+
+  int32_t time_offset;
+  EXPECT_TRUE(packet.GetExtension<TransmissionOffset>(&time_offset));
+  EXPECT_EQ(kTimeOffset, time_offset);
+  bool voice_active;
+  uint8_t audio_level;
+  EXPECT_TRUE(packet.GetExtension<AudioLevel>(&voice_active, &audio_level));
+  EXPECT_EQ(kVoiceActive, voice_active);
+  EXPECT_EQ(kAudioLevel, audio_level);
+  PlayoutDelay playout_delay;
+  EXPECT_TRUE(packet.GetExtension<PlayoutDelayLimits>(&playout_delay));
+  EXPECT_EQ(30, playout_delay.min_ms);
+  EXPECT_EQ(340, playout_delay.max_ms);
+}
+
+TEST(RtpPacketTest, CopyHeaderFromKeepsExtensions) {
+  RtpPacketToSend::ExtensionManager extensions;
+  extensions.Register(kRtpExtensionTransmissionTimeOffset,
+                      kTransmissionOffsetExtensionId);
+  extensions.Register(kRtpExtensionAudioLevel, kAudioLevelExtensionId);
+  RtpPacketReceived packet(&extensions);
+  EXPECT_TRUE(packet.Parse(kPacketWithTOAndAL, sizeof(kPacketWithTOAndAL)));
+
+  RtpPacketToSend copy(nullptr);
+  copy.CopyHeaderFrom(packet);
+  int32_t time_offset;
+  EXPECT_TRUE(copy.GetExtension<TransmissionOffset>(&time_offset));
+  EXPECT_EQ(kTimeOffset, time_offset);
+  EXPECT_TRUE(copy.HasExtension<AudioLevel>());
+}
+
 TEST(RtpPacketTest, ParseWith2ExtensionsInvalidPadding) {
   RtpPacketToSend::ExtensionManager extensions;
   extensions.Register(kRtpExtensionTransmissionTimeOffset,
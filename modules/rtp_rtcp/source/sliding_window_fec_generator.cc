@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/sliding_window_fec_generator.h"
+
+#include <string.h>
+#include <algorithm>
+#include <utility>
+
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/forward_error_correction_internal.h"
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+namespace {
+
+// One FEC packet in the Q8 domain of the FEC rate, as in
+// ForwardErrorCorrection::NumFecPackets().
+constexpr int kFecPacketCredit = 1 << 8;
+
+}  // namespace
+
+SlidingWindowFecGenerator::SlidingWindowFecGenerator(
+    std::unique_ptr<ForwardErrorCorrection> fec,
+    size_t window_size)
+    : fec_(std::move(fec)),
+      window_size_(window_size),
+      num_media_packets_since_fec_(0),
+      fec_credit_(0),
+      fec_rate_(0) {
+  RTC_DCHECK_GT(window_size_, 0);
+  RTC_DCHECK_LE(window_size_, kUlpfecMaxMediaPackets);
+}
+
+SlidingWindowFecGenerator::~SlidingWindowFecGenerator() = default;
+
+void SlidingWindowFecGenerator::SetFecParameters(
+    const FecProtectionParams& params) {
+  RTC_DCHECK_GE(params.fec_rate, 0);
+  RTC_DCHECK_LE(params.fec_rate, 255);
+  fec_rate_ = static_cast<uint8_t>(params.fec_rate);
+}
+
+int SlidingWindowFecGenerator::AddRtpPacketAndGenerateFec(
+    const uint8_t* data_buffer,
+    size_t payload_length,
+    size_t rtp_header_length) {
+  RTC_DCHECK(generated_fec_packets_.empty());
+  RTC_DCHECK_GE(rtp_header_length, kRtpHeaderSize);
+  std::unique_ptr<ForwardErrorCorrection::Packet> packet(
+      new ForwardErrorCorrection::Packet());
+  packet->length = payload_length + rtp_header_length;
+  memcpy(packet->data, data_buffer, packet->length);
+  const uint16_t seq_num = ForwardErrorCorrection::ParseSequenceNumber(
+      packet->data);
+  media_packets_.push_back(std::move(packet));
+  ++num_media_packets_since_fec_;
+
+  // Slide the window forward, without letting it span more sequence numbers
+  // than one FEC packet can protect.
+  const size_t window_size =
+      std::max(window_size_, num_media_packets_since_fec_);
+  while (media_packets_.size() > window_size ||
+         static_cast<uint16_t>(
+             seq_num - ForwardErrorCorrection::ParseSequenceNumber(
+                           media_packets_.front()->data)) >=
+             kUlpfecMaxMediaPackets) {
+    media_packets_.pop_front();
+  }
+
+  // Don't leave the end of a frame waiting for the next frame to be protected,
+  // if it has earned at least half an FEC packet. The credit may then go
+  // negative, which keeps the FEC rate over time.
+  const bool complete_frame = (data_buffer[1] & 0x80) != 0;
+  fec_credit_ += fec_rate_;
+  if (fec_credit_ < kFecPacketCredit &&
+      !(complete_frame && fec_rate_ > 0 &&
+        fec_credit_ >= kFecPacketCredit / 2)) {
+    return 0;
+  }
+  fec_credit_ -= kFecPacketCredit;
+  num_media_packets_since_fec_ = 0;
+  return fec_->EncodeSlidingWindowFec(media_packets_, &generated_fec_packets_);
+}
+
+bool SlidingWindowFecGenerator::FecAvailable() const {
+  return !generated_fec_packets_.empty();
+}
+
+void SlidingWindowFecGenerator::ResetState() {
+  generated_fec_packets_.clear();
+}
+
+}  // namespace webrtc
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_SLIDING_WINDOW_FEC_GENERATOR_H_
+#define MODULES_RTP_RTCP_SOURCE_SLIDING_WINDOW_FEC_GENERATOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <memory>
+
+#include "modules/include/module_fec_types.h"
+#include "modules/rtp_rtcp/source/forward_error_correction.h"
+
+namespace webrtc {
+
+class FlexfecSender;
+
+// Generates FEC packets that each protect the most recent media packets,
+// regardless of frame boundaries, instead of the media packets of whole
+// frames as UlpfecGenerator does. The windows of consecutive FEC packets
+// overlap, so that a receiver can recover a lost packet as soon as one FEC
+// packet covering it has arrived, and chain recoveries for burst losses.
+// Only used for FlexFEC.
+class SlidingWindowFecGenerator {
+  friend class FlexfecSender;
+
+ public:
+  // Each FEC packet protects the last |window_size| media packets, or all
+  // media packets since the previous FEC packet if there are more, as long as
+  // they span at most |kUlpfecMaxMediaPackets| sequence numbers.
+  SlidingWindowFecGenerator(std::unique_ptr<ForwardErrorCorrection> fec,
+                            size_t window_size);
+  ~SlidingWindowFecGenerator();
+
+  // Sets the FEC rate, as the number of FEC packets per media packet in Q8.
+  // The other parameters only apply to per frame FEC. The rate takes effect
+  // immediately.
+  void SetFecParameters(const FecProtectionParams& params);
+
+  // Adds a media packet to the window, and generates an FEC packet if the FEC
+  // rate calls for one, or if the packet completes a frame and the FEC rate
+  // calls for at least half an FEC packet. The FEC packet is then obtained
+  // through FlexfecSender.
+  int AddRtpPacketAndGenerateFec(const uint8_t* data_buffer,
+                                 size_t payload_length,
+                                 size_t rtp_header_length);
+
+  // Returns true if there is a generated FEC packet available.
+  bool FecAvailable() const;
+
+ private:
+  void ResetState();
+
+  const std::unique_ptr<ForwardErrorCorrection> fec_;
+  const size_t window_size_;
+  ForwardErrorCorrection::PacketList media_packets_;
+  size_t num_media_packets_since_fec_;
+  // Grows by |fec_rate_| for every media packet, and shrinks by one packet,
+  // which is 1 << 8 in Q8, for every generated FEC packet.
+  int fec_credit_;
+  uint8_t fec_rate_;
+  std::list<ForwardErrorCorrection::Packet*> generated_fec_packets_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_SOURCE_SLIDING_WINDOW_FEC_GENERATOR_H_
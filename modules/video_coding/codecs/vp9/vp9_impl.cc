@@ -1527,6 +1527,11 @@ VideoEncoder::EncoderInfo VP9EncoderImpl::GetEncoderInfo() const {
   info.has_trusted_rate_controller = trusted_rate_controller_;
   info.is_hardware_accelerated = false;
   info.has_internal_source = false;
+  if (profile_ == VP9Profile::kProfile2) {
+    // High bit depth input is encoded without a round trip through I420.
+    info.preferred_pixel_formats = {VideoFrameBuffer::Type::kI010,
+                                    VideoFrameBuffer::Type::kI420};
+  }
   for (size_t si = 0; si < num_spatial_layers_; ++si) {
     info.fps_allocation[si].clear();
     if (!codec_.spatialLayers[si].active) {
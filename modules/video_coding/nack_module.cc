@@ -89,7 +89,7 @@ int NackModule::OnReceivedPacket(uint16_t seq_num,
   if (!initialized_) {
     newest_seq_num_ = seq_num;
     if (is_keyframe)
-      keyframe_list_.insert(seq_num);
+      keyframe_list_.emplace(seq_num);
     initialized_ = true;
     return 0;
   }
@@ -114,7 +114,7 @@ int NackModule::OnReceivedPacket(uint16_t seq_num,
 
   // Keep track of new keyframes.
   if (is_keyframe)
-    keyframe_list_.insert(seq_num);
+    keyframe_list_.emplace(seq_num);
 
   // And remove old ones so we don't accumulate keyframes.
   auto it = keyframe_list_.lower_bound(seq_num - kMaxPacketAge);
@@ -122,7 +122,7 @@ int NackModule::OnReceivedPacket(uint16_t seq_num,
     keyframe_list_.erase(keyframe_list_.begin(), it);
 
   if (is_recovered) {
-    recovered_list_.insert(seq_num);
+    recovered_list_.emplace(seq_num);
 
     // Remove old ones so we don't accumulate recovered packets.
     auto it = recovered_list_.lower_bound(seq_num - kMaxPacketAge);
@@ -164,6 +164,8 @@ void NackModule::UpdateRtt(int64_t rtt_ms) {
 void NackModule::Clear() {
   rtc::CritScope lock(&crit_);
   nack_list_.clear();
+  sent_nacks_.clear();
+  oldest_unsent_seq_num_.reset();
   keyframe_list_.clear();
   recovered_list_.clear();
 }
@@ -204,7 +206,7 @@ void NackModule::Process() {
 
 bool NackModule::RemovePacketsUntilKeyFrame() {
   while (!keyframe_list_.empty()) {
-    auto it = nack_list_.lower_bound(*keyframe_list_.begin());
+    auto it = nack_list_.lower_bound(keyframe_list_.begin()->first);
 
     if (it != nack_list_.begin()) {
       // We have found a keyframe that actually is newer than at least one
@@ -237,6 +239,8 @@ void NackModule::AddPacketsToNack(uint16_t seq_num_start,
 
     if (nack_list_.size() + num_new_nacks > kMaxNackPackets) {
       nack_list_.clear();
+      sent_nacks_.clear();
+      oldest_unsent_seq_num_.reset();
       RTC_LOG(LS_WARNING) << "NACK list full, clearing NACK"
                              " list and requesting keyframe.";
       keyframe_request_sender_->RequestKeyFrame();
@@ -244,14 +248,31 @@ void NackModule::AddPacketsToNack(uint16_t seq_num_start,
     }
   }
 
+  // The oldest unsent packet may since have been removed from the list. Move
+  // |oldest_unsent_seq_num_| along so it stays within the list's span.
+  if (oldest_unsent_seq_num_ &&
+      (nack_list_.empty() ||
+       AheadOf(nack_list_.begin()->first, *oldest_unsent_seq_num_))) {
+    oldest_unsent_seq_num_.reset();
+    if (!nack_list_.empty())
+      oldest_unsent_seq_num_ = nack_list_.begin()->first;
+  }
+
+  auto recovered_it = recovered_list_.lower_bound(seq_num_start);
   for (uint16_t seq_num = seq_num_start; seq_num != seq_num_end; ++seq_num) {
     // Do not send nack for packets that are already recovered by FEC or RTX
-    if (recovered_list_.find(seq_num) != recovered_list_.end())
+    while (recovered_it != recovered_list_.end() &&
+           AheadOf(seq_num, recovered_it->first)) {
+      ++recovered_it;
+    }
+    if (recovered_it != recovered_list_.end() && recovered_it->first == seq_num)
       continue;
     NackInfo nack_info(seq_num, seq_num + WaitNumberOfPackets(0.5),
                        clock_->TimeInMilliseconds());
     RTC_DCHECK(nack_list_.find(seq_num) == nack_list_.end());
-    nack_list_[seq_num] = nack_info;
+    nack_list_.emplace(seq_num, nack_info);
+    if (!oldest_unsent_seq_num_)
+      oldest_unsent_seq_num_ = seq_num;
   }
 }
 
@@ -260,33 +281,76 @@ std::vector<uint16_t> NackModule::GetNackBatch(NackFilterOptions options) {
   bool consider_timestamp = options != kSeqNumOnly;
   int64_t now_ms = clock_->TimeInMilliseconds();
   std::vector<uint16_t> nack_batch;
-  auto it = nack_list_.begin();
-  while (it != nack_list_.end()) {
-    bool delay_timed_out =
-        now_ms - it->second.created_at_time >= send_nack_delay_ms_;
-    bool nack_on_rtt_passed = now_ms - it->second.sent_at_time >= rtt_ms_;
-    bool nack_on_seq_num_passed =
-        it->second.sent_at_time == -1 &&
-        AheadOrAt(newest_seq_num_, it->second.send_at_seq_num);
-    if (delay_timed_out && ((consider_seq_num && nack_on_seq_num_passed) ||
-                            (consider_timestamp && nack_on_rtt_passed))) {
-      nack_batch.emplace_back(it->second.seq_num);
-      ++it->second.retries;
-      it->second.sent_at_time = now_ms;
-      if (it->second.retries >= kMaxNackRetries) {
-        RTC_LOG(LS_WARNING) << "Sequence number " << it->second.seq_num
-                            << " removed from NACK list due to max retries.";
-        it = nack_list_.erase(it);
-      } else {
+
+  // Packets that have been nacked before are due again once an RTT has
+  // passed. Since |sent_nacks_| is ordered by send time, only the due packets
+  // are visited. Packets nacked again below are appended to |sent_nacks_| and
+  // must not be visited twice.
+  if (consider_timestamp) {
+    size_t num_to_visit = sent_nacks_.size();
+    while (num_to_visit-- > 0 &&
+           now_ms - sent_nacks_.front().sent_at_time >= rtt_ms_) {
+      const SentNack sent_nack = sent_nacks_.front();
+      sent_nacks_.pop_front();
+      auto it = nack_list_.find(sent_nack.seq_num);
+      if (it == nack_list_.end() ||
+          it->second.sent_at_time != sent_nack.sent_at_time) {
+        continue;
+      }
+      if (!SendNack(&it->second, now_ms, &nack_batch))
+        nack_list_.erase(it);
+    }
+  }
+
+  // Packets that have not been nacked yet.
+  if (oldest_unsent_seq_num_) {
+    absl::optional<uint16_t> oldest_unsent_seq_num;
+    auto it = nack_list_.lower_bound(*oldest_unsent_seq_num_);
+    while (it != nack_list_.end()) {
+      NackInfo& nack_info = it->second;
+      if (nack_info.sent_at_time != -1) {
         ++it;
+        continue;
       }
-      continue;
+      bool delay_timed_out =
+          now_ms - nack_info.created_at_time >= send_nack_delay_ms_;
+      bool nack_on_rtt_passed = now_ms - nack_info.sent_at_time >= rtt_ms_;
+      bool nack_on_seq_num_passed =
+          AheadOrAt(newest_seq_num_, nack_info.send_at_seq_num);
+      if (delay_timed_out && ((consider_seq_num && nack_on_seq_num_passed) ||
+                              (consider_timestamp && nack_on_rtt_passed))) {
+        if (!SendNack(&nack_info, now_ms, &nack_batch)) {
+          it = nack_list_.erase(it);
+          continue;
+        }
+      } else if (!oldest_unsent_seq_num) {
+        oldest_unsent_seq_num = it->first;
+      }
+      ++it;
     }
-    ++it;
+    oldest_unsent_seq_num_ = oldest_unsent_seq_num;
   }
+
+  std::sort(nack_batch.begin(), nack_batch.end(),
+            DescendingSeqNumComp<uint16_t>());
   return nack_batch;
 }
 
+bool NackModule::SendNack(NackInfo* nack_info,
+                          int64_t now_ms,
+                          std::vector<uint16_t>* nack_batch) {
+  nack_batch->emplace_back(nack_info->seq_num);
+  ++nack_info->retries;
+  nack_info->sent_at_time = now_ms;
+  if (nack_info->retries >= kMaxNackRetries) {
+    RTC_LOG(LS_WARNING) << "Sequence number " << nack_info->seq_num
+                        << " removed from NACK list due to max retries.";
+    return false;
+  }
+  sent_nacks_.push_back({nack_info->seq_num, now_ms});
+  return true;
+}
+
 void NackModule::UpdateReorderingStatistics(uint16_t seq_num) {
   RTC_DCHECK(AheadOf(newest_seq_num_, seq_num));
   uint16_t diff = ReverseDiff(newest_seq_num_, seq_num);
@@ -12,14 +12,15 @@
 #define MODULES_VIDEO_CODING_NACK_MODULE_H_
 
 #include <stdint.h>
-#include <map>
-#include <set>
+#include <deque>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "modules/include/module.h"
 #include "modules/include/module_common_types.h"
 #include "modules/video_coding/histogram.h"
 #include "rtc_base/critical_section.h"
+#include "rtc_base/numerics/seq_num_ring_map.h"
 #include "rtc_base/numerics/sequence_number_util.h"
 #include "rtc_base/thread_annotations.h"
 #include "system_wrappers/include/clock.h"
@@ -63,6 +64,13 @@ class NackModule : public Module {
     int64_t sent_at_time;
     int retries;
   };
+
+  // A packet that was nacked at |sent_at_time|, and is due to be nacked again
+  // once an RTT has passed unless it has been received by then.
+  struct SentNack {
+    uint16_t seq_num;
+    int64_t sent_at_time;
+  };
   void AddPacketsToNack(uint16_t seq_num_start, uint16_t seq_num_end)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
@@ -71,6 +79,13 @@ class NackModule : public Module {
   bool RemovePacketsUntilKeyFrame() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
   std::vector<uint16_t> GetNackBatch(NackFilterOptions options)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Adds |nack_info| to |nack_batch|. Returns false if the packet has now
+  // been nacked the maximum number of times and should be removed from the
+  // nack list.
+  bool SendNack(NackInfo* nack_info,
+                int64_t now_ms,
+                std::vector<uint16_t>* nack_batch)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
   // Update the reordering distribution.
   void UpdateReorderingStatistics(uint16_t seq_num)
@@ -89,12 +104,16 @@ class NackModule : public Module {
   // TODO(philipel): Some of the variables below are consistently used on a
   // known thread (e.g. see |initialized_|). Those probably do not need
   // synchronized access.
-  std::map<uint16_t, NackInfo, DescendingSeqNumComp<uint16_t>> nack_list_
-      RTC_GUARDED_BY(crit_);
-  std::set<uint16_t, DescendingSeqNumComp<uint16_t>> keyframe_list_
-      RTC_GUARDED_BY(crit_);
-  std::set<uint16_t, DescendingSeqNumComp<uint16_t>> recovered_list_
-      RTC_GUARDED_BY(crit_);
+  SeqNumRingMap<NackInfo> nack_list_ RTC_GUARDED_BY(crit_);
+  // Packets of |nack_list_| in the order they were last nacked, which is also
+  // the order in which they become due to be nacked again. Entries for
+  // packets that have since been received, or nacked again, are skipped.
+  std::deque<SentNack> sent_nacks_ RTC_GUARDED_BY(crit_);
+  // All packets in |nack_list_| older than this have been nacked at least
+  // once. Unset if all of them have.
+  absl::optional<uint16_t> oldest_unsent_seq_num_ RTC_GUARDED_BY(crit_);
+  SeqNumRingSet<> keyframe_list_ RTC_GUARDED_BY(crit_);
+  SeqNumRingSet<> recovered_list_ RTC_GUARDED_BY(crit_);
   video_coding::Histogram reordering_histogram_ RTC_GUARDED_BY(crit_);
   bool initialized_ RTC_GUARDED_BY(crit_);
   int64_t rtt_ms_ RTC_GUARDED_BY(crit_);
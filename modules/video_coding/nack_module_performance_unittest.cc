@@ -0,0 +1,128 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "modules/video_coding/nack_module.h"
+#include "rtc_base/random.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/clock.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumSeconds = 60;
+constexpr int kQuickNumSeconds = 2;
+// Roughly a 30 Mbps stream of full size packets.
+constexpr int kPacketsPerMs = 3;
+constexpr int kKeyframeInterval = 3000;
+constexpr int64_t kRttMs = 100;
+constexpr int64_t kProcessIntervalMs = 20;
+
+class NullSender : public NackSender, public KeyFrameRequestSender {
+ public:
+  void SendNack(const std::vector<uint16_t>& sequence_numbers,
+                bool buffering_allowed) override {
+    num_nacked_ += sequence_numbers.size();
+  }
+  void RequestKeyFrame() override {}
+
+  size_t num_nacked() const { return num_nacked_; }
+
+ private:
+  size_t num_nacked_ = 0;
+};
+
+struct LossPattern {
+  std::string name;
+  // Probability that a packet is lost given the previous one was received,
+  // and probability that the loss continues given the previous one was lost.
+  double loss_probability;
+  double burst_probability;
+};
+
+// Feeds a stream with the given loss pattern through a NackModule, where
+// lost packets are retransmitted one RTT later. Returns the time spent in the
+// module per received packet.
+double MeasureNsPerPacket(const LossPattern& pattern,
+                          int num_seconds,
+                          size_t* num_nacked) {
+  SimulatedClock clock(0);
+  NullSender sender;
+  NackModule nack_module(&clock, &sender, &sender);
+  nack_module.UpdateRtt(kRttMs);
+  Random random(0x5eed);
+
+  // Retransmissions by arrival time.
+  std::multimap<int64_t, uint16_t> retransmissions;
+  uint16_t seq_num = 0;
+  bool lost = false;
+  int64_t elapsed_ns = 0;
+  int num_received = 0;
+  for (int64_t now_ms = 0; now_ms < num_seconds * 1000; ++now_ms) {
+    clock.AdvanceTimeMilliseconds(1);
+    const int64_t start_ns = rtc::TimeNanos();
+    for (int i = 0; i < kPacketsPerMs; ++i, ++seq_num) {
+      lost = random.Rand<double>() < (lost ? pattern.burst_probability
+                                           : pattern.loss_probability);
+      if (lost) {
+        retransmissions.emplace(now_ms + kRttMs, seq_num);
+        continue;
+      }
+      nack_module.OnReceivedPacket(seq_num, seq_num % kKeyframeInterval == 0,
+                                   false);
+      ++num_received;
+    }
+    while (!retransmissions.empty() &&
+           retransmissions.begin()->first <= now_ms) {
+      nack_module.OnReceivedPacket(retransmissions.begin()->second, false,
+                                   false);
+      retransmissions.erase(retransmissions.begin());
+      ++num_received;
+    }
+    if (now_ms % kProcessIntervalMs == 0)
+      nack_module.Process();
+    elapsed_ns += rtc::TimeNanos() - start_ns;
+  }
+  *num_nacked = sender.num_nacked();
+  return static_cast<double>(elapsed_ns) / num_received;
+}
+
+}  // namespace
+
+// Measures the cost of NACK bookkeeping for a high bitrate stream under
+// different loss patterns.
+TEST(NackModulePerformanceTest, LossPatterns) {
+  const int num_seconds = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                              ? kQuickNumSeconds
+                              : kNumSeconds;
+  const LossPattern kPatterns[] = {{"no_loss", 0.0, 0.0},
+                                   {"random_1_percent", 0.01, 0.01},
+                                   {"random_10_percent", 0.1, 0.1},
+                                   {"bursty_5_percent", 0.005, 0.9}};
+  for (const LossPattern& pattern : kPatterns) {
+    size_t num_nacked = 0;
+    const double ns_per_packet =
+        MeasureNsPerPacket(pattern, num_seconds, &num_nacked);
+    test::PrintResult("nack_module_time_per_packet", "", pattern.name,
+                      ns_per_packet, "ns", true);
+    test::PrintResult("nack_module_nacked_packets", "", pattern.name,
+                      num_nacked, "count", false);
+  }
+}
+
+}  // namespace webrtc
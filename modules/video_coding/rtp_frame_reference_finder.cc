@@ -22,13 +22,32 @@
 
 namespace webrtc {
 namespace video_coding {
+namespace {
+
+// Key of |layer_info_| and |gof_info_|. Only the most recent base layer frames
+// are kept, so 16 bits of the unwrapped TL0 picture index are plenty.
+uint16_t Tl0Key(int64_t unwrapped_tl0) {
+  return static_cast<uint16_t>(unwrapped_tl0);
+}
+
+}  // namespace
 
 RtpFrameReferenceFinder::RtpFrameReferenceFinder(
     OnCompleteFrameCallback* frame_callback)
     : last_picture_id_(-1),
       current_ss_idx_(0),
       cleared_to_seq_num_(-1),
-      frame_callback_(frame_callback) {}
+      frame_callback_(frame_callback) {
+  // Size the state from the limits above, so that frames can be handled
+  // without allocating.
+  stashed_padding_.reserve(kMaxPaddingAge);
+  not_yet_received_frames_.reserve(kMaxNotYetReceivedFrames);
+  not_yet_received_seq_num_.reserve(2 * kMaxNotYetReceivedFrames);
+  stashed_frames_.reserve(kMaxStashedFrames + 1);
+  layer_info_.reserve(kMaxLayerInfo);
+  gof_info_.reserve(kMaxGofSaved);
+  up_switch_.reserve(kMaxUpSwitchAge);
+}
 
 RtpFrameReferenceFinder::~RtpFrameReferenceFinder() = default;
 
@@ -47,8 +66,8 @@ void RtpFrameReferenceFinder::ManageFrame(
   switch (decision) {
     case kStash:
       if (stashed_frames_.size() > kMaxStashedFrames)
-        stashed_frames_.pop_back();
-      stashed_frames_.push_front(std::move(frame));
+        stashed_frames_.erase(stashed_frames_.begin());
+      stashed_frames_.push_back(std::move(frame));
       break;
     case kHandOff:
       frame_callback_->OnCompleteFrame(std::move(frame));
@@ -63,22 +82,26 @@ void RtpFrameReferenceFinder::RetryStashedFrames() {
   bool complete_frame = false;
   do {
     complete_frame = false;
-    for (auto frame_it = stashed_frames_.begin();
-         frame_it != stashed_frames_.end();) {
+    // Retry the most recently stashed frames first, and remove the frames that
+    // were handed off or dropped once done.
+    for (auto frame_it = stashed_frames_.rbegin();
+         frame_it != stashed_frames_.rend(); ++frame_it) {
       FrameDecision decision = ManageFrameInternal(frame_it->get());
 
       switch (decision) {
         case kStash:
-          ++frame_it;
           break;
         case kHandOff:
           complete_frame = true;
           frame_callback_->OnCompleteFrame(std::move(*frame_it));
           RTC_FALLTHROUGH();
         case kDrop:
-          frame_it = stashed_frames_.erase(frame_it);
+          frame_it->reset();
       }
     }
+    stashed_frames_.erase(
+        std::remove(stashed_frames_.begin(), stashed_frames_.end(), nullptr),
+        stashed_frames_.end());
   } while (complete_frame);
 }
 
@@ -114,7 +137,7 @@ void RtpFrameReferenceFinder::PaddingReceived(uint16_t seq_num) {
   auto clean_padding_to =
       stashed_padding_.lower_bound(seq_num - kMaxPaddingAge);
   stashed_padding_.erase(stashed_padding_.begin(), clean_padding_to);
-  stashed_padding_.insert(seq_num);
+  stashed_padding_.emplace(seq_num);
   UpdateLastPictureIdWithPadding(seq_num);
   RetryStashedFrames();
 }
@@ -123,14 +146,13 @@ void RtpFrameReferenceFinder::ClearTo(uint16_t seq_num) {
   rtc::CritScope lock(&crit_);
   cleared_to_seq_num_ = seq_num;
 
-  auto it = stashed_frames_.begin();
-  while (it != stashed_frames_.end()) {
-    if (AheadOf<uint16_t>(cleared_to_seq_num_, (*it)->first_seq_num())) {
-      it = stashed_frames_.erase(it);
-    } else {
-      ++it;
-    }
-  }
+  stashed_frames_.erase(
+      std::remove_if(stashed_frames_.begin(), stashed_frames_.end(),
+                     [seq_num](const std::unique_ptr<RtpFrameObject>& frame) {
+                       return AheadOf<uint16_t>(seq_num,
+                                                frame->first_seq_num());
+                     }),
+      stashed_frames_.end());
 }
 
 void RtpFrameReferenceFinder::UpdateLastPictureIdWithPadding(uint16_t seq_num) {
@@ -152,7 +174,7 @@ void RtpFrameReferenceFinder::UpdateLastPictureIdWithPadding(uint16_t seq_num) {
   // continuous, then advance the "last-picture-id-with-padding" and remove
   // the stashed padding packet.
   while (padding_seq_num_it != stashed_padding_.end() &&
-         *padding_seq_num_it == next_seq_num_with_padding) {
+         padding_seq_num_it->first == next_seq_num_with_padding) {
     gop_seq_num_it->second.second = next_seq_num_with_padding;
     ++next_seq_num_with_padding;
     padding_seq_num_it = stashed_padding_.erase(padding_seq_num_it);
@@ -164,8 +186,9 @@ void RtpFrameReferenceFinder::UpdateLastPictureIdWithPadding(uint16_t seq_num) {
   // to prevent this we advance the picture id of the keyframe every so often.
   if (ForwardDiff(gop_seq_num_it->first, seq_num) > 10000) {
     RTC_DCHECK_EQ(1ul, last_seq_num_gop_.size());
-    last_seq_num_gop_[seq_num] = gop_seq_num_it->second;
+    const std::pair<uint16_t, uint16_t> last_seq_nums = gop_seq_num_it->second;
     last_seq_num_gop_.erase(gop_seq_num_it);
+    last_seq_num_gop_.emplace(seq_num, last_seq_nums);
   }
 }
 
@@ -216,10 +239,9 @@ RtpFrameReferenceFinder::ManageFramePidOrSeqNum(RtpFrameObject* frame,
   // Clean up info for old keyframes but make sure to keep info
   // for the last keyframe.
   auto clean_to = last_seq_num_gop_.lower_bound(frame->last_seq_num() - 100);
-  for (auto it = last_seq_num_gop_.begin();
-       it != clean_to && last_seq_num_gop_.size() > 1;) {
-    it = last_seq_num_gop_.erase(it);
-  }
+  if (clean_to == last_seq_num_gop_.end())
+    --clean_to;
+  last_seq_num_gop_.erase(last_seq_num_gop_.begin(), clean_to);
 
   // Find the last sequence number of the last frame for the keyframe
   // that this frame indirectly references.
@@ -292,7 +314,7 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp8(
   if (AheadOf<uint16_t, kPicIdLength>(frame->id.picture_id, last_picture_id_)) {
     do {
       last_picture_id_ = Add<kPicIdLength>(last_picture_id_, 1);
-      not_yet_received_frames_.insert(last_picture_id_);
+      not_yet_received_frames_.emplace(last_picture_id_);
     } while (last_picture_id_ != frame->id.picture_id);
   }
 
@@ -300,7 +322,7 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp8(
 
   // Clean up info for base layers that are too old.
   int64_t old_tl0_pic_idx = unwrapped_tl0 - kMaxLayerInfo;
-  auto clean_layer_info_to = layer_info_.lower_bound(old_tl0_pic_idx);
+  auto clean_layer_info_to = layer_info_.lower_bound(Tl0Key(old_tl0_pic_idx));
   layer_info_.erase(layer_info_.begin(), clean_layer_info_to);
 
   // Clean up info about not yet received frames that are too old.
@@ -312,13 +334,13 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp8(
 
   if (frame->frame_type() == VideoFrameType::kVideoFrameKey) {
     frame->num_references = 0;
-    layer_info_[unwrapped_tl0].fill(-1);
+    layer_info_.emplace(Tl0Key(unwrapped_tl0)).first->second.fill(-1);
     UpdateLayerInfoVp8(frame, unwrapped_tl0, codec_header.temporalIdx);
     return kHandOff;
   }
 
-  auto layer_info_it = layer_info_.find(
-      codec_header.temporalIdx == 0 ? unwrapped_tl0 - 1 : unwrapped_tl0);
+  auto layer_info_it = layer_info_.find(Tl0Key(
+      codec_header.temporalIdx == 0 ? unwrapped_tl0 - 1 : unwrapped_tl0));
 
   // If we don't have the base layer frame yet, stash this frame.
   if (layer_info_it == layer_info_.end())
@@ -329,7 +351,7 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp8(
   // base layer frame.
   if (codec_header.temporalIdx == 0) {
     layer_info_it =
-        layer_info_.emplace(unwrapped_tl0, layer_info_it->second).first;
+        layer_info_.emplace(Tl0Key(unwrapped_tl0), layer_info_it->second).first;
     frame->num_references = 1;
     frame->references[0] = layer_info_it->second[0];
     UpdateLayerInfoVp8(frame, unwrapped_tl0, codec_header.temporalIdx);
@@ -367,7 +389,7 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp8(
         not_yet_received_frames_.upper_bound(layer_info_it->second[layer]);
     if (not_received_frame_it != not_yet_received_frames_.end() &&
         AheadOf<uint16_t, kPicIdLength>(frame->id.picture_id,
-                                        *not_received_frame_it)) {
+                                        not_received_frame_it->first)) {
       return kStash;
     }
 
@@ -392,7 +414,7 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp8(
 void RtpFrameReferenceFinder::UpdateLayerInfoVp8(RtpFrameObject* frame,
                                                  int64_t unwrapped_tl0,
                                                  uint8_t temporal_idx) {
-  auto layer_info_it = layer_info_.find(unwrapped_tl0);
+  auto layer_info_it = layer_info_.find(Tl0Key(unwrapped_tl0));
 
   // Update this layer info and newer.
   while (layer_info_it != layer_info_.end()) {
@@ -406,7 +428,7 @@ void RtpFrameReferenceFinder::UpdateLayerInfoVp8(RtpFrameObject* frame,
 
     layer_info_it->second[temporal_idx] = frame->id.picture_id;
     ++unwrapped_tl0;
-    layer_info_it = layer_info_.find(unwrapped_tl0);
+    layer_info_it = layer_info_.find(Tl0Key(unwrapped_tl0));
   }
   not_yet_received_frames_.erase(frame->id.picture_id);
 
@@ -476,12 +498,12 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp9(
       current_ss_idx_ = Add<kMaxGofSaved>(current_ss_idx_, 1);
       scalability_structures_[current_ss_idx_] = gof;
       scalability_structures_[current_ss_idx_].pid_start = frame->id.picture_id;
-      gof_info_.emplace(unwrapped_tl0,
+      gof_info_.emplace(Tl0Key(unwrapped_tl0),
                         GofInfo(&scalability_structures_[current_ss_idx_],
                                 frame->id.picture_id));
     }
 
-    const auto gof_info_it = gof_info_.find(unwrapped_tl0);
+    const auto gof_info_it = gof_info_.find(Tl0Key(unwrapped_tl0));
     if (gof_info_it == gof_info_.end())
       return kStash;
 
@@ -498,7 +520,7 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp9(
       RTC_LOG(LS_WARNING) << "Received keyframe without scalability structure";
       return kDrop;
     }
-    const auto gof_info_it = gof_info_.find(unwrapped_tl0);
+    const auto gof_info_it = gof_info_.find(Tl0Key(unwrapped_tl0));
     if (gof_info_it == gof_info_.end())
       return kStash;
 
@@ -511,18 +533,19 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp9(
       return kHandOff;
     }
   } else {
-    auto gof_info_it = gof_info_.find(
-        (codec_header.temporal_idx == 0) ? unwrapped_tl0 - 1 : unwrapped_tl0);
+    auto gof_info_it = gof_info_.find(Tl0Key(
+        (codec_header.temporal_idx == 0) ? unwrapped_tl0 - 1 : unwrapped_tl0));
 
     // Gof info for this frame is not available yet, stash this frame.
     if (gof_info_it == gof_info_.end())
       return kStash;
 
     if (codec_header.temporal_idx == 0) {
-      gof_info_it = gof_info_
-                        .emplace(unwrapped_tl0, GofInfo(gof_info_it->second.gof,
-                                                        frame->id.picture_id))
-                        .first;
+      gof_info_it =
+          gof_info_
+              .emplace(Tl0Key(unwrapped_tl0),
+                       GofInfo(gof_info_it->second.gof, frame->id.picture_id))
+              .first;
     }
 
     info = &gof_info_it->second;
@@ -530,7 +553,7 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp9(
 
   // Clean up info for base layers that are too old.
   int64_t old_tl0_pic_idx = unwrapped_tl0 - kMaxGofSaved;
-  auto clean_gof_info_to = gof_info_.lower_bound(old_tl0_pic_idx);
+  auto clean_gof_info_to = gof_info_.lower_bound(Tl0Key(old_tl0_pic_idx));
   gof_info_.erase(gof_info_.begin(), clean_gof_info_to);
 
   FrameReceivedVp9(frame->id.picture_id, info);
@@ -544,7 +567,8 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp9(
     up_switch_.emplace(frame->id.picture_id, codec_header.temporal_idx);
 
   // Clean out old info about up switch frames.
-  uint16_t old_picture_id = Subtract<kPicIdLength>(frame->id.picture_id, 50);
+  uint16_t old_picture_id =
+      Subtract<kPicIdLength>(frame->id.picture_id, kMaxUpSwitchAge);
   auto up_switch_erase_to = up_switch_.lower_bound(old_picture_id);
   up_switch_.erase(up_switch_.begin(), up_switch_erase_to);
 
@@ -598,7 +622,8 @@ bool RtpFrameReferenceFinder::MissingRequiredFrameVp9(uint16_t picture_id,
     for (size_t l = 0; l < temporal_idx; ++l) {
       auto missing_frame_it = missing_frames_for_layer_[l].lower_bound(ref_pid);
       if (missing_frame_it != missing_frames_for_layer_[l].end() &&
-          AheadOf<uint16_t, kPicIdLength>(picture_id, *missing_frame_it)) {
+          AheadOf<uint16_t, kPicIdLength>(picture_id,
+                                          missing_frame_it->first)) {
         return true;
       }
     }
@@ -631,7 +656,7 @@ void RtpFrameReferenceFinder::FrameReceivedVp9(uint16_t picture_id,
         return;
       }
 
-      missing_frames_for_layer_[temporal_idx].insert(last_picture_id);
+      missing_frames_for_layer_[temporal_idx].emplace(last_picture_id);
       last_picture_id = Add<kPicIdLength>(last_picture_id, 1);
     }
 
@@ -707,7 +732,7 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameH264(
     if (AheadOf<uint16_t>(frame->id.picture_id, last_pic_id_padded)) {
       do {
         last_pic_id_padded = last_pic_id_padded + 1;
-        not_yet_received_seq_num_.insert(last_pic_id_padded);
+        not_yet_received_seq_num_.emplace(last_pic_id_padded);
       } while (last_pic_id_padded != frame->id.picture_id);
     }
   }
@@ -716,7 +741,7 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameH264(
 
   // Clean up info for base layers that are too old.
   int64_t old_tl0_pic_idx = unwrapped_tl0 - kMaxLayerInfo;
-  auto clean_layer_info_to = layer_info_.lower_bound(old_tl0_pic_idx);
+  auto clean_layer_info_to = layer_info_.lower_bound(Tl0Key(old_tl0_pic_idx));
   layer_info_.erase(layer_info_.begin(), clean_layer_info_to);
 
   // Clean up info about not yet received frames that are too old.
@@ -727,13 +752,13 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameH264(
 
   if (frame->frame_type() == VideoFrameType::kVideoFrameKey) {
     frame->num_references = 0;
-    layer_info_[unwrapped_tl0].fill(-1);
+    layer_info_.emplace(Tl0Key(unwrapped_tl0)).first->second.fill(-1);
     UpdateDataH264(frame, unwrapped_tl0, tid);
     return kHandOff;
   }
 
-  auto layer_info_it = layer_info_.find(
-      tid == 0 ? unwrapped_tl0 - 1 : unwrapped_tl0);
+  auto layer_info_it =
+      layer_info_.find(Tl0Key(tid == 0 ? unwrapped_tl0 - 1 : unwrapped_tl0));
 
   // Stash if we have no base layer frame yet.
   if (layer_info_it == layer_info_.end())
@@ -741,8 +766,8 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameH264(
 
   // Base layer frame. Copy layer info from previous base layer frame.
   if (tid == 0) {
-    layer_info_it = layer_info_.insert(
-        std::make_pair(unwrapped_tl0, layer_info_it->second)).first;
+    layer_info_it =
+        layer_info_.emplace(Tl0Key(unwrapped_tl0), layer_info_it->second).first;
     frame->num_references = 1;
     frame->references[0] = layer_info_it->second[0];
     UpdateDataH264(frame, unwrapped_tl0, tid);
@@ -774,7 +799,8 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameH264(
     auto not_received_seq_num_it =
         not_yet_received_seq_num_.upper_bound(last_frame_in_layer);
     if (not_received_seq_num_it != not_yet_received_seq_num_.end() &&
-        AheadOf<uint16_t>(frame->id.picture_id, *not_received_seq_num_it)) {
+        AheadOf<uint16_t>(frame->id.picture_id,
+                          not_received_seq_num_it->first)) {
       return kStash;
     }
 
@@ -805,7 +831,7 @@ void RtpFrameReferenceFinder::UpdateLastPictureIdWithPaddingH264() {
   // Check for more consecutive padding packets to increment
   // the "last-picture-id-with-padding" and remove the stashed packets.
   while (padding_seq_num_it != stashed_padding_.end() &&
-         *padding_seq_num_it == next_padded_seq_num) {
+         padding_seq_num_it->first == next_padded_seq_num) {
     seq_num_it->second.second = next_padded_seq_num;
     ++next_padded_seq_num;
     padding_seq_num_it = stashed_padding_.erase(padding_seq_num_it);
@@ -815,7 +841,7 @@ void RtpFrameReferenceFinder::UpdateLastPictureIdWithPaddingH264() {
 void RtpFrameReferenceFinder::UpdateLayerInfoH264(RtpFrameObject* frame,
                                                   int64_t unwrapped_tl0,
                                                   uint8_t temporal_idx) {
-  auto layer_info_it = layer_info_.find(unwrapped_tl0);
+  auto layer_info_it = layer_info_.find(Tl0Key(unwrapped_tl0));
 
   // Update this layer info and newer.
   while (layer_info_it != layer_info_.end()) {
@@ -828,7 +854,7 @@ void RtpFrameReferenceFinder::UpdateLayerInfoH264(RtpFrameObject* frame,
 
     layer_info_it->second[temporal_idx] = frame->id.picture_id;
     ++unwrapped_tl0;
-    layer_info_it = layer_info_.find(unwrapped_tl0);
+    layer_info_it = layer_info_.find(Tl0Key(unwrapped_tl0));
   }
 
   for (size_t i = 0; i < frame->num_references; ++i)
@@ -12,15 +12,14 @@
 #define MODULES_VIDEO_CODING_RTP_FRAME_REFERENCE_FINDER_H_
 
 #include <array>
-#include <deque>
-#include <map>
 #include <memory>
-#include <set>
 #include <utility>
+#include <vector>
 
 #include "modules/include/module_common_types.h"
 #include "modules/rtp_rtcp/source/rtp_generic_frame_descriptor.h"
 #include "rtc_base/critical_section.h"
+#include "rtc_base/numerics/seq_num_ring_map.h"
 #include "rtc_base/numerics/sequence_number_util.h"
 #include "rtc_base/thread_annotations.h"
 
@@ -66,10 +65,12 @@ class RtpFrameReferenceFinder {
   static const int kMaxNotYetReceivedFrames = 100;
   static const int kMaxGofSaved = 50;
   static const int kMaxPaddingAge = 100;
+  static const int kMaxUpSwitchAge = 50;
 
   enum FrameDecision { kStash, kHandOff, kDrop };
 
   struct GofInfo {
+    GofInfo() : gof(nullptr), last_picture_id(0) {}
     GofInfo(GofInfoVP9* gof, uint16_t last_picture_id)
         : gof(gof), last_picture_id(last_picture_id) {}
     GofInfoVP9* gof;
@@ -160,10 +161,8 @@ class RtpFrameReferenceFinder {
   // the sequence number of the last packet of the last completed frame, and
   // the second being the sequence number of the last packet of the last
   // completed frame advanced by any potential continuous packets of padding.
-  std::map<uint16_t,
-           std::pair<uint16_t, uint16_t>,
-           DescendingSeqNumComp<uint16_t>>
-      last_seq_num_gop_ RTC_GUARDED_BY(crit_);
+  SeqNumRingMap<std::pair<uint16_t, uint16_t>> last_seq_num_gop_
+      RTC_GUARDED_BY(crit_);
 
   // Save the last picture id in order to detect when there is a gap in frames
   // that have not yet been fully received.
@@ -171,27 +170,24 @@ class RtpFrameReferenceFinder {
 
   // Padding packets that have been received but that are not yet continuous
   // with any group of pictures.
-  std::set<uint16_t, DescendingSeqNumComp<uint16_t>> stashed_padding_
-      RTC_GUARDED_BY(crit_);
+  SeqNumRingSet<> stashed_padding_ RTC_GUARDED_BY(crit_);
 
   // Frames earlier than the last received frame that have not yet been
   // fully received.
-  std::set<uint16_t, DescendingSeqNumComp<uint16_t, kPicIdLength>>
-      not_yet_received_frames_ RTC_GUARDED_BY(crit_);
+  SeqNumRingSet<kPicIdLength> not_yet_received_frames_ RTC_GUARDED_BY(crit_);
 
   // Sequence numbers of frames earlier than the last received frame that
   // have not yet been fully received.
-  std::set<uint16_t, DescendingSeqNumComp<uint16_t>>
-      not_yet_received_seq_num_ RTC_GUARDED_BY(crit_);
+  SeqNumRingSet<> not_yet_received_seq_num_ RTC_GUARDED_BY(crit_);
 
   // Frames that have been fully received but didn't have all the information
-  // needed to determine their references.
-  std::deque<std::unique_ptr<RtpFrameObject>> stashed_frames_
+  // needed to determine their references, from the oldest to the newest.
+  std::vector<std::unique_ptr<RtpFrameObject>> stashed_frames_
       RTC_GUARDED_BY(crit_);
 
   // Holds the information about the last completed frame for a given temporal
-  // layer given an unwrapped Tl0 picture index.
-  std::map<int64_t, std::array<int64_t, kMaxTemporalLayers>> layer_info_
+  // layer given an unwrapped Tl0 picture index, truncated to 16 bits.
+  SeqNumRingMap<std::array<int64_t, kMaxTemporalLayers>> layer_info_
       RTC_GUARDED_BY(crit_);
 
   // Where the current scalability structure is in the
@@ -202,17 +198,16 @@ class RtpFrameReferenceFinder {
   std::array<GofInfoVP9, kMaxGofSaved> scalability_structures_
       RTC_GUARDED_BY(crit_);
 
-  // Holds the the Gof information for a given unwrapped TL0 picture index.
-  std::map<int64_t, GofInfo> gof_info_ RTC_GUARDED_BY(crit_);
+  // Holds the the Gof information for a given unwrapped TL0 picture index,
+  // truncated to 16 bits.
+  SeqNumRingMap<GofInfo> gof_info_ RTC_GUARDED_BY(crit_);
 
   // Keep track of which picture id and which temporal layer that had the
   // up switch flag set.
-  std::map<uint16_t, uint8_t, DescendingSeqNumComp<uint16_t, kPicIdLength>>
-      up_switch_ RTC_GUARDED_BY(crit_);
+  SeqNumRingMap<uint8_t, kPicIdLength> up_switch_ RTC_GUARDED_BY(crit_);
 
   // For every temporal layer, keep a set of which frames that are missing.
-  std::array<std::set<uint16_t, DescendingSeqNumComp<uint16_t, kPicIdLength>>,
-             kMaxTemporalLayers>
+  std::array<SeqNumRingSet<kPicIdLength>, kMaxTemporalLayers>
       missing_frames_for_layer_ RTC_GUARDED_BY(crit_);
 
   // How far frames have been cleared by sequence number. A frame will be
@@ -0,0 +1,272 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "modules/video_coding/frame_object.h"
+#include "modules/video_coding/packet_buffer.h"
+#include "modules/video_coding/rtp_frame_reference_finder.h"
+#include "rtc_base/random.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace video_coding {
+namespace {
+
+constexpr int kNumSeconds = 60;
+constexpr int kQuickNumSeconds = 2;
+constexpr int kFps = 60;
+constexpr int kKeyframeInterval = 600;
+constexpr int kNumSpatialLayers = 3;
+// Lost frames are retransmitted and arrive this many frames later.
+constexpr int kRetransmissionDelayFrames = 6;
+// How often, and how far behind the newest frame, the receiver clears frames
+// that were not decoded, as RtpVideoStreamReceiver does for decoded frames.
+constexpr int kClearIntervalFrames = 30;
+constexpr uint16_t kClearDelayPackets = 100;
+// The temporal layer of each frame in a 0212 temporal structure.
+constexpr uint8_t kTemporalPattern[] = {0, 2, 1, 2};
+
+// The first frames of the upper temporal layers after a keyframe are layer
+// sync frames.
+bool IsLayerSync(int picture_index) {
+  const int index_in_gop = picture_index % kKeyframeInterval;
+  return index_in_gop == 1 || index_in_gop == 2;
+}
+
+class FakePacketBuffer : public PacketBuffer {
+ public:
+  FakePacketBuffer() : PacketBuffer(nullptr, 0, 0, nullptr) {}
+
+  VCMPacket* GetPacket(uint16_t seq_num) override {
+    auto packet_it = packets_.find(seq_num);
+    return packet_it == packets_.end() ? nullptr : &packet_it->second;
+  }
+
+  bool InsertPacket(VCMPacket* packet) override {
+    packets_[packet->seqNum] = *packet;
+    return true;
+  }
+
+  bool GetBitstream(const RtpFrameObject& frame,
+                    uint8_t* destination) override {
+    return true;
+  }
+
+  void ReturnFrame(RtpFrameObject* frame) override {}
+
+ private:
+  std::map<uint16_t, VCMPacket> packets_;
+};
+
+// Keeps the complete frames, so that destroying them is not measured.
+class CompleteFrames : public OnCompleteFrameCallback {
+ public:
+  explicit CompleteFrames(size_t max_frames) { frames_.reserve(max_frames); }
+
+  void OnCompleteFrame(std::unique_ptr<EncodedFrame> frame) override {
+    frames_.push_back(std::move(frame));
+  }
+
+  size_t size() const { return frames_.size(); }
+
+ private:
+  std::vector<std::unique_ptr<EncodedFrame>> frames_;
+};
+
+// Builds the frames of a synthetic stream, one packet per frame, in the order
+// they were sent.
+class StreamBuilder {
+ public:
+  explicit StreamBuilder(rtc::scoped_refptr<FakePacketBuffer> packet_buffer)
+      : packet_buffer_(packet_buffer) {}
+
+  void AddFrame(VCMPacket* packet) {
+    packet->seqNum = seq_num_++;
+    packet->video_header.is_last_packet_in_frame = true;
+    packet->markerBit = true;
+    packet_buffer_->InsertPacket(packet);
+    frames_.emplace_back(new RtpFrameObject(
+        packet_buffer_, packet->seqNum, packet->seqNum, 0, 0, 0, 0, {}));
+  }
+
+  std::vector<std::unique_ptr<RtpFrameObject>> Release() {
+    return std::move(frames_);
+  }
+
+ private:
+  const rtc::scoped_refptr<FakePacketBuffer> packet_buffer_;
+  uint16_t seq_num_ = 0;
+  std::vector<std::unique_ptr<RtpFrameObject>> frames_;
+};
+
+VCMPacket FramePacket(VideoCodecType codec, bool keyframe) {
+  VCMPacket packet;
+  packet.video_header.codec = codec;
+  packet.video_header.frame_type = keyframe ? VideoFrameType::kVideoFrameKey
+                                            : VideoFrameType::kVideoFrameDelta;
+  return packet;
+}
+
+void BuildVp8TemporalLayers(int num_pictures, StreamBuilder* builder) {
+  uint8_t tl0_pic_idx = 0;
+  for (int i = 0; i < num_pictures; ++i) {
+    const uint8_t temporal_idx = kTemporalPattern[i % 4];
+    if (temporal_idx == 0 && i > 0)
+      ++tl0_pic_idx;
+    VCMPacket packet =
+        FramePacket(kVideoCodecVP8, i % kKeyframeInterval == 0);
+    auto& vp8_header =
+        packet.video_header.video_type_header.emplace<RTPVideoHeaderVP8>();
+    vp8_header.pictureId = i % (1 << 15);
+    vp8_header.temporalIdx = temporal_idx;
+    vp8_header.tl0PicIdx = tl0_pic_idx;
+    vp8_header.layerSync = IsLayerSync(i);
+    builder->AddFrame(&packet);
+  }
+}
+
+void BuildVp9Svc(int num_pictures, StreamBuilder* builder) {
+  GofInfoVP9 gof;
+  gof.SetGofInfoVP9(kTemporalStructureMode3);
+  uint8_t tl0_pic_idx = 0;
+  for (int i = 0; i < num_pictures; ++i) {
+    const bool key_picture = i % kKeyframeInterval == 0;
+    const size_t gof_idx = i % gof.num_frames_in_gof;
+    if (gof.temporal_idx[gof_idx] == 0 && i > 0)
+      ++tl0_pic_idx;
+    for (int spatial_idx = 0; spatial_idx < kNumSpatialLayers; ++spatial_idx) {
+      VCMPacket packet =
+          FramePacket(kVideoCodecVP9, key_picture && spatial_idx == 0);
+      packet.timestamp = i;
+      auto& vp9_header =
+          packet.video_header.video_type_header.emplace<RTPVideoHeaderVP9>();
+      vp9_header.flexible_mode = false;
+      vp9_header.picture_id = i % (1 << 15);
+      vp9_header.spatial_idx = spatial_idx;
+      vp9_header.temporal_idx = gof.temporal_idx[gof_idx];
+      vp9_header.tl0_pic_idx = tl0_pic_idx;
+      vp9_header.temporal_up_switch = gof.temporal_up_switch[gof_idx];
+      vp9_header.inter_layer_predicted = spatial_idx > 0;
+      vp9_header.inter_pic_predicted = !key_picture;
+      if (key_picture && spatial_idx == 0) {
+        vp9_header.ss_data_available = true;
+        vp9_header.gof = gof;
+      }
+      builder->AddFrame(&packet);
+    }
+  }
+}
+
+void BuildH264TemporalLayers(int num_pictures, StreamBuilder* builder) {
+  uint8_t tl0_pic_idx = 0;
+  for (int i = 0; i < num_pictures; ++i) {
+    const uint8_t temporal_idx = kTemporalPattern[i % 4];
+    if (temporal_idx == 0 && i > 0)
+      ++tl0_pic_idx;
+    VCMPacket packet =
+        FramePacket(kVideoCodecH264, i % kKeyframeInterval == 0);
+    packet.video_header.frame_marking.temporal_id = temporal_idx;
+    packet.video_header.frame_marking.tl0_pic_idx = tl0_pic_idx;
+    packet.video_header.frame_marking.base_layer_sync = IsLayerSync(i);
+    builder->AddFrame(&packet);
+  }
+}
+
+// Reorders |frames| as if a |loss_rate| fraction of them was lost and
+// retransmitted, and neighbouring frames were swapped with probability
+// |reorder_rate|.
+void ApplyNetwork(double loss_rate,
+                  double reorder_rate,
+                  std::vector<std::unique_ptr<RtpFrameObject>>* frames) {
+  Random random(0x5eed);
+  std::vector<std::unique_ptr<RtpFrameObject>> received;
+  std::multimap<size_t, std::unique_ptr<RtpFrameObject>> retransmissions;
+  for (size_t i = 0; i < frames->size(); ++i) {
+    if (random.Rand<double>() < loss_rate) {
+      retransmissions.emplace(i + kRetransmissionDelayFrames,
+                              std::move((*frames)[i]));
+    } else {
+      received.push_back(std::move((*frames)[i]));
+      if (received.size() > 1 && random.Rand<double>() < reorder_rate)
+        std::swap(received.back(), received[received.size() - 2]);
+    }
+    while (!retransmissions.empty() && retransmissions.begin()->first <= i) {
+      received.push_back(std::move(retransmissions.begin()->second));
+      retransmissions.erase(retransmissions.begin());
+    }
+  }
+  for (auto& retransmission : retransmissions)
+    received.push_back(std::move(retransmission.second));
+  *frames = std::move(received);
+}
+
+struct Scenario {
+  std::string name;
+  void (*build)(int num_pictures, StreamBuilder* builder);
+  double loss_rate;
+  double reorder_rate;
+};
+
+}  // namespace
+
+// Measures the time RtpFrameReferenceFinder spends per frame for streams with
+// temporal and spatial layers, with and without loss and reordering.
+TEST(RtpFrameReferenceFinderPerformanceTest, LayeredStreams) {
+  const int num_seconds = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                              ? kQuickNumSeconds
+                              : kNumSeconds;
+  const Scenario kScenarios[] = {
+      {"vp8_3tl", &BuildVp8TemporalLayers, 0.0, 0.0},
+      {"vp8_3tl_lossy", &BuildVp8TemporalLayers, 0.05, 0.05},
+      {"vp9_3sl_3tl", &BuildVp9Svc, 0.0, 0.0},
+      {"vp9_3sl_3tl_lossy", &BuildVp9Svc, 0.05, 0.05},
+      {"h264_3tl", &BuildH264TemporalLayers, 0.0, 0.0},
+      {"h264_3tl_lossy", &BuildH264TemporalLayers, 0.05, 0.05}};
+  for (const Scenario& scenario : kScenarios) {
+    rtc::scoped_refptr<FakePacketBuffer> packet_buffer(new FakePacketBuffer());
+    StreamBuilder builder(packet_buffer);
+    scenario.build(kFps * num_seconds, &builder);
+    std::vector<std::unique_ptr<RtpFrameObject>> frames = builder.Release();
+    ApplyNetwork(scenario.loss_rate, scenario.reorder_rate, &frames);
+    const size_t num_frames = frames.size();
+
+    CompleteFrames complete_frames(num_frames);
+    RtpFrameReferenceFinder reference_finder(&complete_frames);
+    const int64_t start_ns = rtc::TimeNanos();
+    for (size_t i = 0; i < num_frames; ++i) {
+      const uint16_t seq_num = frames[i]->first_seq_num();
+      reference_finder.ManageFrame(std::move(frames[i]));
+      if (i % kClearIntervalFrames == 0)
+        reference_finder.ClearTo(seq_num - kClearDelayPackets);
+    }
+    const int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+
+    EXPECT_GT(complete_frames.size(), 0u);
+    test::PrintResult("reference_finder_time_per_frame", "", scenario.name,
+                      static_cast<double>(elapsed_ns) / num_frames, "ns",
+                      true);
+    test::PrintResult("reference_finder_complete_frames", "", scenario.name,
+                      complete_frames.size(), "count", false);
+  }
+}
+
+}  // namespace video_coding
+}  // namespace webrtc
@@ -217,7 +217,8 @@ void ConnectionRequest::Prepare(StunMessage* request) {
       STUN_ATTR_PRIORITY, prflx_priority));
 
   // Adding Message Integrity attribute.
-  request->AddMessageIntegrity(connection_->remote_candidate().password());
+  request->AddMessageIntegrity(connection_->remote_password_key_.Get(
+      connection_->remote_candidate().password()));
   // Adding Fingerprint.
   request->AddFingerprint();
 }
@@ -455,8 +456,9 @@ void Connection::OnReadPacket(const char* data,
       // id's match.
       case STUN_BINDING_RESPONSE:
       case STUN_BINDING_ERROR_RESPONSE:
-        if (msg->ValidateMessageIntegrity(data, size,
-                                          remote_candidate().password())) {
+        if (msg->ValidateMessageIntegrity(
+                data, size,
+                remote_password_key_.Get(remote_candidate().password()))) {
           requests_.CheckResponse(msg.get());
         }
         // Otherwise silently discard the response message.
@@ -362,6 +362,8 @@ class Connection : public CandidatePairInterface,
   uint32_t remote_nomination_ = 0;
 
   IceMode remote_ice_mode_;
+  // Keyed with the remote password, for the pings sent and their responses.
+  StunMessageIntegrityKey remote_password_key_;
   StunRequestManager requests_;
   int rtt_;
   int rtt_samples_ = 0;
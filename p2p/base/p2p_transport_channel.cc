@@ -10,6 +10,8 @@
 
 #include "p2p/base/p2p_transport_channel.h"
 
+#include <algorithm>
+#include <functional>
 #include <iterator>
 #include <set>
 #include <utility>
@@ -94,6 +96,36 @@ uint32_t GetWeakPingIntervalInFieldTrial() {
   return cricket::WEAK_PING_INTERVAL;
 }
 
+// Sorts |connections| like a stable sort, by finding the runs that are already
+// sorted and merging them. Since the connections are sorted every time one of
+// them changes, usually only a few of them are out of place, and the sort
+// takes close to linear time.
+template <typename Compare>
+void MergeSortedRuns(std::vector<cricket::Connection*>* connections,
+                     Compare comp) {
+  std::vector<size_t> run_bounds = {0};
+  for (size_t i = 1; i < connections->size(); ++i) {
+    if (comp((*connections)[i], (*connections)[i - 1]))
+      run_bounds.push_back(i);
+  }
+  run_bounds.push_back(connections->size());
+  // Merge adjacent runs pairwise until there is only one run left. Merging
+  // adjacent runs keeps the order of equal connections.
+  auto begin = connections->begin();
+  while (run_bounds.size() > 2) {
+    std::vector<size_t> merged_bounds = {0};
+    for (size_t i = 0; i + 2 < run_bounds.size(); i += 2) {
+      std::inplace_merge(begin + run_bounds[i], begin + run_bounds[i + 1],
+                         begin + run_bounds[i + 2], comp);
+      merged_bounds.push_back(run_bounds[i + 2]);
+    }
+    // With an odd number of runs, the last one is merged in the next round.
+    if (run_bounds.size() % 2 == 0)
+      merged_bounds.push_back(run_bounds.back());
+    run_bounds = std::move(merged_bounds);
+  }
+}
+
 }  // unnamed namespace
 
 namespace cricket {
@@ -1694,10 +1726,8 @@ int P2PTransportChannel::CompareConnectionCandidates(
   // want to use the new candidates and purge the old candidates as they come
   // in, so use the fact that the old ports get pruned immediately to rank the
   // candidates with an active port/remote candidate higher.
-  bool a_pruned = IsPortPruned(a->port()) ||
-      IsRemoteCandidatePruned(a->remote_candidate());
-  bool b_pruned = IsPortPruned(b->port()) ||
-      IsRemoteCandidatePruned(b->remote_candidate());
+  bool a_pruned = IsConnectionPruned(a);
+  bool b_pruned = IsConnectionPruned(b);
   if (!a_pruned && b_pruned) {
     return a_is_better;
   }
@@ -1719,6 +1749,43 @@ bool P2PTransportChannel::IsRemoteCandidatePruned(const Candidate& cand) const {
   return !absl::c_linear_search(remote_candidates_, cand);
 }
 
+bool P2PTransportChannel::IsConnectionPruned(const Connection* conn) const {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  if (pruned_connections_) {
+    return pruned_connections_->count(conn) > 0;
+  }
+  return IsPortPruned(conn->port()) ||
+         IsRemoteCandidatePruned(conn->remote_candidate());
+}
+
+std::set<const Connection*> P2PTransportChannel::FindPrunedConnections()
+    const {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  auto address_less = [](const Candidate* a, const Candidate* b) {
+    return a->address() < b->address();
+  };
+  std::vector<const Candidate*> remote_candidates;
+  for (const Candidate& candidate : remote_candidates_) {
+    remote_candidates.push_back(&candidate);
+  }
+  absl::c_sort(remote_candidates, address_less);
+
+  std::set<const Connection*> pruned_connections;
+  for (const Connection* conn : connections_) {
+    const Candidate& cand = conn->remote_candidate();
+    auto range = std::equal_range(remote_candidates.begin(),
+                                  remote_candidates.end(), &cand, address_less);
+    if (IsPortPruned(conn->port()) ||
+        std::none_of(range.first, range.second,
+                     [&cand](const Candidate* candidate) {
+                       return *candidate == cand;
+                     })) {
+      pruned_connections.insert(conn);
+    }
+  }
+  return pruned_connections;
+}
+
 int P2PTransportChannel::CompareConnections(
     const Connection* a,
     const Connection* b,
@@ -1785,9 +1852,13 @@ void P2PTransportChannel::SortConnectionsAndUpdateState(
   // that amongst equal preference, writable connections, this will choose the
   // one whose estimated latency is lowest.  So it is the only one that we
   // need to consider switching to.
-  // TODO(honghaiz): Don't sort;  Just use std::max_element in the right places.
-  absl::c_stable_sort(
-      connections_, [this](const Connection* a, const Connection* b) {
+  // The connections are still sorted from the last time, apart from the ones
+  // whose state changed since, so only those are moved into place.
+  const std::set<const Connection*> pruned_connections =
+      FindPrunedConnections();
+  pruned_connections_ = &pruned_connections;
+  MergeSortedRuns(
+      &connections_, [this](const Connection* a, const Connection* b) {
         int cmp = CompareConnections(a, b, absl::nullopt, nullptr);
         if (cmp != 0) {
           return cmp > 0;
@@ -1795,11 +1866,14 @@ void P2PTransportChannel::SortConnectionsAndUpdateState(
         // Otherwise, sort based on latency estimate.
         return a->rtt() < b->rtt();
       });
+  pruned_connections_ = nullptr;
 
   RTC_LOG(LS_VERBOSE) << "Sorting " << connections_.size()
                       << " available connections";
-  for (size_t i = 0; i < connections_.size(); ++i) {
-    RTC_LOG(LS_VERBOSE) << connections_[i]->ToString();
+  if (RTC_LOG_CHECK_LEVEL(LS_VERBOSE)) {
+    for (size_t i = 0; i < connections_.size(); ++i) {
+      RTC_LOG(LS_VERBOSE) << connections_[i]->ToString();
+    }
   }
 
   Connection* top_connection =
@@ -2261,32 +2335,44 @@ Connection* P2PTransportChannel::FindNextPingableConnection() {
   // Otherwise, treat everything as unpinged.
   // TODO(honghaiz): Instead of adding two separate vectors, we can add a state
   // "pinged" to filter out unpinged connections.
-  if (absl::c_none_of(unpinged_connections_, [this, now](Connection* conn) {
-        return this->IsPingable(conn, now);
-      })) {
+  std::vector<Connection*> pingable_connections;
+  absl::c_copy_if(
+      unpinged_connections_, std::back_inserter(pingable_connections),
+      [this, now](Connection* conn) { return IsPingable(conn, now); });
+  if (pingable_connections.empty()) {
     unpinged_connections_.insert(pinged_connections_.begin(),
                                  pinged_connections_.end());
     pinged_connections_.clear();
+    absl::c_copy_if(
+        unpinged_connections_, std::back_inserter(pingable_connections),
+        [this, now](Connection* conn) { return IsPingable(conn, now); });
+  }
+  if (pingable_connections.empty()) {
+    return nullptr;
   }
 
-  // Among un-pinged pingable connections, "more pingable" takes precedence.
-  std::vector<Connection*> pingable_connections;
-  absl::c_copy_if(
-      unpinged_connections_, std::back_inserter(pingable_connections),
-      [this, now](Connection* conn) { return IsPingable(conn, now); });
-  auto iter = absl::c_max_element(pingable_connections,
-                                  [this](Connection* conn1, Connection* conn2) {
-                                    // Some implementations of max_element
-                                    // compare an element with itself.
-                                    if (conn1 == conn2) {
-                                      return false;
-                                    }
-                                    return MorePingable(conn1, conn2) == conn2;
-                                  });
-  if (iter != pingable_connections.end()) {
-    return *iter;
+  // Among un-pinged pingable connections, "more pingable" takes precedence,
+  // and among equally pingable ones, the first one in the ordered
+  // |connections_|. The positions are looked up once, rather than for every
+  // comparison. |pingable_connections| is in the order of the set.
+  std::vector<size_t> positions(pingable_connections.size());
+  for (size_t i = 0; i < connections_.size(); ++i) {
+    auto it = std::lower_bound(pingable_connections.begin(),
+                               pingable_connections.end(), connections_[i],
+                               std::less<Connection*>());
+    if (it != pingable_connections.end() && *it == connections_[i])
+      positions[it - pingable_connections.begin()] = i;
+  }
+  size_t most_pingable = 0;
+  for (size_t i = 1; i < pingable_connections.size(); ++i) {
+    Connection* more_pingable = MorePingable(
+        pingable_connections[most_pingable], pingable_connections[i]);
+    if (more_pingable ? more_pingable == pingable_connections[i]
+                      : positions[i] < positions[most_pingable]) {
+      most_pingable = i;
+    }
   }
-  return nullptr;
+  return pingable_connections[most_pingable];
 }
 
 void P2PTransportChannel::MarkConnectionPinged(Connection* conn) {
@@ -2592,16 +2678,7 @@ Connection* P2PTransportChannel::MorePingable(Connection* conn1,
     }
   }
 
-  Connection* least_recently_pinged_conn = LeastRecentlyPinged(conn1, conn2);
-  if (least_recently_pinged_conn) {
-    return least_recently_pinged_conn;
-  }
-
-  // During the initial state when nothing has been pinged yet, return the first
-  // one in the ordered |connections_|.
-  return *(absl::c_find_if(connections_, [conn1, conn2](Connection* conn) {
-    return conn == conn1 || conn == conn2;
-  }));
+  return LeastRecentlyPinged(conn1, conn2);
 }
 
 void P2PTransportChannel::SetWritable(bool writable) {
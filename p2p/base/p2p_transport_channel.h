@@ -365,7 +365,8 @@ class RTC_EXPORT P2PTransportChannel : public IceTransportInternal {
 
   Connection* FindOldestConnectionNeedingTriggeredCheck(int64_t now);
   // Between |conn1| and |conn2|, this function returns the one which should
-  // be pinged first.
+  // be pinged first, or nullptr if neither should, e.g. during the initial
+  // state when nothing has been pinged yet.
   Connection* MorePingable(Connection* conn1, Connection* conn2);
   // Select the connection which is Relay/Relay. If both of them are,
   // UDP relay protocol takes precedence.
@@ -399,6 +400,13 @@ class RTC_EXPORT P2PTransportChannel : public IceTransportInternal {
   // Indicates if the given remote candidate has been pruned.
   bool IsRemoteCandidatePruned(const Candidate& cand) const;
 
+  // Indicates if the local port or the remote candidate of the given
+  // connection has been pruned.
+  bool IsConnectionPruned(const Connection* conn) const;
+  // Returns the connections for which IsConnectionPruned() is true, looking up
+  // the remote candidates by address rather than one by one.
+  std::set<const Connection*> FindPrunedConnections() const;
+
   // Sets the writable state, signaling if necessary.
   void SetWritable(bool writable);
   // Sets the receiving state, signaling if necessary.
@@ -436,6 +444,10 @@ class RTC_EXPORT P2PTransportChannel : public IceTransportInternal {
 
   std::vector<RemoteCandidate> remote_candidates_
       RTC_GUARDED_BY(network_thread_);
+  // Set while |connections_| are sorted, so that IsConnectionPruned() doesn't
+  // search |remote_candidates_| for every comparison.
+  const std::set<const Connection*>* pruned_connections_
+      RTC_GUARDED_BY(network_thread_) = nullptr;
   bool sort_dirty_ RTC_GUARDED_BY(
       network_thread_);  // indicates whether another sort is needed right now
   bool had_connection_ RTC_GUARDED_BY(network_thread_) =
@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+#include "api/units/time_delta.h"
+#include "p2p/base/connection.h"
+#include "p2p/base/fake_port_allocator.h"
+#include "p2p/base/p2p_constants.h"
+#include "p2p/base/p2p_transport_channel.h"
+#include "rtc_base/fake_clock.h"
+#include "rtc_base/random.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+#include "rtc_base/virtual_socket_server.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+namespace {
+
+constexpr int kNumRemoteCandidates = 300;
+constexpr int kNumSeconds = 60;
+constexpr int kQuickNumSeconds = 5;
+constexpr int kTickMs = 10;
+constexpr int kMinRttMs = 10;
+constexpr int kMaxRttMs = 200;
+// Share of the pings that don't get a response.
+constexpr double kPingLossRatio = 0.1;
+
+const IceParameters kLocalIceParameters("UF00", "TESTICEPWD00000000000000",
+                                        false);
+const IceParameters kRemoteIceParameters("UF01", "TESTICEPWD00000000000001",
+                                         false);
+
+Candidate CreateUdpCandidate(const std::string& ip, int port, int priority) {
+  Candidate c;
+  c.set_address(rtc::SocketAddress(ip, port));
+  c.set_component(ICE_CANDIDATE_COMPONENT_DEFAULT);
+  c.set_protocol(UDP_PROTOCOL_NAME);
+  c.set_priority(priority);
+  c.set_type(LOCAL_PORT_TYPE);
+  return c;
+}
+
+struct PingState {
+  int rtt_ms;
+  int64_t last_handled_ping = 0;
+};
+
+}  // namespace
+
+// Runs the ICE checks of a channel with hundreds of candidate pairs, like a
+// host with many remote candidates, and reports how much time the network
+// thread spends on them per second. The remote side responds to the pings
+// after a round trip time that differs between the pairs, and drops some of
+// them, so that the pairs change state and are re-sorted over time. Being
+// controlled, the channel doesn't prune any pairs, although pairs that fail
+// too many checks in a row are still removed.
+TEST(P2PTransportChannelPerformanceTest, ManyCandidatePairs) {
+  const int num_seconds =
+      webrtc::field_trial::IsEnabled("WebRTC-QuickPerfTest") ? kQuickNumSeconds
+                                                             : kNumSeconds;
+  rtc::VirtualSocketServer vss;
+  rtc::AutoSocketServerThread thread(&vss);
+  rtc::ScopedFakeClock clock;
+  webrtc::Random random(42);
+
+  FakePortAllocator pa(rtc::Thread::Current(), nullptr);
+  P2PTransportChannel ch("perf", ICE_CANDIDATE_COMPONENT_DEFAULT, &pa);
+  ch.SetIceRole(ICEROLE_CONTROLLED);
+  ch.SetIceParameters(kLocalIceParameters);
+  ch.SetRemoteIceParameters(kRemoteIceParameters);
+  ch.MaybeStartGathering();
+  for (int i = 0; i < kNumRemoteCandidates; ++i) {
+    std::string ip = "10.0." + std::to_string(i / 250) + "." +
+                     std::to_string(i % 250 + 1);
+    ch.AddRemoteCandidate(CreateUdpCandidate(ip, 5000, random.Rand(1, 1000)));
+  }
+  clock.AdvanceTime(webrtc::TimeDelta::ms(kTickMs));
+  ASSERT_EQ(static_cast<size_t>(kNumRemoteCandidates),
+            ch.connections().size());
+
+  // Keyed by the remote address, since removed connections are deleted.
+  std::map<rtc::SocketAddress, PingState> ping_states;
+  for (Connection* conn : ch.connections()) {
+    ping_states[conn->remote_candidate().address()].rtt_ms =
+        random.Rand(kMinRttMs, kMaxRttMs);
+  }
+
+  int num_pings = 0;
+  int64_t elapsed_ns = 0;
+  for (int t = 0; t < num_seconds * 1000; t += kTickMs) {
+    const int64_t now = rtc::TimeMillis();
+    for (Connection* conn : ch.connections()) {
+      PingState& state = ping_states[conn->remote_candidate().address()];
+      const int64_t ping = conn->last_ping_sent();
+      if (ping <= conn->last_ping_response_received() ||
+          ping == state.last_handled_ping || now < ping + state.rtt_ms) {
+        continue;
+      }
+      state.last_handled_ping = ping;
+      ++num_pings;
+      if (random.Rand<double>() >= kPingLossRatio)
+        conn->ReceivedPingResponse(state.rtt_ms, "id");
+    }
+    // Only the time spent by the channel on the network thread is measured.
+    const int64_t start_ns = rtc::SystemTimeNanos();
+    clock.AdvanceTime(webrtc::TimeDelta::ms(kTickMs));
+    elapsed_ns += rtc::SystemTimeNanos() - start_ns;
+  }
+  EXPECT_GT(num_pings, 0);
+
+  webrtc::test::PrintResult(
+      "ice_check_time_per_second", "",
+      std::to_string(kNumRemoteCandidates) + "_candidate_pairs",
+      static_cast<double>(elapsed_ns) / rtc::kNumNanosecsPerMillisec /
+          num_seconds,
+      "ms", true);
+}
+
+}  // namespace cricket
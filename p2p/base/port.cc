@@ -21,6 +21,7 @@
 #include "absl/strings/match.h"
 #include "p2p/base/connection.h"
 #include "p2p/base/port_allocator.h"
+#include "rtc_base/byte_order.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/crc32.h"
 #include "rtc_base/helpers.h"
@@ -56,6 +57,20 @@ rtc::PacketInfoProtocolType ConvertProtocolTypeToPacketInfoProtocolType(
 // it to a little higher than a total STUN timeout.
 const int kPortTimeoutDelay = cricket::STUN_TOTAL_TIMEOUT + 5000;
 
+// Splits a STUN username of the form RFRAG:LFRAG.
+bool SplitStunUsername(const std::string& username,
+                       std::string* local_ufrag,
+                       std::string* remote_ufrag) {
+  size_t colon_pos = username.find(':');
+  if (colon_pos == std::string::npos) {
+    return false;
+  }
+
+  *local_ufrag = username.substr(0, colon_pos);
+  *remote_ufrag = username.substr(colon_pos + 1, username.size());
+  return true;
+}
+
 }  // namespace
 
 namespace cricket {
@@ -435,9 +450,6 @@ bool Port::GetStunMessage(const char* data,
                           const rtc::SocketAddress& addr,
                           std::unique_ptr<IceMessage>* out_msg,
                           std::string* out_username) {
-  // NOTE: This could clearly be optimized to avoid allocating any memory.
-  //       However, at the data rates we'll be looking at on the client side,
-  //       this probably isn't worth worrying about.
   RTC_DCHECK(out_msg != NULL);
   RTC_DCHECK(out_username != NULL);
   out_username->clear();
@@ -448,6 +460,15 @@ bool Port::GetStunMessage(const char* data,
     return false;
   }
 
+  // Binding requests, most of which are consent freshness checks on
+  // established connections, are authenticated on the raw packet. Requests
+  // that fail are answered without parsing them into attributes.
+  std::string remote_ufrag;
+  if (rtc::GetBE16(data) == STUN_BINDING_REQUEST &&
+      !ValidateStunBindingRequest(data, size, addr, &remote_ufrag)) {
+    return true;
+  }
+
   // Parse the request message.  If the packet is not a complete and correct
   // STUN message, then ignore it.
   std::unique_ptr<IceMessage> stun_msg(new IceMessage());
@@ -457,41 +478,6 @@ bool Port::GetStunMessage(const char* data,
   }
 
   if (stun_msg->type() == STUN_BINDING_REQUEST) {
-    // Check for the presence of USERNAME and MESSAGE-INTEGRITY (if ICE) first.
-    // If not present, fail with a 400 Bad Request.
-    if (!stun_msg->GetByteString(STUN_ATTR_USERNAME) ||
-        !stun_msg->GetByteString(STUN_ATTR_MESSAGE_INTEGRITY)) {
-      RTC_LOG(LS_ERROR) << ToString()
-                        << ": Received STUN request without username/M-I from: "
-                        << addr.ToSensitiveString();
-      SendBindingErrorResponse(stun_msg.get(), addr, STUN_ERROR_BAD_REQUEST,
-                               STUN_ERROR_REASON_BAD_REQUEST);
-      return true;
-    }
-
-    // If the username is bad or unknown, fail with a 401 Unauthorized.
-    std::string local_ufrag;
-    std::string remote_ufrag;
-    if (!ParseStunUsername(stun_msg.get(), &local_ufrag, &remote_ufrag) ||
-        local_ufrag != username_fragment()) {
-      RTC_LOG(LS_ERROR) << ToString()
-                        << ": Received STUN request with bad local username "
-                        << local_ufrag << " from " << addr.ToSensitiveString();
-      SendBindingErrorResponse(stun_msg.get(), addr, STUN_ERROR_UNAUTHORIZED,
-                               STUN_ERROR_REASON_UNAUTHORIZED);
-      return true;
-    }
-
-    // If ICE, and the MESSAGE-INTEGRITY is bad, fail with a 401 Unauthorized
-    if (!stun_msg->ValidateMessageIntegrity(data, size, password_)) {
-      RTC_LOG(LS_ERROR) << ToString()
-                        << ": Received STUN request with bad M-I from "
-                        << addr.ToSensitiveString()
-                        << ", password_=" << password_;
-      SendBindingErrorResponse(stun_msg.get(), addr, STUN_ERROR_UNAUTHORIZED,
-                               STUN_ERROR_REASON_UNAUTHORIZED);
-      return true;
-    }
     out_username->assign(remote_ufrag);
   } else if ((stun_msg->type() == STUN_BINDING_RESPONSE) ||
              (stun_msg->type() == STUN_BINDING_ERROR_RESPONSE)) {
@@ -534,6 +520,63 @@ bool Port::GetStunMessage(const char* data,
   return true;
 }
 
+bool Port::ValidateStunBindingRequest(const char* data,
+                                      size_t size,
+                                      const rtc::SocketAddress& addr,
+                                      std::string* remote_ufrag) {
+  // The error responses only need the transaction ID of the request, which
+  // follows the magic cookie checked by ValidateFingerprint().
+  StunMessage request;
+  request.SetType(STUN_BINDING_REQUEST);
+  request.SetTransactionID(
+      std::string(data + kStunTransactionIdOffset, kStunTransactionIdLength));
+
+  // Check for the presence of USERNAME and MESSAGE-INTEGRITY (if ICE) first.
+  // If not present, fail with a 400 Bad Request.
+  const char* username;
+  size_t username_length;
+  const char* message_integrity;
+  size_t message_integrity_length;
+  if (!StunMessage::FindRawAttribute(data, size, STUN_ATTR_USERNAME, &username,
+                                     &username_length) ||
+      !StunMessage::FindRawAttribute(data, size, STUN_ATTR_MESSAGE_INTEGRITY,
+                                     &message_integrity,
+                                     &message_integrity_length)) {
+    RTC_LOG(LS_ERROR) << ToString()
+                      << ": Received STUN request without username/M-I from: "
+                      << addr.ToSensitiveString();
+    SendBindingErrorResponse(&request, addr, STUN_ERROR_BAD_REQUEST,
+                             STUN_ERROR_REASON_BAD_REQUEST);
+    return false;
+  }
+
+  // If the username is bad or unknown, fail with a 401 Unauthorized.
+  std::string local_ufrag;
+  if (!SplitStunUsername(std::string(username, username_length), &local_ufrag,
+                         remote_ufrag) ||
+      local_ufrag != username_fragment()) {
+    RTC_LOG(LS_ERROR) << ToString()
+                      << ": Received STUN request with bad local username "
+                      << local_ufrag << " from " << addr.ToSensitiveString();
+    SendBindingErrorResponse(&request, addr, STUN_ERROR_UNAUTHORIZED,
+                             STUN_ERROR_REASON_UNAUTHORIZED);
+    return false;
+  }
+
+  // If ICE, and the MESSAGE-INTEGRITY is bad, fail with a 401 Unauthorized
+  if (!StunMessage::ValidateMessageIntegrity(data, size,
+                                             password_key_.Get(password_))) {
+    RTC_LOG(LS_ERROR) << ToString()
+                      << ": Received STUN request with bad M-I from "
+                      << addr.ToSensitiveString()
+                      << ", password_=" << password_;
+    SendBindingErrorResponse(&request, addr, STUN_ERROR_UNAUTHORIZED,
+                             STUN_ERROR_REASON_UNAUTHORIZED);
+    return false;
+  }
+  return true;
+}
+
 bool Port::IsCompatibleAddress(const rtc::SocketAddress& addr) {
   // Get a representative IP for the Network this port is configured to use.
   rtc::IPAddress ip = network_->GetBestIP();
@@ -567,16 +610,8 @@ bool Port::ParseStunUsername(const StunMessage* stun_msg,
   if (username_attr == NULL)
     return false;
 
-  // RFRAG:LFRAG
-  const std::string username = username_attr->GetString();
-  size_t colon_pos = username.find(':');
-  if (colon_pos == std::string::npos) {
-    return false;
-  }
-
-  *local_ufrag = username.substr(0, colon_pos);
-  *remote_ufrag = username.substr(colon_pos + 1, username.size());
-  return true;
+  return SplitStunUsername(username_attr->GetString(), local_ufrag,
+                           remote_ufrag);
 }
 
 bool Port::MaybeIceRoleConflict(const rtc::SocketAddress& addr,
@@ -696,7 +731,7 @@ void Port::SendBindingResponse(StunMessage* request,
 
   response.AddAttribute(absl::make_unique<StunXorAddressAttribute>(
       STUN_ATTR_XOR_MAPPED_ADDRESS, addr));
-  response.AddMessageIntegrity(password_);
+  response.AddMessageIntegrity(password_key_.Get(password_));
   response.AddFingerprint();
 
   // Send the response message.
@@ -750,7 +785,7 @@ void Port::SendBindingErrorResponse(StunMessage* request,
   // because we don't have enough information to determine the shared secret.
   if (error_code != STUN_ERROR_BAD_REQUEST &&
       error_code != STUN_ERROR_UNAUTHORIZED)
-    response.AddMessageIntegrity(password_);
+    response.AddMessageIntegrity(password_key_.Get(password_));
   response.AddFingerprint();
 
   // Send the response message.
@@ -419,6 +419,15 @@ class Port : public PortInterface,
                       std::unique_ptr<IceMessage>* out_msg,
                       std::string* out_username);
 
+  // Checks the USERNAME and MESSAGE-INTEGRITY of a raw binding request, which
+  // has a valid fingerprint, without parsing it. If the checks fail, sends an
+  // error response and returns false. Otherwise, |remote_ufrag| contains the
+  // remote fragment of the STUN username.
+  bool ValidateStunBindingRequest(const char* data,
+                                  size_t size,
+                                  const rtc::SocketAddress& addr,
+                                  std::string* remote_ufrag);
+
   // Checks if the address in addr is compatible with the port's ip.
   bool IsCompatibleAddress(const rtc::SocketAddress& addr);
 
@@ -464,6 +473,7 @@ class Port : public PortInterface,
   // username_fragment().
   std::string ice_username_fragment_;
   std::string password_;
+  StunMessageIntegrityKey password_key_;
   std::vector<Candidate> candidates_;
   AddressMap connections_;
   int timeout_delay_;
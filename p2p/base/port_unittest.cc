@@ -2192,6 +2192,11 @@ TEST_F(PortTest, TestHandleStunMessageBadMessageIntegrity) {
   EXPECT_TRUE(out_msg.get() == NULL);
   EXPECT_EQ("", username);
   EXPECT_EQ(STUN_ERROR_UNAUTHORIZED, port->last_stun_error_code());
+  // The error response is sent without parsing the request, but still has
+  // its transaction ID.
+  ASSERT_TRUE(port->last_stun_msg());
+  EXPECT_EQ(STUN_BINDING_ERROR_RESPONSE, port->last_stun_msg()->type());
+  EXPECT_EQ(in_msg->transaction_id(), port->last_stun_msg()->transaction_id());
 
   // TODO(?): BINDING-RESPONSES and BINDING-ERROR-RESPONSES are checked
   // by the Connection, not the Port, since they require the remote username.
@@ -183,79 +183,52 @@ const StunUInt16ListAttribute* StunMessage::GetUnknownAttributes() const {
 bool StunMessage::ValidateMessageIntegrity(const char* data,
                                            size_t size,
                                            const std::string& password) {
-  // Verifying the size of the message.
-  if ((size % 4) != 0 || size < kStunHeaderSize) {
-    return false;
-  }
-
-  // Getting the message length from the STUN header.
-  uint16_t msg_length = rtc::GetBE16(&data[2]);
-  if (size != (msg_length + kStunHeaderSize)) {
-    return false;
-  }
+  std::unique_ptr<rtc::MessageDigest> hmac(
+      rtc::MessageDigestFactory::CreateHmac(rtc::DIGEST_SHA_1, password.data(),
+                                            password.size()));
+  return hmac && ValidateMessageIntegrity(data, size, hmac.get());
+}
 
+bool StunMessage::ValidateMessageIntegrity(const char* data,
+                                           size_t size,
+                                           rtc::MessageDigest* hmac) {
+  RTC_DCHECK_EQ(hmac->Size(), kStunMessageIntegritySize);
   // Finding Message Integrity attribute in stun message.
-  size_t current_pos = kStunHeaderSize;
-  bool has_message_integrity_attr = false;
-  while (current_pos + 4 <= size) {
-    uint16_t attr_type, attr_length;
-    // Getting attribute type and length.
-    attr_type = rtc::GetBE16(&data[current_pos]);
-    attr_length = rtc::GetBE16(&data[current_pos + sizeof(attr_type)]);
-
-    // If M-I, sanity check it, and break out.
-    if (attr_type == STUN_ATTR_MESSAGE_INTEGRITY) {
-      if (attr_length != kStunMessageIntegritySize ||
-          current_pos + sizeof(attr_type) + sizeof(attr_length) + attr_length >
-              size) {
-        return false;
-      }
-      has_message_integrity_attr = true;
-      break;
-    }
-
-    // Otherwise, skip to the next attribute.
-    current_pos += sizeof(attr_type) + sizeof(attr_length) + attr_length;
-    if ((attr_length % 4) != 0) {
-      current_pos += (4 - (attr_length % 4));
-    }
-  }
-
-  if (!has_message_integrity_attr) {
+  const char* mi_value;
+  size_t mi_length;
+  if (!FindRawAttribute(data, size, STUN_ATTR_MESSAGE_INTEGRITY, &mi_value,
+                        &mi_length) ||
+      mi_length != kStunMessageIntegritySize) {
     return false;
   }
 
-  // Getting length of the message to calculate Message Integrity.
-  size_t mi_pos = current_pos;
-  std::unique_ptr<char[]> temp_data(new char[current_pos]);
-  memcpy(temp_data.get(), data, current_pos);
-  if (size > mi_pos + kStunAttributeHeaderSize + kStunMessageIntegritySize) {
-    // Stun message has other attributes after message integrity.
-    // Adjust the length parameter in stun message to calculate HMAC.
-    size_t extra_offset =
-        size - (mi_pos + kStunAttributeHeaderSize + kStunMessageIntegritySize);
-    size_t new_adjusted_len = size - extra_offset - kStunHeaderSize;
-
-    // Writing new length of the STUN message @ Message Length in temp buffer.
-    //      0                   1                   2                   3
-    //      0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
-    //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    //     |0 0|     STUN Message Type     |         Message Length        |
-    //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    rtc::SetBE16(temp_data.get() + 2, static_cast<uint16_t>(new_adjusted_len));
-  }
-
-  char hmac[kStunMessageIntegritySize];
-  size_t ret =
-      rtc::ComputeHmac(rtc::DIGEST_SHA_1, password.c_str(), password.size(),
-                       temp_data.get(), mi_pos, hmac, sizeof(hmac));
-  RTC_DCHECK(ret == sizeof(hmac));
-  if (ret != sizeof(hmac))
+  // The HMAC is calculated over the message up to the Message Integrity
+  // attribute. If the message has other attributes after it, the length in
+  // the header is adjusted as if the message ended with Message Integrity.
+  //      0                   1                   2                   3
+  //      0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+  //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  //     |0 0|     STUN Message Type     |         Message Length        |
+  //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  // Only the header is copied for this; the rest of the message is hashed in
+  // place.
+  size_t mi_pos = mi_value - kStunAttributeHeaderSize - data;
+  size_t adjusted_len = mi_pos + kStunAttributeHeaderSize +
+                        kStunMessageIntegritySize - kStunHeaderSize;
+  char header[kStunHeaderSize];
+  memcpy(header, data, kStunHeaderSize);
+  rtc::SetBE16(header + 2, static_cast<uint16_t>(adjusted_len));
+  hmac->Update(header, kStunHeaderSize);
+  hmac->Update(data + kStunHeaderSize, mi_pos - kStunHeaderSize);
+
+  char computed[kStunMessageIntegritySize];
+  size_t ret = hmac->Finish(computed, sizeof(computed));
+  RTC_DCHECK(ret == sizeof(computed));
+  if (ret != sizeof(computed))
     return false;
 
   // Comparing the calculated HMAC with the one present in the message.
-  return memcmp(data + current_pos + kStunAttributeHeaderSize, hmac,
-                sizeof(hmac)) == 0;
+  return memcmp(mi_value, computed, sizeof(computed)) == 0;
 }
 
 bool StunMessage::AddMessageIntegrity(const std::string& password) {
@@ -263,6 +236,13 @@ bool StunMessage::AddMessageIntegrity(const std::string& password) {
 }
 
 bool StunMessage::AddMessageIntegrity(const char* key, size_t keylen) {
+  std::unique_ptr<rtc::MessageDigest> hmac(
+      rtc::MessageDigestFactory::CreateHmac(rtc::DIGEST_SHA_1, key, keylen));
+  return hmac && AddMessageIntegrity(hmac.get());
+}
+
+bool StunMessage::AddMessageIntegrity(rtc::MessageDigest* hmac) {
+  RTC_DCHECK_EQ(hmac->Size(), kStunMessageIntegritySize);
   // Add the attribute with a dummy value. Since this is a known attribute, it
   // can't fail.
   auto msg_integrity_attr_ptr = absl::make_unique<StunByteStringAttribute>(
@@ -277,21 +257,61 @@ bool StunMessage::AddMessageIntegrity(const char* key, size_t keylen) {
 
   int msg_len_for_hmac = static_cast<int>(
       buf.Length() - kStunAttributeHeaderSize - msg_integrity_attr->length());
-  char hmac[kStunMessageIntegritySize];
-  size_t ret = rtc::ComputeHmac(rtc::DIGEST_SHA_1, key, keylen, buf.Data(),
-                                msg_len_for_hmac, hmac, sizeof(hmac));
-  RTC_DCHECK(ret == sizeof(hmac));
-  if (ret != sizeof(hmac)) {
+  char computed[kStunMessageIntegritySize];
+  size_t ret = rtc::ComputeDigest(hmac, buf.Data(), msg_len_for_hmac, computed,
+                                  sizeof(computed));
+  RTC_DCHECK(ret == sizeof(computed));
+  if (ret != sizeof(computed)) {
     RTC_LOG(LS_ERROR) << "HMAC computation failed. Message-Integrity "
                          "has dummy value.";
     return false;
   }
 
   // Insert correct HMAC into the attribute.
-  msg_integrity_attr->CopyBytes(hmac, sizeof(hmac));
+  msg_integrity_attr->CopyBytes(computed, sizeof(computed));
   return true;
 }
 
+bool StunMessage::FindRawAttribute(const char* data,
+                                   size_t size,
+                                   int type,
+                                   const char** value,
+                                   size_t* length) {
+  // Verifying the size of the message.
+  if ((size % 4) != 0 || size < kStunHeaderSize) {
+    return false;
+  }
+
+  // Getting the message length from the STUN header.
+  uint16_t msg_length = rtc::GetBE16(&data[2]);
+  if (size != (msg_length + kStunHeaderSize)) {
+    return false;
+  }
+
+  size_t current_pos = kStunHeaderSize;
+  while (current_pos + kStunAttributeHeaderSize <= size) {
+    // Getting attribute type and length.
+    uint16_t attr_type = rtc::GetBE16(&data[current_pos]);
+    uint16_t attr_length = rtc::GetBE16(&data[current_pos + sizeof(attr_type)]);
+    if (current_pos + kStunAttributeHeaderSize + attr_length > size) {
+      return false;
+    }
+
+    if (attr_type == type) {
+      *value = data + current_pos + kStunAttributeHeaderSize;
+      *length = attr_length;
+      return true;
+    }
+
+    // Otherwise, skip to the next attribute.
+    current_pos += kStunAttributeHeaderSize + attr_length;
+    if ((attr_length % 4) != 0) {
+      current_pos += (4 - (attr_length % 4));
+    }
+  }
+  return false;
+}
+
 // Verifies a message is in fact a STUN message, by performing the checks
 // outlined in RFC 5389, section 7.3, including the FINGERPRINT check detailed
 // in section 15.5.
@@ -500,6 +520,19 @@ bool StunMessage::IsValidTransactionId(const std::string& transaction_id) {
          transaction_id.size() == kStunLegacyTransactionIdLength;
 }
 
+StunMessageIntegrityKey::StunMessageIntegrityKey() = default;
+
+StunMessageIntegrityKey::~StunMessageIntegrityKey() = default;
+
+rtc::MessageDigest* StunMessageIntegrityKey::Get(const std::string& password) {
+  if (!hmac_ || password != password_) {
+    password_ = password;
+    hmac_.reset(rtc::MessageDigestFactory::CreateHmac(
+        rtc::DIGEST_SHA_1, password.data(), password.size()));
+  }
+  return hmac_.get();
+}
+
 // StunAttribute
 
 StunAttribute::StunAttribute(uint16_t type, uint16_t length)
@@ -22,6 +22,7 @@
 
 #include "rtc_base/byte_buffer.h"
 #include "rtc_base/ip_address.h"
+#include "rtc_base/message_digest.h"
 #include "rtc_base/socket_address.h"
 
 namespace cricket {
@@ -178,9 +179,25 @@ class StunMessage {
   static bool ValidateMessageIntegrity(const char* data,
                                        size_t size,
                                        const std::string& password);
+  // Like the above, but with an HMAC-SHA1 that is already keyed with the
+  // password, e.g. by StunMessageIntegrityKey. Doesn't allocate memory.
+  static bool ValidateMessageIntegrity(const char* data,
+                                       size_t size,
+                                       rtc::MessageDigest* hmac);
   // Adds a MESSAGE-INTEGRITY attribute that is valid for the current message.
   bool AddMessageIntegrity(const std::string& password);
   bool AddMessageIntegrity(const char* key, size_t keylen);
+  bool AddMessageIntegrity(rtc::MessageDigest* hmac);
+
+  // Finds the first attribute of |type| in a raw STUN message without parsing
+  // the message into attributes, and sets |value| and |length| to its value.
+  // Returns false if there is no such attribute, or if the attributes before
+  // it are malformed.
+  static bool FindRawAttribute(const char* data,
+                               size_t size,
+                               int type,
+                               const char** value,
+                               size_t* length);
 
   // Verifies that a given buffer is STUN by checking for a correct FINGERPRINT.
   static bool ValidateFingerprint(const char* data, size_t size);
@@ -220,6 +237,22 @@ class StunMessage {
   uint32_t stun_magic_cookie_;
 };
 
+// Keeps the HMAC-SHA1 for MESSAGE-INTEGRITY keyed with a password, so that it
+// isn't keyed again for every message sent or received with that password.
+class StunMessageIntegrityKey {
+ public:
+  StunMessageIntegrityKey();
+  ~StunMessageIntegrityKey();
+
+  // Returns the HMAC keyed with |password|, which is rekeyed if |password|
+  // differs from the last one.
+  rtc::MessageDigest* Get(const std::string& password);
+
+ private:
+  std::string password_;
+  std::unique_ptr<rtc::MessageDigest> hmac_;
+};
+
 // Base class for all STUN/TURN attributes.
 class StunAttribute {
  public:
@@ -0,0 +1,223 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "p2p/base/connection.h"
+#include "p2p/base/p2p_constants.h"
+#include "p2p/base/port.h"
+#include "p2p/base/stun.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/helpers.h"
+#include "rtc_base/ip_address.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/network.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+namespace {
+
+constexpr int kNumSessions = 10000;
+constexpr int kNumRounds = 20;
+constexpr int kQuickNumRounds = 2;
+constexpr uint64_t kTiebreaker = 0x0123456789abcdef;
+
+// Port that counts the STUN packets it would send instead of sending them.
+class BenchmarkPort : public Port {
+ public:
+  BenchmarkPort(rtc::Thread* thread,
+                rtc::Network* network,
+                const std::string& username_fragment,
+                const std::string& password)
+      : Port(thread,
+             LOCAL_PORT_TYPE,
+             /*factory=*/nullptr,
+             network,
+             username_fragment,
+             password) {}
+
+  using Port::GetStunMessage;
+
+  int num_packets_sent() const { return num_packets_sent_; }
+
+  void PrepareAddress() override {
+    rtc::SocketAddress addr(Network()->GetBestIP(), 5000);
+    AddAddress(addr, addr, rtc::SocketAddress(), UDP_PROTOCOL_NAME, "", "",
+               Type(), ICE_TYPE_PREFERENCE_HOST, 0, "", true);
+  }
+  bool SupportsProtocol(const std::string& protocol) const override {
+    return true;
+  }
+  ProtocolType GetProtocol() const override { return PROTO_UDP; }
+  Connection* CreateConnection(const Candidate& remote_candidate,
+                               CandidateOrigin origin) override {
+    Connection* conn = new ProxyConnection(this, 0, remote_candidate);
+    AddOrReplaceConnection(conn);
+    return conn;
+  }
+  int SendTo(const void* data,
+             size_t size,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options,
+             bool payload) override {
+    ++num_packets_sent_;
+    return static_cast<int>(size);
+  }
+  int SetOption(rtc::Socket::Option opt, int value) override { return 0; }
+  int GetOption(rtc::Socket::Option opt, int* value) override { return -1; }
+  int GetError() override { return 0; }
+
+ private:
+  void OnSentPacket(rtc::AsyncPacketSocket* socket,
+                    const rtc::SentPacket& sent_packet) override {}
+
+  int num_packets_sent_ = 0;
+};
+
+struct Session {
+  std::string password;
+  StunMessageIntegrityKey key;
+  rtc::ByteBufferWriter request;
+  std::unique_ptr<BenchmarkPort> port;
+};
+
+// Writes a binding request like the consent freshness checks of a remote
+// controlling agent.
+void WriteBindingRequest(const std::string& local_ufrag,
+                         const std::string& password,
+                         rtc::ByteBufferWriter* buf) {
+  IceMessage request;
+  request.SetType(STUN_BINDING_REQUEST);
+  request.SetTransactionID(rtc::CreateRandomString(kStunTransactionIdLength));
+  request.AddAttribute(absl::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_USERNAME, local_ufrag + ":" + "rfrag"));
+  request.AddAttribute(
+      absl::make_unique<StunUInt32Attribute>(STUN_ATTR_PRIORITY, 0x6e7f1eff));
+  request.AddAttribute(absl::make_unique<StunUInt64Attribute>(
+      STUN_ATTR_ICE_CONTROLLING, kTiebreaker));
+  request.AddMessageIntegrity(password);
+  request.AddFingerprint();
+  request.Write(buf);
+}
+
+// Authenticates a binding request with Port::GetStunMessage(), and answers it
+// with Port::SendBindingResponse(). Returns true if a response was sent.
+bool HandleBindingRequest(Session* session, const rtc::SocketAddress& addr) {
+  std::unique_ptr<IceMessage> request;
+  std::string remote_ufrag;
+  if (!session->port->GetStunMessage(session->request.Data(),
+                                     session->request.Length(), addr,
+                                     &request, &remote_ufrag) ||
+      !request) {
+    return false;
+  }
+  const int num_packets_sent = session->port->num_packets_sent();
+  session->port->SendBindingResponse(request.get(), addr);
+  return session->port->num_packets_sent() > num_packets_sent;
+}
+
+}  // namespace
+
+// Validates the binding requests of 10000 ICE sessions, like a server checking
+// consent freshness, and reports the cost per request of checking its
+// MESSAGE-INTEGRITY with the HMAC keyed for every request, and with the HMAC
+// keyed once per session, as well as the number of binding requests that are
+// handled per second on one core, including the response.
+TEST(StunPerformanceTest, BindingChecks) {
+  const int num_rounds = webrtc::field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                             ? kQuickNumRounds
+                             : kNumRounds;
+  rtc::AutoThread thread;
+  const rtc::SocketAddress addr("192.168.1.1", 5000);
+  rtc::Network network("unittest", "unittest", addr.ipaddr(), 32);
+  network.AddIP(addr.ipaddr());
+  Candidate remote_candidate;
+  remote_candidate.set_address(addr);
+  remote_candidate.set_protocol(UDP_PROTOCOL_NAME);
+
+  // Creating the ports and connections logs at LS_INFO for each of them.
+  const rtc::LoggingSeverity log_severity = rtc::LogMessage::GetLogToDebug();
+  rtc::LogMessage::LogToDebug(rtc::LS_WARNING);
+  std::vector<std::unique_ptr<Session>> sessions;
+  for (int i = 0; i < kNumSessions; ++i) {
+    auto session = absl::make_unique<Session>();
+    const std::string local_ufrag = rtc::CreateRandomString(ICE_UFRAG_LENGTH);
+    session->password = rtc::CreateRandomString(ICE_PWD_LENGTH);
+    WriteBindingRequest(local_ufrag, session->password, &session->request);
+    session->port = absl::make_unique<BenchmarkPort>(
+        &thread, &network, local_ufrag, session->password);
+    session->port->SetIceRole(ICEROLE_CONTROLLED);
+    session->port->PrepareAddress();
+    // Port::SendBindingResponse() expects a connection to the sender.
+    session->port->CreateConnection(remote_candidate,
+                                    PortInterface::ORIGIN_MESSAGE);
+    sessions.push_back(std::move(session));
+  }
+  const int num_checks = num_rounds * kNumSessions;
+
+  int num_valid = 0;
+  int64_t start_ns = rtc::TimeNanos();
+  for (int round = 0; round < num_rounds; ++round) {
+    for (const auto& session : sessions) {
+      num_valid += StunMessage::ValidateMessageIntegrity(
+          session->request.Data(), session->request.Length(),
+          session->password);
+    }
+  }
+  const int64_t password_ns = rtc::TimeNanos() - start_ns;
+  EXPECT_EQ(num_checks, num_valid);
+
+  num_valid = 0;
+  start_ns = rtc::TimeNanos();
+  for (int round = 0; round < num_rounds; ++round) {
+    for (const auto& session : sessions) {
+      num_valid += StunMessage::ValidateMessageIntegrity(
+          session->request.Data(), session->request.Length(),
+          session->key.Get(session->password));
+    }
+  }
+  const int64_t key_ns = rtc::TimeNanos() - start_ns;
+  EXPECT_EQ(num_checks, num_valid);
+
+  num_valid = 0;
+  start_ns = rtc::TimeNanos();
+  for (int round = 0; round < num_rounds; ++round) {
+    for (const auto& session : sessions)
+      num_valid += HandleBindingRequest(session.get(), addr);
+  }
+  const int64_t binding_ns = rtc::TimeNanos() - start_ns;
+  EXPECT_EQ(num_checks, num_valid);
+
+  sessions.clear();
+  rtc::LogMessage::LogToDebug(log_severity);
+
+  webrtc::test::PrintResult("stun_integrity_check_time", "", "password",
+                            static_cast<double>(password_ns) / num_checks,
+                            "ns", true);
+  webrtc::test::PrintResult("stun_integrity_check_time", "", "cached_key",
+                            static_cast<double>(key_ns) / num_checks, "ns",
+                            true);
+  webrtc::test::PrintResult(
+      "stun_binding_checks_per_second", "", "one_core",
+      num_checks / (static_cast<double>(binding_ns) / rtc::kNumNanosecsPerSec),
+      "checks", false);
+}
+
+}  // namespace cricket
@@ -1269,6 +1269,56 @@ TEST_F(StunTest, AddMessageIntegrity) {
       kRfc5769SampleMsgPassword));
 }
 
+// Check that a StunMessageIntegrityKey can be used for many messages, and is
+// rekeyed when the password changes.
+TEST_F(StunTest, MessageIntegrityWithKey) {
+  StunMessageIntegrityKey key;
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(StunMessage::ValidateMessageIntegrity(
+        reinterpret_cast<const char*>(kRfc5769SampleRequest),
+        sizeof(kRfc5769SampleRequest), key.Get(kRfc5769SampleMsgPassword)));
+    EXPECT_TRUE(StunMessage::ValidateMessageIntegrity(
+        reinterpret_cast<const char*>(kRfc5769SampleResponse),
+        sizeof(kRfc5769SampleResponse), key.Get(kRfc5769SampleMsgPassword)));
+    EXPECT_FALSE(StunMessage::ValidateMessageIntegrity(
+        reinterpret_cast<const char*>(kRfc5769SampleRequest),
+        sizeof(kRfc5769SampleRequest), key.Get("InvalidPassword")));
+  }
+
+  IceMessage msg;
+  rtc::ByteBufferReader buf(
+      reinterpret_cast<const char*>(kRfc5769SampleRequestWithoutMI),
+      sizeof(kRfc5769SampleRequestWithoutMI));
+  EXPECT_TRUE(msg.Read(&buf));
+  EXPECT_TRUE(msg.AddMessageIntegrity(key.Get(kRfc5769SampleMsgPassword)));
+  const StunByteStringAttribute* mi_attr =
+      msg.GetByteString(STUN_ATTR_MESSAGE_INTEGRITY);
+  EXPECT_EQ(
+      0, memcmp(mi_attr->bytes(), kCalculatedHmac1, sizeof(kCalculatedHmac1)));
+}
+
+TEST_F(StunTest, FindRawAttribute) {
+  const char* value;
+  size_t length;
+  EXPECT_TRUE(StunMessage::FindRawAttribute(
+      reinterpret_cast<const char*>(kRfc5769SampleRequest),
+      sizeof(kRfc5769SampleRequest), STUN_ATTR_USERNAME, &value, &length));
+  EXPECT_EQ("evtj:h6vY", std::string(value, length));
+  EXPECT_TRUE(StunMessage::FindRawAttribute(
+      reinterpret_cast<const char*>(kRfc5769SampleRequest),
+      sizeof(kRfc5769SampleRequest), STUN_ATTR_MESSAGE_INTEGRITY, &value,
+      &length));
+  EXPECT_EQ(kStunMessageIntegritySize, length);
+
+  EXPECT_FALSE(StunMessage::FindRawAttribute(
+      reinterpret_cast<const char*>(kRfc5769SampleRequest),
+      sizeof(kRfc5769SampleRequest), STUN_ATTR_ERROR_CODE, &value, &length));
+  EXPECT_FALSE(StunMessage::FindRawAttribute(
+      reinterpret_cast<const char*>(kStunMessageWithExcessLength),
+      sizeof(kStunMessageWithExcessLength), STUN_ATTR_USERNAME, &value,
+      &length));
+}
+
 // Check our STUN message validation code against the RFC5769 test messages.
 TEST_F(StunTest, ValidateFingerprint) {
   EXPECT_TRUE(StunMessage::ValidateFingerprint(
@@ -78,6 +78,12 @@ struct StreamFinder {
   const StreamParams* target_;
 };
 
+bool DemuxerCriteriaEqual(const webrtc::RtpDemuxerCriteria& lhs,
+                          const webrtc::RtpDemuxerCriteria& rhs) {
+  return lhs.mid == rhs.mid && lhs.rsid == rhs.rsid && lhs.ssrcs == rhs.ssrcs &&
+         lhs.payload_types == rhs.payload_types;
+}
+
 }  // namespace
 
 enum {
@@ -165,9 +171,13 @@ BaseChannel::~BaseChannel() {
 
 bool BaseChannel::ConnectToRtpTransport() {
   RTC_DCHECK(rtp_transport_);
-  if (!RegisterRtpDemuxerSink()) {
+  if (!rtp_transport_->RegisterRtpDemuxerSink(demuxer_criteria_, this)) {
     return false;
   }
+  {
+    rtc::CritScope cs(&registered_demuxer_criteria_crit_);
+    registered_demuxer_criteria_ = demuxer_criteria_;
+  }
   rtp_transport_->SignalReadyToSend.connect(
       this, &BaseChannel::OnTransportReadyToSend);
   rtp_transport_->SignalRtcpPacketReceived.connect(
@@ -191,6 +201,10 @@ bool BaseChannel::ConnectToRtpTransport() {
 void BaseChannel::DisconnectFromRtpTransport() {
   RTC_DCHECK(rtp_transport_);
   rtp_transport_->UnregisterRtpDemuxerSink(this);
+  {
+    rtc::CritScope cs(&registered_demuxer_criteria_crit_);
+    registered_demuxer_criteria_.reset();
+  }
   rtp_transport_->SignalReadyToSend.disconnect(this);
   rtp_transport_->SignalRtcpPacketReceived.disconnect(this);
   rtp_transport_->SignalNetworkRouteChanged.disconnect(this);
@@ -486,8 +500,26 @@ void BaseChannel::UpdateRtpHeaderExtensionMap(
 
 bool BaseChannel::RegisterRtpDemuxerSink() {
   RTC_DCHECK(rtp_transport_);
+  // Most renegotiations leave the criteria of a channel unchanged, in which
+  // case the hop to the network thread is skipped.
+  {
+    rtc::CritScope cs(&registered_demuxer_criteria_crit_);
+    if (registered_demuxer_criteria_ &&
+        DemuxerCriteriaEqual(*registered_demuxer_criteria_,
+                             demuxer_criteria_)) {
+      return true;
+    }
+  }
   return network_thread_->Invoke<bool>(RTC_FROM_HERE, [this] {
-    return rtp_transport_->RegisterRtpDemuxerSink(demuxer_criteria_, this);
+    bool success =
+        rtp_transport_->RegisterRtpDemuxerSink(demuxer_criteria_, this);
+    rtc::CritScope cs(&registered_demuxer_criteria_crit_);
+    if (success) {
+      registered_demuxer_criteria_ = demuxer_criteria_;
+    } else {
+      registered_demuxer_criteria_.reset();
+    }
+    return success;
   });
 }
 
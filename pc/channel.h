@@ -18,6 +18,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "api/call/audio_sink.h"
 #include "api/jsep.h"
 #include "api/media_transport_config.h"
@@ -284,6 +285,8 @@ class BaseChannel : public ChannelInterface,
   void UpdateRtpHeaderExtensionMap(
       const RtpHeaderExtensions& header_extensions);
 
+  // Registers the channel as the sink of |demuxer_criteria_| on the RTP
+  // transport, unless they are the criteria it was last registered with.
   bool RegisterRtpDemuxerSink();
 
   bool has_received_packet_ = false;
@@ -336,6 +339,12 @@ class BaseChannel : public ChannelInterface,
       webrtc::RtpTransceiverDirection::kInactive;
 
   webrtc::RtpDemuxerCriteria demuxer_criteria_;
+  // The criteria the channel is registered with on |rtp_transport_|, if known.
+  // Only written on the network thread, where the registration happens, but
+  // read on the worker thread to skip registering unchanged criteria.
+  rtc::CriticalSection registered_demuxer_criteria_crit_;
+  absl::optional<webrtc::RtpDemuxerCriteria> registered_demuxer_criteria_
+      RTC_GUARDED_BY(registered_demuxer_criteria_crit_);
   // This generator is used to generate SSRCs for local streams.
   // This is needed in cases where SSRCs are not negotiated or set explicitly
   // like in Simulcast.
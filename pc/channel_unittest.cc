@@ -63,6 +63,23 @@ const int kAudioPts[] = {0, 8};
 const int kVideoPts[] = {97, 99};
 enum class NetworkIsWorker { Yes, No };
 
+// Counts how often a channel registers itself with the RTP demuxer.
+class CountingRtpTransport : public webrtc::RtpTransport {
+ public:
+  CountingRtpTransport() : webrtc::RtpTransport(/*rtcp_mux_enabled=*/true) {}
+
+  bool RegisterRtpDemuxerSink(const webrtc::RtpDemuxerCriteria& criteria,
+                              webrtc::RtpPacketSinkInterface* sink) override {
+    ++num_registrations_;
+    return webrtc::RtpTransport::RegisterRtpDemuxerSink(criteria, sink);
+  }
+
+  int num_registrations() const { return num_registrations_; }
+
+ private:
+  int num_registrations_ = 0;
+};
+
 }  // namespace
 
 template <class ChannelT,
@@ -1435,6 +1452,63 @@ class ChannelTest : public ::testing::Test, public sigslot::has_slots<> {
     EXPECT_EQ(kRcvBufSize, option_val);
   }
 
+  // Test that renegotiating a channel without changing what it receives
+  // doesn't register it with the RTP demuxer again.
+  void TestDemuxerSinkNotRegisteredForUnchangedCriteria() {
+    CreateChannels(RTCP_MUX, RTCP_MUX);
+    CountingRtpTransport* transport = CreateCountingRtpTransport();
+    EXPECT_TRUE(channel1_->SetRtpTransport(transport));
+    EXPECT_EQ(1, transport->num_registrations());
+
+    // The local payload types are new criteria.
+    EXPECT_TRUE(channel1_->SetLocalContent(&local_media_content1_,
+                                           SdpType::kOffer, NULL));
+    EXPECT_EQ(2, transport->num_registrations());
+    EXPECT_TRUE(channel1_->SetRemoteContent(&remote_media_content1_,
+                                            SdpType::kAnswer, NULL));
+    EXPECT_TRUE(channel1_->SetLocalContent(&local_media_content1_,
+                                           SdpType::kOffer, NULL));
+    EXPECT_EQ(2, transport->num_registrations());
+
+    // A new remote SSRC is.
+    typename T::Content content;
+    CreateContent(0, kPcmuCodec, kH264Codec, &content);
+    content.AddStream(StreamParams::CreateLegacy(kSsrc3));
+    EXPECT_TRUE(
+        channel1_->SetRemoteContent(&content, SdpType::kAnswer, NULL));
+    EXPECT_EQ(3, transport->num_registrations());
+  }
+
+  // Test that a channel moved to another RtpTransport registers with its
+  // demuxer once, and again whenever it is moved back to it.
+  void TestDemuxerSinkRegisteredOnTransportSwitch() {
+    CreateChannels(RTCP_MUX, RTCP_MUX);
+    EXPECT_TRUE(channel1_->SetLocalContent(&local_media_content1_,
+                                           SdpType::kOffer, NULL));
+    CountingRtpTransport* transport = CreateCountingRtpTransport();
+    EXPECT_TRUE(channel1_->SetRtpTransport(transport));
+    EXPECT_EQ(1, transport->num_registrations());
+    // Connecting to the transport registered the current criteria.
+    EXPECT_TRUE(channel1_->SetLocalContent(&local_media_content1_,
+                                           SdpType::kOffer, NULL));
+    EXPECT_EQ(1, transport->num_registrations());
+
+    EXPECT_TRUE(channel1_->SetRtpTransport(rtp_transport1_.get()));
+    EXPECT_TRUE(channel1_->SetRtpTransport(transport));
+    EXPECT_EQ(2, transport->num_registrations());
+    EXPECT_TRUE(channel1_->SetLocalContent(&local_media_content1_,
+                                           SdpType::kOffer, NULL));
+    EXPECT_EQ(2, transport->num_registrations());
+  }
+
+  CountingRtpTransport* CreateCountingRtpTransport() {
+    auto transport = absl::make_unique<CountingRtpTransport>();
+    transport->SetRtpPacketTransport(fake_rtp_dtls_transport1_.get());
+    CountingRtpTransport* transport_ptr = transport.get();
+    new_rtp_transport_ = std::move(transport);
+    return transport_ptr;
+  }
+
   void CreateSimulcastContent(const std::vector<std::string>& rids,
                               typename T::Content* content) {
     std::vector<RidDescription> rid_descriptions;
@@ -1822,6 +1896,16 @@ TEST_F(VoiceChannelSingleThreadTest, SocketOptionsMergedOnSetTransport) {
   Base::SocketOptionsMergedOnSetTransport();
 }
 
+TEST_F(VoiceChannelSingleThreadTest,
+       TestDemuxerSinkNotRegisteredForUnchangedCriteria) {
+  Base::TestDemuxerSinkNotRegisteredForUnchangedCriteria();
+}
+
+TEST_F(VoiceChannelSingleThreadTest,
+       TestDemuxerSinkRegisteredOnTransportSwitch) {
+  Base::TestDemuxerSinkRegisteredOnTransportSwitch();
+}
+
 // VoiceChannelDoubleThreadTest
 TEST_F(VoiceChannelDoubleThreadTest, TestInit) {
   Base::TestInit();
@@ -1971,6 +2055,16 @@ TEST_F(VoiceChannelDoubleThreadTest, SocketOptionsMergedOnSetTransport) {
   Base::SocketOptionsMergedOnSetTransport();
 }
 
+TEST_F(VoiceChannelDoubleThreadTest,
+       TestDemuxerSinkNotRegisteredForUnchangedCriteria) {
+  Base::TestDemuxerSinkNotRegisteredForUnchangedCriteria();
+}
+
+TEST_F(VoiceChannelDoubleThreadTest,
+       TestDemuxerSinkRegisteredOnTransportSwitch) {
+  Base::TestDemuxerSinkRegisteredOnTransportSwitch();
+}
+
 // VideoChannelSingleThreadTest
 TEST_F(VideoChannelSingleThreadTest, TestInit) {
   Base::TestInit();
@@ -2118,6 +2212,16 @@ TEST_F(VideoChannelSingleThreadTest, SocketOptionsMergedOnSetTransport) {
   Base::SocketOptionsMergedOnSetTransport();
 }
 
+TEST_F(VideoChannelSingleThreadTest,
+       TestDemuxerSinkNotRegisteredForUnchangedCriteria) {
+  Base::TestDemuxerSinkNotRegisteredForUnchangedCriteria();
+}
+
+TEST_F(VideoChannelSingleThreadTest,
+       TestDemuxerSinkRegisteredOnTransportSwitch) {
+  Base::TestDemuxerSinkRegisteredOnTransportSwitch();
+}
+
 TEST_F(VideoChannelSingleThreadTest, UpdateLocalStreamsWithSimulcast) {
   Base::TestUpdateLocalStreamsWithSimulcast();
 }
@@ -2415,6 +2519,16 @@ TEST_F(VideoChannelDoubleThreadTest, SocketOptionsMergedOnSetTransport) {
   Base::SocketOptionsMergedOnSetTransport();
 }
 
+TEST_F(VideoChannelDoubleThreadTest,
+       TestDemuxerSinkNotRegisteredForUnchangedCriteria) {
+  Base::TestDemuxerSinkNotRegisteredForUnchangedCriteria();
+}
+
+TEST_F(VideoChannelDoubleThreadTest,
+       TestDemuxerSinkRegisteredOnTransportSwitch) {
+  Base::TestDemuxerSinkRegisteredOnTransportSwitch();
+}
+
 // RtpDataChannelSingleThreadTest
 class RtpDataChannelSingleThreadTest : public ChannelTest<DataTraits> {
  public:
@@ -678,9 +678,9 @@ void ReportSimulcastApiVersion(const char* name,
 const ContentInfo* FindTransceiverMSection(
     RtpTransceiverProxyWithInternal<RtpTransceiver>* transceiver,
     const SessionDescriptionInterface* session_description) {
-  return transceiver->mid()
+  return transceiver->internal()->mid()
              ? session_description->description()->GetContentByName(
-                   *transceiver->mid())
+                   *transceiver->internal()->mid())
              : nullptr;
 }
 
@@ -2296,9 +2296,9 @@ RTCError PeerConnection::ApplyLocalDescription(
       // 2.2.7.1.1.(6-9): Set sender and receiver's transport slots.
       // Note that code paths that don't set MID won't be able to use
       // information about DTLS transports.
-      if (transceiver->mid()) {
+      if (transceiver->internal()->mid()) {
         auto dtls_transport =
-            LookupDtlsTransportByMidInternal(*transceiver->mid());
+            LookupDtlsTransportByMidInternal(*transceiver->internal()->mid());
         transceiver->internal()->sender_internal()->set_transport(
             dtls_transport);
         transceiver->internal()->receiver_internal()->set_transport(
@@ -2762,8 +2762,9 @@ RTCError PeerConnection::ApplyRemoteDescription(
         // "Set the RTCSessionDescription: If direction is sendrecv or recvonly,
         // and transceiver's current direction is neither sendrecv nor recvonly,
         // process the addition of a remote track for the media description.
-        if (!transceiver->fired_direction() ||
-            !RtpTransceiverDirectionHasRecv(*transceiver->fired_direction())) {
+        if (!transceiver->internal()->fired_direction() ||
+            !RtpTransceiverDirectionHasRecv(
+                *transceiver->internal()->fired_direction())) {
           RTC_LOG(LS_INFO)
               << "Processing the addition of a remote track for MID="
               << content->name << ".";
@@ -2775,8 +2776,9 @@ RTCError PeerConnection::ApplyRemoteDescription(
       // removal of a remote track for the media description, given transceiver,
       // removeList, and muteTracks.
       if (!RtpTransceiverDirectionHasRecv(local_direction) &&
-          (transceiver->fired_direction() &&
-           RtpTransceiverDirectionHasRecv(*transceiver->fired_direction()))) {
+          (transceiver->internal()->fired_direction() &&
+           RtpTransceiverDirectionHasRecv(
+               *transceiver->internal()->fired_direction()))) {
         ProcessRemovalOfRemoteTrack(transceiver, &remove_list,
                                     &removed_streams);
       }
@@ -2789,9 +2791,9 @@ RTCError PeerConnection::ApplyRemoteDescription(
         // direction.
         transceiver->internal()->set_current_direction(local_direction);
         // 2.2.8.1.11.[3-6]: Set the transport internal slots.
-        if (transceiver->mid()) {
+        if (transceiver->internal()->mid()) {
           auto dtls_transport =
-              LookupDtlsTransportByMidInternal(*transceiver->mid());
+              LookupDtlsTransportByMidInternal(*transceiver->internal()->mid());
           transceiver->internal()->sender_internal()->set_transport(
               dtls_transport);
           transceiver->internal()->receiver_internal()->set_transport(
@@ -2800,7 +2802,7 @@ RTCError PeerConnection::ApplyRemoteDescription(
       }
       // 2.2.8.1.12: If the media description is rejected, and transceiver is
       // not already stopped, stop the RTCRtpTransceiver transceiver.
-      if (content->rejected && !transceiver->stopped()) {
+      if (content->rejected && !transceiver->internal()->stopped()) {
         RTC_LOG(LS_INFO) << "Stopping transceiver for MID=" << content->name
                          << " since the media section was rejected.";
         transceiver->Stop();
@@ -3325,7 +3327,7 @@ rtc::scoped_refptr<RtpTransceiverProxyWithInternal<RtpTransceiver>>
 PeerConnection::GetAssociatedTransceiver(const std::string& mid) const {
   RTC_DCHECK(IsUnifiedPlan());
   for (auto transceiver : transceivers_) {
-    if (transceiver->mid() == mid) {
+    if (transceiver->internal()->mid() == mid) {
       return transceiver;
     }
   }
@@ -3353,9 +3355,10 @@ PeerConnection::FindAvailableTransceiverToReceive(
   // associated with any m= section and are not stopped, find the first such
   // RtpTransceiver.
   for (auto transceiver : transceivers_) {
-    if (transceiver->media_type() == media_type &&
-        transceiver->internal()->created_by_addtrack() && !transceiver->mid() &&
-        !transceiver->stopped()) {
+    if (transceiver->internal()->media_type() == media_type &&
+        transceiver->internal()->created_by_addtrack() &&
+        !transceiver->internal()->mid() &&
+        !transceiver->internal()->stopped()) {
       return transceiver;
     }
   }
@@ -3780,7 +3783,7 @@ PeerConnection::GetRemoteAudioSSLCertChain() {
 rtc::scoped_refptr<RtpTransceiverProxyWithInternal<RtpTransceiver>>
 PeerConnection::GetFirstAudioTransceiver() const {
   for (auto transceiver : transceivers_) {
-    if (transceiver->media_type() == cricket::MEDIA_TYPE_AUDIO) {
+    if (transceiver->internal()->media_type() == cricket::MEDIA_TYPE_AUDIO) {
       return transceiver;
     }
   }
@@ -4447,24 +4450,25 @@ GetMediaDescriptionOptionsForTransceiver(
         transceiver,
     const std::string& mid) {
   cricket::MediaDescriptionOptions media_description_options(
-      transceiver->media_type(), mid, transceiver->direction(),
-      transceiver->stopped());
+      transceiver->internal()->media_type(), mid,
+      transceiver->internal()->direction(), transceiver->internal()->stopped());
   media_description_options.codec_preferences =
-      transceiver->codec_preferences();
+      transceiver->internal()->codec_preferences();
   // This behavior is specified in JSEP. The gist is that:
   // 1. The MSID is included if the RtpTransceiver's direction is sendonly or
   //    sendrecv.
   // 2. If the MSID is included, then it must be included in any subsequent
   //    offer/answer exactly the same until the RtpTransceiver is stopped.
-  if (transceiver->stopped() ||
-      (!RtpTransceiverDirectionHasSend(transceiver->direction()) &&
+  if (transceiver->internal()->stopped() ||
+      (!RtpTransceiverDirectionHasSend(transceiver->internal()->direction()) &&
        !transceiver->internal()->has_ever_been_used_to_send())) {
     return media_description_options;
   }
 
   cricket::SenderOptions sender_options;
-  sender_options.track_id = transceiver->sender()->id();
-  sender_options.stream_ids = transceiver->sender()->stream_ids();
+  sender_options.track_id = transceiver->internal()->sender_internal()->id();
+  sender_options.stream_ids =
+      transceiver->internal()->sender_internal()->stream_ids();
 
   // The following sets up RIDs and Simulcast.
   // RIDs are included if Simulcast is requested or if any RID was specified.
@@ -4556,11 +4560,11 @@ void PeerConnection::GetOptionsForUnifiedPlanOffer(
       RTC_CHECK(transceiver);
       // A media section is considered eligible for recycling if it is marked as
       // rejected in either the current local or current remote description.
-      if (had_been_rejected && transceiver->stopped()) {
+      if (had_been_rejected && transceiver->internal()->stopped()) {
         session_options->media_description_options.push_back(
-            cricket::MediaDescriptionOptions(transceiver->media_type(), mid,
-                                             RtpTransceiverDirection::kInactive,
-                                             /*stopped=*/true));
+            cricket::MediaDescriptionOptions(
+                transceiver->internal()->media_type(), mid,
+                RtpTransceiverDirection::kInactive, /*stopped=*/true));
         recycleable_mline_indices.push(i);
       } else {
         session_options->media_description_options.push_back(
@@ -4590,7 +4594,7 @@ void PeerConnection::GetOptionsForUnifiedPlanOffer(
   // otherwise append to the end of the offer. New media sections should be
   // added in the order they were added to the PeerConnection.
   for (const auto& transceiver : transceivers_) {
-    if (transceiver->mid() || transceiver->stopped()) {
+    if (transceiver->internal()->mid() || transceiver->internal()->stopped()) {
       continue;
     }
     size_t mline_index;
@@ -5682,6 +5686,9 @@ RTCError PeerConnection::PushdownMediaDescription(
   RTC_DCHECK(sdesc);
 
   // Push down the new SDP media section for each audio/video transceiver.
+  std::vector<std::pair<cricket::ChannelInterface*,
+                        const MediaContentDescription*>>
+      channels;
   for (const auto& transceiver : transceivers_) {
     const ContentInfo* content_info =
         FindMediaSectionForTransceiver(transceiver, sdesc);
@@ -5694,13 +5701,26 @@ RTCError PeerConnection::PushdownMediaDescription(
     if (!content_desc) {
       continue;
     }
-    std::string error;
-    bool success = (source == cricket::CS_LOCAL)
-                       ? channel->SetLocalContent(content_desc, type, &error)
-                       : channel->SetRemoteContent(content_desc, type, &error);
-    if (!success) {
-      LOG_AND_RETURN_ERROR(RTCErrorType::INVALID_PARAMETER, error);
-    }
+    channels.push_back(std::make_pair(channel, content_desc));
+  }
+  // The channels are updated in a single hop to the worker thread, rather than
+  // one per channel, since their Set*Content() methods run there anyway.
+  RTCError channel_error =
+      worker_thread()->Invoke<RTCError>(RTC_FROM_HERE, [&] {
+        for (const auto& entry : channels) {
+          std::string error;
+          bool success =
+              (source == cricket::CS_LOCAL)
+                  ? entry.first->SetLocalContent(entry.second, type, &error)
+                  : entry.first->SetRemoteContent(entry.second, type, &error);
+          if (!success) {
+            LOG_AND_RETURN_ERROR(RTCErrorType::INVALID_PARAMETER, error);
+          }
+        }
+        return RTCError::OK();
+      });
+  if (!channel_error.ok()) {
+    return channel_error;
   }
 
   // If using the RtpDataChannel, push down the new SDP section for it too.
@@ -7345,7 +7365,7 @@ bool PeerConnection::CheckIfNegotiationIsNeeded() {
     // but the associated m= section is not yet rejected in
     // connection.[[CurrentLocalDescription]] or
     // connection.[[CurrentRemoteDescription]], return true.
-    if (transceiver->stopped()) {
+    if (transceiver->internal()->stopped()) {
       if (current_local_msection && !current_local_msection->rejected &&
           ((current_remote_msection && !current_remote_msection->rejected) ||
            !current_remote_msection)) {
@@ -7369,7 +7389,7 @@ bool PeerConnection::CheckIfNegotiationIsNeeded() {
     // "a=msid" line, or the number of MSIDs from the "a=msid" lines in this
     // m= section, or the MSID values themselves, differ from what is in
     // transceiver.sender.[[AssociatedMediaStreamIds]], return true.
-    if (RtpTransceiverDirectionHasSend(transceiver->direction())) {
+    if (RtpTransceiverDirectionHasSend(transceiver->internal()->direction())) {
       if (current_local_media_description->streams().size() == 0)
         return true;
 
@@ -7380,7 +7400,7 @@ bool PeerConnection::CheckIfNegotiationIsNeeded() {
       }
 
       std::vector<std::string> transceiver_msids =
-          transceiver->sender()->stream_ids();
+          transceiver->internal()->sender_internal()->stream_ids();
       if (msection_msids.size() != transceiver_msids.size())
         return true;
 
@@ -7405,8 +7425,8 @@ bool PeerConnection::CheckIfNegotiationIsNeeded() {
           current_local_media_description->direction();
       RtpTransceiverDirection current_remote_direction =
           current_remote_msection->media_description()->direction();
-      if (transceiver->direction() != current_local_direction &&
-          transceiver->direction() !=
+      if (transceiver->internal()->direction() != current_local_direction &&
+          transceiver->internal()->direction() !=
               RtpTransceiverDirectionReversed(current_remote_direction)) {
         return true;
       }
@@ -7430,7 +7450,7 @@ bool PeerConnection::CheckIfNegotiationIsNeeded() {
 
       if (current_local_media_description->direction() !=
           (RtpTransceiverDirectionIntersection(
-              transceiver->direction(),
+              transceiver->internal()->direction(),
               RtpTransceiverDirectionReversed(offered_direction)))) {
         return true;
       }
@@ -1189,6 +1189,10 @@ class PeerConnection : public PeerConnectionInternal,
   rtc::scoped_refptr<RTCStatsCollector> stats_collector_
       RTC_GUARDED_BY(signaling_thread());
 
+  // Code running on the signaling thread should go through internal() rather
+  // than the proxy. Even when a proxy call runs inline, its MethodCall is a
+  // MessageHandler whose destructor clears every message queue under a global
+  // lock, which adds up in the per-transceiver loops of a renegotiation.
   std::vector<
       rtc::scoped_refptr<RtpTransceiverProxyWithInternal<RtpTransceiver>>>
       transceivers_;  // TODO(bugs.webrtc.org/9987): Accessed on both signaling
@@ -0,0 +1,189 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/call/call_factory_interface.h"
+#include "api/jsep.h"
+#include "api/peer_connection_interface.h"
+#include "api/rtp_transceiver_interface.h"
+#include "api/scoped_refptr.h"
+#include "api/task_queue/default_task_queue_factory.h"
+#include "media/base/fake_media_engine.h"
+#include "p2p/base/fake_port_allocator.h"
+#include "pc/test/mock_peer_connection_observers.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/ref_counted_object.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+#include "rtc_base/virtual_socket_server.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumRounds = 20;
+constexpr int kQuickNumRounds = 2;
+constexpr int kTimeoutMs = 10000;
+
+using RTCConfiguration = PeerConnectionInterface::RTCConfiguration;
+using RTCOfferAnswerOptions = PeerConnectionInterface::RTCOfferAnswerOptions;
+
+// A PeerConnection with a fake media engine and a port allocator that doesn't
+// gather, whose signaling thread is the current thread.
+class PeerConnectionForTest {
+ public:
+  PeerConnectionForTest(rtc::Thread* network_thread,
+                        rtc::Thread* worker_thread) {
+    PeerConnectionFactoryDependencies factory_dependencies;
+    factory_dependencies.network_thread = network_thread;
+    factory_dependencies.worker_thread = worker_thread;
+    factory_dependencies.signaling_thread = rtc::Thread::Current();
+    factory_dependencies.task_queue_factory = CreateDefaultTaskQueueFactory();
+    factory_dependencies.media_engine =
+        absl::make_unique<cricket::FakeMediaEngine>();
+    factory_dependencies.call_factory = CreateCallFactory();
+    factory_ = CreateModularPeerConnectionFactory(
+        std::move(factory_dependencies));
+
+    RTCConfiguration config;
+    config.sdp_semantics = SdpSemantics::kUnifiedPlan;
+    config.bundle_policy = PeerConnectionInterface::kBundlePolicyMaxBundle;
+    pc_ = factory_->CreatePeerConnection(
+        config,
+        absl::make_unique<cricket::FakePortAllocator>(network_thread,
+                                                      nullptr),
+        nullptr, &observer_);
+    observer_.SetPeerConnectionInterface(pc_.get());
+  }
+
+  PeerConnectionInterface* pc() { return pc_.get(); }
+
+  // The time spent in the call of CreateOffer() or CreateAnswer() is added to
+  // |elapsed_us|, but not the time to wait for the result.
+  std::unique_ptr<SessionDescriptionInterface> CreateSdp(bool offer,
+                                                         int64_t* elapsed_us) {
+    rtc::scoped_refptr<MockCreateSessionDescriptionObserver> observer(
+        new rtc::RefCountedObject<MockCreateSessionDescriptionObserver>());
+    const int64_t start_us = rtc::TimeMicros();
+    if (offer)
+      pc_->CreateOffer(observer, RTCOfferAnswerOptions());
+    else
+      pc_->CreateAnswer(observer, RTCOfferAnswerOptions());
+    *elapsed_us += rtc::TimeMicros() - start_us;
+    EXPECT_TRUE_WAIT(observer->called(), kTimeoutMs);
+    EXPECT_TRUE(observer->result());
+    return observer->MoveDescription();
+  }
+
+  void SetSdp(bool local,
+              std::unique_ptr<SessionDescriptionInterface> desc,
+              int64_t* elapsed_us) {
+    rtc::scoped_refptr<MockSetSessionDescriptionObserver> observer(
+        new rtc::RefCountedObject<MockSetSessionDescriptionObserver>());
+    const int64_t start_us = rtc::TimeMicros();
+    if (local)
+      pc_->SetLocalDescription(observer, desc.release());
+    else
+      pc_->SetRemoteDescription(observer, desc.release());
+    *elapsed_us += rtc::TimeMicros() - start_us;
+    EXPECT_TRUE_WAIT(observer->called(), kTimeoutMs);
+    EXPECT_TRUE(observer->result());
+  }
+
+  // Negotiates with |answerer|, and returns the time spent by both sides in
+  // the calls that create and apply the descriptions.
+  int64_t ExchangeOfferAnswerWith(PeerConnectionForTest* answerer) {
+    int64_t elapsed_us = 0;
+    auto offer = CreateSdp(/*offer=*/true, &elapsed_us);
+    std::string sdp;
+    offer->ToString(&sdp);
+    SetSdp(/*local=*/true, std::move(offer), &elapsed_us);
+    answerer->SetSdp(/*local=*/false,
+                     CreateSessionDescription(SdpType::kOffer, sdp),
+                     &elapsed_us);
+    auto answer = answerer->CreateSdp(/*offer=*/false, &elapsed_us);
+    answer->ToString(&sdp);
+    answerer->SetSdp(/*local=*/true, std::move(answer), &elapsed_us);
+    SetSdp(/*local=*/false, CreateSessionDescription(SdpType::kAnswer, sdp),
+           &elapsed_us);
+    return elapsed_us;
+  }
+
+ private:
+  rtc::scoped_refptr<PeerConnectionFactoryInterface> factory_;
+  MockPeerConnectionObserver observer_;
+  rtc::scoped_refptr<PeerConnectionInterface> pc_;
+};
+
+// Negotiates a session with |num_transceivers| audio and video transceivers,
+// and returns the mean time of a renegotiation as participants join and leave,
+// i.e. as transceivers are added and stopped one at a time.
+double MeasureRenegotiationTimeMs(int num_transceivers, int num_rounds) {
+  rtc::VirtualSocketServer vss;
+  rtc::AutoSocketServerThread main_thread(&vss);
+  std::unique_ptr<rtc::Thread> network_thread =
+      rtc::Thread::CreateWithSocketServer();
+  std::unique_ptr<rtc::Thread> worker_thread = rtc::Thread::Create();
+  network_thread->Start();
+  worker_thread->Start();
+  // Destroyed before the threads.
+  auto caller = absl::make_unique<PeerConnectionForTest>(network_thread.get(),
+                                                         worker_thread.get());
+  auto callee = absl::make_unique<PeerConnectionForTest>(network_thread.get(),
+                                                         worker_thread.get());
+
+  for (int i = 0; i < num_transceivers; ++i) {
+    caller->pc()->AddTransceiver(i % 2 == 0 ? cricket::MEDIA_TYPE_AUDIO
+                                            : cricket::MEDIA_TYPE_VIDEO);
+  }
+  caller->ExchangeOfferAnswerWith(callee.get());
+
+  int64_t elapsed_us = 0;
+  for (int round = 0; round < num_rounds; ++round) {
+    auto transceiver =
+        caller->pc()->AddTransceiver(cricket::MEDIA_TYPE_VIDEO).MoveValue();
+    elapsed_us += caller->ExchangeOfferAnswerWith(callee.get());
+    transceiver->Stop();
+    elapsed_us += caller->ExchangeOfferAnswerWith(callee.get());
+  }
+
+  caller.reset();
+  callee.reset();
+  return static_cast<double>(elapsed_us) / rtc::kNumMicrosecsPerMillisec /
+         (2 * num_rounds);
+}
+
+}  // namespace
+
+// Reports the time spent by the caller and the callee on the signaling thread
+// to create and apply the descriptions of a renegotiation in which a single
+// m= section is added or rejected, for a growing number of transceivers.
+TEST(PeerConnectionRenegotiationPerformanceTest, AddAndStopTransceiver) {
+  const int num_rounds = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                             ? kQuickNumRounds
+                             : kNumRounds;
+  for (int num_transceivers : {10, 50, 100, 200}) {
+    webrtc::test::PrintResult(
+        "renegotiation_time", "",
+        std::to_string(num_transceivers) + "_transceivers",
+        MeasureRenegotiationTimeMs(num_transceivers, num_rounds), "ms", true);
+  }
+}
+
+}  // namespace webrtc
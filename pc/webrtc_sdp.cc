@@ -26,6 +26,7 @@
 #include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
 #include "api/candidate.h"
 #include "api/crypto_params.h"
 #include "api/jsep_ice_candidate.h"
@@ -269,6 +270,22 @@ struct SsrcInfo {
 typedef std::vector<SsrcInfo> SsrcInfoVec;
 typedef std::vector<SsrcGroup> SsrcGroupVec;
 
+// The lines written by BuildRtpMap() for the codecs of |media_desc|.
+template <class T>
+struct RtpMapLines {
+  const T* media_desc = nullptr;
+  std::string lines;
+};
+
+// The codec lines of the last audio and video m= section of a session
+// description being serialized. They are reused for the following m= sections
+// with the same codecs, since the m= sections of a large bundled session mostly
+// share them, and they make up most of the text of an m= section.
+struct RtpMapCache {
+  RtpMapLines<AudioContentDescription> audio;
+  RtpMapLines<VideoContentDescription> video;
+};
+
 template <class T>
 static void AddFmtpLine(const T& codec, std::string* message);
 static void BuildMediaDescription(const ContentInfo* content_info,
@@ -276,10 +293,12 @@ static void BuildMediaDescription(const ContentInfo* content_info,
                                   const cricket::MediaType media_type,
                                   const std::vector<Candidate>& candidates,
                                   int msid_signaling,
+                                  RtpMapCache* rtpmap_cache,
                                   std::string* message);
 static void BuildRtpContentAttributes(const MediaContentDescription* media_desc,
                                       const cricket::MediaType media_type,
                                       int msid_signaling,
+                                      RtpMapCache* rtpmap_cache,
                                       std::string* message);
 static void BuildRtpMap(const MediaContentDescription* media_desc,
                         const cricket::MediaType media_type,
@@ -457,7 +476,7 @@ static bool ParseFailedExpectMinFieldNum(const std::string& line,
 // |line| is the failing line. The failure is due to the fact that it failed to
 // get the value of |attribute|.
 static bool ParseFailedGetValue(const std::string& line,
-                                const std::string& attribute,
+                                absl::string_view attribute,
                                 SdpParseError* error) {
   rtc::StringBuilder description;
   description << "Failed to get the value of attribute: " << attribute;
@@ -501,7 +520,8 @@ static bool GetLine(const std::string& message,
   if (line_end > 0 && (message.at(line_end - 1) == kReturnChar)) {
     --line_end;
   }
-  *line = message.substr(line_begin, (line_end - line_begin));
+  // Reuses the buffer of |line|, which is the same for all lines of an SDP.
+  line->assign(message, line_begin, line_end - line_begin);
   const char* cline = line->c_str();
   // RFC 4566
   // An SDP session description consists of a number of lines of text of
@@ -600,9 +620,11 @@ static bool GetLineWithType(const std::string& message,
   return true;
 }
 
-static bool HasAttribute(const std::string& line,
-                         const std::string& attribute) {
-  if (line.compare(kLinePrefixLength, attribute.size(), attribute) == 0) {
+// Takes the attribute as a string_view, since it's called with the kAttribute
+// constants for every attribute line until one of them matches.
+static bool HasAttribute(const std::string& line, absl::string_view attribute) {
+  if (line.compare(kLinePrefixLength, attribute.size(), attribute.data(),
+                   attribute.size()) == 0) {
     // Make sure that the match is not only a partial match. If length of
     // strings doesn't match, the next character of the line must be ':' or ' '.
     // This function is also used for media descriptions (e.g., "m=audio 9..."),
@@ -632,19 +654,26 @@ static bool AddSsrcLine(uint32_t ssrc_id,
 
 // Get value only from <attribute>:<value>.
 static bool GetValue(const std::string& message,
-                     const std::string& attribute,
+                     absl::string_view attribute,
                      std::string* value,
                      SdpParseError* error) {
-  std::string leftpart;
-  if (!rtc::tokenize_first(message, kSdpDelimiterColonChar, &leftpart, value)) {
+  // Same as rtc::tokenize_first(), without copying the left part.
+  size_t left_end = message.find(kSdpDelimiterColonChar);
+  if (left_end == std::string::npos) {
     return ParseFailedGetValue(message, attribute, error);
   }
   // The left part should end with the expected attribute.
-  if (leftpart.length() < attribute.length() ||
-      leftpart.compare(leftpart.length() - attribute.length(),
-                       attribute.length(), attribute) != 0) {
+  if (left_end < attribute.length() ||
+      message.compare(left_end - attribute.length(), attribute.length(),
+                      attribute.data(), attribute.length()) != 0) {
     return ParseFailedGetValue(message, attribute, error);
   }
+  size_t value_begin = left_end + 1;
+  while (value_begin < message.size() &&
+         message[value_begin] == kSdpDelimiterColonChar) {
+    ++value_begin;
+  }
+  value->assign(message, value_begin, std::string::npos);
   return true;
 }
 
@@ -960,12 +989,13 @@ std::string SdpSerialize(const JsepSessionDescription& jdesc) {
 
   // Preserve the order of the media contents.
   int mline_index = -1;
+  RtpMapCache rtpmap_cache;
   for (const ContentInfo& content : desc->contents()) {
     std::vector<Candidate> candidates;
     GetCandidatesByMindex(jdesc, ++mline_index, &candidates);
     BuildMediaDescription(&content, desc->GetTransportInfoByName(content.name),
                           content.media_description()->type(), candidates,
-                          desc->msid_signaling(), &message);
+                          desc->msid_signaling(), &rtpmap_cache, &message);
   }
   return message;
 }
@@ -1372,6 +1402,7 @@ void BuildMediaDescription(const ContentInfo* content_info,
                            const cricket::MediaType media_type,
                            const std::vector<Candidate>& candidates,
                            int msid_signaling,
+                           RtpMapCache* rtpmap_cache,
                            std::string* message) {
   RTC_DCHECK(message != NULL);
   if (content_info == NULL || message == NULL) {
@@ -1569,13 +1600,70 @@ void BuildMediaDescription(const ContentInfo* content_info,
         media_desc->as_sctp();
     BuildSctpContentAttributes(message, data_desc);
   } else if (cricket::IsRtpProtocol(media_desc->protocol())) {
-    BuildRtpContentAttributes(media_desc, media_type, msid_signaling, message);
+    BuildRtpContentAttributes(media_desc, media_type, msid_signaling,
+                              rtpmap_cache, message);
   }
 }
 
+// Whether BuildRtpMap() writes the same lines for |a| and |b|. Unlike
+// Codec::operator==, this doesn't ignore the case of the feedback params.
+static bool HasSameRtpMap(const cricket::Codec& a, const cricket::Codec& b) {
+  if (a.id != b.id || a.name != b.name || a.clockrate != b.clockrate ||
+      a.params != b.params) {
+    return false;
+  }
+  const std::vector<cricket::FeedbackParam>& a_fb = a.feedback_params.params();
+  const std::vector<cricket::FeedbackParam>& b_fb = b.feedback_params.params();
+  if (a_fb.size() != b_fb.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a_fb.size(); ++i) {
+    if (a_fb[i].id() != b_fb[i].id() || a_fb[i].param() != b_fb[i].param()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool HasSameRtpMap(const cricket::AudioCodec& a,
+                          const cricket::AudioCodec& b) {
+  return a.channels == b.channels &&
+         HasSameRtpMap(static_cast<const cricket::Codec&>(a),
+                       static_cast<const cricket::Codec&>(b));
+}
+
+static bool HasSameRtpMap(const cricket::VideoCodec& a,
+                          const cricket::VideoCodec& b) {
+  return a.packetization == b.packetization &&
+         HasSameRtpMap(static_cast<const cricket::Codec&>(a),
+                       static_cast<const cricket::Codec&>(b));
+}
+
+// Adds the lines of BuildRtpMap() for |media_desc|, reusing the ones of the
+// previous m= section of the same type if it has the same codecs.
+template <class T>
+static void AddCachedRtpMap(const T* media_desc,
+                            const cricket::MediaType media_type,
+                            RtpMapLines<T>* cached,
+                            std::string* message) {
+  const auto& codecs = media_desc->codecs();
+  if (!cached->media_desc ||
+      !absl::c_equal(cached->media_desc->codecs(), codecs,
+                     [](const typename T::CodecType& a,
+                        const typename T::CodecType& b) {
+                       return HasSameRtpMap(a, b);
+                     })) {
+    cached->lines.clear();
+    BuildRtpMap(media_desc, media_type, &cached->lines);
+    cached->media_desc = media_desc;
+  }
+  message->append(cached->lines);
+}
+
 void BuildRtpContentAttributes(const MediaContentDescription* media_desc,
                                const cricket::MediaType media_type,
                                int msid_signaling,
+                               RtpMapCache* rtpmap_cache,
                                std::string* message) {
   SdpSerializer serializer;
   rtc::StringBuilder os;
@@ -1685,7 +1773,15 @@ void BuildRtpContentAttributes(const MediaContentDescription* media_desc,
   // RFC 4566
   // a=rtpmap:<payload type> <encoding name>/<clock rate>
   // [/<encodingparameters>]
-  BuildRtpMap(media_desc, media_type, message);
+  if (media_type == cricket::MEDIA_TYPE_AUDIO) {
+    AddCachedRtpMap(media_desc->as_audio(), media_type, &rtpmap_cache->audio,
+                    message);
+  } else if (media_type == cricket::MEDIA_TYPE_VIDEO) {
+    AddCachedRtpMap(media_desc->as_video(), media_type, &rtpmap_cache->video,
+                    message);
+  } else {
+    BuildRtpMap(media_desc, media_type, message);
+  }
 
   for (const StreamParams& track : media_desc->streams()) {
     // Build the ssrc-group lines.
@@ -2929,22 +3025,9 @@ T GetCodecWithPayloadType(const std::vector<T>& codecs, int payload_type) {
 // Updates or creates a new codec entry in the audio description.
 template <class T, class U>
 void AddOrReplaceCodec(MediaContentDescription* content_desc, const U& codec) {
-  T* desc = static_cast<T*>(content_desc);
-  std::vector<U> codecs = desc->codecs();
-  bool found = false;
-  for (U& existing_codec : codecs) {
-    if (codec.id == existing_codec.id) {
-      // Overwrite existing codec with the new codec.
-      existing_codec = codec;
-      found = true;
-      break;
-    }
-  }
-  if (!found) {
-    desc->AddCodec(codec);
-    return;
-  }
-  desc->set_codecs(codecs);
+  // Replaces the codec in place rather than copying all the codecs, since
+  // this is done for every rtpmap, fmtp and rtcp-fb line.
+  static_cast<T*>(content_desc)->AddOrReplaceCodec(codec);
 }
 
 // Adds or updates existing codec corresponding to |payload_type| according
@@ -3066,6 +3149,8 @@ bool ParseContent(const std::string& message,
   SdpSerializer deserializer;
   std::vector<RidDescription> rids;
   SimulcastDescription simulcast;
+  const bool is_rtp = cricket::IsRtpProtocol(protocol);
+  const bool is_dtls_sctp = cricket::IsDtlsSctp(protocol);
 
   // Loop until the next m line
   while (!IsLineType(message, kLineTypeMedia, *pos)) {
@@ -3107,8 +3192,7 @@ bool ParseContent(const std::string& message,
           // data channels. Don't allow SDP to set the bandwidth, because
           // that would give JS the opportunity to "break the Internet".
           // See: https://code.google.com/p/chromium/issues/detail?id=280726
-          if (media_type == cricket::MEDIA_TYPE_DATA &&
-              cricket::IsRtpProtocol(protocol) &&
+          if (media_type == cricket::MEDIA_TYPE_DATA && is_rtp &&
               b > cricket::kDataMaxBandwidth / 1000) {
             rtc::StringBuilder description;
             description << "RTP-based data channels may not send more than "
@@ -3196,8 +3280,7 @@ bool ParseContent(const std::string& message,
       if (!ParseDtlsSetup(line, &(transport->connection_role), error)) {
         return false;
       }
-    } else if (cricket::IsDtlsSctp(protocol) &&
-               HasAttribute(line, kAttributeSctpPort)) {
+    } else if (is_dtls_sctp && HasAttribute(line, kAttributeSctpPort)) {
       if (media_type != cricket::MEDIA_TYPE_DATA) {
         return ParseFailed(
             line, "sctp-port attribute found in non-data media description.",
@@ -3212,8 +3295,7 @@ bool ParseContent(const std::string& message,
         return false;
       }
       media_desc->as_sctp()->set_port(sctp_port);
-    } else if (cricket::IsDtlsSctp(protocol) &&
-               HasAttribute(line, kAttributeMaxMessageSize)) {
+    } else if (is_dtls_sctp && HasAttribute(line, kAttributeMaxMessageSize)) {
       if (media_type != cricket::MEDIA_TYPE_DATA) {
         return ParseFailed(
             line,
@@ -3225,7 +3307,7 @@ bool ParseContent(const std::string& message,
         return false;
       }
       media_desc->as_sctp()->set_max_message_size(max_message_size);
-    } else if (cricket::IsRtpProtocol(protocol)) {
+    } else if (is_rtp) {
       //
       // RTP specific attrubtes
       //
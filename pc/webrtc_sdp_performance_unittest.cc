@@ -0,0 +1,247 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "api/jsep.h"
+#include "api/jsep_session_description.h"
+#include "pc/session_description.h"
+#include "pc/webrtc_sdp.h"
+#include "rtc_base/strings/string_builder.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumMediaSections = 200;
+constexpr int kNumRounds = 20;
+constexpr int kQuickNumRounds = 2;
+
+const char kSessionSection[] =
+    "v=0\r\n"
+    "o=- 5523165488631297153 2 IN IP4 127.0.0.1\r\n"
+    "s=-\r\n"
+    "t=0 0\r\n";
+
+const char kTransportLines[] =
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=rtcp:9 IN IP4 0.0.0.0\r\n"
+    "a=ice-ufrag:OQ4J\r\n"
+    "a=ice-pwd:HGXo7kPOPM8mBwVjnE2VRhhZ\r\n"
+    "a=ice-options:trickle\r\n"
+    "a=fingerprint:sha-256 "
+    "4A:AD:B9:B1:3F:82:18:3B:54:02:12:DF:3E:5D:49:6B:19:E5:7C:AB:4E:15:6A:"
+    "30:A4:E5:A5:D2:D6:0C:B7:33\r\n"
+    "a=setup:actpass\r\n";
+
+const char kAudioMediaLine[] =
+    "m=audio 9 UDP/TLS/RTP/SAVPF 111 103 104 9 0 8 106 105 13 110 112 113 "
+    "126\r\n";
+
+const char kAudioAttributes[] =
+    "a=extmap:1 urn:ietf:params:rtp-hdrext:ssrc-audio-level\r\n"
+    "a=extmap:2 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+    "a=extmap:3 "
+    "http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01"
+    "\r\n"
+    "a=extmap:4 urn:ietf:params:rtp-hdrext:sdes:mid\r\n"
+    "a=sendrecv\r\n"
+    "a=rtcp-mux\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=rtcp-fb:111 transport-cc\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=rtpmap:103 ISAC/16000\r\n"
+    "a=rtpmap:104 ISAC/32000\r\n"
+    "a=rtpmap:9 G722/8000\r\n"
+    "a=rtpmap:0 PCMU/8000\r\n"
+    "a=rtpmap:8 PCMA/8000\r\n"
+    "a=rtpmap:106 CN/32000\r\n"
+    "a=rtpmap:105 CN/16000\r\n"
+    "a=rtpmap:13 CN/8000\r\n"
+    "a=rtpmap:110 telephone-event/48000\r\n"
+    "a=rtpmap:112 telephone-event/32000\r\n"
+    "a=rtpmap:113 telephone-event/16000\r\n"
+    "a=rtpmap:126 telephone-event/8000\r\n";
+
+const char kVideoMediaLine[] =
+    "m=video 9 UDP/TLS/RTP/SAVPF 96 97 98 99 100 101 102 122 127 121 125 107 "
+    "108 109 124 120 123\r\n";
+
+const char kVideoAttributes[] =
+    "a=extmap:14 urn:ietf:params:rtp-hdrext:toffset\r\n"
+    "a=extmap:2 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+    "a=extmap:13 urn:3gpp:video-orientation\r\n"
+    "a=extmap:3 "
+    "http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01"
+    "\r\n"
+    "a=extmap:12 "
+    "http://www.webrtc.org/experiments/rtp-hdrext/playout-delay\r\n"
+    "a=extmap:4 urn:ietf:params:rtp-hdrext:sdes:mid\r\n"
+    "a=sendrecv\r\n"
+    "a=rtcp-mux\r\n"
+    "a=rtcp-rsize\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=rtcp-fb:96 goog-remb\r\n"
+    "a=rtcp-fb:96 transport-cc\r\n"
+    "a=rtcp-fb:96 ccm fir\r\n"
+    "a=rtcp-fb:96 nack\r\n"
+    "a=rtcp-fb:96 nack pli\r\n"
+    "a=rtpmap:97 rtx/90000\r\n"
+    "a=fmtp:97 apt=96\r\n"
+    "a=rtpmap:98 VP9/90000\r\n"
+    "a=rtcp-fb:98 goog-remb\r\n"
+    "a=rtcp-fb:98 transport-cc\r\n"
+    "a=rtcp-fb:98 ccm fir\r\n"
+    "a=rtcp-fb:98 nack\r\n"
+    "a=rtcp-fb:98 nack pli\r\n"
+    "a=fmtp:98 profile-id=0\r\n"
+    "a=rtpmap:99 rtx/90000\r\n"
+    "a=fmtp:99 apt=98\r\n"
+    "a=rtpmap:100 VP9/90000\r\n"
+    "a=rtcp-fb:100 goog-remb\r\n"
+    "a=rtcp-fb:100 transport-cc\r\n"
+    "a=rtcp-fb:100 ccm fir\r\n"
+    "a=rtcp-fb:100 nack\r\n"
+    "a=rtcp-fb:100 nack pli\r\n"
+    "a=fmtp:100 profile-id=2\r\n"
+    "a=rtpmap:101 rtx/90000\r\n"
+    "a=fmtp:101 apt=100\r\n"
+    "a=rtpmap:102 H264/90000\r\n"
+    "a=rtcp-fb:102 goog-remb\r\n"
+    "a=rtcp-fb:102 transport-cc\r\n"
+    "a=rtcp-fb:102 ccm fir\r\n"
+    "a=rtcp-fb:102 nack\r\n"
+    "a=rtcp-fb:102 nack pli\r\n"
+    "a=fmtp:102 "
+    "level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42001f\r\n"
+    "a=rtpmap:122 rtx/90000\r\n"
+    "a=fmtp:122 apt=102\r\n"
+    "a=rtpmap:127 H264/90000\r\n"
+    "a=rtcp-fb:127 goog-remb\r\n"
+    "a=rtcp-fb:127 transport-cc\r\n"
+    "a=rtcp-fb:127 ccm fir\r\n"
+    "a=rtcp-fb:127 nack\r\n"
+    "a=rtcp-fb:127 nack pli\r\n"
+    "a=fmtp:127 "
+    "level-asymmetry-allowed=1;packetization-mode=0;profile-level-id=42001f\r\n"
+    "a=rtpmap:121 rtx/90000\r\n"
+    "a=fmtp:121 apt=127\r\n"
+    "a=rtpmap:125 H264/90000\r\n"
+    "a=rtcp-fb:125 goog-remb\r\n"
+    "a=rtcp-fb:125 transport-cc\r\n"
+    "a=rtcp-fb:125 ccm fir\r\n"
+    "a=rtcp-fb:125 nack\r\n"
+    "a=rtcp-fb:125 nack pli\r\n"
+    "a=fmtp:125 "
+    "level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42e01f\r\n"
+    "a=rtpmap:107 rtx/90000\r\n"
+    "a=fmtp:107 apt=125\r\n"
+    "a=rtpmap:108 H264/90000\r\n"
+    "a=rtcp-fb:108 goog-remb\r\n"
+    "a=rtcp-fb:108 transport-cc\r\n"
+    "a=rtcp-fb:108 ccm fir\r\n"
+    "a=rtcp-fb:108 nack\r\n"
+    "a=rtcp-fb:108 nack pli\r\n"
+    "a=fmtp:108 "
+    "level-asymmetry-allowed=1;packetization-mode=0;profile-level-id=42e01f\r\n"
+    "a=rtpmap:109 rtx/90000\r\n"
+    "a=fmtp:109 apt=108\r\n"
+    "a=rtpmap:124 red/90000\r\n"
+    "a=rtpmap:120 rtx/90000\r\n"
+    "a=fmtp:120 apt=124\r\n"
+    "a=rtpmap:123 ulpfec/90000\r\n";
+
+// Returns an offer like the ones of a client in a large room, with one audio
+// and one video m-section per participant, bundled on the first one.
+std::string CreateLargeSdp(int num_media_sections) {
+  rtc::StringBuilder sdp;
+  sdp << kSessionSection << "a=group:BUNDLE";
+  for (int i = 0; i < num_media_sections; ++i)
+    sdp << " " << i;
+  sdp << "\r\na=msid-semantic: WMS\r\n";
+  for (int i = 0; i < num_media_sections; ++i) {
+    const bool audio = i % 2 == 0;
+    const int participant = i / 2;
+    const uint32_t ssrc = 1000 + 2 * i;
+    sdp << (audio ? kAudioMediaLine : kVideoMediaLine) << kTransportLines;
+    if (i == 0) {
+      sdp << "a=candidate:1 1 udp 2122260223 192.168.1.10 54321 typ host "
+             "generation 0 network-id 1\r\n"
+             "a=candidate:2 1 udp 1686052607 1.2.3.4 54321 typ srflx raddr "
+             "192.168.1.10 rport 54321 generation 0 network-id 1\r\n";
+    }
+    sdp << "a=mid:" << i << "\r\n"
+        << (audio ? kAudioAttributes : kVideoAttributes) << "a=msid:stream"
+        << participant << " track" << i << "\r\n";
+    if (!audio) {
+      sdp << "a=ssrc-group:FID " << ssrc << " " << ssrc + 1 << "\r\n";
+    }
+    const int num_ssrcs = audio ? 1 : 2;
+    for (int j = 0; j < num_ssrcs; ++j) {
+      sdp << "a=ssrc:" << ssrc + j << " cname:participant" << participant
+          << "\r\n"
+          << "a=ssrc:" << ssrc + j << " msid:stream" << participant << " track"
+          << i << "\r\n";
+    }
+  }
+  return sdp.Release();
+}
+
+}  // namespace
+
+// Parses and serializes an offer with hundreds of m-sections, like in
+// renegotiations of a large bundled session, and reports the time per SDP.
+TEST(WebRtcSdpPerformanceTest, LargeSession) {
+  const int num_rounds = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                             ? kQuickNumRounds
+                             : kNumRounds;
+  const std::string sdp = CreateLargeSdp(kNumMediaSections);
+
+  std::unique_ptr<JsepSessionDescription> jdesc;
+  int64_t start_us = rtc::TimeMicros();
+  for (int round = 0; round < num_rounds; ++round) {
+    jdesc = absl::make_unique<JsepSessionDescription>(SdpType::kOffer);
+    SdpParseError error;
+    ASSERT_TRUE(SdpDeserialize(sdp, jdesc.get(), &error)) << error.description;
+  }
+  const int64_t parse_us = rtc::TimeMicros() - start_us;
+  ASSERT_EQ(static_cast<size_t>(kNumMediaSections),
+            jdesc->description()->contents().size());
+
+  std::string serialized;
+  start_us = rtc::TimeMicros();
+  for (int round = 0; round < num_rounds; ++round)
+    serialized = SdpSerialize(*jdesc);
+  const int64_t serialize_us = rtc::TimeMicros() - start_us;
+
+  JsepSessionDescription reparsed(SdpType::kOffer);
+  EXPECT_TRUE(SdpDeserialize(serialized, &reparsed, nullptr));
+  EXPECT_EQ(serialized, SdpSerialize(reparsed));
+
+  const std::string trace =
+      std::to_string(kNumMediaSections) + "_media_sections";
+  webrtc::test::PrintResult("sdp_parse_time", "", trace,
+                            static_cast<double>(parse_us) /
+                                rtc::kNumMicrosecsPerMillisec / num_rounds,
+                            "ms", true);
+  webrtc::test::PrintResult("sdp_serialize_time", "", trace,
+                            static_cast<double>(serialize_us) /
+                                rtc::kNumMicrosecsPerMillisec / num_rounds,
+                            "ms", true);
+}
+
+}  // namespace webrtc
@@ -3791,6 +3791,29 @@ TEST_F(WebRtcSdpTest, SerializeUnifiedPlanSessionDescription) {
   TestSerialize(jdesc_);
 }
 
+// Tests that the codec lines of an m= section are only reused for the
+// following m= sections of the same type if they have the same codecs.
+TEST_F(WebRtcSdpTest, SerializeUnifiedPlanSessionDescriptionWithOtherCodecs) {
+  MakeUnifiedPlanDescription();
+  VideoContentDescription* video_desc_2 =
+      jdesc_.description()
+          ->GetContentDescriptionByName(kVideoContentName2)
+          ->as_video();
+  cricket::VideoCodecs codecs = video_desc_2->codecs();
+  codecs[0].params["x-google-min-bitrate"] = "10";
+  video_desc_2->set_codecs(codecs);
+
+  std::string message = webrtc::SdpSerialize(jdesc_);
+  const std::string fmtp_line = "a=fmtp:120 x-google-min-bitrate=10\r\n";
+  size_t fmtp_pos = message.find(fmtp_line);
+  ASSERT_NE(std::string::npos, fmtp_pos);
+  EXPECT_EQ(std::string::npos, message.find(fmtp_line, fmtp_pos + 1));
+
+  JsepSessionDescription deserialized_description(kDummyType);
+  EXPECT_TRUE(SdpDeserialize(message, &deserialized_description));
+  EXPECT_TRUE(CompareSessionDescription(jdesc_, deserialized_description));
+}
+
 // This tests deserializing a Unified Plan SDP that is compatible with both
 // Unified Plan and Plan B style SDP, meaning that it contains both "a=ssrc
 // msid" lines and "a=msid " lines. It tests the case for audio/video tracks
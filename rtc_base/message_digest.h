@@ -42,6 +42,12 @@ class MessageDigest {
 class MessageDigestFactory {
  public:
   static MessageDigest* Create(const std::string& alg);
+  // Creates an HMAC keyed with |key_len| bytes of |key|, for computing the
+  // HMACs of many messages with the same key. Returns null if there is no
+  // digest with the name |alg|.
+  static MessageDigest* CreateHmac(const std::string& alg,
+                                   const void* key,
+                                   size_t key_len);
 };
 
 // A whitelist of approved digest algorithms from RFC 4572 (FIPS 180).
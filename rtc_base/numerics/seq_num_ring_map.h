@@ -0,0 +1,348 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_NUMERICS_SEQ_NUM_RING_MAP_H_
+#define RTC_BASE_NUMERICS_SEQ_NUM_RING_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/numerics/sequence_number_util.h"
+
+namespace webrtc {
+
+// A map from 16 bit sequence numbers to values, ordered from the oldest to the
+// newest sequence number, with a subset of the std::map interface. If |M| is
+// non-zero, sequence numbers wrap at |M| rather than at 2^16.
+//
+// Entries are stored sorted in a ring buffer, which suits lists of e.g. lost
+// packets where new sequence numbers are added at the newest end and removed
+// either at the oldest end or one by one:
+//  - Adding a sequence number newer than all others, and removing the oldest
+//    one, is O(1) and does not allocate once the ring has grown to the
+//    working set.
+//  - Removing an arbitrary entry is O(log n); it leaves a hole that is reused
+//    or compacted away later.
+//  - Lookups are O(log n).
+//
+// Erasing invalidates iterators other than the one returned, and inserting
+// invalidates all iterators.
+//
+// WARNING! As with DescendingSeqNumComp, the sequence numbers held may not
+//          span more than half of the sequence number space.
+template <typename T, uint16_t M = 0>
+class SeqNumRingMap {
+ public:
+  using key_type = uint16_t;
+  using mapped_type = T;
+  using value_type = std::pair<uint16_t, T>;
+
+  template <typename Map, typename Value>
+  class Iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = SeqNumRingMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Value*;
+    using reference = Value&;
+
+    Iterator() = default;
+    Iterator(Map* map, size_t pos) : map_(map), pos_(pos) {}
+    // Allows conversion from iterator to const_iterator.
+    template <typename OtherMap, typename OtherValue>
+    Iterator(const Iterator<OtherMap, OtherValue>& other)  // NOLINT
+        : map_(other.map_), pos_(other.pos_) {}
+
+    reference operator*() const { return map_->slot(pos_).value; }
+    pointer operator->() const { return &map_->slot(pos_).value; }
+    Iterator& operator++() {
+      pos_ = map_->NextUsed(pos_ + 1);
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator it = *this;
+      ++*this;
+      return it;
+    }
+    Iterator& operator--() {
+      pos_ = map_->PrevUsed(pos_ - 1);
+      return *this;
+    }
+    Iterator operator--(int) {
+      Iterator it = *this;
+      --*this;
+      return it;
+    }
+    template <typename OtherMap, typename OtherValue>
+    bool operator==(const Iterator<OtherMap, OtherValue>& other) const {
+      return pos_ == other.pos_;
+    }
+    template <typename OtherMap, typename OtherValue>
+    bool operator!=(const Iterator<OtherMap, OtherValue>& other) const {
+      return pos_ != other.pos_;
+    }
+
+   private:
+    friend class SeqNumRingMap;
+    template <typename OtherMap, typename OtherValue>
+    friend class Iterator;
+
+    Map* map_ = nullptr;
+    // Position relative to the oldest slot.
+    size_t pos_ = 0;
+  };
+  using iterator = Iterator<SeqNumRingMap, value_type>;
+  using const_iterator = Iterator<const SeqNumRingMap, const value_type>;
+
+  SeqNumRingMap() = default;
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, num_slots_); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, num_slots_); }
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+  // Allocates room for at least |capacity| entries, so that a map with a known
+  // bound on its size does not allocate later on.
+  void reserve(size_t capacity) {
+    if (capacity > slots_.size())
+      Resize(capacity);
+  }
+
+  void clear() {
+    for (size_t pos = 0; pos < num_slots_; ++pos)
+      slot(pos) = Slot();
+    first_ = 0;
+    num_slots_ = 0;
+    size_ = 0;
+  }
+
+  iterator find(uint16_t seq_num) {
+    const size_t pos = LowerBoundPos(seq_num);
+    if (pos == num_slots_ || slot(pos).value.first != seq_num ||
+        !slot(pos).used) {
+      return end();
+    }
+    return iterator(this, pos);
+  }
+  const_iterator find(uint16_t seq_num) const {
+    return const_cast<SeqNumRingMap*>(this)->find(seq_num);
+  }
+
+  // First entry that is not older than |seq_num|.
+  iterator lower_bound(uint16_t seq_num) {
+    return iterator(this, NextUsed(LowerBoundPos(seq_num)));
+  }
+  // First entry that is newer than |seq_num|.
+  iterator upper_bound(uint16_t seq_num) {
+    size_t pos = LowerBoundPos(seq_num);
+    if (pos < num_slots_ && slot(pos).value.first == seq_num)
+      ++pos;
+    return iterator(this, NextUsed(pos));
+  }
+
+  // Inserts |value| unless its sequence number is already present. Adding a
+  // sequence number newer than all others is the fast path.
+  std::pair<iterator, bool> insert(value_type value) {
+    if (num_slots_ > 0 && !AheadOf<uint16_t, M>(
+                              value.first, slot(num_slots_ - 1).value.first)) {
+      return InsertBefore(std::move(value));
+    }
+    ReserveSlot();
+    ++num_slots_;
+    ++size_;
+    slot(num_slots_ - 1) = Slot(std::move(value));
+    return {iterator(this, num_slots_ - 1), true};
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(uint16_t seq_num, Args&&... args) {
+    return insert(value_type(seq_num, T(std::forward<Args>(args)...)));
+  }
+
+  iterator erase(const_iterator it) {
+    RTC_DCHECK(it != end());
+    size_t pos = it.pos_;
+    RTC_DCHECK(slot(pos).used);
+    slot(pos).used = false;
+    slot(pos).value.second = T();
+    --size_;
+    // Keep the oldest and newest slots in use, so that begin() is cheap and
+    // new entries can be compared with the newest one.
+    while (num_slots_ > 0 && !slot(num_slots_ - 1).used)
+      --num_slots_;
+    size_t num_popped = 0;
+    while (num_popped < num_slots_ && !slot(num_popped).used)
+      ++num_popped;
+    PopFront(num_popped);
+    pos = pos + 1 > num_popped ? pos + 1 - num_popped : 0;
+    return iterator(this, NextUsed(std::min(pos, num_slots_)));
+  }
+  iterator erase(const_iterator first, const_iterator last) {
+    for (size_t pos = first.pos_; pos < last.pos_; ++pos) {
+      if (slot(pos).used) {
+        slot(pos).used = false;
+        slot(pos).value.second = T();
+        --size_;
+      }
+    }
+    if (first.pos_ == 0) {
+      // Removing the oldest entries, the common case. |last| is either end()
+      // or an entry in use, so the new oldest slot is in use.
+      PopFront(last.pos_);
+      return begin();
+    }
+    if (last.pos_ == num_slots_) {
+      while (num_slots_ > 0 && !slot(num_slots_ - 1).used)
+        --num_slots_;
+      return end();
+    }
+    return iterator(this, last.pos_);
+  }
+  size_t erase(uint16_t seq_num) {
+    iterator it = find(seq_num);
+    if (it == end())
+      return 0;
+    erase(it);
+    return 1;
+  }
+
+ private:
+  struct Slot {
+    Slot() = default;
+    explicit Slot(value_type value) : used(true), value(std::move(value)) {}
+
+    // Unused slots are holes left by erase(). They keep their sequence number
+    // so that the slots stay sorted.
+    bool used = false;
+    value_type value;
+  };
+
+  Slot& slot(size_t pos) {
+    return slots_[(first_ + pos) & (slots_.size() - 1)];
+  }
+  const Slot& slot(size_t pos) const {
+    return slots_[(first_ + pos) & (slots_.size() - 1)];
+  }
+
+  size_t NextUsed(size_t pos) const {
+    while (pos < num_slots_ && !slot(pos).used)
+      ++pos;
+    return pos;
+  }
+  // The oldest slot is always in use, so this stops there at the latest.
+  size_t PrevUsed(size_t pos) const {
+    while (!slot(pos).used)
+      --pos;
+    return pos;
+  }
+
+  // Position of the first slot that is not older than |seq_num|.
+  size_t LowerBoundPos(uint16_t seq_num) const {
+    size_t low = 0;
+    size_t high = num_slots_;
+    while (low < high) {
+      const size_t mid = low + (high - low) / 2;
+      if (AheadOf<uint16_t, M>(seq_num, slot(mid).value.first)) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+
+  void PopFront(size_t num_popped) {
+    first_ = (first_ + num_popped) & (slots_.size() - 1);
+    num_slots_ -= num_popped;
+  }
+
+  // Makes room for one more slot, either by compacting away the holes or by
+  // growing the ring.
+  void ReserveSlot() {
+    if (num_slots_ < slots_.size())
+      return;
+    if (size_ < slots_.size() / 2) {
+      size_t num_used = 0;
+      for (size_t pos = 0; pos < num_slots_; ++pos) {
+        if (!slot(pos).used)
+          continue;
+        if (pos != num_used)
+          slot(num_used) = std::move(slot(pos));
+        ++num_used;
+      }
+      num_slots_ = num_used;
+      return;
+    }
+    Resize(2 * slots_.size());
+  }
+
+  void Resize(size_t min_capacity) {
+    size_t capacity = 16;
+    while (capacity < min_capacity)
+      capacity *= 2;
+    std::vector<Slot> slots(capacity);
+    for (size_t pos = 0; pos < num_slots_; ++pos)
+      slots[pos] = std::move(slot(pos));
+    slots_ = std::move(slots);
+    first_ = 0;
+  }
+
+  std::pair<iterator, bool> InsertBefore(value_type value) {
+    size_t pos = LowerBoundPos(value.first);
+    if (pos < num_slots_ && slot(pos).value.first == value.first) {
+      if (slot(pos).used)
+        return {iterator(this, pos), false};
+      slot(pos) = Slot(std::move(value));
+      ++size_;
+      return {iterator(this, pos), true};
+    }
+    if (pos > 0 && !slot(pos - 1).used) {
+      // Reuse the hole just before the insertion point.
+      slot(pos - 1) = Slot(std::move(value));
+      ++size_;
+      return {iterator(this, pos - 1), true};
+    }
+    ReserveSlot();
+    pos = LowerBoundPos(value.first);
+    ++num_slots_;
+    for (size_t i = num_slots_ - 1; i > pos; --i)
+      slot(i) = std::move(slot(i - 1));
+    slot(pos) = Slot(std::move(value));
+    ++size_;
+    return {iterator(this, pos), true};
+  }
+
+  // Capacity is zero or a power of two.
+  std::vector<Slot> slots_;
+  // Index in |slots_| of the oldest slot.
+  size_t first_ = 0;
+  // Number of slots from the oldest to the newest entry, including holes.
+  size_t num_slots_ = 0;
+  // Number of entries.
+  size_t size_ = 0;
+};
+
+// An ordered set of sequence numbers, with the same characteristics as
+// SeqNumRingMap.
+struct SeqNumRingSetValue {};
+template <uint16_t M = 0>
+using SeqNumRingSet = SeqNumRingMap<SeqNumRingSetValue, M>;
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_NUMERICS_SEQ_NUM_RING_MAP_H_
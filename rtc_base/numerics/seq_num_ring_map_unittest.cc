@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/numerics/seq_num_ring_map.h"
+
+#include <map>
+#include <vector>
+
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ReferenceMap = std::map<uint16_t, int, DescendingSeqNumComp<uint16_t>>;
+
+std::vector<std::pair<uint16_t, int>> Entries(const SeqNumRingMap<int>& map) {
+  return std::vector<std::pair<uint16_t, int>>(map.begin(), map.end());
+}
+
+std::vector<std::pair<uint16_t, int>> Entries(const ReferenceMap& map) {
+  return std::vector<std::pair<uint16_t, int>>(map.begin(), map.end());
+}
+
+}  // namespace
+
+TEST(SeqNumRingMapTest, OrderedAcrossWrapAround) {
+  SeqNumRingMap<int> map;
+  EXPECT_TRUE(map.empty());
+  map.emplace(0xfffe, 1);
+  map.emplace(0xffff, 2);
+  map.emplace(0, 3);
+  map.emplace(1, 4);
+  EXPECT_EQ(4u, map.size());
+  EXPECT_EQ(0xfffe, map.begin()->first);
+  EXPECT_EQ(3, map.find(0)->second);
+  EXPECT_TRUE(map.find(2) == map.end());
+  EXPECT_EQ(0xffff, map.lower_bound(0xffff)->first);
+  EXPECT_EQ(0, map.upper_bound(0xffff)->first);
+}
+
+TEST(SeqNumRingMapTest, InsertKeepsExistingEntry) {
+  SeqNumRingMap<int> map;
+  EXPECT_TRUE(map.emplace(10, 1).second);
+  EXPECT_FALSE(map.emplace(10, 2).second);
+  EXPECT_EQ(1, map.find(10)->second);
+}
+
+TEST(SeqNumRingMapTest, InsertsOutOfOrder) {
+  SeqNumRingMap<int> map;
+  map.emplace(20, 1);
+  map.emplace(10, 2);
+  map.emplace(15, 3);
+  ASSERT_EQ(3u, map.size());
+  std::vector<std::pair<uint16_t, int>> expected = {{10, 2}, {15, 3}, {20, 1}};
+  EXPECT_EQ(expected, Entries(map));
+}
+
+TEST(SeqNumRingMapTest, EraseLeavesOtherEntriesReachable) {
+  SeqNumRingMap<int> map;
+  map.reserve(100);
+  for (uint16_t seq_num = 0; seq_num < 100; ++seq_num)
+    map.emplace(seq_num, seq_num);
+  for (uint16_t seq_num = 1; seq_num < 100; seq_num += 2)
+    EXPECT_EQ(1u, map.erase(seq_num));
+  EXPECT_EQ(0u, map.erase(1));
+  EXPECT_EQ(50u, map.size());
+  for (uint16_t seq_num = 0; seq_num < 100; seq_num += 2)
+    EXPECT_EQ(seq_num, map.find(seq_num)->second);
+  EXPECT_EQ(4, map.lower_bound(3)->first);
+  map.erase(map.begin(), map.lower_bound(50));
+  EXPECT_EQ(50, map.begin()->first);
+  EXPECT_EQ(25u, map.size());
+}
+
+TEST(SeqNumRingMapTest, WrapsAtModulus) {
+  SeqNumRingMap<int, 1 << 15> map;
+  map.emplace(0x7ffe, 1);
+  map.emplace(0x7fff, 2);
+  map.emplace(0, 3);
+  EXPECT_EQ(0x7ffe, map.begin()->first);
+  EXPECT_EQ(0, map.upper_bound(0x7fff)->first);
+  EXPECT_EQ(0x7fff, map.upper_bound(0x7ffe)->first);
+}
+
+TEST(SeqNumRingMapTest, DecrementSkipsErasedEntries) {
+  SeqNumRingMap<int> map;
+  for (uint16_t seq_num = 10; seq_num < 20; ++seq_num)
+    map.emplace(seq_num, seq_num);
+  map.erase(14);
+  map.erase(15);
+  auto it = map.upper_bound(15);
+  EXPECT_EQ(16, it->first);
+  --it;
+  EXPECT_EQ(13, it->first);
+  it = map.end();
+  --it;
+  EXPECT_EQ(19, it->first);
+}
+
+TEST(SeqNumRingMapTest, MatchesStdMap) {
+  Random random(0x12345678);
+  SeqNumRingMap<int> map;
+  ReferenceMap reference;
+  uint16_t newest = 60000;
+  for (int i = 0; i < 100000; ++i) {
+    const uint16_t seq_num = newest - random.Rand(0, 1000);
+    switch (random.Rand(0, 5)) {
+      case 0:
+      case 1:
+        newest += random.Rand(1, 5);
+        map.emplace(newest, i);
+        reference.emplace(newest, i);
+        break;
+      case 2:
+        map.emplace(seq_num, i);
+        reference.emplace(seq_num, i);
+        break;
+      case 3:
+        EXPECT_EQ(reference.erase(seq_num), map.erase(seq_num));
+        break;
+      case 4:
+        map.erase(map.begin(), map.lower_bound(newest - 1000));
+        reference.erase(reference.begin(),
+                        reference.lower_bound(newest - 1000));
+        break;
+      case 5: {
+        auto it = map.lower_bound(seq_num);
+        auto reference_it = reference.lower_bound(seq_num);
+        ASSERT_EQ(reference_it == reference.end(), it == map.end());
+        if (it != map.end()) {
+          EXPECT_EQ(reference_it->first, it->first);
+          it = map.erase(it);
+          reference_it = reference.erase(reference_it);
+          ASSERT_EQ(reference_it == reference.end(), it == map.end());
+          if (it != map.end()) {
+            EXPECT_EQ(reference_it->first, it->first);
+          }
+        }
+        break;
+      }
+    }
+    ASSERT_EQ(reference.size(), map.size());
+  }
+  EXPECT_EQ(Entries(reference), Entries(map));
+}
+
+}  // namespace webrtc
@@ -10,6 +10,10 @@
 
 #include "rtc_base/openssl_digest.h"
 
+#include <string.h>
+
+#include <vector>
+
 #include "rtc_base/checks.h"  // RTC_DCHECK, RTC_CHECK
 #include "rtc_base/openssl.h"
 
@@ -115,4 +119,79 @@ bool OpenSSLDigest::GetDigestSize(const std::string& algorithm,
   return true;
 }
 
+OpenSSLHmac::OpenSSLHmac(const std::string& algorithm,
+                         const void* key,
+                         size_t key_len) {
+  if (!OpenSSLDigest::GetDigestEVP(algorithm, &md_)) {
+    md_ = nullptr;
+    return;
+  }
+  ctx_ = EVP_MD_CTX_new();
+  inner_ctx_ = EVP_MD_CTX_new();
+  outer_ctx_ = EVP_MD_CTX_new();
+  RTC_CHECK(ctx_ != nullptr && inner_ctx_ != nullptr && outer_ctx_ != nullptr);
+
+  // Copy the key to a block-sized buffer to simplify padding.
+  // If the key is longer than a block, hash it and use the result instead.
+  const size_t block_len = EVP_MD_block_size(md_);
+  std::vector<uint8_t> new_key(block_len, 0);
+  if (key_len > block_len) {
+    EVP_DigestInit_ex(ctx_, md_, nullptr);
+    EVP_DigestUpdate(ctx_, key, key_len);
+    EVP_DigestFinal_ex(ctx_, new_key.data(), nullptr);
+  } else if (key_len > 0) {
+    memcpy(new_key.data(), key, key_len);
+  }
+  // Hash the inner and outer padding, salted from the key, up front.
+  std::vector<uint8_t> o_pad(block_len);
+  std::vector<uint8_t> i_pad(block_len);
+  for (size_t i = 0; i < block_len; ++i) {
+    o_pad[i] = 0x5c ^ new_key[i];
+    i_pad[i] = 0x36 ^ new_key[i];
+  }
+  EVP_DigestInit_ex(inner_ctx_, md_, nullptr);
+  EVP_DigestUpdate(inner_ctx_, i_pad.data(), block_len);
+  EVP_DigestInit_ex(outer_ctx_, md_, nullptr);
+  EVP_DigestUpdate(outer_ctx_, o_pad.data(), block_len);
+  EVP_MD_CTX_copy_ex(ctx_, inner_ctx_);
+}
+
+OpenSSLHmac::~OpenSSLHmac() {
+  EVP_MD_CTX_destroy(ctx_);
+  EVP_MD_CTX_destroy(inner_ctx_);
+  EVP_MD_CTX_destroy(outer_ctx_);
+}
+
+size_t OpenSSLHmac::Size() const {
+  if (!md_) {
+    return 0;
+  }
+  return EVP_MD_size(md_);
+}
+
+void OpenSSLHmac::Update(const void* buf, size_t len) {
+  if (!md_) {
+    return;
+  }
+  EVP_DigestUpdate(ctx_, buf, len);
+}
+
+size_t OpenSSLHmac::Finish(void* buf, size_t len) {
+  if (!md_ || len < Size()) {
+    return 0;
+  }
+  // The precomputed states are copied into the existing context, which
+  // BoringSSL does without allocating, since the digest is the same.
+  uint8_t inner[EVP_MAX_MD_SIZE];
+  unsigned int inner_len;
+  EVP_DigestFinal_ex(ctx_, inner, &inner_len);
+  EVP_MD_CTX_copy_ex(ctx_, outer_ctx_);
+  EVP_DigestUpdate(ctx_, inner, inner_len);
+  unsigned int md_len;
+  EVP_DigestFinal_ex(ctx_, static_cast<unsigned char*>(buf), &md_len);
+  EVP_MD_CTX_copy_ex(ctx_, inner_ctx_);  // prepare for future Update()s
+  RTC_DCHECK(md_len == Size());
+  return md_len;
+}
+
 }  // namespace rtc
@@ -0,0 +1,61 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/synchronization/read_mostly.h"
+
+#include "absl/base/attributes.h"
+#include "absl/base/config.h"
+
+namespace webrtc {
+
+#if RTC_DCHECK_IS_ON
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+namespace {
+// Number of ReaderEpochs::Enter() calls on this thread that have not been
+// matched by Leave() yet, across all instances.
+ABSL_CONST_INIT thread_local int readers_on_current_thread = 0;
+}  // namespace
+
+void ReaderEpochs::AddReaderOnCurrentThread(int delta) {
+  readers_on_current_thread += delta;
+}
+
+int ReaderEpochs::ReadersOnCurrentThread() {
+  return readers_on_current_thread;
+}
+#else
+// Without thread-local storage, readers are not tracked per thread, and
+// Synchronize() can't detect that it's called from within a read scope.
+void ReaderEpochs::AddReaderOnCurrentThread(int delta) {}
+
+int ReaderEpochs::ReadersOnCurrentThread() {
+  return 0;
+}
+#endif
+#endif
+
+void ReaderEpochs::Synchronize() {
+#if RTC_DCHECK_IS_ON
+  // Waiting here from within a read scope may never return.
+  RTC_DCHECK_EQ(ReadersOnCurrentThread(), 0);
+#endif
+  const uint32_t previous_epoch = epoch_.fetch_add(1);
+  std::atomic<int>& previous_readers = readers_[previous_epoch & 1];
+  if (previous_readers.load() == 0)
+    return;
+  // Either a leaving reader sees |writer_waiting_| and signals |drained_|, or
+  // the load below sees that it already left.
+  writer_waiting_.store(true);
+  while (previous_readers.load() != 0)
+    drained_.Wait(rtc::Event::kForever);
+  writer_waiting_.store(false);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,140 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_SYNCHRONIZATION_READ_MOSTLY_H_
+#define RTC_BASE_SYNCHRONIZATION_READ_MOSTLY_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/constructor_magic.h"
+#include "rtc_base/event.h"
+
+namespace webrtc {
+
+// Counts the readers of a ReadMostly<T>, split in two generations so that a
+// writer can wait for the readers that may still see an old value without
+// blocking new readers.
+class ReaderEpochs {
+ public:
+  ReaderEpochs() = default;
+
+  // Registers a reader. Returns the slot to pass to Leave().
+  int Enter() {
+#if RTC_DCHECK_IS_ON
+    AddReaderOnCurrentThread(1);
+#endif
+    while (true) {
+      const uint32_t epoch = epoch_.load();
+      const int slot = epoch & 1;
+      readers_[slot].fetch_add(1);
+      if (epoch_.load() == epoch)
+        return slot;
+      // A writer switched generation after we read |epoch_|, and may already
+      // be waiting for this slot to drain. Retry in the current generation.
+      Release(slot);
+    }
+  }
+
+  void Leave(int slot) {
+    Release(slot);
+#if RTC_DCHECK_IS_ON
+    AddReaderOnCurrentThread(-1);
+#endif
+  }
+
+  // Starts a new generation of readers, and waits until all readers of the
+  // previous generation have called Leave(). Calls must be serialized, and
+  // must not be made by a thread that is itself between Enter() and Leave().
+  void Synchronize();
+
+ private:
+  void Release(int slot) {
+    // The last reader of a slot wakes up the writer, if there is one. A
+    // spurious wakeup, e.g. from a reader of the new generation, only makes
+    // the writer check the count again.
+    if (readers_[slot].fetch_sub(1) == 1 && writer_waiting_.load())
+      drained_.Set();
+  }
+
+#if RTC_DCHECK_IS_ON
+  static void AddReaderOnCurrentThread(int delta);
+  static int ReadersOnCurrentThread();
+#endif
+
+  std::atomic<uint32_t> epoch_{0};
+  std::atomic<int> readers_[2] = {{0}, {0}};
+  std::atomic<bool> writer_waiting_{false};
+  rtc::Event drained_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(ReaderEpochs);
+};
+
+// Holds a value that is read far more often than it is replaced, e.g. a
+// routing table consulted for every received packet. Readers never take a
+// lock; Publish() swaps in a new value and destroys the old one once no
+// reader can observe it anymore, sleeping until the last such reader leaves.
+//
+// Example:
+//   ReadMostly<Table> table(absl::make_unique<Table>());
+//   // Any thread.
+//   {
+//     ReadMostly<Table>::ReadScope scope(table);
+//     Lookup(*scope, key);
+//   }
+//   // Writer thread. Blocks until readers of the old table are done, so it
+//   // must not be called from within a ReadScope.
+//   table.Publish(absl::make_unique<Table>(new_table));
+template <typename T>
+class ReadMostly {
+ public:
+  class ReadScope {
+   public:
+    explicit ReadScope(const ReadMostly<T>& owner)
+        : owner_(owner),
+          slot_(owner.epochs_.Enter()),
+          value_(owner.value_.load()) {}
+    ~ReadScope() { owner_.epochs_.Leave(slot_); }
+
+    const T& operator*() const { return *value_; }
+    const T* operator->() const { return value_; }
+
+   private:
+    const ReadMostly<T>& owner_;
+    const int slot_;
+    const T* const value_;
+
+    RTC_DISALLOW_COPY_AND_ASSIGN(ReadScope);
+  };
+
+  explicit ReadMostly(std::unique_ptr<T> value) : value_(value.release()) {}
+  ~ReadMostly() { delete value_.load(); }
+
+  // Replaces the value. Returns when the previous value has been destroyed.
+  // Calls must be serialized, and must not be made from within a ReadScope on
+  // the calling thread.
+  void Publish(std::unique_ptr<T> value) {
+    std::unique_ptr<T> previous(value_.exchange(value.release()));
+    epochs_.Synchronize();
+  }
+
+ private:
+  mutable ReaderEpochs epochs_;
+  std::atomic<T*> value_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(ReadMostly);
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_SYNCHRONIZATION_READ_MOSTLY_H_
@@ -0,0 +1,117 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/synchronization/read_mostly.h"
+
+#include <atomic>
+#include <thread>  // Not allowed in production per Chromium style guide.
+#include <vector>
+
+#include "absl/base/config.h"
+#include "absl/memory/memory.h"
+#include "rtc_base/event.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kAlive = 0x600d;
+
+// Records its own destruction, and clears |state| so that a reader using a
+// destroyed value is detected.
+struct Value {
+  Value(int number, std::atomic<int>* num_destroyed)
+      : number(number), num_destroyed(num_destroyed) {}
+  ~Value() {
+    state = 0;
+    if (num_destroyed)
+      num_destroyed->fetch_add(1);
+  }
+
+  const int number;
+  std::atomic<int>* const num_destroyed;
+  volatile int state = kAlive;
+};
+
+}  // namespace
+
+TEST(ReadMostlyTest, ReadersSeePublishedValue) {
+  ReadMostly<Value> value(absl::make_unique<Value>(1, nullptr));
+  {
+    ReadMostly<Value>::ReadScope scope(value);
+    EXPECT_EQ(1, scope->number);
+  }
+  value.Publish(absl::make_unique<Value>(2, nullptr));
+  ReadMostly<Value>::ReadScope scope(value);
+  EXPECT_EQ(2, scope->number);
+}
+
+TEST(ReadMostlyTest, PublishWaitsForReadersOfPreviousValue) {
+  std::atomic<int> num_destroyed(0);
+  ReadMostly<Value> value(absl::make_unique<Value>(1, &num_destroyed));
+  rtc::Event published;
+  std::thread writer;
+  {
+    ReadMostly<Value>::ReadScope scope(value);
+    writer = std::thread([&] {
+      value.Publish(absl::make_unique<Value>(2, &num_destroyed));
+      published.Set();
+    });
+    EXPECT_FALSE(published.Wait(50));
+    EXPECT_EQ(0, num_destroyed.load());
+    EXPECT_EQ(1, scope->number);
+    EXPECT_EQ(kAlive, scope->state);
+  }
+  // Leaving the scope unblocks the writer.
+  writer.join();
+  EXPECT_TRUE(published.Wait(rtc::Event::kForever));
+  EXPECT_EQ(1, num_destroyed.load());
+}
+
+TEST(ReadMostlyTest, ConcurrentReadersNeverSeeDestroyedValue) {
+  constexpr int kNumReaders = 4;
+  constexpr int kNumPublishes = 2000;
+  std::atomic<int> num_destroyed(0);
+  ReadMostly<Value> value(absl::make_unique<Value>(0, &num_destroyed));
+  std::atomic<bool> done(false);
+  std::atomic<int> num_bad_reads(0);
+  std::vector<std::thread> readers;
+  for (int i = 0; i < kNumReaders; ++i) {
+    readers.emplace_back([&] {
+      int last_number = 0;
+      while (!done.load()) {
+        ReadMostly<Value>::ReadScope scope(value);
+        if (scope->state != kAlive || scope->number < last_number)
+          num_bad_reads.fetch_add(1);
+        last_number = scope->number;
+      }
+    });
+  }
+  for (int i = 1; i <= kNumPublishes; ++i) {
+    value.Publish(absl::make_unique<Value>(i, &num_destroyed));
+  }
+  done.store(true);
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, num_bad_reads.load());
+  EXPECT_EQ(kNumPublishes, num_destroyed.load());
+}
+
+#if RTC_DCHECK_IS_ON && defined(ABSL_HAVE_THREAD_LOCAL) && GTEST_HAS_DEATH_TEST && \
+    !defined(WEBRTC_ANDROID)
+TEST(ReadMostlyDeathTest, PublishFromWithinReadScope) {
+  ReadMostly<Value> value(absl::make_unique<Value>(1, nullptr));
+  ReadMostly<Value>::ReadScope scope(value);
+  EXPECT_DEATH(value.Publish(absl::make_unique<Value>(2, nullptr)), "");
+}
+#endif
+
+}  // namespace webrtc
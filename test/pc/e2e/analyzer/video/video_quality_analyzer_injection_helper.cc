@@ -72,7 +72,7 @@ class AnalyzingVideoSink : public rtc::VideoSinkInterface<VideoFrame> {
   ~AnalyzingVideoSink() override = default;
 
   void OnFrame(const VideoFrame& frame) override {
-    if (IsDummyFrameBuffer(frame.video_frame_buffer()->ToI420())) {
+    if (IsDummyFrameBuffer(frame.video_frame_buffer())) {
       // This is dummy frame, so we  don't need to process it further.
       return;
     }
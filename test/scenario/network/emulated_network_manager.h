@@ -23,6 +23,7 @@
 #include "rtc_base/thread_checker.h"
 #include "test/scenario/network/fake_network_socket_server.h"
 #include "test/scenario/network/network_emulation.h"
+#include "test/time_controller/time_controller.h"
 
 namespace webrtc {
 namespace test {
@@ -32,7 +33,7 @@ class EmulatedNetworkManager : public rtc::NetworkManagerBase,
                                public sigslot::has_slots<>,
                                public EmulatedNetworkManagerInterface {
  public:
-  EmulatedNetworkManager(Clock* clock,
+  EmulatedNetworkManager(TimeController* time_controller,
                          TaskQueueForTest* task_queue,
                          EndpointsContainer* endpoints_container);
 
@@ -45,7 +46,7 @@ class EmulatedNetworkManager : public rtc::NetworkManagerBase,
   void StopUpdating() override;
 
   // EmulatedNetworkManagerInterface API
-  rtc::Thread* network_thread() override { return &network_thread_; }
+  rtc::Thread* network_thread() override { return network_thread_.get(); }
   rtc::NetworkManager* network_manager() override { return this; }
   void GetStats(
       std::function<void(EmulatedNetworkStats)> stats_callback) const override;
@@ -56,11 +57,12 @@ class EmulatedNetworkManager : public rtc::NetworkManagerBase,
 
   TaskQueueForTest* const task_queue_;
   EndpointsContainer* const endpoints_container_;
-  FakeNetworkSocketServer socket_server_;
-  rtc::Thread network_thread_;
+  // Created by the time controller, so that it runs in the same time domain
+  // as the emulated network.
+  std::unique_ptr<rtc::Thread> network_thread_;
 
-  bool sent_first_update_ RTC_GUARDED_BY(network_thread_);
-  int start_count_ RTC_GUARDED_BY(network_thread_);
+  bool sent_first_update_ RTC_GUARDED_BY(*network_thread_);
+  int start_count_ RTC_GUARDED_BY(*network_thread_);
 };
 
 }  // namespace test
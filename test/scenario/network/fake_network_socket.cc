@@ -44,7 +44,7 @@ void FakeNetworkSocket::OnPacketReceived(EmulatedIpPacket packet) {
     packet_queue_.push_back(std::move(packet));
     pending_read_events_count_++;
   }
-  socket_manager_->WakeUp();
+  socket_manager_->ScheduleIo();
 }
 
 bool FakeNetworkSocket::ProcessIo() {
@@ -36,7 +36,9 @@ class SocketManager {
  public:
   virtual ~SocketManager() = default;
 
-  virtual void WakeUp() = 0;
+  // Makes the socket manager call ProcessIo() on its sockets on the thread
+  // owning them.
+  virtual void ScheduleIo() = 0;
   virtual void Unregister(SocketIoProcessor* io_processor) = 0;
   // Provides endpoints by IP address.
   virtual EmulatedEndpoint* GetEndpointNode(const rtc::IPAddress& ip) = 0;
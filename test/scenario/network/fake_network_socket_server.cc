@@ -11,6 +11,7 @@
 #include "test/scenario/network/fake_network_socket_server.h"
 
 #include <utility>
+#include "rtc_base/location.h"
 #include "rtc_base/thread.h"
 
 namespace webrtc {
@@ -25,6 +26,7 @@ FakeNetworkSocketServer::FakeNetworkSocketServer(
 FakeNetworkSocketServer::~FakeNetworkSocketServer() = default;
 
 void FakeNetworkSocketServer::OnMessageQueueDestroyed() {
+  rtc::CritScope crit(&lock_);
   msg_queue_ = nullptr;
 }
 
@@ -56,7 +58,20 @@ rtc::AsyncSocket* FakeNetworkSocketServer::CreateAsyncSocket(int family,
   return out;
 }
 
+void FakeNetworkSocketServer::ScheduleIo() {
+  rtc::MessageQueue* msg_queue;
+  {
+    rtc::CritScope crit(&lock_);
+    if (io_scheduled_ || !msg_queue_)
+      return;
+    io_scheduled_ = true;
+    msg_queue = msg_queue_;
+  }
+  msg_queue->Post(RTC_FROM_HERE, this);
+}
+
 void FakeNetworkSocketServer::SetMessageQueue(rtc::MessageQueue* msg_queue) {
+  rtc::CritScope crit(&lock_);
   msg_queue_ = msg_queue;
   if (msg_queue_) {
     msg_queue_->SignalQueueDestroyed.connect(
@@ -66,23 +81,28 @@ void FakeNetworkSocketServer::SetMessageQueue(rtc::MessageQueue* msg_queue) {
 
 // Always returns true (if return false, it won't be invoked again...)
 bool FakeNetworkSocketServer::Wait(int cms, bool process_io) {
-  RTC_DCHECK(msg_queue_ == rtc::Thread::Current());
-  if (!process_io) {
-    wakeup_.Wait(cms);
-    return true;
+  {
+    rtc::CritScope crit(&lock_);
+    RTC_DCHECK(msg_queue_ == rtc::Thread::Current());
   }
-  wakeup_.Wait(cms);
+  // I/O is processed by the message posted by ScheduleIo(). Not waiting when
+  // there's no time to wait also avoids yielding on simulated threads.
+  if (cms != 0)
+    wakeup_.Wait(cms);
+  return true;
+}
+
+void FakeNetworkSocketServer::WakeUp() {
+  wakeup_.Set();
+}
 
+void FakeNetworkSocketServer::OnMessage(rtc::Message* msg) {
   rtc::CritScope crit(&lock_);
+  io_scheduled_ = false;
   for (auto* io_processor : io_processors_) {
     while (io_processor->ProcessIo()) {
     }
   }
-  return true;
-}
-
-void FakeNetworkSocketServer::WakeUp() {
-  wakeup_.Set();
 }
 
 Timestamp FakeNetworkSocketServer::Now() const {
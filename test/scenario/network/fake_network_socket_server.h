@@ -29,8 +29,12 @@
 namespace webrtc {
 namespace test {
 
-// FakeNetworkSocketServer must outlive any sockets it creates.
+// FakeNetworkSocketServer must outlive any sockets it creates. Received
+// packets are processed by a message posted to the thread using the server,
+// rather than while waiting for I/O, so that it also works on threads run in
+// simulated time.
 class FakeNetworkSocketServer : public rtc::SocketServer,
+                                public rtc::MessageHandler,
                                 public sigslot::has_slots<>,
                                 public SocketManager {
  public:
@@ -40,6 +44,7 @@ class FakeNetworkSocketServer : public rtc::SocketServer,
 
   EmulatedEndpoint* GetEndpointNode(const rtc::IPAddress& ip) override;
   void Unregister(SocketIoProcessor* io_processor) override;
+  void ScheduleIo() override;
   void OnMessageQueueDestroyed();
 
   // rtc::SocketFactory methods:
@@ -53,16 +58,20 @@ class FakeNetworkSocketServer : public rtc::SocketServer,
   bool Wait(int cms, bool process_io) override;
   void WakeUp() override;
 
+  // rtc::MessageHandler methods:
+  void OnMessage(rtc::Message* msg) override;
+
  private:
   Timestamp Now() const;
 
   Clock* const clock_;
   const EndpointsContainer* endpoints_container_;
   rtc::Event wakeup_;
-  rtc::MessageQueue* msg_queue_;
 
   rtc::CriticalSection lock_;
+  rtc::MessageQueue* msg_queue_ RTC_GUARDED_BY(lock_) = nullptr;
   std::set<SocketIoProcessor*> io_processors_ RTC_GUARDED_BY(lock_);
+  bool io_scheduled_ RTC_GUARDED_BY(lock_) = false;
 };
 
 }  // namespace test
@@ -9,6 +9,7 @@
  */
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 
 #include "absl/memory/memory.h"
@@ -16,7 +17,10 @@
 #include "api/peer_connection_interface.h"
 #include "api/rtc_event_log/rtc_event_log_factory.h"
 #include "api/scoped_refptr.h"
-#include "api/task_queue/default_task_queue_factory.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "call/call.h"
 #include "call/simulated_network.h"
 #include "media/engine/webrtc_media_engine.h"
 #include "media/engine/webrtc_media_engine_defaults.h"
@@ -25,10 +29,14 @@
 #include "pc/peer_connection_wrapper.h"
 #include "pc/test/mock_peer_connection_observers.h"
 #include "rtc_base/gunit.h"
+#include "rtc_base/rtc_certificate.h"
+#include "rtc_base/ssl_identity.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 #include "test/scenario/network/network_emulation.h"
 #include "test/scenario/network/network_emulation_manager.h"
+#include "test/time_controller/real_time_controller.h"
+#include "test/time_controller/simulated_time_controller.h"
 
 namespace webrtc {
 namespace test {
@@ -38,6 +46,54 @@ constexpr int kDefaultTimeoutMs = 1000;
 constexpr int kMaxAptitude = 32000;
 constexpr int kSamplingFrequency = 48000;
 constexpr char kSignalThreadName[] = "signaling_thread";
+constexpr TimeDelta kSimulatedTimeout = TimeDelta::Seconds<10>();
+constexpr TimeDelta kSimulatedPollInterval = TimeDelta::Millis<10>();
+
+// The PeerConnectionFactory owns its task queue factory, so this forwards to
+// the one of a time controller.
+class TaskQueueFactoryProxy : public TaskQueueFactory {
+ public:
+  explicit TaskQueueFactoryProxy(TaskQueueFactory* task_queue_factory)
+      : task_queue_factory_(task_queue_factory) {}
+
+  std::unique_ptr<TaskQueueBase, TaskQueueDeleter> CreateTaskQueue(
+      absl::string_view name,
+      Priority priority) const override {
+    return task_queue_factory_->CreateTaskQueue(name, priority);
+  }
+
+ private:
+  TaskQueueFactory* const task_queue_factory_;
+};
+
+// Creates calls running their modules on process threads of a time
+// controller.
+class TimeControllerCallFactory : public CallFactoryInterface {
+ public:
+  explicit TimeControllerCallFactory(TimeController* time_controller)
+      : time_controller_(time_controller) {}
+
+  Call* CreateCall(const CallConfig& config) override {
+    return Call::Create(config, time_controller_->GetClock(),
+                        time_controller_->CreateProcessThread("CallModules"),
+                        time_controller_->CreateProcessThread("Pacer"));
+  }
+
+ private:
+  TimeController* const time_controller_;
+};
+
+// Lets time pass until |condition| is met, or |kSimulatedTimeout| has passed.
+bool SleepUntil(TimeController* time_controller,
+                std::function<bool()> condition) {
+  for (TimeDelta slept = TimeDelta::Zero(); slept < kSimulatedTimeout;
+       slept += kSimulatedPollInterval) {
+    if (condition())
+      return true;
+    time_controller->Sleep(kSimulatedPollInterval);
+  }
+  return condition();
+}
 
 bool AddIceCandidates(PeerConnectionWrapper* peer,
                       std::vector<const IceCandidateInterface*> candidates) {
@@ -51,14 +107,19 @@ bool AddIceCandidates(PeerConnectionWrapper* peer,
 }
 
 rtc::scoped_refptr<PeerConnectionFactoryInterface> CreatePeerConnectionFactory(
+    TimeController* time_controller,
     rtc::Thread* signaling_thread,
+    rtc::Thread* worker_thread,
     rtc::Thread* network_thread) {
   PeerConnectionFactoryDependencies pcf_deps;
-  pcf_deps.task_queue_factory = CreateDefaultTaskQueueFactory();
-  pcf_deps.call_factory = CreateCallFactory();
+  pcf_deps.task_queue_factory = absl::make_unique<TaskQueueFactoryProxy>(
+      time_controller->GetTaskQueueFactory());
+  pcf_deps.call_factory =
+      absl::make_unique<TimeControllerCallFactory>(time_controller);
   pcf_deps.event_log_factory =
       absl::make_unique<RtcEventLogFactory>(pcf_deps.task_queue_factory.get());
   pcf_deps.network_thread = network_thread;
+  pcf_deps.worker_thread = worker_thread;
   pcf_deps.signaling_thread = signaling_thread;
   cricket::MediaEngineDependencies media_deps;
   media_deps.task_queue_factory = pcf_deps.task_queue_factory.get();
@@ -76,7 +137,8 @@ rtc::scoped_refptr<PeerConnectionFactoryInterface> CreatePeerConnectionFactory(
 rtc::scoped_refptr<PeerConnectionInterface> CreatePeerConnection(
     const rtc::scoped_refptr<PeerConnectionFactoryInterface>& pcf,
     PeerConnectionObserver* observer,
-    rtc::NetworkManager* network_manager) {
+    rtc::NetworkManager* network_manager,
+    bool generate_certificate = false) {
   PeerConnectionDependencies pc_deps(observer);
   auto port_allocator =
       absl::make_unique<cricket::BasicPortAllocator>(network_manager);
@@ -88,6 +150,13 @@ rtc::scoped_refptr<PeerConnectionInterface> CreatePeerConnection(
   pc_deps.allocator = std::move(port_allocator);
   PeerConnectionInterface::RTCConfiguration rtc_configuration;
   rtc_configuration.sdp_semantics = SdpSemantics::kUnifiedPlan;
+  if (generate_certificate) {
+    // Otherwise, the certificate is generated asynchronously on the worker
+    // thread, which only runs in simulated time while the test sleeps.
+    rtc_configuration.certificates.push_back(rtc::RTCCertificate::Create(
+        std::unique_ptr<rtc::SSLIdentity>(
+            rtc::SSLIdentity::Generate("test", rtc::KT_DEFAULT))));
+  }
 
   return pcf->CreatePeerConnection(rtc_configuration, std::move(pc_deps));
 }
@@ -130,13 +199,15 @@ TEST(NetworkEmulationManagerPCTest, Run) {
       absl::make_unique<MockPeerConnectionObserver>();
 
   signaling_thread->Invoke<void>(RTC_FROM_HERE, [&]() {
-    alice_pcf = CreatePeerConnectionFactory(signaling_thread.get(),
-                                            alice_network->network_thread());
+    alice_pcf = CreatePeerConnectionFactory(
+        GlobalRealTimeController(), signaling_thread.get(),
+        /*worker_thread=*/nullptr, alice_network->network_thread());
     alice_pc = CreatePeerConnection(alice_pcf, alice_observer.get(),
                                     alice_network->network_manager());
 
-    bob_pcf = CreatePeerConnectionFactory(signaling_thread.get(),
-                                          bob_network->network_thread());
+    bob_pcf = CreatePeerConnectionFactory(
+        GlobalRealTimeController(), signaling_thread.get(),
+        /*worker_thread=*/nullptr, bob_network->network_thread());
     bob_pc = CreatePeerConnection(bob_pcf, bob_observer.get(),
                                   bob_network->network_manager());
   });
@@ -183,5 +254,97 @@ TEST(NetworkEmulationManagerPCTest, Run) {
   });
 }
 
+// Same as above, but with the whole stack running in simulated time, on the
+// thread running the test.
+TEST(NetworkEmulationManagerPCTest, RunInSimulatedTime) {
+  GlobalSimulatedTimeController time_controller(Timestamp::seconds(10000));
+  rtc::Thread* signaling_thread = time_controller.GetMainThread();
+  std::unique_ptr<rtc::Thread> worker_thread =
+      time_controller.CreateThread("worker_thread");
+
+  // Setup emulated network
+  NetworkEmulationManagerImpl emulation(&time_controller);
+
+  EmulatedNetworkNode* alice_node = emulation.CreateEmulatedNode(
+      absl::make_unique<SimulatedNetwork>(BuiltInNetworkBehaviorConfig()));
+  EmulatedNetworkNode* bob_node = emulation.CreateEmulatedNode(
+      absl::make_unique<SimulatedNetwork>(BuiltInNetworkBehaviorConfig()));
+  EmulatedEndpoint* alice_endpoint =
+      emulation.CreateEndpoint(EmulatedEndpointConfig());
+  EmulatedEndpoint* bob_endpoint =
+      emulation.CreateEndpoint(EmulatedEndpointConfig());
+  emulation.CreateRoute(alice_endpoint, {alice_node}, bob_endpoint);
+  emulation.CreateRoute(bob_endpoint, {bob_node}, alice_endpoint);
+
+  EmulatedNetworkManagerInterface* alice_network =
+      emulation.CreateEmulatedNetworkManagerInterface({alice_endpoint});
+  EmulatedNetworkManagerInterface* bob_network =
+      emulation.CreateEmulatedNetworkManagerInterface({bob_endpoint});
+
+  // Setup peer connections.
+  rtc::scoped_refptr<PeerConnectionFactoryInterface> alice_pcf =
+      CreatePeerConnectionFactory(&time_controller, signaling_thread,
+                                  worker_thread.get(),
+                                  alice_network->network_thread());
+  auto alice_observer = absl::make_unique<MockPeerConnectionObserver>();
+  rtc::scoped_refptr<PeerConnectionInterface> alice_pc = CreatePeerConnection(
+      alice_pcf, alice_observer.get(), alice_network->network_manager(),
+      /*generate_certificate=*/true);
+  auto alice = absl::make_unique<PeerConnectionWrapper>(
+      alice_pcf, alice_pc, std::move(alice_observer));
+
+  rtc::scoped_refptr<PeerConnectionFactoryInterface> bob_pcf =
+      CreatePeerConnectionFactory(&time_controller, signaling_thread,
+                                  worker_thread.get(),
+                                  bob_network->network_thread());
+  auto bob_observer = absl::make_unique<MockPeerConnectionObserver>();
+  rtc::scoped_refptr<PeerConnectionInterface> bob_pc = CreatePeerConnection(
+      bob_pcf, bob_observer.get(), bob_network->network_manager(),
+      /*generate_certificate=*/true);
+  auto bob = absl::make_unique<PeerConnectionWrapper>(bob_pcf, bob_pc,
+                                                      std::move(bob_observer));
+
+  rtc::scoped_refptr<webrtc::AudioSourceInterface> source =
+      alice_pcf->CreateAudioSource(cricket::AudioOptions());
+  rtc::scoped_refptr<AudioTrackInterface> track =
+      alice_pcf->CreateAudioTrack("audio", source);
+  alice->AddTransceiver(track);
+
+  // Connect peers.
+  ASSERT_TRUE(alice->ExchangeOfferAnswerWith(bob.get()));
+  // Do the SDP negotiation, and also exchange ice candidates.
+  ASSERT_TRUE(SleepUntil(&time_controller, [&] {
+    return alice->signaling_state() == PeerConnectionInterface::kStable;
+  }));
+  ASSERT_TRUE(SleepUntil(&time_controller,
+                         [&] { return alice->IsIceGatheringDone(); }));
+  ASSERT_TRUE(SleepUntil(&time_controller,
+                         [&] { return bob->IsIceGatheringDone(); }));
+
+  // Connect an ICE candidate pairs.
+  ASSERT_TRUE(
+      AddIceCandidates(bob.get(), alice->observer()->GetAllCandidates()));
+  ASSERT_TRUE(
+      AddIceCandidates(alice.get(), bob->observer()->GetAllCandidates()));
+  // This means that ICE and DTLS are connected.
+  ASSERT_TRUE(SleepUntil(&time_controller,
+                         [&] { return bob->IsIceConnected(); }));
+  ASSERT_TRUE(SleepUntil(&time_controller,
+                         [&] { return alice->IsIceConnected(); }));
+
+  // Let the call run for a while, which takes far less than a minute of real
+  // time.
+  time_controller.Sleep(TimeDelta::seconds(60));
+  EXPECT_TRUE(bob->IsIceConnected());
+
+  // Close peer connections
+  alice->pc()->Close();
+  bob->pc()->Close();
+
+  // Delete peers.
+  alice.reset();
+  bob.reset();
+}
+
 }  // namespace test
 }  // namespace webrtc
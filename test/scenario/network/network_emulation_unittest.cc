@@ -23,6 +23,7 @@
 #include "test/gtest.h"
 #include "test/scenario/network/network_emulation.h"
 #include "test/scenario/network/network_emulation_manager.h"
+#include "test/time_controller/simulated_time_controller.h"
 
 namespace webrtc {
 namespace test {
@@ -323,6 +324,61 @@ TEST(NetworkEmulationManagerTest, ThroughputStats) {
   delete s2;
 }
 
+TEST(NetworkEmulationManagerTest, RunsInSimulatedTime) {
+  GlobalSimulatedTimeController time_controller(Timestamp::seconds(10000));
+  NetworkEmulationManagerImpl network_manager(&time_controller);
+
+  BuiltInNetworkBehaviorConfig config;
+  config.queue_delay_ms = 100;
+  EmulatedNetworkNode* alice_node = network_manager.CreateEmulatedNode(
+      absl::make_unique<SimulatedNetwork>(config));
+  EmulatedNetworkNode* bob_node = network_manager.CreateEmulatedNode(
+      absl::make_unique<SimulatedNetwork>(config));
+  EmulatedEndpoint* alice_endpoint =
+      network_manager.CreateEndpoint(EmulatedEndpointConfig());
+  EmulatedEndpoint* bob_endpoint =
+      network_manager.CreateEndpoint(EmulatedEndpointConfig());
+  network_manager.CreateRoute(alice_endpoint, {alice_node}, bob_endpoint);
+  network_manager.CreateRoute(bob_endpoint, {bob_node}, alice_endpoint);
+
+  EmulatedNetworkManagerInterface* nt1 =
+      network_manager.CreateEmulatedNetworkManagerInterface({alice_endpoint});
+  EmulatedNetworkManagerInterface* nt2 =
+      network_manager.CreateEmulatedNetworkManagerInterface({bob_endpoint});
+
+  rtc::CopyOnWriteBuffer data("Hello");
+  auto* s1 = nt1->network_thread()->socketserver()->CreateAsyncSocket(
+      AF_INET, SOCK_DGRAM);
+  auto* s2 = nt2->network_thread()->socketserver()->CreateAsyncSocket(
+      AF_INET, SOCK_DGRAM);
+
+  SocketReader r1(s1, nt1->network_thread());
+  SocketReader r2(s2, nt2->network_thread());
+
+  s1->Bind(rtc::SocketAddress(alice_endpoint->GetPeerLocalAddress(), 0));
+  s2->Bind(rtc::SocketAddress(bob_endpoint->GetPeerLocalAddress(), 0));
+  s1->Connect(s2->GetLocalAddress());
+  s2->Connect(s1->GetLocalAddress());
+
+  nt1->network_thread()->PostTask(
+      RTC_FROM_HERE, [&]() { s1->Send(data.data(), data.size()); });
+  // The packets only arrive once the simulated network delay has passed.
+  time_controller.Sleep(TimeDelta::ms(50));
+  EXPECT_EQ(r2.ReceivedCount(), 0);
+  time_controller.Sleep(TimeDelta::ms(100));
+  EXPECT_EQ(r2.ReceivedCount(), 1);
+
+  for (int i = 0; i < 1000; ++i) {
+    nt2->network_thread()->PostTask(
+        RTC_FROM_HERE, [&]() { s2->Send(data.data(), data.size()); });
+  }
+  time_controller.Sleep(TimeDelta::seconds(1));
+  EXPECT_EQ(r1.ReceivedCount(), 1000);
+
+  delete s1;
+  delete s2;
+}
+
 // Testing that packets are delivered via all routes using a routing scheme as
 // follows:
 //  * e1 -> n1 -> e2
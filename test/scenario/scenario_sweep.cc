@@ -0,0 +1,415 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "test/scenario/scenario_sweep.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <map>
+#include <type_traits>
+#include <utility>
+
+#include "absl/types/optional.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/strings/string_builder.h"
+#include "system_wrappers/include/cpu_info.h"
+#include "test/field_trial.h"
+#include "test/scenario/scenario.h"
+#include "test/scenario/stats_collection.h"
+
+#if defined(WEBRTC_POSIX)
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <deque>
+
+#include "test/gtest.h"
+
+extern char** environ;
+#endif
+
+namespace webrtc {
+namespace test {
+namespace {
+// The stats are passed from the child processes as raw bytes.
+static_assert(std::is_trivially_copyable<SweepRunStats>::value, "");
+
+struct SenderCounters {
+  int64_t packets_sent = 0;
+  int64_t packets_lost = 0;
+  int64_t freeze_count = 0;
+  int64_t total_freeze_duration_ms = 0;
+};
+
+SenderCounters GetCounters(VideoStreamPair* video) {
+  SenderCounters counters;
+  for (const auto& it : video->send()->GetStats().substreams) {
+    if (it.second.is_rtx || it.second.is_flexfec)
+      continue;
+    counters.packets_sent += it.second.rtp_stats.transmitted.packets;
+    counters.packets_lost += it.second.rtcp_stats.packets_lost;
+  }
+  VideoReceiveStream::Stats receive_stats = video->receive()->GetStats();
+  counters.freeze_count = receive_stats.freeze_count;
+  counters.total_freeze_duration_ms = receive_stats.total_freezes_duration_ms;
+  return counters;
+}
+
+void AppendJsonString(rtc::StringBuilder* sb, const std::string& str) {
+  std::string escaped = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\')
+      escaped += '\\';
+    escaped += c;
+  }
+  escaped += '"';
+  *sb << escaped;
+}
+
+// Quotes |str| as a CSV field, as in RFC 4180.
+void AppendCsvString(rtc::StringBuilder* sb, const std::string& str) {
+  std::string escaped = "\"";
+  for (char c : str) {
+    if (c == '"')
+      escaped += '"';
+    escaped += c;
+  }
+  escaped += '"';
+  *sb << escaped;
+}
+
+#if defined(WEBRTC_POSIX)
+// Set in the environment of a child process to the id of the sweep and the
+// index of the run it should execute, and the descriptor it should write the
+// stats of the run to.
+constexpr char kChildRunEnv[] = "WEBRTC_SCENARIO_SWEEP_CHILD_RUN";
+
+// Environment variables that are not passed on to a child process. With the
+// gtest sharding variables, the child would run its test only on shard 0.
+const char* const kDroppedChildEnvs[] = {kChildRunEnv, "GTEST_SHARD_INDEX",
+                                         "GTEST_TOTAL_SHARDS",
+                                         "GTEST_SHARD_STATUS_FILE"};
+
+struct ChildProcess {
+  pid_t pid;
+  size_t run_index;
+  int read_fd;
+};
+
+// Numbers the sweeps run by the current test, so that a child process, which
+// runs the test from the start, can tell which sweep it was started for.
+class SweepIds : public ::testing::EmptyTestEventListener {
+ public:
+  static SweepIds* Get() {
+    // Owned by gtest once appended.
+    static SweepIds* const sweep_ids = [] {
+      SweepIds* sweep_ids = new SweepIds();
+      ::testing::UnitTest::GetInstance()->listeners().Append(sweep_ids);
+      return sweep_ids;
+    }();
+    return sweep_ids;
+  }
+
+  int Next() { return next_id_++; }
+
+ private:
+  void OnTestStart(const ::testing::TestInfo& test_info) override {
+    next_id_ = 0;
+  }
+
+  int next_id_ = 0;
+};
+
+bool IsDroppedChildEnv(const char* env) {
+  for (const char* name : kDroppedChildEnvs) {
+    const size_t length = strlen(name);
+    if (strncmp(env, name, length) == 0 && env[length] == '=')
+      return true;
+  }
+  return false;
+}
+
+// Returns the arguments to execute the current test, and nothing else, in a
+// new instance of the test binary.
+std::vector<std::string> ChildArguments() {
+  const ::testing::TestInfo* test_info =
+      ::testing::UnitTest::GetInstance()->current_test_info();
+  if (!test_info)
+    return {};
+  std::vector<std::string> args = ::testing::internal::GetArgvs();
+  args.push_back(std::string("--gtest_filter=") + test_info->test_case_name() +
+                 "." + test_info->name());
+  args.push_back("--gtest_also_run_disabled_tests");
+  return args;
+}
+
+// Starts a new instance of the test binary executing |run_index|, which writes
+// its stats to a pipe. Unlike a plain fork(), the child doesn't inherit any
+// locks held by other threads of this process.
+absl::optional<ChildProcess> StartChild(const std::vector<std::string>& args,
+                                        const std::string& name,
+                                        int sweep_id,
+                                        size_t run_index) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    RTC_LOG(LS_ERROR) << "Failed to create pipe for run " << name;
+    return absl::nullopt;
+  }
+  // Only the write end is inherited, so that later children don't hold it.
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+
+  std::vector<char*> argv;
+  for (const std::string& arg : args)
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  argv.push_back(nullptr);
+  std::string child_env = std::string(kChildRunEnv) + "=" +
+                          std::to_string(sweep_id) + "," +
+                          std::to_string(run_index) + "," +
+                          std::to_string(fds[1]);
+  std::vector<char*> envp;
+  for (char** env = environ; *env; ++env) {
+    if (!IsDroppedChildEnv(*env))
+      envp.push_back(*env);
+  }
+  envp.push_back(const_cast<char*>(child_env.c_str()));
+  envp.push_back(nullptr);
+
+  // The child runs the test from the start, so its output is discarded.
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null",
+                                   O_WRONLY, 0);
+  // argv[0] may not be a path to the binary, e.g. if it was found in PATH.
+  const char* path = access("/proc/self/exe", X_OK) == 0 ? "/proc/self/exe"
+                                                         : argv[0];
+  pid_t pid;
+  int error =
+      posix_spawn(&pid, path, &actions, nullptr, argv.data(), envp.data());
+  posix_spawn_file_actions_destroy(&actions);
+  close(fds[1]);
+  if (error != 0) {
+    RTC_LOG(LS_ERROR) << "Failed to spawn run " << name;
+    close(fds[0]);
+    return absl::nullopt;
+  }
+  return ChildProcess{pid, run_index, fds[0]};
+}
+
+bool WaitForChild(const ChildProcess& child, SweepRunStats* stats) {
+  int status;
+  bool completed =
+      waitpid(child.pid, &status, 0) == child.pid && WIFEXITED(status) &&
+      WEXITSTATUS(status) == 0 &&
+      read(child.read_fd, stats, sizeof(*stats)) == sizeof(*stats);
+  close(child.read_fd);
+  return completed;
+}
+
+// If this process was started for a single run of a sweep, and |sweep_id| is
+// that sweep, executes the run, writes its stats and exits. Returns true if
+// this process was started for a run of a later sweep, in which case this
+// sweep should not be run at all.
+bool MaybeExecuteChildRun(int sweep_id,
+                          const std::vector<SweepRunConfig>& runs) {
+  const char* child_run = getenv(kChildRunEnv);
+  if (!child_run)
+    return false;
+  int child_sweep_id;
+  size_t run_index;
+  int write_fd;
+  if (sscanf(child_run, "%d,%zu,%d", &child_sweep_id, &run_index,
+             &write_fd) != 3 ||
+      child_sweep_id < sweep_id) {
+    _exit(1);
+  }
+  if (child_sweep_id > sweep_id)
+    return true;
+  if (run_index >= runs.size())
+    _exit(1);
+  SweepRunStats stats = ScenarioSweep::RunScenario(runs[run_index]);
+  // The stats are smaller than PIPE_BUF, so this neither blocks nor writes
+  // partially.
+  bool written = write(write_fd, &stats, sizeof(stats)) == sizeof(stats);
+  _exit(written ? 0 : 1);
+}
+#endif
+}  // namespace
+
+ScenarioSweep::ScenarioSweep()
+    : max_parallel_runs_(CpuInfo::DetectNumberOfCores()) {}
+
+ScenarioSweep::~ScenarioSweep() = default;
+
+void ScenarioSweep::AddRun(SweepRunConfig run) {
+  runs_.push_back(std::move(run));
+}
+
+void ScenarioSweep::AddGrid(const SweepRunConfig& base,
+                            const std::vector<SweepNetworkProfile>& networks,
+                            const std::vector<std::string>& field_trials) {
+  for (const SweepNetworkProfile& network : networks) {
+    for (size_t i = 0; i < field_trials.size(); ++i) {
+      SweepRunConfig run = base;
+      run.name = network.name + "/" + std::to_string(i);
+      run.network = network;
+      run.field_trials = field_trials[i];
+      AddRun(std::move(run));
+    }
+  }
+}
+
+std::vector<SweepRunResult> ScenarioSweep::Run() const {
+  std::vector<SweepRunResult> results(runs_.size());
+  for (size_t i = 0; i < runs_.size(); ++i) {
+    results[i].name = runs_[i].name;
+    results[i].field_trials = runs_[i].field_trials;
+  }
+#if defined(WEBRTC_POSIX)
+  const std::vector<std::string> args = ChildArguments();
+  const int sweep_id = args.empty() ? 0 : SweepIds::Get()->Next();
+  if (MaybeExecuteChildRun(sweep_id, runs_)) {
+    // A child process started for a later sweep of the test; this sweep's
+    // results are reported as not completed.
+    return results;
+  }
+  if (args.empty()) {
+    // Not running in a test, so there's no way to start a child for a run.
+    for (size_t i = 0; i < runs_.size(); ++i) {
+      results[i].stats = RunScenario(runs_[i]);
+      results[i].completed = true;
+    }
+    return results;
+  }
+  const size_t max_children = std::max(max_parallel_runs_, 1);
+  // The runs take about the same time, so the children are waited for in the
+  // order they were started.
+  std::deque<ChildProcess> children;
+  size_t next_run = 0;
+  while (next_run < runs_.size() || !children.empty()) {
+    while (next_run < runs_.size() && children.size() < max_children) {
+      absl::optional<ChildProcess> child =
+          StartChild(args, runs_[next_run].name, sweep_id, next_run);
+      ++next_run;
+      if (child)
+        children.push_back(*child);
+    }
+    if (children.empty())
+      continue;
+    const ChildProcess child = children.front();
+    children.pop_front();
+    SweepRunResult& result = results[child.run_index];
+    result.completed = WaitForChild(child, &result.stats);
+    if (!result.completed)
+      RTC_LOG(LS_ERROR) << "Run " << result.name << " failed.";
+  }
+#else
+  for (size_t i = 0; i < runs_.size(); ++i) {
+    results[i].stats = RunScenario(runs_[i]);
+    results[i].completed = true;
+  }
+#endif
+  return results;
+}
+
+SweepRunStats ScenarioSweep::RunScenario(const SweepRunConfig& run) {
+  ScopedFieldTrials field_trials(run.field_trials);
+  CallStatsCollector call_stats;
+  Scenario s("sweep/" + run.name, /*real_time=*/false);
+  CallClient* sender = s.CreateClient("send", run.sender);
+  CallClient* receiver = s.CreateClient("return", CallClientConfig());
+  CallClientPair* route =
+      s.CreateRoutes(sender, {s.CreateSimulationNode(run.network.send_link)},
+                     receiver,
+                     {s.CreateSimulationNode(run.network.return_link)});
+  VideoStreamPair* video = s.CreateVideoStream(route->forward(), run.video);
+
+  s.RunFor(run.warmup);
+  const SenderCounters warmup_counters = GetCounters(video);
+  s.Every(run.stats_interval,
+          [&call_stats, sender] { call_stats.AddStats(sender->GetStats()); });
+  s.RunFor(run.duration - run.warmup);
+  const SenderCounters counters = GetCounters(video);
+
+  SweepRunStats stats;
+  CollectedCallStats& collected = call_stats.stats();
+  if (!collected.target_rate.IsEmpty()) {
+    stats.mean_target_rate = collected.target_rate.Mean();
+    stats.min_target_rate = collected.target_rate.Min();
+  }
+  if (!collected.round_trip_time.IsEmpty()) {
+    stats.mean_rtt = collected.round_trip_time.Mean();
+    stats.max_rtt = collected.round_trip_time.Max();
+  }
+  stats.packets_sent = counters.packets_sent - warmup_counters.packets_sent;
+  stats.packets_lost = counters.packets_lost - warmup_counters.packets_lost;
+  stats.freeze_count = counters.freeze_count - warmup_counters.freeze_count;
+  stats.total_freeze_duration =
+      TimeDelta::ms(counters.total_freeze_duration_ms -
+                    warmup_counters.total_freeze_duration_ms);
+  return stats;
+}
+
+std::string ScenarioSweep::ResultsToCsv(
+    const std::vector<SweepRunResult>& results) {
+  rtc::StringBuilder sb;
+  sb << "name,field_trials,completed,mean_target_rate_kbps,"
+        "min_target_rate_kbps,mean_rtt_ms,max_rtt_ms,packets_sent,"
+        "packets_lost,loss_ratio,freeze_count,total_freeze_duration_ms\n";
+  for (const SweepRunResult& result : results) {
+    const SweepRunStats& stats = result.stats;
+    AppendCsvString(&sb, result.name);
+    sb << ",";
+    AppendCsvString(&sb, result.field_trials);
+    sb << ","
+       << (result.completed ? 1 : 0) << ","
+       << stats.mean_target_rate.kbps<double>() << ","
+       << stats.min_target_rate.kbps<double>() << ","
+       << stats.mean_rtt.ms<double>() << "," << stats.max_rtt.ms<double>()
+       << "," << stats.packets_sent << "," << stats.packets_lost << ","
+       << stats.loss_ratio() << "," << stats.freeze_count << ","
+       << stats.total_freeze_duration.ms() << "\n";
+  }
+  return sb.Release();
+}
+
+std::string ScenarioSweep::ResultsToJson(
+    const std::vector<SweepRunResult>& results) {
+  rtc::StringBuilder sb;
+  sb << "[";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const SweepRunResult& result = results[i];
+    const SweepRunStats& stats = result.stats;
+    sb << (i == 0 ? "\n" : ",\n") << "  {\"name\": ";
+    AppendJsonString(&sb, result.name);
+    sb << ", \"field_trials\": ";
+    AppendJsonString(&sb, result.field_trials);
+    sb << ", \"completed\": " << (result.completed ? "true" : "false")
+       << ", \"mean_target_rate_kbps\": "
+       << stats.mean_target_rate.kbps<double>()
+       << ", \"min_target_rate_kbps\": " << stats.min_target_rate.kbps<double>()
+       << ", \"mean_rtt_ms\": " << stats.mean_rtt.ms<double>()
+       << ", \"max_rtt_ms\": " << stats.max_rtt.ms<double>()
+       << ", \"packets_sent\": " << stats.packets_sent
+       << ", \"packets_lost\": " << stats.packets_lost
+       << ", \"loss_ratio\": " << stats.loss_ratio()
+       << ", \"freeze_count\": " << stats.freeze_count
+       << ", \"total_freeze_duration_ms\": "
+       << stats.total_freeze_duration.ms() << "}";
+  }
+  sb << "\n]\n";
+  return sb.Release();
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -0,0 +1,118 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#ifndef TEST_SCENARIO_SCENARIO_SWEEP_H_
+#define TEST_SCENARIO_SCENARIO_SWEEP_H_
+
+#include <string>
+#include <vector>
+
+#include "api/units/data_rate.h"
+#include "api/units/time_delta.h"
+#include "test/scenario/scenario_config.h"
+
+namespace webrtc {
+namespace test {
+
+// A network profile to sweep over, with one simulated link in each direction.
+struct SweepNetworkProfile {
+  std::string name;
+  NetworkSimulationConfig send_link;
+  NetworkSimulationConfig return_link;
+};
+
+// One run of a sweep: a video call from a sender to a receiver over the given
+// links, with the given field trials, e.g. to tune GoogCcNetworkController.
+struct SweepRunConfig {
+  std::string name;
+  std::string field_trials;
+  SweepNetworkProfile network;
+  CallClientConfig sender;
+  VideoStreamConfig video;
+  TimeDelta duration = TimeDelta::seconds(30);
+  // Time to let the bandwidth estimate ramp up before stats are collected.
+  TimeDelta warmup = TimeDelta::seconds(5);
+  TimeDelta stats_interval = TimeDelta::ms(100);
+};
+
+// Stats of the sender collected over a run, excluding the warmup.
+struct SweepRunStats {
+  DataRate mean_target_rate = DataRate::Zero();
+  DataRate min_target_rate = DataRate::Zero();
+  TimeDelta mean_rtt = TimeDelta::Zero();
+  TimeDelta max_rtt = TimeDelta::Zero();
+  int64_t packets_sent = 0;
+  int64_t packets_lost = 0;
+  int64_t freeze_count = 0;
+  TimeDelta total_freeze_duration = TimeDelta::Zero();
+  double loss_ratio() const {
+    return packets_sent > 0 ? static_cast<double>(packets_lost) / packets_sent
+                            : 0;
+  }
+};
+
+struct SweepRunResult {
+  std::string name;
+  std::string field_trials;
+  // False if the run crashed.
+  bool completed = false;
+  SweepRunStats stats;
+};
+
+// ScenarioSweep runs many independent scenarios concurrently, e.g. every
+// combination of a set of network profiles and field trials, and collects the
+// results of each run in the order the runs were added.
+//
+// The simulated time controller overrides the global clock, and field trials
+// are global as well, so two scenarios can't run in the same process at the
+// same time. On POSIX, each run is therefore executed by a new instance of the
+// test binary, which runs only the current test until it reaches Run(). This
+// also keeps the results deterministic, as no state carries over from one run
+// to the next. Outside of a test, or on other platforms, the runs are executed
+// sequentially.
+//
+// A test may run several sweeps. In a child process, the sweeps of the test
+// before the one the child was started for return without running, with no
+// run completed, so whether a test reaches a sweep must not depend on the
+// results of its earlier sweeps.
+class ScenarioSweep {
+ public:
+  ScenarioSweep();
+  ~ScenarioSweep();
+
+  void AddRun(SweepRunConfig run);
+  // Adds a run for every combination of |networks| and |field_trials|, named
+  // "<network name>/<field trials index>", with the other settings taken from
+  // |base|.
+  void AddGrid(const SweepRunConfig& base,
+               const std::vector<SweepNetworkProfile>& networks,
+               const std::vector<std::string>& field_trials);
+  // Defaults to the number of cores.
+  void set_max_parallel_runs(int max_parallel_runs) {
+    max_parallel_runs_ = max_parallel_runs;
+  }
+
+  // Runs all added runs, blocking until they are done.
+  std::vector<SweepRunResult> Run() const;
+
+  // Runs a single scenario in this process.
+  static SweepRunStats RunScenario(const SweepRunConfig& run);
+
+  static std::string ResultsToCsv(const std::vector<SweepRunResult>& results);
+  static std::string ResultsToJson(const std::vector<SweepRunResult>& results);
+
+ private:
+  std::vector<SweepRunConfig> runs_;
+  int max_parallel_runs_;
+};
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // TEST_SCENARIO_SCENARIO_SWEEP_H_
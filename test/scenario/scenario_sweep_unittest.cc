@@ -0,0 +1,159 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "test/scenario/scenario_sweep.h"
+
+#include <stdlib.h>
+
+#include <string>
+
+#include "absl/types/optional.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+SweepRunConfig ShortRun() {
+  SweepRunConfig run;
+  run.sender.transport.rates.start_rate = DataRate::kbps(300);
+  run.duration = TimeDelta::seconds(10);
+  run.warmup = TimeDelta::seconds(2);
+  return run;
+}
+
+#if defined(WEBRTC_POSIX)
+// Sets an environment variable, and restores its previous value when it goes
+// out of scope.
+class ScopedEnv {
+ public:
+  ScopedEnv(const char* name, const char* value) : name_(name) {
+    const char* previous = getenv(name);
+    if (previous)
+      previous_ = std::string(previous);
+    setenv(name, value, /*overwrite=*/1);
+  }
+  ~ScopedEnv() {
+    if (previous_)
+      setenv(name_, previous_->c_str(), /*overwrite=*/1);
+    else
+      unsetenv(name_);
+  }
+
+ private:
+  const char* const name_;
+  absl::optional<std::string> previous_;
+};
+#endif
+
+SweepNetworkProfile Network(std::string name, DataRate bandwidth) {
+  SweepNetworkProfile network;
+  network.name = name;
+  network.send_link.bandwidth = bandwidth;
+  network.send_link.delay = TimeDelta::ms(50);
+  network.return_link.delay = TimeDelta::ms(50);
+  return network;
+}
+}  // namespace
+
+TEST(ScenarioSweepTest, RunsGridWithDeterministicResults) {
+  ScenarioSweep sweep;
+  sweep.set_max_parallel_runs(4);
+  sweep.AddGrid(ShortRun(),
+                {Network("slow", DataRate::kbps(250)),
+                 Network("fast", DataRate::kbps(1000))},
+                {"", ""});
+  std::vector<SweepRunResult> results = sweep.Run();
+  ASSERT_EQ(results.size(), 4u);
+  EXPECT_EQ(results[0].name, "slow/0");
+  EXPECT_EQ(results[3].name, "fast/1");
+  for (const SweepRunResult& result : results) {
+    EXPECT_TRUE(result.completed);
+    EXPECT_GT(result.stats.packets_sent, 0);
+  }
+  // Runs with the same config give the same results, whichever process they
+  // ran in.
+  for (int i : {0, 2}) {
+    const SweepRunStats& first = results[i].stats;
+    const SweepRunStats& second = results[i + 1].stats;
+    EXPECT_EQ(first.mean_target_rate, second.mean_target_rate);
+    EXPECT_EQ(first.mean_rtt, second.mean_rtt);
+    EXPECT_EQ(first.packets_sent, second.packets_sent);
+    EXPECT_EQ(first.packets_lost, second.packets_lost);
+  }
+  EXPECT_LT(results[0].stats.mean_target_rate,
+            results[2].stats.mean_target_rate);
+}
+
+TEST(ScenarioSweepTest, RunsEachSweepOfATestUnderAShardedRunner) {
+#if defined(WEBRTC_POSIX)
+  // As set by a sharded test runner on a shard other than the first. The
+  // child processes must still run this test.
+  ScopedEnv shard_index("GTEST_SHARD_INDEX", "1");
+  ScopedEnv total_shards("GTEST_TOTAL_SHARDS", "2");
+#endif
+  ScenarioSweep slow_sweep;
+  slow_sweep.AddGrid(ShortRun(), {Network("slow", DataRate::kbps(250))}, {""});
+  ScenarioSweep fast_sweep;
+  fast_sweep.AddGrid(ShortRun(), {Network("fast", DataRate::kbps(1000))},
+                     {""});
+  std::vector<SweepRunResult> slow_results = slow_sweep.Run();
+  std::vector<SweepRunResult> fast_results = fast_sweep.Run();
+  ASSERT_EQ(slow_results.size(), 1u);
+  ASSERT_EQ(fast_results.size(), 1u);
+  EXPECT_TRUE(slow_results[0].completed);
+  EXPECT_TRUE(fast_results[0].completed);
+  // Each sweep got the results of its own run.
+  EXPECT_LT(slow_results[0].stats.mean_target_rate,
+            fast_results[0].stats.mean_target_rate);
+}
+
+TEST(ScenarioSweepTest, FormatsResultsAsCsvAndJson) {
+  SweepRunResult result;
+  result.name = "lte/0";
+  result.field_trials = "WebRTC-Bwe-Trial/Enabled/";
+  result.completed = true;
+  result.stats.mean_target_rate = DataRate::kbps(500);
+  result.stats.min_target_rate = DataRate::kbps(300);
+  result.stats.mean_rtt = TimeDelta::ms(120);
+  result.stats.max_rtt = TimeDelta::ms(200);
+  result.stats.packets_sent = 1000;
+  result.stats.packets_lost = 10;
+  result.stats.freeze_count = 2;
+  result.stats.total_freeze_duration = TimeDelta::ms(400);
+
+  EXPECT_EQ(ScenarioSweep::ResultsToCsv({result}),
+            "name,field_trials,completed,mean_target_rate_kbps,"
+            "min_target_rate_kbps,mean_rtt_ms,max_rtt_ms,packets_sent,"
+            "packets_lost,loss_ratio,freeze_count,total_freeze_duration_ms\n"
+            "\"lte/0\",\"WebRTC-Bwe-Trial/Enabled/\",1,500,300,120,200,1000,"
+            "10,0.01,2,400\n");
+  EXPECT_EQ(ScenarioSweep::ResultsToJson({result}),
+            "[\n"
+            "  {\"name\": \"lte/0\", "
+            "\"field_trials\": \"WebRTC-Bwe-Trial/Enabled/\", "
+            "\"completed\": true, \"mean_target_rate_kbps\": 500, "
+            "\"min_target_rate_kbps\": 300, \"mean_rtt_ms\": 120, "
+            "\"max_rtt_ms\": 200, \"packets_sent\": 1000, "
+            "\"packets_lost\": 10, \"loss_ratio\": 0.01, "
+            "\"freeze_count\": 2, \"total_freeze_duration_ms\": 400}\n"
+            "]\n");
+}
+
+TEST(ScenarioSweepTest, EscapesCsvFields) {
+  SweepRunResult result;
+  result.name = "lte/\"a\"";
+  result.field_trials = "WebRTC-Bwe-Trial/Enabled,window:8/";
+  std::string csv = ScenarioSweep::ResultsToCsv({result});
+  std::string row = csv.substr(csv.find('\n') + 1);
+  EXPECT_EQ(row.substr(0, row.find(",0,")),
+            "\"lte/\"\"a\"\"\",\"WebRTC-Bwe-Trial/Enabled,window:8/\"");
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -0,0 +1,106 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/transport/goog_cc_factory.h"
+#include "modules/congestion_controller/coupled/coupled_factory.h"
+#include "test/gtest.h"
+#include "test/scenario/scenario.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+constexpr int kNumSenders = 3;
+const DataRate kBottleneckCapacity = DataRate::kbps(1500);
+const TimeDelta kRunTime = TimeDelta::seconds(30);
+
+struct SharedBottleneckResult {
+  // Time until the senders together use 80% of the bottleneck, or the run time
+  // if they never do.
+  TimeDelta convergence_time = kRunTime;
+  bool converged = false;
+  int packets_lost = 0;
+};
+
+// Runs |kNumSenders| video senders through a bottleneck with an active queue
+// management, so that overshooting the capacity leads to loss. With
+// |coupled|, the senders share one coupled congestion controller group.
+SharedBottleneckResult RunSharedBottleneck(std::string name, bool coupled) {
+  CoupledNetworkControllerFactory coupled_factory(
+      absl::make_unique<GoogCcNetworkControllerFactory>());
+  Scenario s("coupled_cc/" + name, false);
+  CallClientConfig config;
+  if (coupled)
+    config.transport.cc_factory = &coupled_factory;
+  config.transport.rates.start_rate = DataRate::kbps(300);
+  auto* send_net = s.CreateSimulationNode([](NetworkSimulationConfig* c) {
+    c->bandwidth = kBottleneckCapacity;
+    c->delay = TimeDelta::ms(50);
+    c->codel_active_queue_management = true;
+  });
+  auto* ret_net = s.CreateSimulationNode(
+      [](NetworkSimulationConfig* c) { c->delay = TimeDelta::ms(50); });
+
+  std::vector<CallClient*> senders;
+  std::vector<VideoStreamPair*> videos;
+  for (int i = 0; i < kNumSenders; ++i) {
+    CallClient* sender = s.CreateClient("send" + std::to_string(i), config);
+    CallClient* receiver =
+        s.CreateClient("return" + std::to_string(i), CallClientConfig());
+    auto* route = s.CreateRoutes(sender, {send_net}, receiver, {ret_net});
+    videos.push_back(
+        s.CreateVideoStream(route->forward(), [](VideoStreamConfig* c) {
+          c->encoder.max_data_rate = kBottleneckCapacity;
+        }));
+    senders.push_back(sender);
+  }
+
+  SharedBottleneckResult result;
+  s.Every(TimeDelta::ms(100), [&] {
+    if (result.converged)
+      return;
+    DataRate total_rate = DataRate::Zero();
+    for (CallClient* sender : senders)
+      total_rate += sender->target_rate();
+    if (total_rate >= kBottleneckCapacity * 0.8) {
+      result.convergence_time = s.TimeSinceStart();
+      result.converged = true;
+    }
+  });
+  s.RunFor(kRunTime);
+
+  for (VideoStreamPair* video : videos) {
+    for (const auto& substream : video->send()->GetStats().substreams)
+      result.packets_lost += substream.second.rtcp_stats.packets_lost;
+  }
+  return result;
+}
+}  // namespace
+
+// Reports the convergence time and loss with and without coupling. Doesn't
+// expect coupling to do better until that has been confirmed over a range of
+// bottlenecks.
+TEST(CoupledCcScenarioTest, SharedBottleneck) {
+  for (bool coupled : {false, true}) {
+    const std::string name = coupled ? "coupled" : "independent";
+    SharedBottleneckResult result = RunSharedBottleneck(name, coupled);
+    PrintResult("coupled_cc_convergence_time", "", name,
+                result.convergence_time.ms(), "ms", false);
+    PrintResult("coupled_cc_packets_lost", "", name, result.packets_lost,
+                "packets", false);
+  }
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -0,0 +1,77 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "test/gtest.h"
+#include "test/scenario/scenario_sweep.h"
+#include "test/testsupport/file_utils.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+void WriteToOutputFile(const std::string& file_name,
+                       const std::string& content) {
+  std::string path = OutputPath() + file_name;
+  FILE* file = fopen(path.c_str(), "w");
+  ASSERT_TRUE(file) << "Failed to open " << path;
+  fwrite(content.data(), 1, content.size(), file);
+  fclose(file);
+}
+
+SweepNetworkProfile Network(std::string name,
+                            DataRate bandwidth,
+                            TimeDelta delay,
+                            double loss_rate) {
+  SweepNetworkProfile network;
+  network.name = name;
+  network.send_link.bandwidth = bandwidth;
+  network.send_link.delay = delay;
+  network.send_link.loss_rate = loss_rate;
+  network.return_link.delay = delay;
+  return network;
+}
+}  // namespace
+
+// Sweeps GoogCC field trials over a set of network profiles and writes the
+// results to goog_cc_sweep.csv and goog_cc_sweep.json in the output directory,
+// for tracking them across changes.
+TEST(GoogCcSweepTest, FieldTrialsOverNetworkProfiles) {
+  SweepRunConfig base;
+  base.sender.transport.rates.min_rate = DataRate::kbps(30);
+  base.sender.transport.rates.start_rate = DataRate::kbps(300);
+  base.sender.transport.rates.max_rate = DataRate::kbps(2500);
+  std::vector<SweepNetworkProfile> networks = {
+      Network("dsl", DataRate::kbps(1000), TimeDelta::ms(20), 0),
+      Network("cellular", DataRate::kbps(500), TimeDelta::ms(100), 0.01),
+      Network("satellite", DataRate::kbps(800), TimeDelta::ms(300), 0.02),
+  };
+  std::vector<std::string> field_trials = {
+      "",
+      "WebRTC-Bwe-LossBasedControl/Enabled/",
+      "WebRTC-Bwe-CongestionWindowDownlinkDelay/Enabled/",
+  };
+  ScenarioSweep sweep;
+  sweep.AddGrid(base, networks, field_trials);
+  std::vector<SweepRunResult> results = sweep.Run();
+
+  for (const SweepRunResult& result : results) {
+    EXPECT_TRUE(result.completed) << result.name;
+    EXPECT_GT(result.stats.mean_target_rate, DataRate::Zero()) << result.name;
+  }
+  WriteToOutputFile("goog_cc_sweep.csv", ScenarioSweep::ResultsToCsv(results));
+  WriteToOutputFile("goog_cc_sweep.json",
+                    ScenarioSweep::ResultsToJson(results));
+}
+
+}  // namespace test
+}  // namespace webrtc
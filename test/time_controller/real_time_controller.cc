@@ -9,7 +9,11 @@
  */
 #include "test/time_controller/real_time_controller.h"
 
+#include <utility>
+
+#include "absl/memory/memory.h"
 #include "api/task_queue/default_task_queue_factory.h"
+#include "rtc_base/null_socket_server.h"
 #include "system_wrappers/include/sleep.h"
 
 namespace webrtc {
@@ -30,6 +34,21 @@ std::unique_ptr<ProcessThread> RealTimeController::CreateProcessThread(
   return ProcessThread::Create(thread_name);
 }
 
+std::unique_ptr<rtc::Thread> RealTimeController::CreateThread(
+    const std::string& name,
+    std::unique_ptr<rtc::SocketServer> socket_server) {
+  if (!socket_server)
+    socket_server = absl::make_unique<rtc::NullSocketServer>();
+  auto res = absl::make_unique<rtc::Thread>(std::move(socket_server));
+  res->SetName(name, nullptr);
+  res->Start();
+  return res;
+}
+
+rtc::Thread* RealTimeController::GetMainThread() {
+  return rtc::ThreadManager::Instance()->WrapCurrentThread();
+}
+
 void RealTimeController::Sleep(TimeDelta duration) {
   SleepMs(duration.ms());
 }
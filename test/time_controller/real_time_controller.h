@@ -12,6 +12,7 @@
 
 #include <functional>
 #include <memory>
+#include <string>
 
 #include "api/task_queue/task_queue_factory.h"
 #include "api/units/time_delta.h"
@@ -28,6 +29,10 @@ class RealTimeController : public TimeController {
   TaskQueueFactory* GetTaskQueueFactory() override;
   std::unique_ptr<ProcessThread> CreateProcessThread(
       const char* thread_name) override;
+  std::unique_ptr<rtc::Thread> CreateThread(
+      const std::string& name,
+      std::unique_ptr<rtc::SocketServer> socket_server = nullptr) override;
+  rtc::Thread* GetMainThread() override;
   void Sleep(TimeDelta duration) override;
   void InvokeWithControlledYield(std::function<void()> closure) override;
 
@@ -15,10 +15,12 @@
 #include <map>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
+#include "rtc_base/location.h"
 
 namespace webrtc {
 namespace {
@@ -31,24 +33,63 @@ bool RemoveByValue(C& vec, typename C::value_type val) {
   vec.erase(it);
   return true;
 }
+
+// Sets the current rtc::Thread of the calling thread for the lifetime of the
+// object.
+class ScopedCurrentThread {
+ public:
+  explicit ScopedCurrentThread(rtc::Thread* thread)
+      : previous_(rtc::ThreadManager::Instance()->CurrentThread()) {
+    SetCurrentThread(thread);
+  }
+  ~ScopedCurrentThread() { SetCurrentThread(previous_); }
+
+ private:
+  static void SetCurrentThread(rtc::Thread* thread) {
+    // Clear first, as SetCurrentThread() complains about replacing a thread.
+    rtc::ThreadManager::Instance()->SetCurrentThread(nullptr);
+    rtc::ThreadManager::Instance()->SetCurrentThread(thread);
+  }
+
+  rtc::Thread* const previous_;
+};
+
+// Socket server for simulated threads without I/O. Unlike NullSocketServer,
+// it never waits, as waiting on an event would yield to the controller.
+class DummySocketServer : public rtc::SocketServer {
+ public:
+  rtc::Socket* CreateSocket(int family, int type) override {
+    RTC_NOTREACHED();
+    return nullptr;
+  }
+  rtc::AsyncSocket* CreateAsyncSocket(int family, int type) override {
+    RTC_NOTREACHED();
+    return nullptr;
+  }
+  bool Wait(int cms, bool process_io) override {
+    RTC_CHECK_EQ(cms, 0);
+    return true;
+  }
+  void WakeUp() override {}
+};
 }  // namespace
 
 namespace sim_time_impl {
-class SimulatedSequenceRunner : public ProcessThread, public TaskQueueBase {
+// Used both as task queue and as process thread.
+class SimulatedTaskQueue : public ProcessThread,
+                           public TaskQueueBase,
+                           public SimulatedSequenceRunner {
  public:
-  SimulatedSequenceRunner(SimulatedTimeControllerImpl* handler,
-                          absl::string_view queue_name)
-      : handler_(handler), name_(queue_name) {}
-  ~SimulatedSequenceRunner() override { handler_->Unregister(this); }
-
-  // Provides next run time.
-  Timestamp GetNextRunTime() const;
+  SimulatedTaskQueue(SimulatedTimeControllerImpl* handler,
+                     absl::string_view queue_name)
+      : handler_(handler), name_(queue_name) {
+    handler_->Register(this);
+  }
+  ~SimulatedTaskQueue() override { handler_->Unregister(this); }
 
-  // Iterates through delayed tasks and modules and moves them to the ready set
-  // if they are supposed to execute by |at time|.
-  void UpdateReady(Timestamp at_time);
-  // Runs all ready tasks and modules and updates next run time.
-  void Run(Timestamp at_time);
+  // SimulatedSequenceRunner interface
+  Timestamp GetNextRunTime() const override;
+  void RunReady(Timestamp at_time) override;
 
   // TaskQueueBase interface
   void Delete() override;
@@ -67,6 +108,9 @@ class SimulatedSequenceRunner : public ProcessThread, public TaskQueueBase {
   using CurrentTaskQueueSetter = TaskQueueBase::CurrentTaskQueueSetter;
 
  private:
+  // Iterates through delayed tasks and modules and moves them to the ready set
+  // if they are supposed to execute by |at time|.
+  void UpdateReady(Timestamp at_time);
   Timestamp GetCurrentTime() const { return handler_->CurrentTime(); }
   void RunReadyTasks(Timestamp at_time) RTC_LOCKS_EXCLUDED(lock_);
   void RunReadyModules(Timestamp at_time) RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
@@ -91,12 +135,20 @@ class SimulatedSequenceRunner : public ProcessThread, public TaskQueueBase {
   Timestamp next_run_time_ RTC_GUARDED_BY(lock_) = Timestamp::PlusInfinity();
 };
 
-Timestamp SimulatedSequenceRunner::GetNextRunTime() const {
+Timestamp SimulatedTaskQueue::GetNextRunTime() const {
   rtc::CritScope lock(&lock_);
   return next_run_time_;
 }
 
-void SimulatedSequenceRunner::UpdateReady(Timestamp at_time) {
+void SimulatedTaskQueue::RunReady(Timestamp at_time) {
+  UpdateReady(at_time);
+  RunReadyTasks(at_time);
+  rtc::CritScope lock(&lock_);
+  RunReadyModules(at_time);
+  UpdateNextRunTime();
+}
+
+void SimulatedTaskQueue::UpdateReady(Timestamp at_time) {
   rtc::CritScope lock(&lock_);
   for (auto it = delayed_tasks_.begin();
        it != delayed_tasks_.end() && it->first <= at_time;
@@ -114,14 +166,7 @@ void SimulatedSequenceRunner::UpdateReady(Timestamp at_time) {
   }
 }
 
-void SimulatedSequenceRunner::Run(Timestamp at_time) {
-  RunReadyTasks(at_time);
-  rtc::CritScope lock(&lock_);
-  RunReadyModules(at_time);
-  UpdateNextRunTime();
-}
-
-void SimulatedSequenceRunner::Delete() {
+void SimulatedTaskQueue::Delete() {
   {
     rtc::CritScope lock(&lock_);
     ready_tasks_.clear();
@@ -130,7 +175,7 @@ void SimulatedSequenceRunner::Delete() {
   delete this;
 }
 
-void SimulatedSequenceRunner::RunReadyTasks(Timestamp at_time) {
+void SimulatedTaskQueue::RunReadyTasks(Timestamp at_time) {
   std::deque<std::unique_ptr<QueuedTask>> ready_tasks;
   {
     rtc::CritScope lock(&lock_);
@@ -149,7 +194,7 @@ void SimulatedSequenceRunner::RunReadyTasks(Timestamp at_time) {
   }
 }
 
-void SimulatedSequenceRunner::RunReadyModules(Timestamp at_time) {
+void SimulatedTaskQueue::RunReadyModules(Timestamp at_time) {
   if (!ready_modules_.empty()) {
     CurrentTaskQueueSetter set_current(this);
     for (auto* module : ready_modules_) {
@@ -160,7 +205,7 @@ void SimulatedSequenceRunner::RunReadyModules(Timestamp at_time) {
   ready_modules_.clear();
 }
 
-void SimulatedSequenceRunner::UpdateNextRunTime() {
+void SimulatedTaskQueue::UpdateNextRunTime() {
   if (!ready_tasks_.empty() || !ready_modules_.empty()) {
     next_run_time_ = Timestamp::MinusInfinity();
   } else {
@@ -173,21 +218,21 @@ void SimulatedSequenceRunner::UpdateNextRunTime() {
   }
 }
 
-void SimulatedSequenceRunner::PostTask(std::unique_ptr<QueuedTask> task) {
+void SimulatedTaskQueue::PostTask(std::unique_ptr<QueuedTask> task) {
   rtc::CritScope lock(&lock_);
   ready_tasks_.emplace_back(std::move(task));
   next_run_time_ = Timestamp::MinusInfinity();
 }
 
-void SimulatedSequenceRunner::PostDelayedTask(std::unique_ptr<QueuedTask> task,
-                                              uint32_t milliseconds) {
+void SimulatedTaskQueue::PostDelayedTask(std::unique_ptr<QueuedTask> task,
+                                         uint32_t milliseconds) {
   rtc::CritScope lock(&lock_);
   Timestamp target_time = GetCurrentTime() + TimeDelta::ms(milliseconds);
   delayed_tasks_[target_time].push_back(std::move(task));
   next_run_time_ = std::min(next_run_time_, target_time);
 }
 
-void SimulatedSequenceRunner::Start() {
+void SimulatedTaskQueue::Start() {
   std::vector<Module*> starting;
   {
     rtc::CritScope lock(&lock_);
@@ -206,7 +251,7 @@ void SimulatedSequenceRunner::Start() {
   UpdateNextRunTime();
 }
 
-void SimulatedSequenceRunner::Stop() {
+void SimulatedTaskQueue::Stop() {
   std::vector<Module*> stopping;
   {
     rtc::CritScope lock(&lock_);
@@ -228,7 +273,7 @@ void SimulatedSequenceRunner::Stop() {
     module->ProcessThreadAttached(nullptr);
 }
 
-void SimulatedSequenceRunner::WakeUp(Module* module) {
+void SimulatedTaskQueue::WakeUp(Module* module) {
   rtc::CritScope lock(&lock_);
   // If we already are planning to run this module as soon as possible, we don't
   // need to do anything.
@@ -245,8 +290,8 @@ void SimulatedSequenceRunner::WakeUp(Module* module) {
   next_run_time_ = std::min(next_run_time_, next_time);
 }
 
-void SimulatedSequenceRunner::RegisterModule(Module* module,
-                                             const rtc::Location& from) {
+void SimulatedTaskQueue::RegisterModule(Module* module,
+                                        const rtc::Location& from) {
   module->ProcessThreadAttached(this);
   rtc::CritScope lock(&lock_);
   if (!process_thread_running_) {
@@ -258,7 +303,7 @@ void SimulatedSequenceRunner::RegisterModule(Module* module,
   }
 }
 
-void SimulatedSequenceRunner::DeRegisterModule(Module* module) {
+void SimulatedTaskQueue::DeRegisterModule(Module* module) {
   bool modules_running;
   {
     rtc::CritScope lock(&lock_);
@@ -279,12 +324,164 @@ void SimulatedSequenceRunner::DeRegisterModule(Module* module) {
     module->ProcessThreadAttached(nullptr);
 }
 
-Timestamp SimulatedSequenceRunner::GetNextTime(Module* module,
-                                               Timestamp at_time) {
+Timestamp SimulatedTaskQueue::GetNextTime(Module* module, Timestamp at_time) {
   CurrentTaskQueueSetter set_current(this);
   return at_time + TimeDelta::ms(module->TimeUntilNextProcess());
 }
 
+class SimulatedThread : public rtc::Thread, public SimulatedSequenceRunner {
+ public:
+  SimulatedThread(SimulatedTimeControllerImpl* handler,
+                  absl::string_view name,
+                  std::unique_ptr<rtc::SocketServer> socket_server)
+      : rtc::Thread(std::move(socket_server), /*do_init=*/false),
+        handler_(handler) {
+    SetName(std::string(name), nullptr);
+    DoInit();
+    handler_->Register(this);
+  }
+  ~SimulatedThread() override { handler_->Unregister(this); }
+
+  // SimulatedSequenceRunner interface
+  Timestamp GetNextRunTime() const override;
+  void RunReady(Timestamp at_time) override;
+
+  // rtc::Thread interface
+  void Send(const rtc::Location& posted_from,
+            rtc::MessageHandler* phandler,
+            uint32_t id,
+            rtc::MessageData* pdata) override;
+  void Post(const rtc::Location& posted_from,
+            rtc::MessageHandler* phandler,
+            uint32_t id,
+            rtc::MessageData* pdata,
+            bool time_sensitive) override;
+  void PostDelayed(const rtc::Location& posted_from,
+                   int delay_ms,
+                   rtc::MessageHandler* phandler,
+                   uint32_t id,
+                   rtc::MessageData* pdata) override;
+  void PostAt(const rtc::Location& posted_from,
+              uint32_t target_time_ms,
+              rtc::MessageHandler* phandler,
+              uint32_t id,
+              rtc::MessageData* pdata) override;
+  void PostAt(const rtc::Location& posted_from,
+              int64_t target_time_ms,
+              rtc::MessageHandler* phandler,
+              uint32_t id,
+              rtc::MessageData* pdata) override;
+
+ private:
+  // Makes the controller run this thread as soon as possible, which updates
+  // the next run time from the posted messages.
+  void ScheduleRun();
+
+  SimulatedTimeControllerImpl* const handler_;
+  rtc::CriticalSection lock_;
+  Timestamp next_run_time_ RTC_GUARDED_BY(lock_) = Timestamp::PlusInfinity();
+};
+
+Timestamp SimulatedThread::GetNextRunTime() const {
+  rtc::CritScope lock(&lock_);
+  return next_run_time_;
+}
+
+void SimulatedThread::RunReady(Timestamp at_time) {
+  {
+    ScopedCurrentThread set_current(this);
+    ProcessMessages(0);
+  }
+  rtc::CritScope lock(&lock_);
+  // Holding |lock_| ensures that messages posted after GetDelay() reschedule
+  // the thread afterwards.
+  int delay_ms = GetDelay();
+  if (delay_ms == kForever) {
+    next_run_time_ = Timestamp::PlusInfinity();
+  } else {
+    next_run_time_ = at_time + TimeDelta::ms(delay_ms);
+  }
+}
+
+void SimulatedThread::Send(const rtc::Location& posted_from,
+                           rtc::MessageHandler* phandler,
+                           uint32_t id,
+                           rtc::MessageData* pdata) {
+  if (IsQuitting())
+    return;
+  rtc::Message msg;
+  msg.posted_from = posted_from;
+  msg.phandler = phandler;
+  msg.message_id = id;
+  msg.pdata = pdata;
+  if (IsCurrent()) {
+    msg.phandler->OnMessage(&msg);
+    return;
+  }
+  // Rather than blocking until this thread runs the message, the message runs
+  // right away, as this thread would pick it up immediately anyway.
+  handler_->InvokeOn(this, [this, &msg] {
+    ScopedCurrentThread set_current(this);
+    msg.phandler->OnMessage(&msg);
+  });
+}
+
+void SimulatedThread::Post(const rtc::Location& posted_from,
+                           rtc::MessageHandler* phandler,
+                           uint32_t id,
+                           rtc::MessageData* pdata,
+                           bool time_sensitive) {
+  rtc::Thread::Post(posted_from, phandler, id, pdata, time_sensitive);
+  ScheduleRun();
+}
+
+void SimulatedThread::PostDelayed(const rtc::Location& posted_from,
+                                  int delay_ms,
+                                  rtc::MessageHandler* phandler,
+                                  uint32_t id,
+                                  rtc::MessageData* pdata) {
+  rtc::Thread::PostDelayed(posted_from, delay_ms, phandler, id, pdata);
+  ScheduleRun();
+}
+
+void SimulatedThread::PostAt(const rtc::Location& posted_from,
+                             uint32_t target_time_ms,
+                             rtc::MessageHandler* phandler,
+                             uint32_t id,
+                             rtc::MessageData* pdata) {
+  rtc::Thread::PostAt(posted_from, target_time_ms, phandler, id, pdata);
+  ScheduleRun();
+}
+
+void SimulatedThread::PostAt(const rtc::Location& posted_from,
+                             int64_t target_time_ms,
+                             rtc::MessageHandler* phandler,
+                             uint32_t id,
+                             rtc::MessageData* pdata) {
+  rtc::Thread::PostAt(posted_from, target_time_ms, phandler, id, pdata);
+  ScheduleRun();
+}
+
+void SimulatedThread::ScheduleRun() {
+  rtc::CritScope lock(&lock_);
+  next_run_time_ = Timestamp::MinusInfinity();
+}
+
+// Represents the thread owning the controller, and is installed as its
+// current rtc::Thread for the lifetime of the controller. Its messages are run
+// when the owning thread calls Sleep().
+class SimulatedMainThread : public SimulatedThread {
+ public:
+  explicit SimulatedMainThread(SimulatedTimeControllerImpl* handler)
+      : SimulatedThread(handler,
+                        "main",
+                        absl::make_unique<DummySocketServer>()),
+        set_current_(this) {}
+
+ private:
+  ScopedCurrentThread set_current_;
+};
+
 SimulatedTimeControllerImpl::SimulatedTimeControllerImpl(Timestamp start_time)
     : thread_id_(rtc::CurrentThreadId()), current_time_(start_time) {}
 
@@ -296,43 +493,70 @@ SimulatedTimeControllerImpl::CreateTaskQueue(
     TaskQueueFactory::Priority priority) const {
   // TODO(srte): Remove the const cast when the interface is made mutable.
   auto mutable_this = const_cast<SimulatedTimeControllerImpl*>(this);
-  auto task_queue = std::unique_ptr<SimulatedSequenceRunner, TaskQueueDeleter>(
-      new SimulatedSequenceRunner(mutable_this, name));
-  rtc::CritScope lock(&mutable_this->lock_);
-  mutable_this->runners_.push_back(task_queue.get());
-  return task_queue;
+  return std::unique_ptr<SimulatedTaskQueue, TaskQueueDeleter>(
+      new SimulatedTaskQueue(mutable_this, name));
 }
 
 std::unique_ptr<ProcessThread> SimulatedTimeControllerImpl::CreateProcessThread(
     const char* thread_name) {
-  rtc::CritScope lock(&lock_);
-  auto process_thread =
-      absl::make_unique<SimulatedSequenceRunner>(this, thread_name);
-  runners_.push_back(process_thread.get());
-  return process_thread;
+  return absl::make_unique<SimulatedTaskQueue>(this, thread_name);
 }
 
+std::unique_ptr<rtc::Thread> SimulatedTimeControllerImpl::CreateThread(
+    const std::string& name,
+    std::unique_ptr<rtc::SocketServer> socket_server) {
+  if (!socket_server)
+    socket_server = absl::make_unique<DummySocketServer>();
+  return absl::make_unique<SimulatedThread>(this, name,
+                                            std::move(socket_server));
+}
+
+std::unique_ptr<rtc::Thread> SimulatedTimeControllerImpl::CreateMainThread() {
+  RTC_DCHECK_RUN_ON(&thread_checker_);
+  RTC_DCHECK(!current_runner_);
+  auto main_thread = absl::make_unique<SimulatedMainThread>(this);
+  current_runner_ = main_thread.get();
+  return main_thread;
+}
 
 void SimulatedTimeControllerImpl::YieldExecution() {
   if (rtc::CurrentThreadId() == thread_id_) {
-    TaskQueueBase* yielding_from = TaskQueueBase::Current();
+    RTC_DCHECK_RUN_ON(&thread_checker_);
+    SimulatedSequenceRunner* yielding_from = current_runner_;
     // Since we might continue execution on a process thread, we should reset
     // the thread local task queue reference. This ensures that thread checkers
     // won't think we are executing on the yielding task queue. It also ensure
-    // that TaskQueueBase::Current() won't return the yielding task queue.
-    SimulatedSequenceRunner::CurrentTaskQueueSetter reset_queue(nullptr);
-    RTC_DCHECK_RUN_ON(&thread_checker_);
+    // that TaskQueueBase::Current() won't return the yielding task queue. The
+    // same goes for rtc::Thread::Current().
+    SimulatedTaskQueue::CurrentTaskQueueSetter reset_queue(nullptr);
+    ScopedCurrentThread reset_thread(nullptr);
     // When we yield, we don't want to risk executing further tasks on the
     // currently executing task queue. If there's a ready task that also yields,
     // it's added to this set as well and only tasks on the remaining task
     // queues are executed.
-    auto inserted = yielded_.insert(yielding_from);
-    RTC_DCHECK(inserted.second);
+    bool inserted = yielded_.insert(yielding_from).second;
+    RTC_DCHECK(inserted);
     RunReadyRunners();
-    yielded_.erase(inserted.first);
+    yielded_.erase(yielding_from);
   }
 }
 
+void SimulatedTimeControllerImpl::InvokeOn(SimulatedSequenceRunner* runner,
+                                           std::function<void()> closure) {
+  RTC_DCHECK_RUN_ON(&thread_checker_);
+  SimulatedSequenceRunner* invoking_from = current_runner_;
+  SimulatedTaskQueue::CurrentTaskQueueSetter reset_queue(nullptr);
+  ScopedCurrentThread reset_thread(nullptr);
+  // The invoking runner is already in |yielded_| if |runner| invokes back on
+  // it, like a thread receiving a Send() while blocked in one.
+  bool inserted = yielded_.insert(invoking_from).second;
+  current_runner_ = runner;
+  closure();
+  current_runner_ = invoking_from;
+  if (inserted)
+    yielded_.erase(invoking_from);
+}
+
 void SimulatedTimeControllerImpl::RunReadyRunners() {
   RTC_DCHECK_RUN_ON(&thread_checker_);
   rtc::CritScope lock(&lock_);
@@ -356,15 +580,26 @@ void SimulatedTimeControllerImpl::RunReadyRunners() {
     while (!ready_runners_.empty()) {
       auto* runner = ready_runners_.front();
       ready_runners_.pop_front();
-      runner->UpdateReady(current_time);
-      // Note that the Run function might indirectly cause a call to
+      // Note that the RunReady function might indirectly cause a call to
       // Unregister() which will recursively grab |lock_| again to remove items
       // from |ready_runners_|.
-      runner->Run(current_time);
+      RunReady(runner, current_time);
     }
   }
 }
 
+void SimulatedTimeControllerImpl::RunReady(SimulatedSequenceRunner* runner,
+                                           Timestamp at_time) {
+  SimulatedSequenceRunner* previous_runner = current_runner_;
+  current_runner_ = runner;
+  {
+    // Threads set themselves as current while running.
+    ScopedCurrentThread reset_thread(nullptr);
+    runner->RunReady(at_time);
+  }
+  current_runner_ = previous_runner;
+}
+
 Timestamp SimulatedTimeControllerImpl::CurrentTime() const {
   rtc::CritScope lock(&time_lock_);
   return current_time_;
@@ -389,6 +624,11 @@ void SimulatedTimeControllerImpl::AdvanceTime(Timestamp target_time) {
   current_time_ = target_time;
 }
 
+void SimulatedTimeControllerImpl::Register(SimulatedSequenceRunner* runner) {
+  rtc::CritScope lock(&lock_);
+  runners_.push_back(runner);
+}
+
 void SimulatedTimeControllerImpl::Unregister(SimulatedSequenceRunner* runner) {
   rtc::CritScope lock(&lock_);
   bool removed = RemoveByValue(runners_, runner);
@@ -402,6 +642,7 @@ GlobalSimulatedTimeController::GlobalSimulatedTimeController(
     Timestamp start_time)
     : sim_clock_(start_time.us()), impl_(start_time) {
   global_clock_.SetTime(start_time);
+  main_thread_ = impl_.CreateMainThread();
 }
 
 GlobalSimulatedTimeController::~GlobalSimulatedTimeController() = default;
@@ -419,6 +660,16 @@ GlobalSimulatedTimeController::CreateProcessThread(const char* thread_name) {
   return impl_.CreateProcessThread(thread_name);
 }
 
+std::unique_ptr<rtc::Thread> GlobalSimulatedTimeController::CreateThread(
+    const std::string& name,
+    std::unique_ptr<rtc::SocketServer> socket_server) {
+  return impl_.CreateThread(name, std::move(socket_server));
+}
+
+rtc::Thread* GlobalSimulatedTimeController::GetMainThread() {
+  return main_thread_.get();
+}
+
 void GlobalSimulatedTimeController::Sleep(TimeDelta duration) {
   rtc::ScopedYieldPolicy yield_policy(&impl_);
   Timestamp current_time = impl_.CurrentTime();
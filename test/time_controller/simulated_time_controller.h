@@ -10,8 +10,10 @@
 #ifndef TEST_TIME_CONTROLLER_SIMULATED_TIME_CONTROLLER_H_
 #define TEST_TIME_CONTROLLER_SIMULATED_TIME_CONTROLLER_H_
 
+#include <functional>
 #include <list>
 #include <memory>
+#include <string>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -22,14 +24,25 @@
 #include "rtc_base/critical_section.h"
 #include "rtc_base/fake_clock.h"
 #include "rtc_base/platform_thread_types.h"
+#include "rtc_base/socket_server.h"
 #include "rtc_base/synchronization/yield_policy.h"
+#include "rtc_base/thread.h"
 #include "rtc_base/thread_checker.h"
 #include "test/time_controller/time_controller.h"
 
 namespace webrtc {
 
 namespace sim_time_impl {
-class SimulatedSequenceRunner;
+// A task queue, process thread or rtc::Thread run by the controller.
+class SimulatedSequenceRunner {
+ public:
+  virtual ~SimulatedSequenceRunner() = default;
+  // Provides next run time.
+  virtual Timestamp GetNextRunTime() const = 0;
+  // Runs all tasks, modules or messages that are supposed to execute by
+  // |at_time| and updates next run time.
+  virtual void RunReady(Timestamp at_time) = 0;
+};
 
 class SimulatedTimeControllerImpl : public TaskQueueFactory,
                                     public rtc::YieldInterface {
@@ -47,6 +60,21 @@ class SimulatedTimeControllerImpl : public TaskQueueFactory,
   void YieldExecution() override;
   // Create process thread with the name |thread_name|.
   std::unique_ptr<ProcessThread> CreateProcessThread(const char* thread_name);
+  // Create thread with the name |name|, using |socket_server| for I/O if
+  // given. Only messages are simulated, so the socket server must not depend
+  // on waiting for I/O in real time.
+  std::unique_ptr<rtc::Thread> CreateThread(
+      const std::string& name,
+      std::unique_ptr<rtc::SocketServer> socket_server);
+  // Creates the thread representing the thread owning the controller. It's
+  // treated as running whenever no other runner is, so it's skipped when the
+  // owning thread yields.
+  std::unique_ptr<rtc::Thread> CreateMainThread();
+  // Runs |closure| on behalf of |runner|, which is how messages sent with
+  // rtc::Thread::Send are executed. The runner currently running is skipped
+  // until |closure| returns, like when yielding.
+  void InvokeOn(SimulatedSequenceRunner* runner,
+                std::function<void()> closure);
   // Runs all runners in |runners_| that has tasks or modules ready for
   // execution.
   void RunReadyRunners();
@@ -56,10 +84,15 @@ class SimulatedTimeControllerImpl : public TaskQueueFactory,
   Timestamp NextRunTime() const;
   // Set |current_time_| to |target_time|.
   void AdvanceTime(Timestamp target_time);
+  // Adds |runner| to |runners_|.
+  void Register(SimulatedSequenceRunner* runner);
   // Removes |runner| from |runners_|.
   void Unregister(SimulatedSequenceRunner* runner);
 
  private:
+  // Runs |runner| as the current runner.
+  void RunReady(SimulatedSequenceRunner* runner, Timestamp at_time);
+
   const rtc::PlatformThreadId thread_id_;
   rtc::ThreadChecker thread_checker_;
   rtc::CriticalSection time_lock_;
@@ -71,16 +104,23 @@ class SimulatedTimeControllerImpl : public TaskQueueFactory,
   // runners can removed from here by Unregister().
   std::list<SimulatedSequenceRunner*> ready_runners_ RTC_GUARDED_BY(lock_);
 
-  // Task queues on which YieldExecution has been called.
-  std::unordered_set<TaskQueueBase*> yielded_ RTC_GUARDED_BY(thread_checker_);
+  // The runner currently executing on the controller thread, which is the
+  // main thread, if any, when no other runner is executing.
+  SimulatedSequenceRunner* current_runner_ RTC_GUARDED_BY(thread_checker_) =
+      nullptr;
+  // Runners on which YieldExecution has been called.
+  std::unordered_set<SimulatedSequenceRunner*> yielded_
+      RTC_GUARDED_BY(thread_checker_);
 };
 }  // namespace sim_time_impl
 
-// TimeController implementation using completely simulated time. Task queues
-// and process threads created by this controller will run delayed activities
-// when Sleep() is called. Overrides the global clock backing rtc::TimeMillis()
-// and rtc::TimeMicros(). Note that this is not thread safe since it modifies
-// global state.
+// TimeController implementation using completely simulated time. Task queues,
+// process threads and rtc::Threads created by this controller will run delayed
+// activities when Sleep() is called. Overrides the global clock backing
+// rtc::TimeMillis() and rtc::TimeMicros(), and installs a simulated thread as
+// the current rtc::Thread, so that a whole PeerConnection stack can run in
+// simulated time, given that its network I/O is emulated. Note that this is
+// not thread safe since it modifies global state.
 class GlobalSimulatedTimeController : public TimeController {
  public:
   explicit GlobalSimulatedTimeController(Timestamp start_time);
@@ -90,6 +130,10 @@ class GlobalSimulatedTimeController : public TimeController {
   TaskQueueFactory* GetTaskQueueFactory() override;
   std::unique_ptr<ProcessThread> CreateProcessThread(
       const char* thread_name) override;
+  std::unique_ptr<rtc::Thread> CreateThread(
+      const std::string& name,
+      std::unique_ptr<rtc::SocketServer> socket_server = nullptr) override;
+  rtc::Thread* GetMainThread() override;
   void Sleep(TimeDelta duration) override;
   void InvokeWithControlledYield(std::function<void()> closure) override;
 
@@ -98,6 +142,7 @@ class GlobalSimulatedTimeController : public TimeController {
   // Provides simulated CurrentNtpInMilliseconds()
   SimulatedClock sim_clock_;
   sim_time_impl::SimulatedTimeControllerImpl impl_;
+  std::unique_ptr<rtc::Thread> main_thread_;
 };
 }  // namespace webrtc
 
@@ -10,10 +10,15 @@
 
 #include <atomic>
 #include <memory>
+#include <vector>
 
 #include "absl/memory/memory.h"
+#include "rtc_base/location.h"
+#include "rtc_base/message_handler.h"
 #include "rtc_base/task_queue.h"
 #include "rtc_base/task_utils/repeating_task.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 #include "test/time_controller/simulated_time_controller.h"
@@ -40,6 +45,17 @@ class TaskHandleStopper {
  private:
   RepeatingTaskHandle handle_;
 };
+
+// Records when messages are handled and on which thread.
+class MessageRecorder : public rtc::MessageHandler {
+ public:
+  void OnMessage(rtc::Message* msg) override {
+    times_ms.push_back(rtc::TimeMillis());
+    threads.push_back(rtc::Thread::Current());
+  }
+  std::vector<int64_t> times_ms;
+  std::vector<rtc::Thread*> threads;
+};
 }  // namespace
 
 TEST(SimulatedTimeControllerTest, TaskIsStoppedOnStop) {
@@ -117,4 +133,66 @@ TEST(SimulatedTimeControllerTest, Example) {
   };
   task_queue.PostTask(Destructor{std::move(object)});
 }
+
+TEST(SimulatedTimeControllerTest, ThreadRunsDelayedMessagesInSimulatedTime) {
+  GlobalSimulatedTimeController time_simulation(kStartTime);
+  std::unique_ptr<rtc::Thread> thread =
+      time_simulation.CreateThread("TestThread");
+  MessageRecorder recorder;
+  thread->Post(RTC_FROM_HERE, &recorder);
+  thread->PostDelayed(RTC_FROM_HERE, 100, &recorder);
+  thread->PostDelayed(RTC_FROM_HERE, 10000, &recorder);
+  EXPECT_TRUE(recorder.times_ms.empty());
+
+  time_simulation.Sleep(TimeDelta::ms(150));
+  EXPECT_EQ(recorder.times_ms,
+            std::vector<int64_t>({kStartTime.ms(), kStartTime.ms() + 100}));
+  EXPECT_EQ(recorder.threads,
+            std::vector<rtc::Thread*>({thread.get(), thread.get()}));
+
+  time_simulation.Sleep(TimeDelta::seconds(10));
+  ASSERT_EQ(recorder.times_ms.size(), 3u);
+  EXPECT_EQ(recorder.times_ms[2], kStartTime.ms() + 10000);
+}
+
+TEST(SimulatedTimeControllerTest, ThreadInvokeRunsOnTargetThread) {
+  GlobalSimulatedTimeController time_simulation(kStartTime);
+  rtc::Thread* main_thread = time_simulation.GetMainThread();
+  std::unique_ptr<rtc::Thread> worker =
+      time_simulation.CreateThread("Worker");
+  std::unique_ptr<rtc::Thread> network =
+      time_simulation.CreateThread("Network");
+  EXPECT_EQ(rtc::Thread::Current(), main_thread);
+
+  // Nested invokes, including one back to the invoking thread, run without
+  // blocking and without advancing time.
+  rtc::Thread* network_invoked_on = nullptr;
+  rtc::Thread* worker_invoked_on = worker->Invoke<rtc::Thread*>(
+      RTC_FROM_HERE, [&] {
+        network_invoked_on = network->Invoke<rtc::Thread*>(RTC_FROM_HERE, [&] {
+          return worker->Invoke<rtc::Thread*>(
+              RTC_FROM_HERE, [] { return rtc::Thread::Current(); });
+        });
+        return rtc::Thread::Current();
+      });
+  EXPECT_EQ(worker_invoked_on, worker.get());
+  EXPECT_EQ(network_invoked_on, worker.get());
+  EXPECT_EQ(rtc::Thread::Current(), main_thread);
+  EXPECT_EQ(rtc::TimeMillis(), kStartTime.ms());
+}
+
+TEST(SimulatedTimeControllerTest, MainThreadRunsMessagesWhenSleeping) {
+  GlobalSimulatedTimeController time_simulation(kStartTime);
+  rtc::Thread* main_thread = time_simulation.GetMainThread();
+  std::unique_ptr<rtc::Thread> thread =
+      time_simulation.CreateThread("TestThread");
+  MessageRecorder recorder;
+  thread->PostTask(RTC_FROM_HERE, [&] {
+    main_thread->PostDelayed(RTC_FROM_HERE, 10, &recorder);
+  });
+  time_simulation.Sleep(TimeDelta::ms(20));
+  EXPECT_EQ(recorder.times_ms, std::vector<int64_t>({kStartTime.ms() + 10}));
+  EXPECT_EQ(recorder.threads, std::vector<rtc::Thread*>({main_thread}));
+}
+
 }  // namespace webrtc
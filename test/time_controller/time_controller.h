@@ -12,10 +12,13 @@
 
 #include <functional>
 #include <memory>
+#include <string>
 
 #include "api/task_queue/task_queue_factory.h"
 #include "api/units/time_delta.h"
 #include "modules/utility/include/process_thread.h"
+#include "rtc_base/socket_server.h"
+#include "rtc_base/thread.h"
 #include "system_wrappers/include/clock.h"
 
 namespace webrtc {
@@ -35,6 +38,13 @@ class TimeController {
   // Creates a process thread.
   virtual std::unique_ptr<ProcessThread> CreateProcessThread(
       const char* thread_name) = 0;
+  // Creates and starts an rtc::Thread, using |socket_server| if given.
+  virtual std::unique_ptr<rtc::Thread> CreateThread(
+      const std::string& name,
+      std::unique_ptr<rtc::SocketServer> socket_server = nullptr) = 0;
+  // Returns the rtc::Thread representing the thread owning this instance, to
+  // be used e.g. as the signaling thread of a PeerConnectionFactory.
+  virtual rtc::Thread* GetMainThread() = 0;
   // Allow task queues and process threads created by this instance to execute
   // for the given |duration|.
   virtual void Sleep(TimeDelta duration) = 0;
@@ -25,10 +25,18 @@ const size_t kMaxPacketMapSize = 2000;
 // Limit for the maximum number of streams to calculate stats for.
 const size_t kMaxSsrcMapSize = 50;
 const int kMinRequiredPeriodicSamples = 5;
+// Capture to sent delays above this are kept in a map rather than in the
+// array of the percentile counter.
+const uint32_t kMaxCommonCaptureToSentDelayMs = 500;
+const size_t kMinRequiredSentPackets = 200;
 }  // namespace
 
 SendDelayStats::SendDelayStats(Clock* clock)
-    : clock_(clock), num_old_packets_(0), num_skipped_packets_(0) {}
+    : clock_(clock),
+      num_old_packets_(0),
+      num_skipped_packets_(0),
+      capture_to_sent_delay_(kMaxCommonCaptureToSentDelayMs),
+      num_sent_packets_(0) {}
 
 SendDelayStats::~SendDelayStats() {
   if (num_old_packets_ > 0 || num_skipped_packets_ > 0) {
@@ -49,6 +57,13 @@ void SendDelayStats::UpdateHistograms() {
       RTC_LOG(LS_INFO) << "WebRTC.Video.SendDelayInMs, " << stats.ToString();
     }
   }
+  if (num_sent_packets_ >= kMinRequiredSentPackets) {
+    uint32_t delay_95p_ms = *capture_to_sent_delay_.GetPercentile(0.95f);
+    RTC_HISTOGRAM_COUNTS_10000(
+        "WebRTC.Video.CaptureToSentDelay95PercentileInMs", delay_95p_ms);
+    RTC_LOG(LS_INFO) << "WebRTC.Video.CaptureToSentDelay95PercentileInMs "
+                     << delay_95p_ms;
+  }
 }
 
 void SendDelayStats::AddSsrcs(const VideoSendStream::Config& config) {
@@ -102,6 +117,12 @@ bool SendDelayStats::OnSentPacket(int packet_id, int64_t time_ms) {
   // Elapsed time from send (to transport) -> sent (leaving socket).
   int diff_ms = time_ms - it->second.send_time_ms;
   GetSendDelayCounter(it->second.ssrc)->Add(diff_ms);
+  // Elapsed time from capture -> sent (leaving socket).
+  if (time_ms >= it->second.capture_time_ms) {
+    capture_to_sent_delay_.Add(
+        static_cast<uint32_t>(time_ms - it->second.capture_time_ms));
+    ++num_sent_packets_;
+  }
   packets_.erase(it);
   return true;
 }
@@ -20,6 +20,7 @@
 #include "call/video_send_stream.h"
 #include "modules/include/module_common_types_public.h"
 #include "rtc_base/critical_section.h"
+#include "rtc_base/numerics/histogram_percentile_counter.h"
 #include "rtc_base/thread_annotations.h"
 #include "system_wrappers/include/clock.h"
 #include "video/stats_counter.h"
@@ -81,6 +82,10 @@ class SendDelayStats : public SendPacketObserver {
   // Mapped by SSRC.
   std::map<uint32_t, std::unique_ptr<AvgCounter>> send_delay_counters_
       RTC_GUARDED_BY(crit_);
+
+  // Elapsed time from capture -> sent (leaving socket), for all streams.
+  rtc::HistogramPercentileCounter capture_to_sent_delay_ RTC_GUARDED_BY(crit_);
+  size_t num_sent_packets_ RTC_GUARDED_BY(crit_);
 };
 
 }  // namespace webrtc
@@ -128,4 +128,23 @@ TEST_F(SendDelayStatsTest, HistogramsAreUpdated) {
   EXPECT_EQ(1, metrics::NumEvents("WebRTC.Video.SendDelayInMs", kDelayMs2));
 }
 
+TEST_F(SendDelayStatsTest, CaptureToSentHistogramIsUpdated) {
+  metrics::Reset();
+  const int64_t kPacerDelayMs = 10;
+  const int64_t kSendDelayMs = 5;
+  const int kNumPackets = 200;
+
+  for (uint16_t id = 0; id < kNumPackets; ++id) {
+    const int64_t capture_time_ms = clock_.TimeInMilliseconds();
+    clock_.AdvanceTimeMilliseconds(kPacerDelayMs);
+    OnSendPacket(id, kSsrc1, capture_time_ms);
+    clock_.AdvanceTimeMilliseconds(kSendDelayMs);
+    EXPECT_TRUE(OnSentPacket(id));
+  }
+  stats_.reset();
+  const char kHistogram[] = "WebRTC.Video.CaptureToSentDelay95PercentileInMs";
+  EXPECT_EQ(1, metrics::NumSamples(kHistogram));
+  EXPECT_EQ(1, metrics::NumEvents(kHistogram, kPacerDelayMs + kSendDelayMs));
+}
+
 }  // namespace webrtc
@@ -32,6 +32,9 @@ const int64_t kMaxEncodedFrameWindowMs = 800;
 const uint32_t kMaxEncodedFrameTimestampDiff = 900000;  // 10 sec.
 const int64_t kBucketSizeMs = 100;
 const size_t kBucketCount = 10;
+// Pipeline delays above this are kept in a map rather than in the array of
+// the percentile counters.
+const uint32_t kMaxCommonPipelineDelayMs = 500;
 
 const char kVp8ForcedFallbackEncoderFieldTrial[] =
     "WebRTC-VP8-Forced-Fallback-Encoder-v2";
@@ -732,6 +735,11 @@ VideoSendStream::Stats SendStatisticsProxy::GetStats() {
   stats_.media_bitrate_bps = media_byte_rate_tracker_.ComputeRate() * 8;
   stats_.quality_limitation_durations_ms =
       quality_limitation_reason_tracker_.DurationsMs();
+  stats_.capture_to_encoder_task_delay = encoder_task_delay_counter_.GetStats();
+  stats_.capture_to_encode_start_delay = encode_start_delay_counter_.GetStats();
+  stats_.capture_to_encode_finish_delay =
+      encode_finish_delay_counter_.GetStats();
+  stats_.capture_to_packetized_delay = packetized_delay_counter_.GetStats();
   return stats_;
 }
 
@@ -941,6 +949,14 @@ void SendStatisticsProxy::OnSendEncodedImage(
     update_times_[ssrc].resolution_update_ms = clock_->TimeInMilliseconds();
   }
 
+  // The encode times are not known for encoders with internal source.
+  if (encoded_image.timing_.encode_start_ms > 0) {
+    encode_start_delay_counter_.Add(encoded_image.capture_time_ms_,
+                                    encoded_image.timing_.encode_start_ms);
+    encode_finish_delay_counter_.Add(encoded_image.capture_time_ms_,
+                                     encoded_image.timing_.encode_finish_ms);
+  }
+
   uma_container_->key_frame_counter_.Add(encoded_image._frameType ==
                                          VideoFrameType::kVideoFrameKey);
 
@@ -1029,6 +1045,17 @@ void SendStatisticsProxy::OnIncomingFrame(int width, int height) {
   }
 }
 
+void SendStatisticsProxy::OnIncomingFrameQueued(int64_t capture_time_ms) {
+  rtc::CritScope lock(&crit_);
+  encoder_task_delay_counter_.Add(capture_time_ms,
+                                  clock_->TimeInMilliseconds());
+}
+
+void SendStatisticsProxy::OnFramePacketized(int64_t capture_time_ms) {
+  rtc::CritScope lock(&crit_);
+  packetized_delay_counter_.Add(capture_time_ms, clock_->TimeInMilliseconds());
+}
+
 void SendStatisticsProxy::OnFrameDropped(DropReason reason) {
   rtc::CritScope lock(&crit_);
   switch (reason) {
@@ -1247,6 +1274,33 @@ void SendStatisticsProxy::SendSideDelayUpdated(int avg_delay_ms,
   uma_container_->max_delay_counter_.Add(max_delay_ms);
 }
 
+SendStatisticsProxy::PipelineDelayCounter::PipelineDelayCounter()
+    : percentiles_(kMaxCommonPipelineDelayMs) {}
+
+SendStatisticsProxy::PipelineDelayCounter::~PipelineDelayCounter() = default;
+
+void SendStatisticsProxy::PipelineDelayCounter::Add(int64_t capture_time_ms,
+                                                    int64_t time_ms) {
+  // Frames without a capture time, and delays that can't be right because the
+  // capture time is in another clock, are not counted.
+  if (capture_time_ms <= 0 || time_ms < capture_time_ms)
+    return;
+  percentiles_.Add(static_cast<uint32_t>(time_ms - capture_time_ms));
+  ++num_frames_;
+}
+
+VideoSendStream::PipelineDelayStats
+SendStatisticsProxy::PipelineDelayCounter::GetStats() {
+  VideoSendStream::PipelineDelayStats stats;
+  if (num_frames_ == 0)
+    return stats;
+  stats.num_frames = num_frames_;
+  stats.p50_ms = *percentiles_.GetPercentile(0.5f);
+  stats.p95_ms = *percentiles_.GetPercentile(0.95f);
+  stats.p99_ms = *percentiles_.GetPercentile(0.99f);
+  return stats;
+}
+
 void SendStatisticsProxy::StatsTimer::Start(int64_t now_ms) {
   if (start_ms == -1)
     start_ms = now_ms;
@@ -23,6 +23,7 @@
 #include "modules/video_coding/include/video_coding_defines.h"
 #include "rtc_base/critical_section.h"
 #include "rtc_base/numerics/exp_filter.h"
+#include "rtc_base/numerics/histogram_percentile_counter.h"
 #include "rtc_base/rate_tracker.h"
 #include "rtc_base/thread_annotations.h"
 #include "system_wrappers/include/clock.h"
@@ -61,6 +62,10 @@ class SendStatisticsProxy : public VideoStreamEncoderObserver,
 
   // Used to update incoming frame rate.
   void OnIncomingFrame(int width, int height) override;
+  void OnIncomingFrameQueued(int64_t capture_time_ms) override;
+
+  // Called when an encoded frame has been packetized into the pacer queue.
+  void OnFramePacketized(int64_t capture_time_ms);
 
   // Dropped frame stats.
   void OnFrameDropped(DropReason) override;
@@ -187,6 +192,18 @@ class SendStatisticsProxy : public VideoStreamEncoderObserver,
     int down = 0;
     int up = 0;
   };
+  // Time from capture until frames reach a stage of the send pipeline.
+  class PipelineDelayCounter {
+   public:
+    PipelineDelayCounter();
+    ~PipelineDelayCounter();
+    void Add(int64_t capture_time_ms, int64_t time_ms);
+    VideoSendStream::PipelineDelayStats GetStats();
+
+   private:
+    rtc::HistogramPercentileCounter percentiles_;
+    uint32_t num_frames_ = 0;
+  };
 
   // Map holding encoded frames (mapped by timestamp).
   // If simulcast layers are encoded on different threads, there is no guarantee
@@ -252,6 +269,11 @@ class SendStatisticsProxy : public VideoStreamEncoderObserver,
 
   absl::optional<int64_t> last_outlier_timestamp_ RTC_GUARDED_BY(crit_);
 
+  PipelineDelayCounter encoder_task_delay_counter_ RTC_GUARDED_BY(crit_);
+  PipelineDelayCounter encode_start_delay_counter_ RTC_GUARDED_BY(crit_);
+  PipelineDelayCounter encode_finish_delay_counter_ RTC_GUARDED_BY(crit_);
+  PipelineDelayCounter packetized_delay_counter_ RTC_GUARDED_BY(crit_);
+
   struct EncoderChangeEvent {
     std::string previous_encoder_implementation;
     std::string new_encoder_implementation;
@@ -368,6 +368,58 @@ TEST_F(SendStatisticsProxyTest, OnSendEncodedImageWithoutQpQpSumWontExist) {
   EXPECT_EQ(absl::nullopt, statistics_proxy_->GetStats().qp_sum);
 }
 
+TEST_F(SendStatisticsProxyTest, ReportsDelaysThroughSendPipeline) {
+  const int64_t kTaskDelayMs = 5;
+  const int64_t kEncodeStartDelayMs = 8;
+  const int64_t kEncodeTimeMs = 20;
+  const int64_t kPacketizationTimeMs = 2;
+  const int kNumFrames = 100;
+  EncodedImage encoded_image;
+  CodecSpecificInfo codec_info;
+  for (int i = 0; i < kNumFrames; ++i) {
+    const int64_t capture_time_ms = fake_clock_.TimeInMilliseconds();
+    // Every tenth frame waits longer for its encoder queue task to run.
+    const int64_t task_delay_ms =
+        i % 10 == 0 ? 10 * kTaskDelayMs : kTaskDelayMs;
+    fake_clock_.AdvanceTimeMilliseconds(task_delay_ms);
+    statistics_proxy_->OnIncomingFrameQueued(capture_time_ms);
+    fake_clock_.AdvanceTimeMilliseconds(kEncodeStartDelayMs + kEncodeTimeMs -
+                                        task_delay_ms);
+    encoded_image.capture_time_ms_ = capture_time_ms;
+    encoded_image.SetEncodeTime(capture_time_ms + kEncodeStartDelayMs,
+                                fake_clock_.TimeInMilliseconds());
+    statistics_proxy_->OnSendEncodedImage(encoded_image, &codec_info);
+    fake_clock_.AdvanceTimeMilliseconds(kPacketizationTimeMs);
+    statistics_proxy_->OnFramePacketized(capture_time_ms);
+    fake_clock_.AdvanceTimeMilliseconds(100);
+  }
+
+  VideoSendStream::Stats stats = statistics_proxy_->GetStats();
+  EXPECT_EQ(static_cast<uint32_t>(kNumFrames),
+            stats.capture_to_encoder_task_delay.num_frames);
+  EXPECT_EQ(kTaskDelayMs, stats.capture_to_encoder_task_delay.p50_ms);
+  EXPECT_EQ(10 * kTaskDelayMs, stats.capture_to_encoder_task_delay.p95_ms);
+  EXPECT_EQ(static_cast<uint32_t>(kNumFrames),
+            stats.capture_to_encode_start_delay.num_frames);
+  EXPECT_EQ(kEncodeStartDelayMs, stats.capture_to_encode_start_delay.p99_ms);
+  EXPECT_EQ(kEncodeStartDelayMs + kEncodeTimeMs,
+            stats.capture_to_encode_finish_delay.p50_ms);
+  EXPECT_EQ(static_cast<uint32_t>(kNumFrames),
+            stats.capture_to_packetized_delay.num_frames);
+  EXPECT_EQ(kEncodeStartDelayMs + kEncodeTimeMs + kPacketizationTimeMs,
+            stats.capture_to_packetized_delay.p50_ms);
+}
+
+TEST_F(SendStatisticsProxyTest, NoEncodeDelaysWithoutEncodeTimes) {
+  EncodedImage encoded_image;
+  CodecSpecificInfo codec_info;
+  encoded_image.capture_time_ms_ = fake_clock_.TimeInMilliseconds();
+  statistics_proxy_->OnSendEncodedImage(encoded_image, &codec_info);
+  VideoSendStream::Stats stats = statistics_proxy_->GetStats();
+  EXPECT_EQ(0u, stats.capture_to_encode_start_delay.num_frames);
+  EXPECT_EQ(0u, stats.capture_to_encode_finish_delay.num_frames);
+}
+
 TEST_F(SendStatisticsProxyTest, TotalEncodedBytesTargetFirstFrame) {
   const uint32_t kTargetBytesPerSecond = 100000;
   statistics_proxy_->OnSetEncoderTargetRate(kTargetBytesPerSecond * 8);
@@ -629,6 +629,8 @@ EncodedImageCallback::Result VideoSendStreamImpl::OnEncodedImage(
   } else {
     result = rtp_video_sender_->OnEncodedImage(
         encoded_image, codec_specific_info, fragmentation);
+    if (result.error == EncodedImageCallback::Result::OK)
+      stats_proxy_->OnFramePacketized(encoded_image.capture_time_ms_);
   }
   // Check if there's a throttled VideoBitrateAllocation that we should try
   // sending.
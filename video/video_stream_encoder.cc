@@ -955,6 +955,9 @@ void VideoStreamEncoder::OnFrame(const VideoFrame& video_frame) {
 
   last_captured_timestamp_ = incoming_frame.ntp_time_ms();
 
+  TRACE_EVENT_ASYNC_STEP0("webrtc", "Video", incoming_frame.render_time_ms(),
+                          "Queue");
+
   int64_t post_time_us = rtc::TimeMicros();
   ++posted_frames_waiting_for_encode_;
 
@@ -963,6 +966,8 @@ void VideoStreamEncoder::OnFrame(const VideoFrame& video_frame) {
         RTC_DCHECK_RUN_ON(&encoder_queue_);
         encoder_stats_observer_->OnIncomingFrame(incoming_frame.width(),
                                                  incoming_frame.height());
+        encoder_stats_observer_->OnIncomingFrameQueued(
+            incoming_frame.render_time_ms());
         ++captured_frame_count_;
         const int posted_frames_waiting_for_encode =
             posted_frames_waiting_for_encode_.fetch_sub(1);
@@ -1244,30 +1249,26 @@ void VideoStreamEncoder::EncodeVideoFrame(const VideoFrame& video_frame,
   VideoFrame out_frame(video_frame);
   // Crop frame if needed.
   if (crop_width_ > 0 || crop_height_ > 0) {
-    // If the frame can't be converted to I420, drop it.
-    auto i420_buffer = video_frame.video_frame_buffer()->ToI420();
-    if (!i420_buffer) {
-      RTC_LOG(LS_ERROR) << "Frame conversion for crop failed, dropping frame.";
-      return;
-    }
     int cropped_width = video_frame.width() - crop_width_;
     int cropped_height = video_frame.height() - crop_height_;
-    rtc::scoped_refptr<I420Buffer> cropped_buffer =
-        I420Buffer::Create(cropped_width, cropped_height);
+    rtc::scoped_refptr<I420BufferInterface> cropped_buffer;
     // TODO(ilnik): Remove scaling if cropping is too big, as it should never
     // happen after SinkWants signaled correctly from ReconfigureEncoder.
     VideoFrame::UpdateRect update_rect = video_frame.update_rect();
     if (crop_width_ < 4 && crop_height_ < 4) {
-      cropped_buffer->CropAndScaleFrom(*i420_buffer, crop_width_ / 2,
-                                       crop_height_ / 2, cropped_width,
-                                       cropped_height);
+      cropped_buffer = crop_scale_rotator_.CropScaleAndRotate(
+          video_frame.video_frame_buffer(), crop_width_ / 2, crop_height_ / 2,
+          cropped_width, cropped_height, cropped_width, cropped_height,
+          kVideoRotation_0);
       update_rect.offset_x -= crop_width_ / 2;
       update_rect.offset_y -= crop_height_ / 2;
       update_rect.Intersect(
           VideoFrame::UpdateRect{0, 0, cropped_width, cropped_height});
 
     } else {
-      cropped_buffer->ScaleFrom(*i420_buffer);
+      cropped_buffer = crop_scale_rotator_.ScaleAndRotate(
+          video_frame.video_frame_buffer(), cropped_width, cropped_height,
+          kVideoRotation_0);
       if (!update_rect.IsEmpty()) {
         // Since we can't reason about pixels after scaling, we invalidate whole
         // picture, if anything changed.
@@ -1275,6 +1276,11 @@ void VideoStreamEncoder::EncodeVideoFrame(const VideoFrame& video_frame,
             VideoFrame::UpdateRect{0, 0, cropped_width, cropped_height};
       }
     }
+    // If the frame can't be converted to I420, drop it.
+    if (!cropped_buffer) {
+      RTC_LOG(LS_ERROR) << "Frame conversion for crop failed, dropping frame.";
+      return;
+    }
     out_frame.set_video_frame_buffer(cropped_buffer);
     out_frame.set_update_rect(update_rect);
     out_frame.set_ntp_time_ms(video_frame.ntp_time_ms());
@@ -1324,15 +1330,10 @@ void VideoStreamEncoder::EncodeVideoFrame(const VideoFrame& video_frame,
   last_encode_info_ms_ = clock_->TimeInMilliseconds();
   RTC_DCHECK_EQ(send_codec_.width, out_frame.width());
   RTC_DCHECK_EQ(send_codec_.height, out_frame.height());
-  const VideoFrameBuffer::Type buffer_type =
-      out_frame.video_frame_buffer()->type();
-  const bool is_buffer_type_supported =
-      buffer_type == VideoFrameBuffer::Type::kI420 ||
-      (buffer_type == VideoFrameBuffer::Type::kNative &&
-       info.supports_native_handle);
-
-  if (!is_buffer_type_supported) {
-    // This module only supports software encoding.
+  if (!info.SupportsBufferType(out_frame.video_frame_buffer()->type())) {
+    // The encoder needs a memory backed buffer of another type. I420 is the
+    // fallback all encoders support. The frame is converted once here and the
+    // result passed down, so that the encoder doesn't convert it again.
     rtc::scoped_refptr<I420BufferInterface> converted_buffer(
         out_frame.video_frame_buffer()->ToI420());
 
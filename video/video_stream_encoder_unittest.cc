@@ -18,6 +18,7 @@
 #include "absl/memory/memory.h"
 #include "api/task_queue/default_task_queue_factory.h"
 #include "api/video/builtin_video_bitrate_allocator_factory.h"
+#include "api/video/i010_buffer.h"
 #include "api/video/i420_buffer.h"
 #include "api/video/video_bitrate_allocation.h"
 #include "api/video_codecs/video_encoder.h"
@@ -658,6 +659,7 @@ class VideoStreamEncoderTest : public ::testing::Test {
               VideoEncoder::ScalingSettings(1, 2, kMinPixelsPerFrame);
         }
         info.is_hardware_accelerated = is_hardware_accelerated_;
+        info.preferred_pixel_formats = preferred_pixel_formats_;
         for (int i = 0; i < kMaxSpatialLayers; ++i) {
           if (temporal_layers_supported_[i]) {
             int num_layers = temporal_layers_supported_[i].value() ? 2 : 1;
@@ -694,6 +696,18 @@ class VideoStreamEncoderTest : public ::testing::Test {
       is_hardware_accelerated_ = is_hardware_accelerated;
     }
 
+    void SetPreferredPixelFormats(
+        absl::InlinedVector<VideoFrameBuffer::Type,
+                            EncoderInfo::kMaxPreferredPixelFormats> formats) {
+      rtc::CritScope lock(&local_crit_sect_);
+      preferred_pixel_formats_ = std::move(formats);
+    }
+
+    VideoFrameBuffer::Type GetLastInputBufferType() const {
+      rtc::CritScope lock(&local_crit_sect_);
+      return last_input_buffer_type_;
+    }
+
     void SetTemporalLayersSupported(size_t spatial_idx, bool supported) {
       RTC_DCHECK_LT(spatial_idx, kMaxSpatialLayers);
       rtc::CritScope lock(&local_crit_sect_);
@@ -781,6 +795,7 @@ class VideoStreamEncoderTest : public ::testing::Test {
         ntp_time_ms_ = input_image.ntp_time_ms();
         last_input_width_ = input_image.width();
         last_input_height_ = input_image.height();
+        last_input_buffer_type_ = input_image.video_frame_buffer()->type();
         block_encode = block_next_encode_;
         block_next_encode_ = false;
         last_update_rect_ = input_image.update_rect();
@@ -854,6 +869,12 @@ class VideoStreamEncoderTest : public ::testing::Test {
     int last_input_height_ RTC_GUARDED_BY(local_crit_sect_) = 0;
     bool quality_scaling_ RTC_GUARDED_BY(local_crit_sect_) = true;
     bool is_hardware_accelerated_ RTC_GUARDED_BY(local_crit_sect_) = false;
+    absl::InlinedVector<VideoFrameBuffer::Type,
+                        EncoderInfo::kMaxPreferredPixelFormats>
+        preferred_pixel_formats_ RTC_GUARDED_BY(local_crit_sect_) = {
+            VideoFrameBuffer::Type::kI420};
+    VideoFrameBuffer::Type last_input_buffer_type_
+        RTC_GUARDED_BY(local_crit_sect_) = VideoFrameBuffer::Type::kI420;
     std::unique_ptr<Vp8FrameBufferController> frame_buffer_controller_
         RTC_GUARDED_BY(local_crit_sect_);
     absl::optional<bool>
@@ -1172,6 +1193,40 @@ TEST_F(VideoStreamEncoderTest, DropFrameWithFailedI420ConversionWithCrop) {
   video_stream_encoder_->Stop();
 }
 
+TEST_F(VideoStreamEncoderTest, PassesBufferTypesTheEncoderSupports) {
+  video_stream_encoder_->OnBitrateUpdated(
+      DataRate::bps(kTargetBitrateBps), DataRate::bps(kTargetBitrateBps), 0, 0);
+
+  auto create_i010_frame = [this](int64_t ntp_time_ms) {
+    VideoFrame frame =
+        VideoFrame::Builder()
+            .set_video_frame_buffer(
+                I010Buffer::Create(codec_width_, codec_height_))
+            .set_timestamp_rtp(99)
+            .set_timestamp_ms(99)
+            .set_rotation(kVideoRotation_0)
+            .build();
+    frame.set_ntp_time_ms(ntp_time_ms);
+    return frame;
+  };
+
+  // By default, encoders get I420.
+  video_source_.IncomingCapturedFrame(create_i010_frame(1));
+  WaitForEncodedFrame(1);
+  EXPECT_EQ(VideoFrameBuffer::Type::kI420,
+            fake_encoder_.GetLastInputBufferType());
+
+  // Buffers of the types the encoder prefers are passed as is.
+  fake_encoder_.SetPreferredPixelFormats(
+      {VideoFrameBuffer::Type::kI010, VideoFrameBuffer::Type::kI420});
+  video_source_.IncomingCapturedFrame(create_i010_frame(2));
+  WaitForEncodedFrame(2);
+  EXPECT_EQ(VideoFrameBuffer::Type::kI010,
+            fake_encoder_.GetLastInputBufferType());
+
+  video_stream_encoder_->Stop();
+}
+
 TEST_F(VideoStreamEncoderTest,
        ConfigureEncoderTriggersOnEncoderConfigurationChanged) {
   video_stream_encoder_->OnBitrateUpdated(